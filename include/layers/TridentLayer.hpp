@@ -42,6 +42,21 @@ class TridentScan : public DBLayer::Scan {
         DBLayer::Hint *hint;
         size_t countHint;
 
+        //Pushed down by the range FILTERs on the inlined literals
+        struct RangeFilter {
+            int pos;
+            uint64_t begin, end;
+            uint64_t lo, hi;
+        };
+        std::vector<RangeFilter> rangeFilters;
+
+        bool nextRow();
+
+        bool isRejected();
+
+        //Moves to the first row that passes the range filters
+        bool skipRejected(bool resp);
+
     public:
         TridentScan(const int perm, const DBLayer::Aggr_t a,
                 Querier *q, DBLayer::Hint *hint) : a(a), perm(perm),
@@ -69,6 +84,9 @@ class TridentScan : public DBLayer::Scan {
 
         bool first(uint64_t, bool, uint64_t, bool, uint64_t, bool);
 
+        void addRangeFilter(int pos, uint64_t begin, uint64_t end,
+                uint64_t lo, uint64_t hi);
+
         ~TridentScan();
 };
 
@@ -190,6 +208,19 @@ class TridentLayer : public DBLayer {
                 ::Type::ID& type,
                 unsigned& subType);
 
+		DDLEXPORT void lookupManyById(const uint64_t *ids,
+                const size_t n,
+                std::string *texts,
+                ::Type::ID *types,
+                bool *found);
+
+        DDLEXPORT bool searchText(const std::string &pattern,
+                const uint64_t maxCandidates,
+                std::vector<uint64_t> &ids,
+                uint64_t &idsUpperBound);
+
+        DDLEXPORT bool inlinesLiterals();
+
         DDLEXPORT uint64_t getNextId();
 
         DDLEXPORT double getScanCost(DBLayer::DataOrder order,
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _BATCHREADERS_H
+#define _BATCHREADERS_H
+
+#include <trident/kb/consts.h>
+
+#include <inttypes.h>
+#include <cstddef>
+
+#define BATCH_SCALAR 0
+#define BATCH_SSSE3 1
+#define BATCH_AVX2 2
+
+/*
+ * Decode many fixed-width (1-8 bytes, big-endian) values at once. These are
+ * the same encodings read one-by-one by ByteReader, ShortReader, etc. On x86
+ * the values are unpacked with byte shuffles (SSSE3 or AVX2, selected at
+ * runtime). Otherwise, a scalar loop is used.
+ *
+ * The SIMD kernels load 16 bytes at a time. They are used only while the load
+ * stays below "limit", so that we never read past the end of the table.
+ */
+class BatchReader {
+    public:
+        //Decode n values of nbytes each, stored one after the other
+        DDLEXPORT static void readColumn(const char *buffer,
+                const uint8_t nbytes,
+                const size_t n,
+                const char *limit,
+                uint64_t *out);
+
+        //Decode n rows, each made of a value of nbytes1 followed by a
+        //value of nbytes2
+        DDLEXPORT static void readRows(const char *buffer,
+                const uint8_t nbytes1,
+                const uint8_t nbytes2,
+                const size_t n,
+                const char *limit,
+                uint64_t *out1,
+                uint64_t *out2);
+
+        //Unpack 128 values of "bits" bits each (0-32). The values are stored
+        //in four interleaved 32-bit lanes (value i is in lane i % 4), so
+        //that they can be extracted four at a time with shifts and masks.
+        //The input is 16 * bits bytes long.
+        DDLEXPORT static void unpackBits(const char *buffer,
+                const uint8_t bits,
+                uint32_t *out);
+
+        //Inverse of unpackBits. Only the lowest "bits" bits of every value
+        //are stored. It writes 16 * bits bytes.
+        DDLEXPORT static void packBits(const uint32_t *values,
+                const uint8_t bits,
+                char *out);
+
+        //Returns BATCH_SCALAR, BATCH_SSSE3 or BATCH_AVX2
+        DDLEXPORT static int getMode();
+
+        //Force a given mode (used for testing). The mode is lowered if the
+        //CPU does not support it.
+        DDLEXPORT static void setMode(int mode);
+};
+
+#endif
@@ -72,6 +72,8 @@ class BinaryTableInserter {
             return 2;
         }
 
+        void writeBytes(const char *bytes, const uint64_t size);
+
         string getRootDir();
 
         void writeLong(const uint8_t nbytes, const int64_t v);
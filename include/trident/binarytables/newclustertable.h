@@ -24,9 +24,11 @@
 #define _NEW_CLUSTERTABLE_H
 
 #include <trident/binarytables/newtable.h>
+#include <trident/binarytables/batchreaders.h>
 #include <trident/kb/consts.h>
 
 #include <iostream>
+#include <algorithm>
 #include <assert.h>
 
 using namespace std;
@@ -154,6 +156,33 @@ class NewClusterTable: public AbsNewTable {
             return current < end;
         }
 
+        size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+            if (isSecondColumnIgnored) {
+                return AbsNewTable::nextBatch(v1, v2, max);
+            }
+            size_t n = 0;
+            while (n < max && current < end) {
+                if (count == 0) {
+                    currentValue1 = Reader1::read(current);
+                    current += Reader1::size();
+                    count = countgroup = ReaderCount::read(current);
+                    current += ReaderCount::size();
+                }
+                //The second values of a group are stored contiguously
+                const size_t toread = std::min((size_t) count, max - n);
+                BatchReader::readColumn(current, Reader2::size(), toread, end,
+                        v2 + n);
+                std::fill(v1 + n, v1 + n + toread, currentValue1);
+                current += toread * Reader2::size();
+                count -= toread;
+                n += toread;
+            }
+            if (n > 0) {
+                currentValue2 = v2[n - 1];
+            }
+            return n;
+        }
+
         bool hasNext() {
             return current < end;
         }
@@ -303,6 +332,9 @@ class NewClusterTable: public AbsNewTable {
                     } else {
                         const char *e = current + count * Reader2::size();
                         const char *orige = e;
+                        gallop(current, e, Reader2::size(), [c2](const char *p) {
+                                return Reader2::read(p) < c2;
+                                });
                         while (current < e) {
                             const size_t diff = e - current;
                             const size_t middlevalue = (diff / Reader2::size()) >> 1;
@@ -25,9 +25,11 @@
 
 //#include <trident/iterators/pairitr.h>
 #include <trident/binarytables/newtable.h>
+#include <trident/binarytables/batchreaders.h>
 #include <trident/kb/consts.h>
 #include <kognac/utils.h>
 
+#include <algorithm>
 #include <assert.h>
 
 class SequenceWriter {
@@ -191,6 +193,42 @@ class NewColumnTable: public AbsNewTable {
             return hasNext();
         }
 
+        size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+            if (isSecondColumnIgnored) {
+                return AbsNewTable::nextBatch(v1, v2, max);
+            }
+            size_t n = 0;
+            while (n < max && hasNext()) {
+                if (scannedCounts == currentCount) {
+                    currentValue1 = Utils::decode_longFixedBytes(currentpos1, bytesPerFirstEntry);
+                    currentpos1 += bytesPerFirstEntry;
+                    currentCount = Utils::decode_longFixedBytes(currentpos1, bytesPerCount);
+                    currentpos1 += bytesPerCount + bytesPerStartingPoint;
+                    scannedCounts = 0;
+                    startblock2 = currentpos2;
+                }
+                //The second column is contiguous. Decode the rest of the group
+                size_t toread = std::min((size_t) (currentCount - scannedCounts), max - n);
+                toread = std::min(toread, (size_t) (end - currentpos2) / bytesPerSecondEntry);
+                if (toread == 0) {
+                    break;
+                }
+                BatchReader::readColumn(currentpos2, bytesPerSecondEntry, toread,
+                        end, v2 + n);
+                std::fill(v1 + n, v1 + n + toread, currentValue1);
+                currentpos2 += toread * bytesPerSecondEntry;
+                scannedCounts += toread;
+                n += toread;
+                currentValue2 = v2[n - 1];
+            }
+#if DEBUG
+            if (n > 0) {
+                movetoAllowed = true;
+            }
+#endif
+            return n;
+        }
+
         void first() {
             next();
         }
@@ -221,6 +259,10 @@ class NewColumnTable: public AbsNewTable {
                 //Binary search
                 const char *s = currentpos1;
                 const char *e = startpos2;
+                const uint8_t bytesFirst = bytesPerFirstEntry;
+                gallop(s, e, bytesFirstBlock, [bytesFirst, c1](const char *p) {
+                        return Utils::decode_longFixedBytes(p, bytesFirst) < c1;
+                        });
                 bool found = false;
                 uint64_t middleValue;
                 while (s < e) {
@@ -281,6 +323,10 @@ class NewColumnTable: public AbsNewTable {
 
                     const char *s = currentpos2;
                     const char *e = startblock2 + currentCount * bytesPerSecondEntry;
+                    const uint8_t bytesSecond = bytesPerSecondEntry;
+                    gallop(s, e, bytesSecond, [bytesSecond, c2](const char *p) {
+                            return Utils::decode_longFixedBytes(p, bytesSecond) < c2;
+                            });
                     bool found = false;
                     while (s < e) {
                         const uint64_t middlePos = (e - s) / bytesPerSecondEntry / 2;
@@ -24,6 +24,7 @@
 #define _NEW_ROWTABLE_H
 
 #include <trident/binarytables/newtable.h>
+#include <trident/binarytables/batchreaders.h>
 #include <trident/kb/consts.h>
 
 #include <iostream>
@@ -147,6 +148,25 @@ class NewRowTable: public AbsNewTable {
             return current < end;
         }
 
+        size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+            if (isSecondColumnIgnored) {
+                return AbsNewTable::nextBatch(v1, v2, max);
+            }
+            const uint8_t rowsize = Reader1::size() + Reader2::size();
+            size_t n = (end - current) / rowsize;
+            if (n > max) {
+                n = max;
+            }
+            if (n > 0) {
+                BatchReader::readRows(current, Reader1::size(), Reader2::size(),
+                        n, end, v1, v2);
+                current += n * rowsize;
+                currentValue1 = v1[n - 1];
+                currentValue2 = v2[n - 1];
+            }
+            return n;
+        }
+
         bool hasNext() {
             assert(current <= end);
             return current < end;
@@ -264,23 +284,25 @@ class NewRowTable: public AbsNewTable {
 
             if (c1 > currentValue1 ||
                     (!isSecondColumnIgnored && c1 == currentValue1 && c2 > currentValue2)) {
-                // Read the first entry
-                int64_t currentvalue = -1;
-                while (current != end) {
-                    currentvalue = Reader1::read(current);
-                    if (currentvalue >= c1)
-                        break;
-                    current += Reader1::size() + Reader2::size();
-                }
-                assert(current <= end);
-
-                if (c2 > 0 && current != end && currentvalue == c1) {
-                    int64_t currentC1 = Reader1::read(current);
-                    while (current != end && Reader1::read(current) == currentC1 &&
-                            Reader2::read(current + Reader1::size()) < c2) {
-                        current += Reader1::size() + Reader2::size();
+                //Search the first row >= (c1,c2). The search gallops from the
+                //current position because joins move forward by small steps
+                auto isSmaller = [c1, c2](const char *p) {
+                    const int64_t v1 = Reader1::read(p);
+                    return v1 < c1 || (c2 > 0 && v1 == c1 &&
+                            Reader2::read(p + Reader1::size()) < c2);
+                };
+                const uint8_t rowsize = Reader1::size() + Reader2::size();
+                const char *e = end;
+                gallop(current, e, rowsize, isSmaller);
+                while (current < e) {
+                    const char *middle = current + ((e - current) / rowsize / 2) * rowsize;
+                    if (isSmaller(middle)) {
+                        current = middle + rowsize;
+                    } else {
+                        e = middle;
                     }
                 }
+                assert(current <= end);
             } else {
                 current -= Reader1::size() + Reader2::size();
             }
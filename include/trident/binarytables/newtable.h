@@ -24,11 +24,21 @@
 #define _NEWTABLE_H
 
 #include <trident/iterators/pairitr.h>
+#include <trident/files/filetable.h>
 
 
 
 class AbsNewTable : public PairItr {
+    private:
+        //Keeps the memory of the table valid (the file or the block of the
+        //compressed file that contains it)
+        TablePin pin;
+
     public:
+        void setPin(const TablePin &pin) {
+            this->pin = pin;
+        }
+
         virtual char getReaderSize1() const = 0;
 
         virtual char getReaderSize2() const = 0;
@@ -45,6 +55,27 @@ class AbsNewTable : public PairItr {
                 const int64_t rowId) const  {
             throw 10;
         }
+
+        //Exponential search over fixed-size records, starting from s. It
+        //shrinks [s, e) to a range whose size is logarithmic in the distance
+        //from s of the first record for which isSmaller returns false, so
+        //that a following binary search costs O(log distance) instead of
+        //O(log n). isSmaller must be monotone over the records.
+        template<typename F>
+        static void gallop(const char *&s, const char *&e,
+                const size_t recordSize, F isSmaller) {
+            const size_t n = (e - s) / recordSize;
+            size_t prev = 0;
+            size_t step = 1;
+            while (step < n && isSmaller(s + step * recordSize)) {
+                prev = step;
+                step *= 2;
+            }
+            if (step < n) {
+                e = s + (step + 1) * recordSize;
+            }
+            s += prev * recordSize;
+        }
 };
 
 #endif
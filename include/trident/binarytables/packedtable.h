@@ -0,0 +1,196 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _PACKEDTABLE_H
+#define _PACKEDTABLE_H
+
+#include <trident/binarytables/newtable.h>
+#include <trident/kb/consts.h>
+
+#include <assert.h>
+
+/*
+ * Layout:
+ * 1 byte <bytes per first value (4 bits) -- bytes per second value (4 bits)>
+ * 1 byte <bytes per block offset>
+ * vlong2 <n. rows> vlong2 <n. unique first values>
+ * directory: for every block of PACKED_BLOCK_SIZE rows, its first pair, its
+ * last pair and the offset of the block (fixed length)
+ * blocks: two bit-packed columns (see PackedTableInserter)
+ *
+ * The rows are decoded one block at a time. The directory is used by moveto
+ * and setup to skip the blocks that cannot contain the searched pair.
+ */
+class PackedTable: public AbsNewTable {
+    private:
+        const char *start;
+        const char *end;
+        const char *directory;
+        const char *data;
+
+        uint8_t bytesPerFirstEntry, bytesPerSecondEntry;
+        uint8_t bytesPerOffset, bytesPerDirectoryEntry;
+        uint64_t nRows, nUniqueFirstTerms, nBlocks;
+
+        //Rows are identified by their global position in the table
+        uint64_t startRow, endRow, currentRow, lastRow;
+        int64_t currentValue1, currentValue2;
+        int64_t count;
+        bool isSecondColumnIgnored;
+
+        int64_t decodedBlock;
+        uint64_t values1[PACKED_BLOCK_SIZE];
+        uint64_t values2[PACKED_BLOCK_SIZE];
+
+        // For mark/reset
+        uint64_t savedCurrentRow, savedLastRow;
+        int64_t savedCurrentValue1, savedCurrentValue2;
+        int64_t savedCount;
+
+        const char *decodeColumn(const char *buffer, uint64_t *out);
+
+        void decodeBlock(const uint64_t block);
+
+        bool isBlockBefore(const uint64_t block, const int64_t c1,
+                const int64_t c2) const;
+
+        //Returns the first row >= from whose pair is >= (c1,c2), or endRow.
+        //c2 = -1 matches any second value.
+        uint64_t findRow(const int64_t c1, const int64_t c2,
+                const uint64_t from);
+
+        void readRow(const uint64_t row) {
+            decodeBlock(row / PACKED_BLOCK_SIZE);
+            currentValue1 = values1[row % PACKED_BLOCK_SIZE];
+            currentValue2 = values2[row % PACKED_BLOCK_SIZE];
+        }
+
+    public:
+        char getReaderSize1() const {
+            return bytesPerFirstEntry;
+        }
+
+        char getReaderSize2() const {
+            return bytesPerSecondEntry;
+        }
+
+        char getReaderCountSize() const {
+            return 0;
+        }
+
+        int64_t getValue1() {
+            return currentValue1;
+        }
+
+        int64_t getValue2() {
+            return currentValue2;
+        }
+
+        uint64_t getCardinality() {
+            if (isSecondColumnIgnored) {
+                return nUniqueFirstTerms;
+            } else {
+                return endRow - startRow;
+            }
+        }
+
+        uint64_t estCardinality() {
+            return getCardinality();
+        }
+
+        bool hasNext() {
+            return currentRow < endRow;
+        }
+
+        void next() {
+            assert(hasNext());
+            lastRow = currentRow;
+            readRow(currentRow);
+            currentRow++;
+            if (isSecondColumnIgnored) {
+                //Skip all the other rows with the same first value
+                currentRow = findRow(currentValue1 + 1, -1, currentRow);
+                count = currentRow - lastRow;
+            }
+        }
+
+        bool next(int64_t &v1, int64_t &v2, int64_t &v3) {
+            next();
+            v1 = key;
+            v2 = currentValue1;
+            v3 = currentValue2;
+            return hasNext();
+        }
+
+        DDLEXPORT size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max);
+
+        void first() {
+            next();
+        }
+
+        DDLEXPORT void moveto(const int64_t c1, const int64_t c2);
+
+        void clear() {
+        }
+
+        void mark() {
+            savedCurrentRow = currentRow;
+            savedLastRow = lastRow;
+            savedCurrentValue1 = currentValue1;
+            savedCurrentValue2 = currentValue2;
+            savedCount = count;
+        }
+
+        void reset(const char i) {
+            currentRow = savedCurrentRow;
+            lastRow = savedLastRow;
+            currentValue1 = savedCurrentValue1;
+            currentValue2 = savedCurrentValue2;
+            count = savedCount;
+        }
+
+        int64_t getCount() {
+            return count;
+        }
+
+        void ignoreSecondColumn() {
+            isSecondColumnIgnored = true;
+            if (currentValue1 != -1) {
+                //I already read some data. I move to the next entry
+                currentRow = findRow(currentValue1 + 1, -1, currentRow);
+                count = currentRow - lastRow;
+            }
+        }
+
+        int getTypeItr() {
+            return PACKED_ITR;
+        }
+
+        DDLEXPORT void setup(const char* start, const char *end);
+
+        DDLEXPORT void setup(int64_t c1, const char* start, const char *end);
+
+        DDLEXPORT void setup(int64_t c1, int64_t c2, const char* start,
+                const char *end);
+};
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _PACKEDTABLEINSERTER_H
+#define _PACKEDTABLEINSERTER_H
+
+#include <trident/kb/consts.h>
+#include <trident/binarytables/binarytableinserter.h>
+
+#include <vector>
+
+/*
+ * Writes the tables read by PackedTable. Every block of PACKED_BLOCK_SIZE
+ * rows stores two columns. The first contains the deltas between
+ * consecutive first values. The second contains the deltas between
+ * consecutive second values if the first value is unchanged, and the second
+ * value otherwise. Each column is frame-of-reference encoded with the
+ * number of bits that minimizes its size (at most 32). The values that do
+ * not fit are stored as exceptions (position + remaining high bits).
+ */
+class PackedTableInserter: public BinaryTableInserter {
+private:
+    std::vector<uint64_t> values1, values2;
+
+    //Directory (first and last pair, offset) and compressed blocks. They are
+    //written only at the end because the directory precedes the blocks.
+    std::vector<uint64_t> directory;
+    std::vector<char> blocks;
+
+    uint64_t largestElement1, largestElement2;
+    uint64_t nRows, nUniqueFirstTerms;
+    int64_t prevel1;
+
+    const size_t thresholdToOffload;
+    uint64_t offloadedBytes;
+    bool fileopen;
+    ofstream offloadfile;
+    ifstream offloadfile_r;
+
+    static void compressColumn(const uint64_t *values, std::vector<char> &out);
+
+    void flushBlock();
+
+public:
+    PackedTableInserter() : thresholdToOffload(256 * 1024 * 1024) {
+    }
+
+    int getType() {
+        return PACKED_ITR;
+    }
+
+    //Append one block of up to PACKED_BLOCK_SIZE rows (without the directory)
+    static void compressBlock(const uint64_t *v1, const uint64_t *v2,
+            const size_t n, std::vector<char> &out);
+
+    //Return the number of bytes that the table would take on disk
+    static uint64_t estimateSize(const int64_t *v1, const int64_t *v2,
+            const size_t n);
+
+    void startAppend();
+
+    void append(int64_t t1, int64_t t2);
+
+    void stopAppend();
+};
+
+#endif
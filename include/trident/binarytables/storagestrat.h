@@ -35,6 +35,8 @@
 #include <trident/binarytables/newrowtableinserter.h>
 #include <trident/binarytables/newclustertableinserter.h>
 #include <trident/binarytables/factorytables.h>
+#include <trident/binarytables/packedtable.h>
+#include <trident/binarytables/packedtableinserter.h>
 
 #include <trident/kb/consts.h>
 
@@ -48,6 +50,10 @@
  * Current format: 3bits <storage format> -- 1bit <delta on the first term> -- 1 bit <compr on firs el> -- 1 bit <compr on second el> -- 1 bit <aggregated> -- 1 bit unused
  */
 
+/*
+ * Packed tables (storage format PACKED_STORAGE) do not use the other bits.
+ */
+
 #define RATE_LIST 1.05
 
 LIBEXP extern const unsigned FIXEDSTRAT5;
@@ -58,6 +64,7 @@ struct Statistics {
     int64_t nListStrategies;
     int64_t nList2Strategies;
     int64_t nGroupStrategies;
+    int64_t nPackedStrategies;
 
     int64_t nFirstCompr1;
     int64_t nFirstCompr2;
@@ -74,6 +81,7 @@ struct Statistics {
 
     Statistics() {
         nList2Strategies = nListStrategies = nGroupStrategies = 0;
+        nPackedStrategies = 0;
         nFirstCompr1 = nFirstCompr2 = nSecondCompr1 = nSecondCompr2 = 0;
         exact = approximate = 0;
         diff = nodiff  = 0;
@@ -152,6 +160,7 @@ private:
     Factory<NewColumnTable> *f4;
     FactoryNewRowTable *f5;
     FactoryNewClusterTable *f6;
+    Factory<PackedTable> *f7;
 
     Factory<RowTableInserter> *f1i;
     Factory<ClusterTableInserter> *f2i;
@@ -159,6 +168,7 @@ private:
     Factory<NewColumnTableInserter> *f4i;
     Factory<NewRowTableInserter> *f5i;
     Factory<NewClusterTableInserter> *f6i;
+    Factory<PackedTableInserter> *f7i;
 
 public:
     bool static isAggregated(const char signature) {
@@ -189,6 +199,7 @@ public:
                                   const int64_t nTerms,
                                   const size_t nTermsClusterColumn,
                                   const bool useRowForLargeTables,
+                                  const bool usePackedTables,
                                   Statistics &stats);
 
     static char determineStrategyOld(int64_t *v1, int64_t *v2, const int size,
@@ -207,6 +218,7 @@ public:
         f4 = NULL;
         f5 = NULL;
         f6 = NULL;
+        f7 = NULL;
         statsCluster = statsRow = statsColumn = 0;
     }
 
@@ -218,21 +230,25 @@ public:
               Factory<NewColumnTable> *ncFactory,
               FactoryNewRowTable *newRowFactories,
               FactoryNewClusterTable *newClusterFactories,
+              Factory<PackedTable> *packedFactory,
               Factory<RowTableInserter> *listFactory_i,
               Factory<ClusterTableInserter> *comprFactory_i,
               Factory<ColumnTableInserter> *list2Factory_i,
               Factory<NewColumnTableInserter> *ncFactory_i,
               Factory<NewRowTableInserter> *nrFactory_i,
-              Factory<NewClusterTableInserter> *ncluFactory_i) {
+              Factory<NewClusterTableInserter> *ncluFactory_i,
+              Factory<PackedTableInserter> *packedFactory_i) {
         this->f4 = ncFactory;
         this->f5 = newRowFactories;
         this->f6 = newClusterFactories;
+        this->f7 = packedFactory;
         this->f1i = listFactory_i;
         this->f2i = comprFactory_i;
         this->f3i = list2Factory_i;
         this->f4i = ncFactory_i;
         this->f5i = nrFactory_i;
         this->f6i = ncluFactory_i;
+        this->f7i = packedFactory_i;
     }
 
     PairItr *getBinaryTable(const char signature);
@@ -28,6 +28,9 @@
 #include <trident/kb/consts.h>
 #include <trident/kb/statistics.h>
 #include <trident/files/filemanager.h>
+#include <trident/files/comprfiledescriptor.h>
+#include <trident/files/blockcache.h>
+#include <trident/files/prefetcher.h>
 #include <trident/utils/memoryfile.h>
 
 #include <string>
@@ -56,7 +59,7 @@ class FileMarks {
             return end;
         }
 
-        void parse(string path);
+        void parse(string path, int64_t sizefile);
 
         std::pair<uint64_t, uint64_t> getPos(const int64_t mark) {
             const uint64_t startpos = Utils::decode_longFixedBytes(begin + 11 * mark, 5);
@@ -95,6 +98,20 @@ class TableStorage {
 
         FileManager<FileDescriptor, FileDescriptor> *cache;
 
+        //Used instead of cache if the files are compressed
+        BlockCache *blockCache;
+        bool compressed;
+        ComprFileDescriptor *comprFiles[MAX_N_FILES];
+
+        //If enabled, the files are read with MADV_RANDOM except the ones
+        //that are being scanned. Number of scans on every file
+        bool accessHints;
+        int nScans[MAX_N_FILES];
+
+        //Reads the tables in the background (see prefetch)
+        Prefetcher *prefetcher;
+        int prefetchFds[MAX_N_FILES];
+
         short lastCreatedFile;
         int64_t sizeLastCreatedFile;
 
@@ -113,6 +130,12 @@ class TableStorage {
         int filePreviousIndex;
         //*** END INSERT ***
 
+        FileMarks *getMarks(short file);
+
+        ComprFileDescriptor *getComprFile(short file);
+
+        int getPrefetchFd(short file);
+
         void storeFileIndices();
         void storeFileIndex(const std::vector<WrittenMarks> &input,
                 string pathFile);
@@ -120,12 +143,55 @@ class TableStorage {
     public:
         TableStorage(bool readOnly, std::string pathDir, int64_t maxFileSize,
                 int maxNFiles, MemoryManager<FileDescriptor> *bytesTracker,
-                Stats &stats, int perm);
+                Stats &stats, int perm) : TableStorage(readOnly, pathDir,
+                    maxFileSize, maxNFiles, bytesTracker, NULL, stats, perm) {
+                }
+
+        TableStorage(bool readOnly, std::string pathDir, int64_t maxFileSize,
+                int maxNFiles, MemoryManager<FileDescriptor> *bytesTracker,
+                BlockCache *blockCache, Stats &stats, int perm);
 
         std::string getPath();
 
+        bool isCompressed() const {
+            return compressed;
+        }
+
+        void setAccessHints();
+
+        bool useAccessHints() const {
+            return accessHints;
+        }
+
+        //Called by the iterators that scan the entire partition when they
+        //start and stop reading a file. The file is read sequentially
+        //until its last scan stops
+        void startScan(short file);
+
+        void stopScan(short file);
+
+        AccessPattern getAccessPattern(short file);
+
+        void setPrefetcher(Prefetcher *prefetcher) {
+            this->prefetcher = prefetcher;
+        }
+
+        bool hasPrefetcher() const {
+            return prefetcher != NULL;
+        }
+
+        //Start loading the table in memory without waiting for it. It does
+        //nothing if no prefetcher was set.
+        void prefetch(short file, int64_t mark);
+
         std::pair<const char*, const char*> getTable(short file, int64_t mark);
 
+        //Same as above, but it works also if the files are compressed. pin
+        //keeps the table in memory until it is reset. Otherwise, the file is
+        //never closed.
+        std::pair<const char*, const char*> getTable(short file, int64_t mark,
+                TablePin &pin);
+
         int64_t startAppend(const int64_t key,
                 const char strat,
                 BinaryTableInserter* handler);
@@ -156,6 +222,9 @@ class TableStorage {
 
         void stopInsert();
 
+        //Compress all the files of a partition. The KB must be closed.
+        static void compressFiles(std::string pathDir);
+
         ~TableStorage();
 };
 
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _BLOCKCACHE_H
+#define _BLOCKCACHE_H
+
+#include <inttypes.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct BlockCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t decompressedBytes;
+    uint64_t decompressionTime; //in microseconds
+    uint64_t bytes;
+    uint64_t maxBytes;
+
+    double getHitRate() const {
+        return hits + misses == 0 ? 0 : (double) hits / (hits + misses);
+    }
+};
+
+/*
+ * Cache of the decompressed blocks of the permutation files. It is shared by
+ * all the partitions of a KB, and the blocks are identified by
+ * (perm, file, block). The least recently used blocks are evicted when the
+ * cache exceeds its budget. Evicted blocks are freed when the last iterator
+ * that uses them is released, so the memory can temporarily exceed the
+ * budget by the blocks that are still in use.
+ */
+class BlockCache {
+    public:
+        typedef std::shared_ptr<std::vector<char>> Block;
+
+    private:
+        struct Entry {
+            Block block;
+            std::list<uint64_t>::iterator pos;
+        };
+
+        const uint64_t maxBytes;
+        uint64_t bytes;
+        std::unordered_map<uint64_t, Entry> entries;
+        std::list<uint64_t> lru;
+
+        uint64_t hits, misses, evictions;
+        uint64_t decompressedBytes, decompressionTime;
+
+        std::mutex mutex;
+
+        static uint64_t getKey(const int perm, const short file,
+                const uint64_t block) {
+            return ((uint64_t) perm << 56) | ((uint64_t) file << 40) | block;
+        }
+
+    public:
+        BlockCache(const uint64_t maxBytes);
+
+        //Returns NULL if the block is not in the cache
+        Block get(const int perm, const short file, const uint64_t block);
+
+        //Returns the block in the cache, which can be a different one if
+        //another thread has inserted the same block in the meantime
+        Block put(const int perm, const short file, const uint64_t block,
+                Block data, const uint64_t decompressionTime);
+
+        BlockCacheStats getStats();
+
+        void clear();
+};
+
+#endif
@@ -23,107 +23,73 @@
 #ifndef _COMPRFILEDESCRIPTOR_H
 #define _COMPRFILEDESCRIPTOR_H
 
-#include <trident/kb/consts.h>
-#include <trident/utils/memorymgr.h>
+#include <trident/files/blockcache.h>
+#include <trident/utils/memoryfile.h>
 
 #include <kognac/utils.h>
 
-#include <fstream>
-#include <sstream>
 #include <string>
+#include <vector>
 
-#define COMPRESSION_ENABLED 0
-#define MAX_N_MAPPINGS  5000
-
-
-struct FileSegment {
-    char block[BLOCK_SIZE];
-    int memId;
-};
-
-class Stats;
+/*
+ * Read-only access to a permutation file compressed with LZ4 in blocks.
+ * Layout:
+ * 8 bytes <n. blocks> 8 bytes <uncompressed size>
+ * directory: for every block, 8 bytes <uncompressed start> 8 bytes <offset
+ * of the compressed block>
+ * compressed blocks
+ *
+ * The blocks are cut only at the beginning of a table, so every table can be
+ * read from a single block. Blocks that LZ4 cannot shrink (or that are too
+ * large for it) are stored raw and read directly from the mapped file.
+ */
 class ComprFileDescriptor {
 private:
-    const std::string file;
-    const int id;
-    const bool readOnly;
-    int sizeMappings;
-    int mappings[MAX_N_MAPPINGS];
-
-    int uncompressedSize;
-    FileSegment *uncompressedBuffers[MAX_N_MAPPINGS];
-
-    //char specialTmpBuffer[BLOCK_MIN_SIZE];
-    std::unique_ptr<char[]> specialTmpBuffers[MAX_SESSIONS];
-
-    int lastAccessedSegment;
-
-    //Used for writing
-    int rawSize;
-    char* rawBuffer;
+    const int perm;
+    const short id;
+    BlockCache * const cache;
+
+    std::unique_ptr<MemoryMappedFile> mappedFile;
+    uint64_t nBlocks;
+    uint64_t uncompressedSize;
+    const char *directory;
+    const char *data;
+    uint64_t sizeData;
+
+    uint64_t getStart(const uint64_t block) const {
+        return block < nBlocks ? Utils::decode_long(directory + block * 16)
+            : uncompressedSize;
+    }
 
-    std::ifstream readOnlyInput;
-    MemoryManager<FileSegment> *tracker;
+    uint64_t getOffset(const uint64_t block) const {
+        return block < nBlocks ? Utils::decode_long(directory + block * 16 + 8)
+            : sizeData;
+    }
 
-    Stats* const stats;
+    BlockCache::Block decompress(const uint64_t block);
 
-    void uncompressBlock(const int b);
-    void writeFile();
-    //bool isUsed();
 public:
-    ComprFileDescriptor(bool readOnly, int id, std::string file, int maxSize,
-                        MemoryManager<FileSegment> *tracker,
-                        ComprFileDescriptor **parentArray, Stats* const stats);
+    ComprFileDescriptor(std::string file, int perm, short id,
+            BlockCache *cache);
 
-    char* getBuffer(int offset, int *length, const int sesID);
+    //Returns the uncompressed bytes [offset, offset + length). If the block
+    //is compressed, pin keeps it alive until it is reset.
+    const char *getBuffer(const uint64_t offset, const uint64_t length,
+            BlockCache::Block &pin);
 
-    char* getBuffer(int offset, int *length, int &memoryBlock, const int sesID);
-
-    int getFileLength() {
+    uint64_t getFileLength() const {
         return uncompressedSize;
     }
 
-    int getId() {
+    int getId() const {
         return id;
     }
 
-    void appendLong(int64_t v) {
-        Utils::encode_long(rawBuffer, uncompressedSize, v);
-        uncompressedSize += 8;
-    }
-
-    int appendVLong(int64_t v) {
-        uncompressedSize = Utils::encode_vlong(rawBuffer, uncompressedSize, v);
-        return uncompressedSize;
-    }
-
-    int appendVLong2(int64_t v) {
-        uncompressedSize = Utils::encode_vlong2(rawBuffer, uncompressedSize, v);
-        return uncompressedSize;
-    }
-
-    void reserveBytes(const uint8_t n) {
-        uncompressedSize += n;
-    }
-
-    void append(char *bytes, int size) {
-        if (size == 1) {
-            rawBuffer[uncompressedSize++] = *bytes;
-        } else {
-            memcpy(rawBuffer + uncompressedSize, bytes, size);
-            uncompressedSize += size;
-        }
-    }
-
-    void overwriteAt(int pos, char byte) {
-        rawBuffer[pos] = byte;
-    }
-
-    void overwriteVLong2At(int pos, int64_t number) {
-        Utils::encode_vlong2(rawBuffer, pos, number);
-    }
-
-    ~ComprFileDescriptor();
+    //Compress the file "input". tableStarts contains the (sorted) positions
+    //of the tables in the file.
+    static void compress(std::string input,
+            const std::vector<uint64_t> &tableStarts,
+            std::string output);
 };
 
 #endif
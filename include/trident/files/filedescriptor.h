@@ -26,6 +26,7 @@
 #include <trident/utils/memorymgr.h>
 #include <trident/utils/memoryfile.h>
 
+#include <atomic>
 #include <string>
 
 //#define SMALLEST_INCR 1*1024*1024
@@ -52,17 +53,18 @@ private:
 
     MemoryManager<FileDescriptor> *tracker;
     int memoryTrackerId;
-    FileDescriptor **parentArray;
+    std::atomic<FileDescriptor*> *parentArray;
 
     void mapFile(uint64_t requiredIncrement);
 
 public:
     FileDescriptor(bool readOnly, int id, std::string file, uint64_t fileMaxSize,
-                   MemoryManager<FileDescriptor> *tracker, FileDescriptor **parents,
+                   MemoryManager<FileDescriptor> *tracker,
+                   std::atomic<FileDescriptor*> *parents,
                    Stats * const stats);
 
     FileDescriptor(bool readOnly, int id, std::string file, uint64_t fileMaxSize,
-                   FileDescriptor **parents, Stats * const stats) :
+                   std::atomic<FileDescriptor*> *parents, Stats * const stats) :
         FileDescriptor(readOnly, id, file, fileMaxSize, NULL, parents, stats) {
     }
 
@@ -76,8 +78,13 @@ public:
         return id;
     }
 
+    //True if the memory manager has locked the file
     bool isUsed();
 
+    void advise(AccessPattern pattern) {
+        mappedFile->advise(pattern);
+    }
+
     void shiftFile(uint64_t pos, uint64_t diff);
 
     void append(char *bytes, const uint64_t size);
@@ -24,13 +24,15 @@
 #define FILEMANAGER_H_
 
 #include <trident/utils/memorymgr.h>
+#include <trident/utils/memoryfile.h>
+#include <trident/files/filetable.h>
 #include <trident/kb/consts.h>
 #include <trident/kb/statistics.h>
 
 #include <kognac/logs.h>
 #include <kognac/consts.h>
 
-#include <list>
+#include <atomic>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -48,11 +50,9 @@ class FileManager {
         const int64_t fileMaxSize;
         const int maxFiles;
         int lastFileId;
-        int nOpenedFiles;
 
         MemoryManager<K> *bytesTracker;
-        T *openedFiles[MAX_N_FILES];
-        list<int> trackerOpenedFiles;
+        FileTable<T> openedFiles;
 
         //Cache the uncompressed size of file used during the writing
         vector<uint64_t> cacheFileSize;
@@ -62,105 +62,121 @@ class FileManager {
 
         Stats* const stats;
 
-#ifdef MT
-        std::mutex mutex;
-#endif
+        std::atomic<AccessPattern> accessPattern;
+        //Overrides accessPattern for single files
+        std::atomic<AccessPattern> filePatterns[MAX_N_FILES];
+
+        T *openFile(const int id) {
+            std::stringstream filePath;
+            filePath << cacheDir << DIR_SEP << id;
+            T* f = new T(readOnly, id, filePath.str(), fileMaxSize,
+                    bytesTracker, openedFiles.getSlots(), stats);
+            const AccessPattern pattern = filePatterns[id] != ACCESS_NORMAL ?
+                filePatterns[id].load() : accessPattern.load();
+            if (pattern != ACCESS_NORMAL) {
+                f->advise(pattern);
+            }
+            return f;
+        }
 
-        bool isFileLoaded(const int id) {
-            return openedFiles[id] != NULL;
+        //The file must be released with openedFiles.release(id)
+        T *acquire(const int id) {
+            return openedFiles.acquire(id, [this](const int id) {
+                    return openFile(id);
+                    });
         }
 
-        void load_file(const int id) {
-            if (!isFileLoaded(id)) {
-#ifdef MT
-                std::unique_lock<std::mutex> lock(mutex);
-                if (!isFileLoaded(id)) {
-#endif
-                    if (nOpenedFiles >= maxFiles) {
-                        //Take the last opened file
-                        int idxFileToRemove = trackerOpenedFiles.front();
-                        int firstFileRemoved = -1;
-                        trackerOpenedFiles.pop_front();
-                        bool rem = true;
-                        assert(!trackerOpenedFiles.empty());
-                        while (openedFiles[idxFileToRemove] == NULL ||
-                                openedFiles[idxFileToRemove]->isUsed()) {
-
-                            if (openedFiles[idxFileToRemove] != NULL) {
-                                //It means the file is still used
-                                trackerOpenedFiles.push_back(idxFileToRemove);
-                                if (firstFileRemoved == -1) {
-                                    firstFileRemoved = idxFileToRemove;
-                                }
-                            } else {
-                                nOpenedFiles--;
-                            }
-
-                            if (!trackerOpenedFiles.empty()) {
-                                idxFileToRemove = trackerOpenedFiles.front();
-                                trackerOpenedFiles.pop_front();
-                            } else {
-                                rem = false;
-                            }
-
-                            if (idxFileToRemove == firstFileRemoved) {
-                                rem = false;
-                                break;
-                            }
-                        }
-                        if (rem) {
-                            //LOG(DEBUGL) << "Deleting map for file " << idxFileToRemove;
-                            delete openedFiles[idxFileToRemove];
-                            openedFiles[idxFileToRemove] = NULL;
-                            nOpenedFiles--;
-                        }
+        //Keeps a reference to a file until it goes out of scope. Used by the
+        //methods that do not return pointers to the memory of the file.
+        class FileRef {
+            private:
+                FileTable<T> &table;
+                const int id;
+                T * const file;
+
+            public:
+                FileRef(FileManager *manager, const int id) :
+                    table(manager->openedFiles), id(id),
+                    file(manager->acquire(id)) {
                     }
-                    std::stringstream filePath;
-                    filePath << cacheDir << DIR_SEP << id;
-                    T* f = new T(readOnly, id, filePath.str(), fileMaxSize,
-                            bytesTracker, openedFiles, stats);
-                    openedFiles[id] = f;
-                    trackerOpenedFiles.push_back(id);
-                    nOpenedFiles++;
-#ifdef MT
+
+                T *operator->() {
+                    return file;
                 }
-                lock.unlock();
-#endif
-            }
-        }
+
+                ~FileRef() {
+                    table.release(id);
+                }
+        };
+
     public:
         FileManager(std::string path, bool readOnly, int64_t fileMaxSize,
                 int maxNumberFiles, int lastFileId, MemoryManager<K> *bytesTracker,
                 Stats * const stats) :
             readOnly(readOnly), cacheDir(path), fileMaxSize(fileMaxSize),
             maxFiles(maxNumberFiles), lastFileId(lastFileId), bytesTracker(bytesTracker),
-            stats(stats) {
-                for (int i = 0; i < MAX_N_FILES; ++i) {
-                    openedFiles[i] = NULL;
-                }
-
+            openedFiles(maxNumberFiles), stats(stats) {
                 lastSession = 0;
                 for (int i = 0; i < MAX_SESSIONS; ++i) {
                     sessions[i] = FREE_SESSION;
                 }
-                nOpenedFiles = 0;
+                accessPattern = ACCESS_NORMAL;
+                for (int i = 0; i < MAX_N_FILES; ++i) {
+                    filePatterns[i] = ACCESS_NORMAL;
+                }
             }
 
+        //Applied to all the files, also to those opened later
+        void setAccessPattern(AccessPattern pattern) {
+            accessPattern = pattern;
+            openedFiles.forEach([pattern](T *f) {
+                    f->advise(pattern);
+                    });
+        }
+
+        //Only for one file, also if it is closed and opened again
+        void setAccessPattern(short id, AccessPattern pattern) {
+            filePatterns[id] = pattern;
+            FileRef(this, id)->advise(pattern);
+        }
+
         string getCacheDir() {
             return cacheDir;
         }
 
+        //If the files are not tracked by a MemoryManager, the file is never
+        //closed afterwards because the caller keeps the pointer
         char* getBuffer(short id, uint64_t offset, uint64_t *length) {
-            load_file(id);
-            return openedFiles[id]->getBuffer(offset, length);
+            T *f = openedFiles.getPinned(id);
+            if (f != NULL) {
+                return f->getBuffer(offset, length);
+            }
+            f = acquire(id);
+            if (bytesTracker == NULL) {
+                openedFiles.pin(id);
+            }
+            char *result = f->getBuffer(offset, length);
+            openedFiles.release(id);
+            return result;
+        }
+
+        //The file is not closed as long as the handle exists
+        typename FileTable<T>::Handle getHandle(short id) {
+            return openedFiles.get(id, [this](const int id) {
+                    return openFile(id);
+                    });
         }
 
         char* getBuffer(short id, uint64_t offset, uint64_t *length, int sessionId) {
-            load_file(id);
+            T *f = acquire(id);
+            if (bytesTracker == NULL) {
+                openedFiles.pin(id);
+            }
             int memoryBlock;
 
-            char *result = openedFiles[id]->getBuffer(offset, length,
+            char *result = f->getBuffer(offset, length,
                     memoryBlock, sessionId);
+            openedFiles.release(id);
 
             if (sessionId != EMPTY_SESSION && sessions[sessionId] != memoryBlock) {
                 //Tell the memory manager that we don't need this block anymore
@@ -205,16 +221,18 @@ class FileManager {
         }
 
         uint64_t sizeFile(const int idx) {
-            if (isFileLoaded(idx)) {
-                return openedFiles[idx]->getFileLength();
+            T *f = openedFiles.tryAcquire(idx);
+            if (f != NULL) {
+                const uint64_t size = f->getFileLength();
+                openedFiles.release(idx);
+                return size;
             }
 
             if (idx < cacheFileSize.size() && cacheFileSize[idx] != 0) {
                 return cacheFileSize[idx];
             }
 
-            load_file(idx);
-            uint64_t size =  openedFiles[idx]->getFileLength();
+            uint64_t size = FileRef(this, idx)->getFileLength();
 
             if (readOnly || idx < lastFileId) {
                 if (idx >= cacheFileSize.size()) {
@@ -231,8 +249,7 @@ class FileManager {
 
 
         void shiftRemainingFile(int idx, uint64_t pos, uint64_t diff) {
-            load_file(idx);
-            openedFiles[idx]->shiftFile(pos, diff);
+            FileRef(this, idx)->shiftFile(pos, diff);
         }
 
         int getIdLastFile() {
@@ -249,67 +266,52 @@ class FileManager {
                 LOG(ERRORL) << "Max number of files is reached";
                 throw 10;
             }
-            load_file(lastFileId);
+            FileRef f(this, lastFileId);
             return (short) lastFileId;
         }
 
         void append(char *bytes, int size) {
-            load_file(lastFileId);
-            openedFiles[lastFileId]->append(bytes, size);
+            FileRef(this, lastFileId)->append(bytes, size);
         }
 
         uint64_t appendVLong(int64_t n) {
-            load_file(lastFileId);
-            return openedFiles[lastFileId]->appendVLong(n);
+            return FileRef(this, lastFileId)->appendVLong(n);
         }
 
         uint64_t appendVLong2(int64_t n) {
-            load_file(lastFileId);
-            return openedFiles[lastFileId]->appendVLong2(n);
+            return FileRef(this, lastFileId)->appendVLong2(n);
         }
 
         void appendLong(int64_t n) {
-            load_file(lastFileId);
-            openedFiles[lastFileId]->appendLong(n);
+            FileRef(this, lastFileId)->appendLong(n);
         }
 
         void appendInt(int64_t n) {
-            load_file(lastFileId);
-            openedFiles[lastFileId]->appendInt(n);
+            FileRef(this, lastFileId)->appendInt(n);
         }
 
         void appendShort(int64_t n) {
-            load_file(lastFileId);
-            openedFiles[lastFileId]->appendShort(n);
+            FileRef(this, lastFileId)->appendShort(n);
         }
 
         void appendLong(const uint8_t nbytes, const uint64_t n) {
-            load_file(lastFileId);
-            openedFiles[lastFileId]->appendLong(nbytes, n);
+            FileRef(this, lastFileId)->appendLong(nbytes, n);
         }
 
         void reserveBytes(const uint8_t bytes) {
-            load_file(lastFileId);
-            openedFiles[lastFileId]->reserveBytes(bytes);
+            FileRef(this, lastFileId)->reserveBytes(bytes);
         }
 
         void overwriteAt(short file, uint64_t pos, char byte) {
-            load_file(file);
-            openedFiles[file]->overwriteAt(pos, byte);
+            FileRef(this, file)->overwriteAt(pos, byte);
         }
 
         void overwriteVLong2At(short file, uint64_t pos, int64_t number) {
-            load_file(file);
-            openedFiles[file]->overwriteVLong2At(pos, number);
+            FileRef(this, file)->overwriteVLong2At(pos, number);
         }
 
         void empty() {
-            for (int i = 0; i < MAX_N_FILES; ++i) {
-                if (openedFiles[i] != NULL) {
-                    delete openedFiles[i];
-                    openedFiles[i] = NULL;
-                }
-            }
+            openedFiles.clear();
         }
 
         ~FileManager() {
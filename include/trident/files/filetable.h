@@ -0,0 +1,267 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _FILETABLE_H
+#define _FILETABLE_H
+
+#include <trident/kb/consts.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <inttypes.h>
+
+//Keeps the memory of a table valid while it is read (a reference to the
+//file or a decompressed block)
+typedef std::shared_ptr<const void> TablePin;
+
+/*
+ * Table of the opened files of a FileManager. The lookups of files that are
+ * already opened do not take any lock. The files are opened under the lock
+ * of their shard (id % FILETABLE_SHARDS), so files in different shards can be
+ * opened in parallel.
+ *
+ * If more than maxFiles are opened, one file is closed with the CLOCK
+ * algorithm. A file is never closed while it has references (acquire/release
+ * or a Handle), if it is pinned or if T::isUsed() returns true. Pinned files
+ * are those whose memory was given out without a reference.
+ *
+ * The slots can also be cleared by the MemoryManager of T, which deletes
+ * the file and sets its slot to NULL. This happens only when the files are
+ * written, and by one thread.
+ */
+template<class T>
+class FileTable {
+    public:
+        typedef std::shared_ptr<T> Handle;
+
+    private:
+        const int maxFiles;
+
+        std::atomic<T*> files[MAX_N_FILES];
+        std::atomic<int> refs[MAX_N_FILES];
+        std::atomic<bool> referenced[MAX_N_FILES]; //CLOCK bits
+        std::atomic<bool> pinned[MAX_N_FILES];
+        bool loaded[MAX_N_FILES]; //Protected by the lock of the shard
+
+        std::mutex shards[FILETABLE_SHARDS];
+        std::atomic<int> nOpened, nPinned;
+        std::atomic<int> nSlots; //Highest id opened + 1
+        std::atomic<uint64_t> hand;
+        std::atomic<uint64_t> nEvictions;
+
+        static int getShard(const int id) {
+            return id % FILETABLE_SHARDS;
+        }
+
+        void markReferenced(const int id) {
+            //Avoid writing on a shared cache line if it is not needed
+            if (!referenced[id].load(std::memory_order_relaxed)) {
+                referenced[id].store(true, std::memory_order_relaxed);
+            }
+        }
+
+        //The caller holds the lock of lockedShard. The locks of the other
+        //shards are only tried, to avoid deadlocks with other evictions.
+        bool evictOne(const int lockedShard) {
+            const int n = nSlots;
+            for (int step = 0; step < 2 * n; ++step) {
+                const int i = (int) (hand++ % n);
+                if (files[i].load() == NULL || pinned[i].load()) {
+                    continue;
+                }
+                if (referenced[i].exchange(false)) {
+                    continue; //Second chance
+                }
+                const int shard = getShard(i);
+                std::unique_lock<std::mutex> lock(shards[shard], std::defer_lock);
+                if (shard != lockedShard && !lock.try_lock()) {
+                    continue;
+                }
+                T *f = files[i].load();
+                if (f == NULL || pinned[i].load() || refs[i].load() > 0 ||
+                        f->isUsed()) {
+                    continue;
+                }
+                //A reader increments refs before reading the slot, so either
+                //it sees NULL or the check below sees its reference
+                files[i].store(NULL);
+                if (refs[i].load() > 0) {
+                    files[i].store(f);
+                    continue;
+                }
+                loaded[i] = false;
+                nOpened--;
+                nEvictions++;
+                delete f;
+                return true;
+            }
+            return false;
+        }
+
+    public:
+        FileTable(const int maxFiles) : maxFiles(maxFiles), nOpened(0),
+        nPinned(0), nSlots(0), hand(0), nEvictions(0) {
+            for (int i = 0; i < MAX_N_FILES; ++i) {
+                files[i] = NULL;
+                refs[i] = 0;
+                referenced[i] = false;
+                pinned[i] = false;
+                loaded[i] = false;
+            }
+        }
+
+        //The array is given to the MemoryManager of the files
+        std::atomic<T*> *getSlots() {
+            return files;
+        }
+
+        //Returns NULL if the file is not opened. Otherwise, the file cannot
+        //be closed until release() is called.
+        T *tryAcquire(const int id) {
+            refs[id]++;
+            T *f = files[id].load();
+            if (f == NULL) {
+                refs[id]--;
+                return NULL;
+            }
+            markReferenced(id);
+            return f;
+        }
+
+        //Returns the file only if it is pinned. No reference is needed
+        //because pinned files are never closed.
+        T *getPinned(const int id) {
+            if (pinned[id].load(std::memory_order_acquire)) {
+                return files[id].load(std::memory_order_acquire);
+            }
+            return NULL;
+        }
+
+        //Same as above, but the file is opened with create(id) if needed
+        template<typename F>
+        T *acquire(const int id, F create) {
+            T *f = tryAcquire(id);
+            if (f != NULL) {
+                return f;
+            }
+            const int shard = getShard(id);
+            std::unique_lock<std::mutex> lock(shards[shard]);
+            f = files[id].load();
+            if (f == NULL) {
+                if (loaded[id]) {
+                    //The file was closed by the memory manager
+                    loaded[id] = false;
+                    nOpened--;
+                    if (pinned[id].exchange(false)) {
+                        nPinned--;
+                    }
+                }
+                //Reserve the place first, so that concurrent openers in
+                //other shards cannot exceed maxFiles
+                const int opened = ++nOpened;
+                if (opened > maxFiles && opened > nPinned) {
+                    evictOne(shard);
+                }
+                try {
+                    f = create(id);
+                } catch (...) {
+                    nOpened--;
+                    throw;
+                }
+                files[id].store(f);
+                loaded[id] = true;
+                int n = nSlots;
+                while (n <= id && !nSlots.compare_exchange_weak(n, id + 1)) {
+                }
+            }
+            refs[id]++;
+            markReferenced(id);
+            return f;
+        }
+
+        void release(const int id) {
+            refs[id]--;
+        }
+
+        template<typename F>
+        Handle get(const int id, F create) {
+            T *f = acquire(id, create);
+            return Handle(f, [this, id](T*) {
+                    release(id);
+                    });
+        }
+
+        //The file will not be closed anymore. The caller must have a
+        //reference to it.
+        void pin(const int id) {
+            if (!pinned[id].load()) {
+                std::unique_lock<std::mutex> lock(shards[getShard(id)]);
+                if (!pinned[id].exchange(true)) {
+                    nPinned++;
+                }
+            }
+        }
+
+        template<typename F>
+        void forEach(F fn) {
+            for (int s = 0; s < FILETABLE_SHARDS; ++s) {
+                std::unique_lock<std::mutex> lock(shards[s]);
+                for (int i = s; i < MAX_N_FILES; i += FILETABLE_SHARDS) {
+                    T *f = files[i].load();
+                    if (f != NULL) {
+                        fn(f);
+                    }
+                }
+            }
+        }
+
+        int getNOpenedFiles() const {
+            return nOpened;
+        }
+
+        uint64_t getNEvictions() const {
+            return nEvictions;
+        }
+
+        //Close all the files. No other thread can use the table.
+        void clear() {
+            for (int i = 0; i < MAX_N_FILES; ++i) {
+                T *f = files[i].load();
+                if (f != NULL) {
+                    files[i].store(NULL);
+                    delete f;
+                }
+                loaded[i] = false;
+                pinned[i] = false;
+                referenced[i] = false;
+            }
+            nOpened = 0;
+            nPinned = 0;
+        }
+
+        ~FileTable() {
+            clear();
+        }
+};
+
+#endif
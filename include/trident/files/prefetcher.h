@@ -0,0 +1,115 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _PREFETCHER_H
+#define _PREFETCHER_H
+
+#include <inttypes.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct PrefetchStats {
+    uint64_t requests;
+    uint64_t dropped; //Requests discarded because the queue was full
+    uint64_t bytes; //Bytes read from the files
+    uint64_t tasks;
+    bool iouring;
+};
+
+class IOUring;
+
+/*
+ * Reads ranges of the permutation files in the background, so that the
+ * pages are already in the page cache when the tables are opened. The
+ * reads are issued with io_uring (up to PREFETCH_QUEUE_DEPTH at the same
+ * time) if the kernel supports it, otherwise by a pool of threads with
+ * pread. The pool also executes generic tasks (e.g. the decompression of
+ * the blocks of the compressed files).
+ *
+ * The threads (and io_uring) are started by the first request, so a KB
+ * that never prefetches does not pay for them. The requests are only
+ * hints: if too many are pending, the new ones are dropped. The file descriptors must remain open until the prefetcher is
+ * destroyed.
+ */
+class Prefetcher {
+    private:
+        struct ReadRequest {
+            int fd;
+            uint64_t offset;
+            uint64_t len;
+        };
+
+        const int nthreads;
+        const bool useIOUring;
+        bool started;
+
+        std::deque<ReadRequest> reads;
+        std::deque<std::function<void()>> tasks;
+        uint64_t pending; //Requests in the queues or in execution
+        bool stop;
+        std::mutex mutex;
+        std::condition_variable cond; //Wakes up the threads of the pool
+        std::condition_variable ringCond; //Wakes up the io_uring thread
+        std::condition_variable idle;
+
+        std::vector<std::thread> threads;
+        std::unique_ptr<IOUring> ring;
+        std::thread ringThread;
+
+        std::atomic<uint64_t> requests, dropped, bytes, nTasks;
+
+        //Called with the mutex locked by the first request
+        void start();
+
+        void done(const uint64_t n);
+
+        void worker();
+
+        void ringLoop();
+
+    public:
+        Prefetcher(const int nthreads, const bool useIOUring);
+
+        //Load the range of the file in the page cache
+        void read(const int fd, uint64_t offset, uint64_t len);
+
+        void run(std::function<void()> task);
+
+        //Wait until all the requests are processed
+        void wait();
+
+        bool usesIOUring() const {
+            return ring != NULL;
+        }
+
+        PrefetchStats getStats();
+
+        ~Prefetcher();
+};
+
+#endif
@@ -128,6 +128,11 @@ public:
 	    }
     }
 
+    size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+        //Every term is a different key
+        return PairItr::nextBatch(v1, v2, max > 0 ? 1 : 0);
+    }
+
     void next() {
         const int64_t key = activechildren.back()->getKey();
         setKey(key);
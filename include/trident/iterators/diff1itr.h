@@ -101,6 +101,11 @@ public:
         }
     }
 
+    size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+        //If the array contains the keys, every pair has its own key
+        return PairItr::nextBatch(v1, v2, posarray == 0 && max > 0 ? 1 : max);
+    }
+
     int64_t getCount() {
         switch (posarray) {
         case 0:
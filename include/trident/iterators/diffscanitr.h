@@ -90,6 +90,11 @@ public:
 
     void next();
 
+    size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+        //The key can change after every pair
+        return PairItr::nextBatch(v1, v2, max > 0 ? 1 : 0);
+    }
+
     void init(TreeItr *root, int perm, DiffIndex *diff);
 
     void setQuerier(Querier *q);
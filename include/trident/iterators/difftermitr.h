@@ -93,6 +93,11 @@ public:
 
     void next();
 
+    size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+        //Every term is a different key
+        return PairItr::nextBatch(v1, v2, max > 0 ? 1 : 0);
+    }
+
     uint64_t getCardinality();
 
     uint64_t estCardinality();
@@ -25,6 +25,7 @@
 
 
 #include <inttypes.h>
+#include <cstddef>
 
 #define NO_CONSTRAINT -1
 
@@ -62,6 +63,24 @@ class PairItr {
             return hasNext();
         }
 
+        //Read up to max pairs. It returns the number of pairs that were
+        //copied in v1 and v2. All the pairs returned by one call share the
+        //same key. Afterwards, the iterator is positioned on the last pair
+        //(as if next() was called that many times). The default
+        //implementation cannot look at the key of the following pair, so it
+        //is only valid for iterators with a fixed key: the iterators whose
+        //key changes during the scan must override it.
+        virtual size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+            size_t n = 0;
+            while (n < max && hasNext()) {
+                next();
+                v1[n] = getValue1();
+                v2[n] = getValue2();
+                n++;
+            }
+            return n;
+        }
+
         virtual void ignoreSecondColumn() = 0;
 
         virtual int64_t getCount() = 0;
@@ -148,6 +148,11 @@ public:
         return getCardinality();
     }
 
+    size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+        //Every term is a different key
+        return PairItr::nextBatch(v1, v2, max > 0 ? 1 : 0);
+    }
+
     void next() {
         if (!hnc && !hasNext()) {
             return;
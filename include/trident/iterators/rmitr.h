@@ -99,6 +99,8 @@ public:
 
     void next();
 
+    size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max);
+
     int64_t getCount();
 
     uint64_t getCardinality();
@@ -47,8 +47,12 @@ private:
     TermItr *itr2;
 
     TableStorage *storage;
+    //The file of storage that is being scanned (see the access hints)
+    short scannedFile;
     StorageStrat *strat;
 
+    void scanFile(short file);
+
 public:
     void init(int idx, Querier *q);
 
@@ -100,6 +104,8 @@ public:
 
     bool next(int64_t &v1, int64_t &v2, int64_t &v3);
 
+    size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max);
+
     void clear();
 
     uint64_t getCardinality();
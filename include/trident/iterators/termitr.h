@@ -77,6 +77,11 @@ class TermItr: public PairItr {
 
         void next();
 
+        size_t nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+            //Every term is a different key
+            return PairItr::nextBatch(v1, v2, max > 0 ? 1 : 0);
+        }
+
         void clear();
 
         uint64_t getCardinality();
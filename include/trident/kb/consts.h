@@ -67,6 +67,12 @@
 #define DIFF1_ITR 17
 #define RM_ITR 18
 #define RMCOMPOSITETERM_ITR 19
+#define PACKED_ITR 20
+
+//The other layouts store their ITR type in the 3-bit storage field of the
+//strategy. PACKED_ITR does not fit in it, so it uses this code instead
+#define PACKED_STORAGE 6
+#define PACKED_BLOCK_SIZE 128
 
 //Use for dynamic layout
 #define W_DIFFERENCE 0
@@ -80,6 +86,11 @@
 
 #define MAX_N_BLOCKS_IN_CACHE 1000000
 
+//2Q policy of the MemoryManager: max share of the cache taken by the new
+//blocks and number of removed blocks that are remembered
+#define MEMORYMGR_KIN_PERCENT 25
+#define MEMORYMGR_MAX_GHOSTS MAX_N_FILES
+
 //Used in the dictionary lookup thread
 #define OUTPUT_BUFFER_SIZE 2048
 #define MAX_N_PATTERNS 10
@@ -87,12 +98,44 @@
 //StringBuffer block size
 #define SB_BLOCK_SIZE 65536
 
+//Target size of the uncompressed blocks in the compressed permutation files
+#define COMPR_BLOCK_SIZE 65536
+
+//Asynchronous reads of the tables (see Prefetcher)
+#define PREFETCH_QUEUE_DEPTH 64
+#define PREFETCH_CHUNK_SIZE (128 * 1024)
+#define PREFETCH_MAX_PENDING 65536
+//Pairs of the outer pattern of a join whose keys are prefetched together
+#define PREFETCH_JOIN_BATCH 256
+
 //Generic options
 #define N_PARTITIONS 6
 #define THRESHOLD_KEEP_MEMORY 1000*1024
 
 #define MAX_N_FILES 4096
 
+//The table of the coordinates (see CoordinatesTable) is created only if the
+//largest key is less than this factor times the number of keys
+#define COORDTABLE_MAX_SPARSITY 2
+
+//Number of locks of the tables of the opened files (see FileTable)
+#define FILETABLE_SHARDS 64
+
+//Number of terms in a block of the front-coded dictionary (see FCDict)
+#define FCDICT_BLOCK_TERMS 16
+//Memory used to sort the terms when the front-coded dictionary is built
+#define FCDICT_SORT_BUFFER (256 * 1024 * 1024)
+
+//Memory used to sort the trigrams when the text index is built
+#define TEXTIDX_SORT_BUFFER (512 * 1024 * 1024)
+//Max number of candidates of the text index when a FILTER is evaluated
+#define TEXTIDX_MAX_FILTER_CANDIDATES (4 * 1024 * 1024)
+
+//Memory budget of the loader (see MemoryBudget): estimate of one buffer of
+//the LZ4 readers and writers of kognac, and minimum memory of the sorts
+#define LOADER_LZ4_BUFFER_SIZE (2 * 1024 * 1024)
+#define LOADER_MIN_SORT_BUFFER (16 * 1024 * 1024)
+
 //Used in the cache of the tree to serialize the nodes
 #define SIZE_SUPPORT_BUFFER 512 * 1024
 
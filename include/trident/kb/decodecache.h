@@ -0,0 +1,122 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _DECODECACHE_H
+#define _DECODECACHE_H
+
+#include <inttypes.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct DecodeCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t admissions;
+    uint64_t rejections; //Texts not admitted because they were less frequent
+    uint64_t evictions;
+    uint64_t entries;
+    uint64_t bytes;
+    uint64_t maxBytes;
+
+    double getHitRate() const {
+        return hits + misses == 0 ? 0 : (double) hits / (hits + misses);
+    }
+};
+
+/*
+ * Cache of the texts of the decoded IDs, shared by all the users of a
+ * DictMgmt (SPARQL results, server, python). It is split in shards, each
+ * with its own lock and LRU list. A new text is admitted in a full shard
+ * only if it was requested more often than the text it would evict
+ * (TinyLFU), so the scans of many distinct IDs do not flush the popular
+ * terms. The frequencies are estimated with a count-min sketch of 4-bit
+ * counters that are halved periodically, so they follow the recent
+ * requests.
+ */
+class DecodeCache {
+    private:
+        class FrequencySketch {
+            private:
+                std::vector<uint8_t> counters;
+                uint64_t mask;
+                uint64_t additions;
+                uint64_t sampleSize;
+
+                uint64_t getIndex(const uint64_t key, const int row) const;
+
+                void reset();
+
+            public:
+                FrequencySketch(const uint64_t width);
+
+                void increment(const uint64_t key);
+
+                int estimate(const uint64_t key) const;
+        };
+
+        struct Entry {
+            std::string text;
+            std::list<uint64_t>::iterator pos;
+        };
+
+        struct Shard {
+            std::mutex mutex;
+            std::unordered_map<uint64_t, Entry> entries;
+            std::list<uint64_t> lru;
+            FrequencySketch sketch;
+            uint64_t bytes;
+            uint64_t hits, misses, admissions, rejections, evictions;
+
+            Shard(const uint64_t sketchWidth) : sketch(sketchWidth), bytes(0),
+            hits(0), misses(0), admissions(0), rejections(0), evictions(0) {
+            }
+        };
+
+        const uint64_t maxBytes;
+        const uint64_t maxBytesShard;
+        std::vector<std::unique_ptr<Shard>> shards;
+
+        Shard &getShard(const uint64_t id) {
+            return *shards[(id * UINT64_C(0x9E3779B97F4A7C15)) >> 60];
+        }
+
+        static uint64_t getSize(const int sizeText);
+
+    public:
+        DecodeCache(const uint64_t maxBytes);
+
+        bool get(const uint64_t id, char *text, int &size);
+
+        bool get(const uint64_t id, std::string &text);
+
+        void put(const uint64_t id, const char *text, const int size);
+
+        DecodeCacheStats getStats();
+
+        void clear();
+};
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _DICTHASHINDEX_H
+#define _DICTHASHINDEX_H
+
+#include <trident/utils/memoryfile.h>
+
+#include <kognac/consts.h>
+
+#include <memory>
+#include <string>
+
+class Root;
+class StringBuffer;
+
+/*
+ * Open-addressing hash table that maps the texts of the main dictionary to
+ * their IDs. It replaces the descent of the tree dict in getNumber. The
+ * slots store the coordinates of the text in the StringBuffer, which are
+ * used to verify the matches of the hash.
+ *
+ * Layout:
+ * 8 bytes <n. slots (power of 2)> 8 bytes <n. terms>
+ * for every slot: 8 bytes <hash> 8 bytes <ID> 8 bytes <coordinates>.
+ * A hash of 0 marks an empty slot. Collisions are resolved with linear
+ * probing.
+ */
+class DictHashIndex {
+    private:
+        struct Slot {
+            uint64_t hash;
+            int64_t id;
+            int64_t coordinates;
+        };
+
+        std::unique_ptr<MemoryMappedFile> file;
+        const Slot *slots;
+        uint64_t mask;
+        StringBuffer *sb;
+
+    public:
+        DictHashIndex(std::string path, StringBuffer *sb);
+
+        bool get(const char *text, const int size, nTerm *id) const;
+
+        //Never returns 0, which marks the empty slots
+        static uint64_t hash(const char *text, const int size);
+
+        static void create(Root *dict, StringBuffer *sb, std::string path);
+};
+
+#endif
@@ -25,6 +25,8 @@
 
 #include <trident/kb/consts.h>
 #include <trident/kb/statistics.h>
+#include <trident/kb/decodecache.h>
+#include <trident/utils/memorymgr.h>
 
 #include <kognac/hashfunctions.h>
 #include <kognac/utils.h>
@@ -35,6 +37,9 @@
 
 class Root;
 class StringBuffer;
+class FCDict;
+class DictHashIndex;
+class TextIndex;
 class TreeItr;
 
 #define DICTMGMT_INTEGER  UINT64_C(0x4000000000000000)
@@ -89,6 +94,12 @@ class DictMgmt {
             std::shared_ptr<Root> dict;
             std::shared_ptr<Root> invdict;
             std::shared_ptr<StringBuffer> sb;
+            //If set, it replaces dict, invdict and sb (static KBs)
+            std::shared_ptr<FCDict> fcdict;
+            //If set, it is used instead of dict to lookup the IDs
+            std::shared_ptr<DictHashIndex> hashidx;
+            //If set, it is used to search the terms by substring
+            std::shared_ptr<TextIndex> textidx;
             int64_t size;
             int64_t nextid;
 
@@ -98,12 +109,15 @@ class DictMgmt {
             }
 
             ~Dict() {
+                hashidx = std::shared_ptr<DictHashIndex>();
+                textidx = std::shared_ptr<TextIndex>();
                 LOG(DEBUGL) << "Deallocating dict ...";
                 dict = std::shared_ptr<Root>();
                 LOG(DEBUGL) << "Deallocating invdict ...";
                 invdict = std::shared_ptr<Root>();
                 LOG(DEBUGL) << "Deallocating sb ...";
                 sb = std::shared_ptr<StringBuffer>();
+                fcdict = std::shared_ptr<FCDict>();
                 LOG(DEBUGL) << "Deallocating stats ...";
                 stats = std::shared_ptr<Stats>();
             }
@@ -122,6 +136,13 @@ class DictMgmt {
 
         bool hash;
 
+        //If set, some literals are encoded in their IDs (see InlineLiterals)
+        bool inlineLits;
+
+        //Texts of the IDs decoded recently. Shared by all the users of the
+        //dictionary. NULL if disabled
+        std::unique_ptr<DecodeCache> decodeCache;
+
         Row row;
 
         //Used if additional terms are defined in the updates
@@ -166,12 +187,24 @@ class DictMgmt {
             return largestID;
         }
 
+        //They throw if the dictionary is front-coded (see getFCDict)
         TreeItr *getInvDictIterator();
 
         TreeItr *getDictIterator();
 
         StringBuffer *getStringBuffer();
 
+        //NULL if the main dictionary is stored in the trees
+        FCDict *getFCDict();
+
+        //Sum of the caches of the trees of all dictionaries
+        MemoryManagerStats getCacheStats();
+
+        //maxBytes == 0 disables the cache
+        void setDecodeCache(uint64_t maxBytes);
+
+        DecodeCacheStats getDecodeCacheStats();
+
         LIBEXP bool getText(nTerm key, char *value);
 
         LIBEXP bool getText(nTerm key, std::string &value);
@@ -180,6 +213,14 @@ class DictMgmt {
 
         LIBEXP bool getText(nTerm key, char *value, int &size);
 
+        //Decodes many IDs at once. Every distinct ID is decoded once, in the
+        //order of its coordinates in the StringBuffer, so that the blocks
+        //are read sequentially. The work is split among nthreads threads
+        //if the dictionaries are read-only. The texts are in the input order
+        LIBEXP void getTexts(const uint64_t *ids, const size_t n,
+                std::string *output, bool *found, int nthreads = 1);
+
+        //It throws if the dictionary is front-coded
         void getTextFromCoordinates(int64_t coordinates, char *output,
                 int &sizeOutput);
 
@@ -198,10 +239,44 @@ class DictMgmt {
 
         void appendPair(const char *key, int sizeKey, nTerm &value);
 
+        //Writes the hash index of the main dictionary (see DictHashIndex)
+        void createHashIndex(string path);
+
+        //Writes the trigram index of the main dictionary (see TextIndex)
+        void createTextIndex(string dir);
+
+        bool hasTextIndex() {
+            return dictionaries[0].textidx != NULL;
+        }
+
+        //Returns the sorted IDs of the terms of the main dictionary that
+        //contain pattern (or start with it, if prefix is set) and
+        //optionally their texts. Returns false if the text index cannot
+        //answer, i.e., if there is no index, the pattern is shorter than
+        //three bytes or it is not selective enough (more than maxCandidates
+        //candidates). The IDs that are not below getTextIndexNIDs() are
+        //not covered by the index
+        LIBEXP bool searchText(const std::string &pattern, bool prefix,
+                std::vector<uint64_t> &ids, std::vector<std::string> *texts,
+                uint64_t maxCandidates = UINT64_MAX, int nthreads = 1);
+
+        uint64_t getTextIndexNIDs();
+
+        //Used when the terms are added outside the trees (see FCDictBuilder)
+        void registerInsertedTerms(int64_t nTerms, int64_t largest);
+
         bool useHashForCompression() {
             return hash;
         }
 
+        void setInlineLiterals(bool inlineLits) {
+            this->inlineLits = inlineLits;
+        }
+
+        bool inlinesLiterals() {
+            return inlineLits;
+        }
+
         void clean() {
             dictionaries.clear();
         }
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _FCDICT_H
+#define _FCDICT_H
+
+#include <trident/kb/consts.h>
+#include <trident/utils/memoryfile.h>
+
+#include <kognac/consts.h>
+#include <kognac/utils.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Static dictionary stored as a sorted pool of front-coded strings. It
+ * replaces the trees dict/invdict of the read-only KBs. All the files are
+ * mapped in memory and are never modified, so the lookups need no locks.
+ *
+ * Files in the directory:
+ * meta: 8 bytes <n. terms> 8 bytes <n. IDs (largest ID + 1)>
+ *       1 byte <bytes per ID> 1 byte <bytes per rank> 4 bytes <terms per block>
+ * strings: the terms in lexicographic (unsigned byte) order, in blocks of
+ *       FCDICT_BLOCK_TERMS terms. The first term of a block is stored as
+ *       <vlong size><text>, the others as <vlong prefix><vlong suffix size>
+ *       <suffix>, where prefix is the length shared with the previous term.
+ * blocks: 8 bytes per block with its offset in strings.
+ * ids: the ID of every term, in the order of strings.
+ * ranks: indexed by ID, the position of the term in strings plus 1 (0 if
+ *       the ID has no term).
+ */
+class FCDict {
+    private:
+        std::unique_ptr<MemoryMappedFile> fStrings, fBlocks, fIds, fRanks;
+        const char *strings;
+        const char *blocks;
+        const char *ids;
+        const char *ranks;
+        uint64_t nTerms;
+        uint64_t nIDs;
+        uint64_t nBlocks;
+        uint8_t bytesPerID, bytesPerRank;
+        int termsPerBlock;
+
+        const char *getBlock(uint64_t block) const {
+            return strings + Utils::decode_long(blocks, block * 8);
+        }
+
+        //Decodes the term at position pos of the block. Returns its size
+        int decode(const char *block, int pos, char *output) const;
+
+    public:
+        FCDict(std::string dir);
+
+        //output must have space for MAX_TERM_SIZE bytes
+        bool getText(nTerm id, char *output, int &size) const;
+
+        bool getNumber(const char *text, const int size, nTerm *id) const;
+
+        uint64_t getNTerms() const {
+            return nTerms;
+        }
+
+        //Access the terms by their position in the sorted pool
+        nTerm getIDAtRank(uint64_t rank) const {
+            return Utils::decode_longFixedBytes(ids + rank * bytesPerID,
+                    bytesPerID);
+        }
+
+        int getTextAtRank(uint64_t rank, char *output) const {
+            return decode(getBlock(rank / termsPerBlock), rank % termsPerBlock,
+                    output);
+        }
+
+        static int compare(const char *t1, const int s1, const char *t2,
+                const int s2);
+
+        static bool exists(std::string dir);
+};
+
+/*
+ * Builds a FCDict from the terms in any order. The terms are sorted in
+ * runs of at most maxMemory bytes that are stored on disk and merged at the
+ * end. If a text is added twice, only the one with the smallest ID is kept.
+ */
+class FCDictBuilder {
+    private:
+        struct Term {
+            uint64_t offset;
+            int size;
+            nTerm id;
+        };
+
+        const std::string dir;
+        const uint64_t maxMemory;
+        std::vector<char> texts;
+        std::vector<Term> terms;
+        std::vector<std::string> runs;
+        nTerm largestID;
+        uint64_t nAdded;
+        uint64_t nDuplicates;
+
+        void flushRun();
+
+    public:
+        FCDictBuilder(std::string dir, uint64_t maxMemory);
+
+        void add(const char *text, const int size, const nTerm id);
+
+        //Writes the dictionary. Returns the number of terms
+        uint64_t finish();
+
+        uint64_t getNDuplicates() const {
+            return nDuplicates;
+        }
+};
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _INLINELITERALS_H
+#define _INLINELITERALS_H
+
+#include <inttypes.h>
+#include <vector>
+
+//Inlined IDs are in [2^39, 2^40). The permutations are sorted with five
+//bytes per term (see PermSorter), so they must stay below 2^40, and the
+//IDs of the dictionary must stay below 2^39. They never clash with the
+//numbers of the aggregates (DICTMGMT_INTEGER and DICTMGMT_FLOAT)
+#define INLINELITS_FLAG (UINT64_C(1) << 39)
+#define INLINELITS_MASK (~(INLINELITS_FLAG - 1))
+#define INLINELITS_CLASS_BITS 37
+#define INLINELITS_PAYLOAD_MASK ((UINT64_C(1) << INLINELITS_CLASS_BITS) - 1)
+
+#define INLINELITS_DOUBLE 0
+#define INLINELITS_DECIMAL 1
+#define INLINELITS_DATETIME 2
+
+/*
+ * Encodes some typed literals directly in their IDs, so they need no entry
+ * in the dictionary and the order of the IDs follows the order of the
+ * values. An ID is <1> <2 bits class> <37 bits payload>.
+ *
+ * xsd:double and xsd:decimal: the payload is an order-preserving key of the
+ * double with the first 30 bits of its mantissa (see getKey). Only the
+ * values with 2^-31 <= |x| < 2^32 (and 0) whose mantissa fits are inlined
+ * (e.g. the integers up to 2^31, "1.5" or "0.25", but not "0.1"), and only
+ * if their text is the canonical one (shortest digits that give back the
+ * double, no exponent), e.g. "1.5" but not "1.50".
+ *
+ * xsd:dateTime: the payload is <seconds since 1900-01-01T00:00:00> <1 bit
+ * Z>. Only the texts YYYY-MM-DDThh:mm:ss[Z] of the years 1900-3999 are
+ * inlined.
+ *
+ * Texts that do not fit stay in the dictionary, so the decoding is always
+ * exact.
+ */
+class InlineLiterals {
+    public:
+        typedef enum { LESS, LESSOREQUAL, GREATER, GREATEROREQUAL } Cmp;
+
+        //The IDs in [begin, end) that are not in [lo, hi] fail a comparison
+        struct Range {
+            uint64_t begin, end;
+            uint64_t lo, hi;
+        };
+
+    private:
+        //If the mantissa does not fit (exact is false), key is the one of
+        //the largest inlined value smaller than value
+        static bool getKey(double value, uint64_t &key, bool &exact);
+
+        static double getValue(uint64_t key);
+
+    public:
+        static bool isInlined(const uint64_t id) {
+            return (id & INLINELITS_MASK) == INLINELITS_FLAG;
+        }
+
+        static int getClass(const uint64_t id) {
+            return (id >> INLINELITS_CLASS_BITS) & 3;
+        }
+
+        static uint64_t getClassBegin(const int c) {
+            return INLINELITS_FLAG | ((uint64_t) c << INLINELITS_CLASS_BITS);
+        }
+
+        static uint64_t getClassEnd(const int c) {
+            return getClassBegin(c) + (UINT64_C(1) << INLINELITS_CLASS_BITS);
+        }
+
+        //Returns true if the literal (in N-Triples syntax) can be inlined
+        static bool encode(const char *text, const int size, uint64_t &id);
+
+        //Writes the text of an inlined ID. Returns its size
+        static int decode(const uint64_t id, char *text);
+
+        //Value of an inlined double or decimal
+        static double getDouble(const uint64_t id);
+
+        //Seconds since 0001-01-01T00:00:00 of an inlined dateTime
+        static int64_t getSeconds(const uint64_t id);
+
+        //Compares two inlined IDs as the SPARQL filters do (numbers by value,
+        //dateTimes up to the second). Returns false if they are not
+        //comparable
+        static bool compare(const uint64_t id1, const uint64_t id2, int &res);
+
+        //Returns the ranges of inlined IDs that can satisfy
+        //"<value> cmp constant". False if the constant is not a number or a
+        //dateTime that can be compared with the inlined literals
+        static bool getRanges(const char *constant, const int size,
+                const Cmp cmp, std::vector<Range> &ranges);
+};
+
+#endif
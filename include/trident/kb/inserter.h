@@ -59,6 +59,7 @@ class Inserter {
         const char fixedStrategy;
 
         bool useRowForLargeTables;
+        bool usePackedTables;
         size_t thresholdForColumnStorage;
         const size_t thresholdSkipTable;
 
@@ -91,6 +92,7 @@ class Inserter {
         Factory<NewColumnTableInserter> ncFactory[N_PARTITIONS];
         Factory<NewRowTableInserter> nrFactory[N_PARTITIONS];
         Factory<NewClusterTableInserter> ncluFactory[N_PARTITIONS];
+        Factory<PackedTableInserter> packedFactory[N_PARTITIONS];
         BinaryTableInserter *currentPairHandler[N_PARTITIONS];
 
         //Store the number of virtual tables per partition
@@ -119,6 +121,7 @@ class Inserter {
                 int64_t *ntables, int64_t *nFirstElsNTables) : nTerms(nTerms),
         useFixedStrategy(useFixedStrategy), fixedStrategy(fixedStrategy),
         useRowForLargeTables(false),
+        usePackedTables(false),
         thresholdForColumnStorage(StorageStrat::getBinaryBreakingPoint()),
         thresholdSkipTable(thresholdSkipTable),
         ntables(ntables), nFirstElsNTables(nFirstElsNTables) {
@@ -131,12 +134,14 @@ class Inserter {
                 values1[i] = new int64_t[THRESHOLD_KEEP_MEMORY + 1];
                 values2[i] = new int64_t[THRESHOLD_KEEP_MEMORY + 1];
                 storageStrategy[i].init(/*NULL, NULL, NULL,*/ NULL, NULL, NULL,
+                        NULL,
                         &listFactory[i],
                         &comprFactory[i],
                         &list2Factory[i],
                         &ncFactory[i],
                         &nrFactory[i],
-                        &ncluFactory[i]);
+                        &ncluFactory[i],
+                        &packedFactory[i]);
                 currentPairHandler[i] = NULL;
 
                 lastFirstTerm[i] = -1;
@@ -156,6 +161,10 @@ class Inserter {
             useRowForLargeTables = true;
         }
 
+        void setUsagePackedTables() {
+            usePackedTables = true;
+        }
+
         bool insert(const int permutation, const int64_t t1, const int64_t t2,
                 const int64_t t3, const int64_t count,
                 TripleWriter *posArray, TreeInserter *treeInserter,
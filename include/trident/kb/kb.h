@@ -30,6 +30,8 @@
 #include <trident/kb/cacheidx.h>
 #include <trident/kb/diffindex.h>
 #include <trident/utils/memorymgr.h>
+#include <trident/files/blockcache.h>
+#include <trident/files/prefetcher.h>
 
 #include <kognac/factory.h>
 
@@ -40,8 +42,8 @@ class Querier;
 class Inserter;
 class TableStorage;
 class Root;
+class TreeBuilder;
 class StringBuffer;
-struct FileSegment;
 class FileDescriptor;
 
 using namespace std;
@@ -88,6 +90,8 @@ class KB {
 
         TableStorage *files[N_PARTITIONS];
         MemoryManager<FileDescriptor> *bytesTracker[N_PARTITIONS];
+        std::unique_ptr<BlockCache> blockCache;
+        std::unique_ptr<Prefetcher> prefetcher;
 
         CacheIdx *pso;
         CacheIdx *osp;
@@ -192,10 +196,37 @@ class KB {
 
         Root* getRootTree();
 
+        //Closes the tree that receives the insertions and returns a builder
+        //that writes it bottom-up from the sorted coordinates
+        TreeBuilder *bulkLoadTree(int nPartitions);
+
         TreeItr *getItrTerms();
 
         std::vector<const char*> openAllFiles(int perm);
 
+        //Statistics of the cache of the compressed permutation files
+        BlockCacheStats getBlockCacheStats() {
+            if (blockCache) {
+                return blockCache->getStats();
+            }
+            return BlockCacheStats();
+        }
+
+        //Statistics of the caches of the files of the trees
+        MemoryManagerStats getTreeCacheStats();
+
+        MemoryManagerStats getDictCacheStats();
+
+        //Statistics of the cache of the decoded terms (see DecodeCache)
+        DecodeCacheStats getDecodeCacheStats();
+
+        PrefetchStats getPrefetchStats() {
+            if (prefetcher) {
+                return prefetcher->getStats();
+            }
+            return PrefetchStats();
+        }
+
         void addDiffIndex(string inputdir, const char **globalbuffers, Querier *q);
 
         DDLEXPORT ~KB();
@@ -51,6 +51,7 @@ typedef enum {
     TREE_NODEMINBYTES, //Min number of bytes used to store the nodes
     TREE_MAXFILESIZE, //Max size in bytes of the files that store the tree
     TREE_MAXNFILES, //Max number of files opened
+    TREE_COORDTABLE, //Read the coordinates from tree/coords, if it exists
 
     //Used by the factory of arrays of internal lines
     //Used by the factory of internal lines
@@ -90,11 +91,29 @@ typedef enum {
     STORAGE_CACHE_SIZE,
     STORAGE_MAX_FILE_SIZE,
     STORAGE_MAX_N_FILES,
+    STORAGE_BLOCKCACHE_SIZE, //Max bytes of decompressed blocks (compressed files)
+    STORAGE_ACCESS_HINTS, //Read the permutations with MADV_RANDOM, except during the scans
+    STORAGE_PREFETCH_THREADS, //Threads used by Querier::prefetch (0 disables it)
+    STORAGE_PREFETCH_IOURING, //Use io_uring for the prefetching, if available
+
+//Replacement policy ("2q" or "fifo") of the caches of the files of the trees
+//and of the partitions (see MemoryManager)
+    CACHE_REPLACEMENT_POLICY,
+
+//Warmup of the files when the KB is opened in read-only mode
+    WARMUP_PERMS, //Permutations to load (e.g. "spo,pos", "all" or "")
+    WARMUP_TREE,
+    WARMUP_DICT,
+    WARMUP_THREADS,
+    WARMUP_TIMEOUT, //Max number of seconds (0 means no limit)
 
 //Parameters about the string buffer
     SB_COMPRESSDOMAINS,
     SB_PREALLBUFFERS,
-    SB_CACHESIZE
+    SB_CACHESIZE,
+
+//Max bytes of the cache of the decoded terms (0 disables it, see DecodeCache)
+    DICT_DECODECACHE_SIZE
 
 } KBParam;
 
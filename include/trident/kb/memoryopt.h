@@ -34,6 +34,13 @@ private:
 public:
     static void optimizeForWriting(int64_t inputTriples, KBConfig &config);
 
+    //Size of the caches of the trees and of the string buffers when writing
+    static uint64_t getCachesSizeForWriting(int ndicts, KBConfig &config);
+
+    //Shrinks the caches so that they take at most maxMemory bytes
+    static void limitCachesForWriting(uint64_t maxMemory, int ndicts,
+                                      KBConfig &config);
+
     static void optimizeForReading(int ndicts, KBConfig &config);
 
     static void optimizeForReasoning(int ndicts, KBConfig &config);
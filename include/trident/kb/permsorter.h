@@ -26,6 +26,7 @@
 #include <kognac/multidisklz4reader.h>
 #include <kognac/multidisklz4writer.h>
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -59,12 +60,32 @@ class PermSorter {
                 char *end, int nthreads);
 
     public:
+        //onSorted is called with the directory of a permutation as soon as
+        //all its sorted chunks are on disk, while the other permutations
+        //might still be sorted. If derivePerms is set, only SPO is sorted and
+        //the other permutations are scattered from the sorted ones
         static void sortChunks(string inputdir,
                 int maxReadingThreads,
                 int parallelProcesses,
                 int64_t estimatedSize,
                 bool outputSPO,
-                std::vector<std::pair<string, char>> &additionalPermutations);
+                bool derivePerms,
+                std::vector<std::pair<string, char>> &additionalPermutations,
+                std::function<void(string)> onSorted =
+                std::function<void(string)>());
+
+        //Sorts spo, which has size records of which the first n are
+        //triples and the others are filled with 0xFF, and writes the same
+        //records in the buffers of the other permutations in their order,
+        //as sortChunks does with derivePerms. onDerived is called with
+        //<target,source> as soon as a permutation is ready (<0,-1> for
+        //spo)
+        static void derivePermutations(char *spo, const int64_t n,
+                const int64_t size,
+                const std::vector<std::pair<char*, char>> &others,
+                const int nthreads,
+                std::function<void(int, int)> onDerived =
+                std::function<void(int, int)>());
 
         static int64_t readTermFromBuffer(char *buffer);
 };
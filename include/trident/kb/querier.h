@@ -41,10 +41,13 @@
 #include <trident/binarytables/storagestrat.h>
 #include <trident/binarytables/factorytables.h>
 #include <trident/kb/diffindex.h>
+#include <trident/utils/memorymgr.h>
 
 #include <kognac/factory.h>
 
 #include <iostream>
+#include <memory>
+#include <vector>
 
 class TableStorage;
 class ListPairHandler;
@@ -94,6 +97,7 @@ class Querier {
         Factory<NewColumnTable> ncFactory;
         FactoryNewRowTable nrFactory;
         FactoryNewClusterTable ncluFactory;
+        Factory<PackedTable> packedFactory;
 
         StorageStrat strat;
 
@@ -111,6 +115,44 @@ class Querier {
 
         PairItr *summaryDiff(const int perm, DiffIndex::TypeUpdate tp);
 
+        //One query of the batched methods. key, v1 and v2 are the terms
+        //in the order of the permutation idx
+        struct BatchQuery {
+            int idx;
+            int64_t s, p, o;
+            int64_t key, v1, v2;
+            size_t pos;
+
+            BatchQuery(Querier *q, const int idx, const int64_t s,
+                    const int64_t p, const int64_t o, const size_t pos);
+
+            bool operator <(const BatchQuery &other) const {
+                if (key != other.key)
+                    return key < other.key;
+                if (idx != other.idx)
+                    return idx < other.idx;
+                if (v1 != other.v1)
+                    return v1 < other.v1;
+                return v2 < other.v2;
+            }
+        };
+
+        //Sort the queries and look up every key once. groups contains the
+        //start of every group of queries with the same key (and the end)
+        void lookupMany(std::vector<BatchQuery> &queries,
+                std::vector<size_t> &groups,
+                std::vector<TermCoordinates> &values,
+                std::unique_ptr<bool[]> &found);
+
+        //Make the following calls on key use the coordinates found by
+        //lookupMany instead of looking them up again
+        void setCurrentKey(const int64_t key, TermCoordinates &value,
+                const bool found);
+
+        //Check the existence of the fully bound queries [begin, end), which
+        //are on the same key and permutation
+        void existsOnTable(BatchQuery *begin, BatchQuery *end, bool *out);
+
     public:
 
         struct Counters {
@@ -121,6 +163,8 @@ class Querier {
             int64_t notAggrIndices;
             int64_t cacheIndices;
             int64_t spo, ops, pos, sop, osp, pso;
+            MemoryManagerStats treeCache; //Cache of the files of the tree
+            MemoryManagerStats dictCache; //Same for the dictionaries
         };
 
         Querier(Root* tree, DictMgmt *dict, TableStorage** files,
@@ -137,6 +181,14 @@ class Querier {
 
         DDLEXPORT PairItr *getTermList(const int perm);
 
+        //Start reading in the background the tables of the keys on perm,
+        //because they will be queried soon (e.g. the keys of the outer
+        //iterator of a join). The keys that are not in the KB are ignored.
+        DDLEXPORT void prefetch(const int perm, const std::vector<int64_t> &keys);
+
+        //False if prefetch() would not do anything on perm
+        DDLEXPORT bool canPrefetch(const int perm);
+
         DDLEXPORT PairItr *summaryAddDiff();
 
         DDLEXPORT PairItr *summaryRmDiff();
@@ -206,6 +258,20 @@ class Querier {
 
         DDLEXPORT bool exists(const int64_t s, const int64_t p, const int64_t o);
 
+        //Batched versions of get, exists and getCard. The queries are
+        //processed sorted by key, so every key is looked up once with a
+        //single pass on the tree, and the queries on the same table share
+        //its setup. The results are in the input order.
+        DDLEXPORT void getMany(const int idx, const int64_t *s,
+                const int64_t *p, const int64_t *o, const size_t n,
+                PairItr **out);
+
+        DDLEXPORT void existsMany(const int64_t *s, const int64_t *p,
+                const int64_t *o, const size_t n, bool *out);
+
+        DDLEXPORT void getCardMany(const int64_t *s, const int64_t *p,
+                const int64_t *o, const size_t n, int64_t *out);
+
         DDLEXPORT int getIndex(const int64_t s, const int64_t p, const int64_t o);
 
         char getStrategy(const int idx, const int64_t v);
@@ -253,22 +319,7 @@ class Querier {
             spo = ops = pos = sop = osp = pso = 0;
         }
 
-        Counters getCounters() {
-            Counters c;
-            c.statsRow = strat.statsRow;
-            c.statsColumn = strat.statsColumn;
-            c.statsCluster = strat.statsCluster;
-            c.aggrIndices = aggrIndices;
-            c.notAggrIndices = notAggrIndices;
-            c.cacheIndices = cacheIndices;
-            c.spo = spo;
-            c.ops = ops;
-            c.pos = pos;
-            c.sop = sop;
-            c.osp = osp;
-            c.pso = pso;
-            return c;
-        }
+        Counters getCounters();
 
         ArrayItr *getArrayIterator() {
             return factory2.get();
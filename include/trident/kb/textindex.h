@@ -0,0 +1,114 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _TEXTINDEX_H
+#define _TEXTINDEX_H
+
+#include <trident/utils/memoryfile.h>
+
+#include <kognac/consts.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Inverted index of the trigrams (sequences of three bytes) of the texts of
+ * the dictionary. A substring of at least three bytes can occur only in the
+ * terms that contain all its trigrams, so the intersection of their posting
+ * lists is a superset of the terms that contain it. The candidates must be
+ * verified on the texts (see DictMgmt::searchText).
+ *
+ * Files in the directory:
+ * meta: 8 bytes <n. grams> 8 bytes <n. IDs (largest ID + 1)>
+ * grams: for every trigram, in ascending order, 8 bytes <trigram>
+ *       8 bytes <offset in postings> 8 bytes <n. IDs>
+ * postings: the IDs of every trigram in ascending order, stored as vlong
+ *       deltas.
+ */
+class TextIndex {
+    private:
+        friend class TextIndexBuilder;
+
+        struct Gram {
+            uint64_t gram;
+            uint64_t offset;
+            uint64_t count;
+        };
+
+        std::unique_ptr<MemoryMappedFile> fGrams, fPostings;
+        const Gram *grams;
+        const char *postings;
+        uint64_t nGrams;
+        uint64_t nIDs;
+
+        const Gram *find(uint64_t gram) const;
+
+    public:
+        TextIndex(std::string dir);
+
+        //Returns false if the pattern is shorter than a trigram or if there
+        //are more than maxCandidates candidates. Otherwise, candidates
+        //contains the sorted IDs of the terms that might contain pattern
+        bool getCandidates(const char *pattern, const int size,
+                const uint64_t maxCandidates,
+                std::vector<uint64_t> &candidates) const;
+
+        //All the IDs of the dictionary are below this bound
+        uint64_t getNIDs() const {
+            return nIDs;
+        }
+
+        static uint64_t getGram(const char *text) {
+            return ((uint64_t) (uint8_t) text[0] << 16) |
+                ((uint64_t) (uint8_t) text[1] << 8) | (uint8_t) text[2];
+        }
+
+        static bool exists(std::string dir);
+};
+
+/*
+ * Builds a TextIndex from the terms of the dictionary. The pairs
+ * <trigram,ID> are sorted in runs of at most maxMemory bytes that are
+ * stored on disk and merged at the end.
+ */
+class TextIndexBuilder {
+    private:
+        const std::string dir;
+        const uint64_t maxMemory;
+        std::vector<uint64_t> pairs;
+        std::vector<uint64_t> termGrams;
+        std::vector<std::string> runs;
+        nTerm largestID;
+
+        void flushRun();
+
+    public:
+        TextIndexBuilder(std::string dir, uint64_t maxMemory);
+
+        void add(const char *text, const int size, const nTerm id);
+
+        //Writes the index. Returns the number of trigrams
+        uint64_t finish();
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _WARMUP_H
+#define _WARMUP_H
+
+#include <string>
+#include <vector>
+
+/*
+ * Loads the files of a KB in the page cache, so that the first queries after
+ * a restart do not wait for random page faults. The files are touched
+ * sequentially, one page at a time, by several threads.
+ */
+class Warmup {
+    private:
+        static void getFiles(std::string dir, std::vector<std::string> &files);
+
+    public:
+        //Parses a list like "spo,pos" (or "all") into permutation IDs
+        static std::vector<int> parsePermutations(std::string perms);
+
+        //Warm up the tree, the dictionary (with the front-coded one, the
+        //hash and the text indices) and the given permutations (in this
+        //order), as long as they fit in the available memory. It stops after
+        //timeout seconds (0 means no limit).
+        //Returns the number of bytes that were read.
+        static uint64_t warmupKB(std::string kbdir, std::vector<int> perms,
+                bool tree, bool dict, int nthreads, int timeout);
+
+        //Loads the files in this order, but not more than maxBytes (0 means
+        //no limit)
+        static uint64_t loadFiles(const std::vector<std::string> &files,
+                int nthreads, int timeout, uint64_t maxBytes);
+
+        //Free memory plus the page cache that can be reclaimed
+        static uint64_t getAvailableMemory();
+};
+
+#endif
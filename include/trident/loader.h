@@ -39,6 +39,8 @@
 #include <condition_variable>
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
 #include <unordered_map>
 
 using namespace std;
@@ -111,6 +113,7 @@ class CoordinatesMerger {
         char supportBuffer[23];
 
         const int ncoordinates;
+        const nTerm endKey;
 
         TreeEl elspo, elops, elpos, elsop, elosp, elpso;
         bool spoFinished, opsFinished, posFinished,
@@ -119,28 +122,44 @@ class CoordinatesMerger {
 
         bool getFirst(TreeEl *el, ifstream *buffer);
 
+        //Moves to the first entry with a key >= startKey
+        void seek(ifstream *buffer, nTerm startKey);
+
     public:
         CoordinatesMerger(string *coordinates, int ncoordinates) :
-            ncoordinates(ncoordinates) {
+            CoordinatesMerger(coordinates, ncoordinates, 0, INT64_MAX) {
+            }
+
+        //Merges only the keys in [startKey, endKey)
+        CoordinatesMerger(string *coordinates, int ncoordinates,
+                nTerm startKey, nTerm endKey) :
+            ncoordinates(ncoordinates), endKey(endKey) {
 
                 //Open the three files
                 spo.open(coordinates[0], ios_base::binary);
+                seek(&spo, startKey);
                 spoFinished = !getFirst(&elspo, &spo);
 
                 if (ncoordinates > 1) {
                     ops.open(coordinates[1], ios_base::binary);
+                    seek(&ops, startKey);
                     opsFinished = !getFirst(&elops, &ops);
                     pos.open(coordinates[2], ios_base::binary);
+                    seek(&pos, startKey);
                     posFinished = !getFirst(&elpos, &pos);
                 }
 
                 if (ncoordinates == 4) {
                     pso.open(coordinates[3], ios_base::binary);
+                    seek(&pso, startKey);
                     getFirst(&elpso, &pso);
                 } else if (ncoordinates == 6 || ncoordinates == 2) {
                     sop.open(coordinates[3], ios_base::binary);
+                    seek(&sop, startKey);
                     osp.open(coordinates[4], ios_base::binary);
+                    seek(&osp, startKey);
                     pso.open(coordinates[5], ios_base::binary);
+                    seek(&pso, startKey);
                     sopFinished = !getFirst(&elsop, &sop);
                     ospFinished = !getFirst(&elosp, &osp);
                     psoFinished = !getFirst(&elpso, &pso);
@@ -201,6 +220,8 @@ class BufferCoordinates {
 };
 
 class SimpleTripleWriter;
+class TreeBuilder;
+class FCDictBuilder;
 struct ParamSortAndInsert {
     ParamSortAndInsert() {}
     int permutation;
@@ -222,6 +243,7 @@ struct ParamSortAndInsert {
     bool removeInput;
     int64_t estimatedSize;
     bool deletePreviousExt;
+    bool keepInput; //The sorted input is kept to resume the load
 };
 
 class L_Triple {
@@ -405,6 +427,18 @@ struct ParamsLoad {
     bool storeDicts;
     bool relsOwnIDs;
     bool flatTree;
+    bool packedTables;
+    bool comprTables;
+    bool coordTable;
+    bool bulkTree;
+    bool fcDict;
+    bool dictHashIndex;
+    bool textIndex;
+    bool inlineLiterals;
+    bool derivePerms;
+    int64_t maxMemory; //MB, 0 means no limit
+    bool resume;
+    int binIDSize; //Bytes per ID of the input with the format 'bin'
 
     ParamsLoad() {
         /**** DEFAULT VALUES ****/
@@ -437,6 +471,18 @@ struct ParamsLoad {
         storeDicts = true;
         relsOwnIDs = false;
         flatTree = false;
+        packedTables = false;
+        comprTables = false;
+        coordTable = true;
+        bulkTree = true;
+        fcDict = false;
+        dictHashIndex = false;
+        textIndex = false;
+        inlineLiterals = false;
+        derivePerms = false;
+        maxMemory = 0;
+        resume = false;
+        binIDSize = 8;
     }
 
     std::string tostring() {
@@ -470,13 +516,54 @@ struct ParamsLoad {
         output += ";storeDicts=" + to_string(storeDicts);
         output += ";relsOwnIDs=" + to_string(relsOwnIDs);
         output += ";flatTree=" + to_string(flatTree);
+        output += ";packedTables=" + to_string(packedTables);
+        output += ";comprTables=" + to_string(comprTables);
+        output += ";coordTable=" + to_string(coordTable);
+        output += ";bulkTree=" + to_string(bulkTree);
+        output += ";fcDict=" + to_string(fcDict);
+        output += ";dictHashIndex=" + to_string(dictHashIndex);
+        output += ";textIndex=" + to_string(textIndex);
+        output += ";inlineLiterals=" + to_string(inlineLiterals);
+        output += ";derivePerms=" + to_string(derivePerms);
+        output += ";maxMemory=" + to_string(maxMemory);
+        output += ";resume=" + to_string(resume);
+        output += ";binIDSize=" + to_string(binIDSize);
         return output;
     }
 };
 
+/*
+ * Stages of a load that are completed (see --resume). Every stage is
+ * appended to a file in the temporary directory, one per line with an
+ * optional value, so that a load that fails can skip it when it is started
+ * again with the files that the stage left.
+ */
+class LoadManifest {
+    private:
+        const string file;
+        std::map<string, string> stages;
+
+    public:
+        LoadManifest(string file);
+
+        bool isDone(string stage) {
+            return stages.count(stage) > 0;
+        }
+
+        string getValue(string stage);
+
+        void setDone(string stage, string value = "");
+
+        void clear();
+};
+
 class Loader {
     private:
         bool printStats;
+        //Not NULL if the load can be resumed
+        std::unique_ptr<LoadManifest> manifest;
+
+        bool prepareResume(ParamsLoad &p);
 
     public:
         static void generateNewPermutation(string outputdir,
@@ -519,7 +606,12 @@ class Loader {
         static void insertDictionary(const int part, DictMgmt *dict,
                 string dictFileInput,
                 bool insertDictionary, bool insertInverseDictionary,
-                bool sortNumberCoordinates, nTerm *maxValueCounter);
+                bool sortNumberCoordinates, nTerm *maxValueCounter,
+                bool removeInput);
+
+        static void insertFCDictionary(string dictFileInput,
+                FCDictBuilder *builder, bool skipInlined,
+                nTerm *maxValueCounter, bool removeInput);
 
         static void parallelmerge(FileMerger<Triple> *merger,
                 int buffersize,
@@ -591,7 +683,8 @@ class Loader {
                 string remotePath,
                 int64_t limitSpace,
                 int64_t estimatedSize,
-                int nindices);
+                int nindices,
+                bool derivePerms);
 
         void createIndices(
                 int parallelProcesses,
@@ -611,7 +704,8 @@ class Loader {
                 string remoteLocation,
                 int64_t limitSpace,
                 int64_t estimatedSize,
-                int nindices);
+                int nindices,
+                bool derivePerms);
 
         void loadKB_createSamples(string kbDir,
                 string sampleDir,
@@ -627,7 +721,18 @@ class Loader {
         void loadKB_storeDicts(KB &kb,
                 int dictionaries,
                 string dictMethod,
-                string *fileNameDictionaries);
+                string *fileNameDictionaries,
+                bool hashIndex,
+                bool textIndex);
+
+        //Returns false if the dictionary is too large for the inlined IDs
+        bool loadKB_inlineLiterals(string dictFileInput,
+                string tripleDir);
+
+        void loadKB_storeFCDict(KB &kb,
+                int dictionaries,
+                string *fileNameDictionaries,
+                bool textIndex);
 
         void loadKB_handleGraphTransformations(KB &kb,
                 string graphTransformation,
@@ -638,13 +743,28 @@ class Loader {
                 string kbDir,
                 bool storeDicts);
 
+        static void loadKB_bulkLoadTreePartition(string *coordinates,
+                int ncoordinates,
+                nTerm startKey,
+                nTerm endKey,
+                TreeBuilder *builder,
+                int partition);
+
+        void loadKB_bulkLoadTree(KB &kb,
+                string *coordinates,
+                int ncoordinates,
+                int nindices,
+                int nthreads);
+
         void loadKB_createTree(KB &kb,
                 string *sTreeWriters,
                 TreeWriter **treeWriters,
                 bool storeDicts,
                 string graphTransformation,
                 Inserter *ins,
-                int nindices);
+                int nindices,
+                bool bulkTree,
+                int nthreads);
 
         void loadKB(KB &kb,
                 ParamsLoad &p,
@@ -682,6 +802,17 @@ class Loader {
                 int maxReadingThreads,
                 int parallelProcesses);
 
+        //Read the triples from files of packed little-endian IDs
+        static int64_t createPermsFromBinFiles(
+                string inputtriples,
+                int idSize,
+                bool separateDictEntRels,
+                string inputdict,
+                string inputdictr,
+                string *permDirs,
+                string fileNameDictionaries,
+                int nthreads);
+
         static int64_t parseSnapFile(
                 string inputtriples,
                 string inputdict,
@@ -62,6 +62,21 @@ class NestedMergeJoinItr : public TupleIterator {
 
         static bool checkNext(PairItr *itr, bool shouldMoveToNext);
 
+        //Second iterator on the first pattern that reads ahead of
+        //iterators[0]. It prefetches the tables of the second pattern if
+        //their keys come from the first one.
+        PairItr *prefetchItr;
+        int prefetchPos;
+        int64_t prefetchTrigger1, prefetchTrigger2;
+        int64_t prefetchEnd1, prefetchEnd2;
+        uint64_t prefetchV1[PREFETCH_JOIN_BATCH];
+        uint64_t prefetchV2[PREFETCH_JOIN_BATCH];
+        std::vector<int64_t> prefetchKeys;
+
+        void initPrefetch();
+
+        void prefetchNextKeys();
+
         //Fields used during the execution of the query
         PairItr *currentItr;
 
@@ -113,6 +128,9 @@ class NestedMergeJoinItr : public TupleIterator {
         DDLEXPORT uint64_t getElementAt(const int pos);
 
         virtual ~NestedMergeJoinItr() {
+            if (prefetchItr != NULL) {
+                q->releaseItr(prefetchItr);
+            }
             if (deleteOutputResults) {
                 delete outputResults;
             }
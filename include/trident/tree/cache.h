@@ -31,6 +31,7 @@
 #include <list>
 #include <string>
 #include <deque>
+#include <utility>
 
 class Node;
 class TreeContext;
@@ -45,6 +46,10 @@ private:
     std::deque<Node*> registeredNodes;
     const int maxNodesInCache;
 
+    //Leaves evicted in read-only mode that other threads might still read.
+    //They are released once their epoch is reclaimable (see Epochs)
+    std::deque<std::pair<uint64_t, Node*>> retiredNodes;
+
     NodeManager *manager;
 
     char supportBuffer[SIZE_SUPPORT_BUFFER];
@@ -63,8 +68,13 @@ public:
     }
 
     void init(TreeContext *context, std::string path, int fileMaxSize,
-              int maxNFiles, int64_t cacheMaxSize, int sizeLeavesFactory,
-              int sizePreallLeavesFactory, int nodeMinBytes);
+              int maxNFiles, int64_t cacheMaxSize, MemoryPolicy cachePolicy,
+              int sizeLeavesFactory, int sizePreallLeavesFactory,
+              int nodeMinBytes);
+
+    MemoryManagerStats getStats() {
+        return manager->getCacheStats();
+    }
 
     Node *getNodeFromCache(int64_t id);
 
@@ -84,6 +94,10 @@ public:
 
     void flushNode(Node *node, const bool registerNode);
 
+    void retireNode(Node *node);
+
+    void reclaimNodes(const bool all);
+
     void flushAllCache();
 
     ~Cache() {
@@ -95,6 +109,7 @@ public:
                 delete node;
         }
         registeredNodes.clear();
+        reclaimNodes(true);
 
         delete factory;
         delete manager;
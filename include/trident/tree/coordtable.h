@@ -0,0 +1,67 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _COORDTABLE_H
+#define _COORDTABLE_H
+
+#include <trident/tree/coordinates.h>
+#include <trident/utils/memoryfile.h>
+#include <trident/kb/consts.h>
+
+#include <memory>
+#include <string>
+
+class Root;
+
+/*
+ * Coordinates of all the keys of the KB, indexed by the key. It is used
+ * instead of the tree to lookup the coordinates when the IDs are dense.
+ *
+ * Layout:
+ * 8 bytes <n. keys (largest key + 1)>
+ * 1 byte <bytes per count> 1 byte <bytes per file> 1 byte <bytes per mark>
+ * for every key: N_PARTITIONS entries <count, strategy (1 byte), file, mark>.
+ * A count of 0 means that the key does not appear in the permutation.
+ */
+class CoordinatesTable {
+    private:
+        std::unique_ptr<MemoryMappedFile> file;
+        const char *records;
+        uint64_t nKeys;
+        uint8_t bytesPerCount, bytesPerFile, bytesPerMark;
+        int sizeEntry, sizeRecord;
+
+    public:
+        CoordinatesTable(std::string path);
+
+        bool get(nTerm key, TermCoordinates *value) const;
+
+        uint64_t getNKeys() const {
+            return nKeys;
+        }
+
+        //Writes the table with the coordinates in the tree. Returns false
+        //(and does not write anything) if the keys are too sparse.
+        static bool create(Root *tree, std::string path);
+};
+
+#endif
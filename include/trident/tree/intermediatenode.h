@@ -26,15 +26,19 @@
 #include <trident/tree/node.h>
 #include <trident/kb/consts.h>
 
+#include <atomic>
+
 class IntermediateNode: public Node {
 private:
-    Node **children;
+    //Atomic because in read-only mode they are loaded and evicted while
+    //other threads read them
+    std::atomic<Node*> *children;
     int64_t *idChildren;
     int lastUpdatedChild;
 
     Node *updateChildren(Node *split, int p,
                          void (*insertAverage)(Node*, int p, Node*, Node*));
-    void ensureChildIsLoaded(int p);
+    Node *ensureChildIsLoaded(int p);
 
 public:
 
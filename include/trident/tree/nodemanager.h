@@ -88,7 +88,12 @@ private:
 
 public:
     NodeManager(TreeContext *context, int nodeMinBytes, int fileMaxSize,
-                int maxNFiles, int64_t cacheMaxSize, std::string path);
+                int maxNFiles, int64_t cacheMaxSize, MemoryPolicy cachePolicy,
+                std::string path);
+
+    MemoryManagerStats getCacheStats() {
+        return bytesTracker->getStats();
+    }
 
     char* get(CachedNode *node);
 
@@ -27,6 +27,7 @@
 #include <trident/tree/leaffactory.h>
 #include <trident/kb/consts.h>
 #include <trident/utils/propertymap.h>
+#include <trident/utils/memorymgr.h>
 
 #include <string>
 
@@ -40,6 +41,7 @@ typedef enum params {
     FILE_MAX_SIZE,
     MAX_N_OPENED_FILES,
     CACHE_MAX_SIZE,
+    CACHE_POLICY,
     NODE_MIN_BYTES,
     MAX_NODES_IN_CACHE,
     TEXT_KEYS,
@@ -55,9 +57,12 @@ typedef enum params {
     NODE_KEYS_PREALL_FACTORY_SIZE
 } TreeParams;
 
+class CoordinatesTable;
+
 class Root {
     private:
         Cache *cache;
+        CoordinatesTable *coordTable;
         StringBuffer *stringbuffer;
         Node *rootNode;
         TreeContext *context;
@@ -73,6 +78,7 @@ class Root {
     protected:
         Root() : readOnly(true), path("") {
             cache = NULL;
+            coordTable = NULL;
             stringbuffer = NULL;
             rootNode = NULL;
             context = NULL;
@@ -107,8 +113,21 @@ class Root {
 
         virtual bool get(nTerm key, TermCoordinates *value);
 
+        //Look up n keys at once. The leaf found for a key is reused for the
+        //following keys in its range, so sorted keys descend the tree only
+        //when they move to another leaf
+        void getMany(const nTerm *keys, const size_t n,
+                TermCoordinates *values, bool *found);
+
+        //The coordinates are read from the table instead of the tree. The
+        //table is deleted with the tree.
+        void setCoordinatesTable(CoordinatesTable *table);
+
         bool get(nTerm key, int64_t &coordinates);
 
+        //Statistics of the cache of the files of the nodes
+        MemoryManagerStats getCacheStats();
+
 };
 
 #endif /* ROOT_H_ */
@@ -25,6 +25,8 @@
 
 #include <trident/kb/consts.h>
 #include <trident/kb/statistics.h>
+#include <trident/files/blockcache.h>
+#include <trident/utils/memoryfile.h>
 
 #include <kognac/factory.h>
 #include <kognac/hashfunctions.h>
@@ -37,6 +39,10 @@
 #include <string>
 #include <vector>
 #include <condition_variable>
+#include <memory>
+
+//Number of shards of the cache of the blocks in read-only mode
+#define SB_CACHE_SHARDS 16
 
 struct eqint {
     bool operator()(int i1, int i2) const {
@@ -58,7 +64,6 @@ private:
     std::string dir;
 
     char uncompressSupportBuffer[SB_BLOCK_SIZE * 2];
-    char termSupportBuffer[MAX_TERM_SIZE];
 
     PreallocatedStratArraysFactory<char> factory;
     const bool readOnly;
@@ -94,13 +99,30 @@ private:
     int entriesSinceBaseEntry;
     int nMatchedChars;
 
-    //Cache
+    //Cache (writing mode)
     std::vector<std::pair<int, int>> cacheVector;
     int firstBlockInCache, lastBlockInCache;
 
     int elementsInCache;
     const int maxElementsInCache;
 
+    //In read-only mode the compressed blocks are mapped in memory and never
+    //change, and the uncompressed blocks are stored in a sharded cache. This
+    //makes the read methods thread-safe.
+    std::unique_ptr<MemoryMappedFile> compressedFile;
+    const char *compressedData;
+    std::vector<std::unique_ptr<BlockCache>> cacheShards;
+    std::mutex statsLock;
+
+    //Position while reading a term. In read-only mode it pins the block, so
+    //that it is not freed if it is evicted from the cache in the meantime
+    struct Cursor {
+        int blockId;
+        const char *block;
+        int offset;
+        BlockCache::Block pin;
+    };
+
     void addCache(int idx);
     void compressBlocks();
     void compressLastBlock();
@@ -108,18 +130,33 @@ private:
 
     char *getBlock(int idxBlock);
 
-    int getFlag(int &blockId, char *&block, int &offset) {
-        if (offset < SB_BLOCK_SIZE) {
-            return block[offset++];
+    BlockCache::Block getCachedBlock(int idxBlock);
+
+    int getNBlocks() const {
+        return readOnly ? sizeCompressedBlocks.size() : blocks.size();
+    }
+
+    void moveToBlock(Cursor &c, int idxBlock) {
+        c.blockId = idxBlock;
+        if (readOnly) {
+            c.pin = getCachedBlock(idxBlock);
+            c.block = c.pin->data();
         } else {
-            blockId++;
-            block = getBlock(blockId);
-            offset = 1;
-            return block[0];
+            c.block = getBlock(idxBlock);
         }
     }
 
-    int getVInt(int &blockId, char *&block, int &offset);
+    int getFlag(Cursor &c) {
+        if (c.offset < SB_BLOCK_SIZE) {
+            return c.block[c.offset++];
+        } else {
+            moveToBlock(c, c.blockId + 1);
+            c.offset = 1;
+            return c.block[0];
+        }
+    }
+
+    int getVInt(Cursor &c);
 
     void writeVInt(int n);
 
@@ -133,10 +170,16 @@ public:
 
     int64_t getSize();
 
+    bool isReadOnly() const {
+        return readOnly;
+    }
+
     void append(char *string, int size);
 
     void get(int64_t pos, char* outputBuffer, int &size);
 
+    //The returned buffer belongs to the calling thread, and it is
+    //overwritten by its next call
     char* get(int64_t pos, int &size);
 
     int cmp(int64_t pos, char *string, int sizeString);
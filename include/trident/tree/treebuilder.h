@@ -0,0 +1,111 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _TREEBUILDER_H
+#define _TREEBUILDER_H
+
+#include <trident/tree/coordinates.h>
+#include <trident/kb/consts.h>
+
+#include <kognac/consts.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Builds a tree bottom-up from the coordinates of keys that are given in
+ * ascending order. The keys are split in partitions of consecutive ranges
+ * (partition i contains only keys smaller than the ones of partition i+1),
+ * and every partition can be filled by a different thread. The leaves of
+ * each partition are written sequentially in their own files, which are
+ * renamed to the files of the tree when the build is finished. The
+ * intermediate nodes, the index of the nodes and the metadata are written
+ * in the same format used by Root and NodeManager, so the tree can be
+ * opened with Root.
+ */
+class TreeBuilder {
+    private:
+        typedef struct BuiltNode {
+            nTerm smallestKey;
+            nTerm largestKey;
+            int64_t id;
+            int posIndex;
+            int nodeSize;
+            int availableSize;
+            short fileIndex;
+            bool children;
+        } BuiltNode;
+
+        typedef struct Partition {
+            std::ofstream out;
+            int nFiles;
+            int64_t sizeFile;
+            std::vector<BuiltNode> nodes;
+
+            //The leaf being filled
+            std::vector<nTerm> keys;
+            std::vector<char> combinations;
+            std::vector<int> offsets;
+            std::vector<char> values;
+            std::vector<char> buffer;
+        } Partition;
+
+        const std::string path;
+        const int maxElementsPerNode;
+        const int fileMaxSize;
+        const int nodeMinBytes;
+        const int sizeBuffer;
+
+        //The last partition stores the intermediate nodes
+        std::vector<std::unique_ptr<Partition>> partitions;
+        bool finished;
+
+        std::string getPartitionFile(int partition, int idx) const;
+
+        int serializeKeys(const std::vector<nTerm> &keys, char *buffer) const;
+
+        void writeNode(int partition, const char *buffer, int size,
+                BuiltNode *node);
+
+        void flushLeaf(int partition);
+
+    public:
+        TreeBuilder(std::string path, int maxElementsPerNode, int fileMaxSize,
+                int nodeMinBytes, int nPartitions);
+
+        int getNPartitions() const {
+            return partitions.size() - 1;
+        }
+
+        //Not thread-safe within the same partition
+        void append(int partition, nTerm key, TermCoordinates *value);
+
+        //Writes the intermediate nodes and the index of the nodes. Must be
+        //called after all the partitions are filled.
+        void finish();
+
+        ~TreeBuilder();
+};
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _EPOCHS_H
+#define _EPOCHS_H
+
+#include <trident/kb/consts.h>
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdint>
+
+#define EPOCHS_MAX_THREADS 1024
+
+/*
+ * Epoch-based reclamation for the structures that are read without locks.
+ * A reader enters an epoch before it follows pointers to shared objects and
+ * exits it afterwards. A writer first unlinks an object, then retires it
+ * with the epoch returned by retire(), and frees it only once
+ * getOldestActive() is larger than that epoch: at that point no reader can
+ * still hold a pointer to it. Entering and exiting are reentrant.
+ */
+class Epochs {
+    private:
+        struct Slot {
+            //0 if the thread is not reading
+            std::atomic<uint64_t> epoch;
+            std::atomic<bool> used;
+            char padding[64 - sizeof(std::atomic<uint64_t>) -
+                sizeof(std::atomic<bool>)];
+        };
+
+        static std::atomic<uint64_t> globalEpoch;
+        static std::atomic<int> nSlots;
+        static Slot slots[EPOCHS_MAX_THREADS];
+
+        static int acquireSlot();
+
+    public:
+        static void enter();
+
+        static void exit();
+
+        //Called after an object is unlinked. Returns the epoch to store
+        //with it
+        static uint64_t retire();
+
+        //Objects retired with an epoch smaller than this value can be freed
+        static uint64_t getOldestActive();
+
+        static void releaseSlot(int slot);
+};
+
+class EpochGuard {
+    public:
+        EpochGuard() {
+            Epochs::enter();
+        }
+
+        ~EpochGuard() {
+            Epochs::exit();
+        }
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _MEMORY_BUDGET_H
+#define _MEMORY_BUDGET_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+/*
+ * Main memory that the stages of the loader can use (--maxMemory). A stage
+ * reserves its large buffers before allocating them: it asks for the amount
+ * it would like and the minimum it can work with, and then sizes its chunks
+ * on what it gets, spilling more often to disk if it gets less. Without a
+ * limit every stage gets what it asks for. The peak of every stage is
+ * reported at the end of the loading.
+ */
+class MemoryBudget {
+    private:
+        std::mutex mutex;
+        uint64_t limit;
+        uint64_t used;
+        uint64_t peak;
+        std::map<std::string, uint64_t> usedByStage;
+        std::map<std::string, uint64_t> peakByStage;
+
+    public:
+        MemoryBudget();
+
+        //0 means no limit
+        void setLimit(uint64_t limit);
+
+        uint64_t getLimit() {
+            return limit;
+        }
+
+        //Returns the number of bytes reserved, between minimum and wanted.
+        //If not even minimum is available, minimum is reserved anyway
+        uint64_t reserve(std::string stage, uint64_t wanted, uint64_t minimum);
+
+        void release(std::string stage, uint64_t size);
+
+        void report();
+
+        //The budget shared by all the stages of the loader
+        static MemoryBudget &getInstance();
+};
+
+/*
+ * Memory reserved from a budget until the object goes out of scope, also
+ * when an exception is thrown.
+ */
+class MemoryReservation {
+    private:
+        MemoryBudget &budget;
+        const std::string stage;
+        const uint64_t size;
+
+    public:
+        MemoryReservation(MemoryBudget &budget, std::string stage,
+                uint64_t wanted, uint64_t minimum) : budget(budget),
+        stage(stage), size(budget.reserve(stage, wanted, minimum)) {
+        }
+
+        uint64_t getSize() const {
+            return size;
+        }
+
+        ~MemoryReservation() {
+            budget.release(stage, size);
+        }
+};
+
+#endif
@@ -19,6 +19,14 @@
 #include <sys/stat.h>
 #endif
 
+//Hints about how a mapped region will be read
+typedef enum {
+    ACCESS_NORMAL,
+    ACCESS_SEQUENTIAL,
+    ACCESS_RANDOM,
+    ACCESS_WILLNEED
+} AccessPattern;
+
 class MemoryMappedFile {
     private: 
 #if defined(_WIN32)
@@ -134,6 +142,42 @@ class MemoryMappedFile {
 #endif
         }
 
+        //Tell the kernel how the range will be accessed. The range is
+        //extended to the pages that contain it
+        static void advise(const char *start, size_t len, AccessPattern pattern) {
+#if defined(_WIN32)
+            //Not supported
+#elif defined(__unix__) || defined(__unix) || defined(unix) || (defined(__APPLE__) && defined(__MACH__))
+            if (len == 0) {
+                return;
+            }
+            const uintptr_t page = alignment();
+            const uintptr_t begin = (uintptr_t) start & ~(page - 1);
+            const uintptr_t end = (uintptr_t) start + len;
+            int advice = MADV_NORMAL;
+            switch (pattern) {
+                case ACCESS_SEQUENTIAL:
+                    advice = MADV_SEQUENTIAL;
+                    break;
+                case ACCESS_RANDOM:
+                    advice = MADV_RANDOM;
+                    break;
+                case ACCESS_WILLNEED:
+                    advice = MADV_WILLNEED;
+                    break;
+                default:
+                    break;
+            }
+            if (madvise((void*) begin, end - begin, advice) != 0) {
+                LOG(DEBUGL) << "madvise returned an error";
+            }
+#endif
+        }
+
+        void advise(AccessPattern pattern) {
+            advise(data, length, pattern);
+        }
+
         void flush(off_t begin, size_t len) {
 #if defined(_WIN32)
 			if (!FlushViewOfFile(data + begin, len)) {
@@ -25,68 +25,262 @@
 
 #include <trident/kb/consts.h>
 
+#include <kognac/logs.h>
+
+#include <atomic>
 #include <iostream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <cstring>
 #include <assert.h>
 
 using namespace std;
 
+/*
+ * MEMPOLICY_FIFO: the blocks are removed in the order they were added.
+ *
+ * MEMPOLICY_2Q: new blocks enter a FIFO queue (A1in) that takes at most
+ * MEMORYMGR_KIN_PERCENT of the cache. The blocks removed from it are
+ * remembered (A1out) and if they are added again, they go to the main
+ * queue (Am), which is managed with CLOCK. A block is admitted to Am only if
+ * it is reused after it left A1in, so a large scan only replaces the blocks
+ * in A1in.
+ */
+typedef enum { MEMPOLICY_FIFO, MEMPOLICY_2Q } MemoryPolicy;
+
+inline MemoryPolicy getMemoryPolicy(const std::string &name) {
+    if (name == "2q") {
+        return MEMPOLICY_2Q;
+    } else if (name == "fifo") {
+        return MEMPOLICY_FIFO;
+    }
+    LOG(ERRORL) << "Memory policy " << name << " unknown (2q, fifo)";
+    throw 10;
+}
+
+struct MemoryManagerStats {
+    uint64_t hits; //Accesses to blocks that were already loaded
+    uint64_t misses; //Blocks that were added
+    uint64_t evictions;
+    uint64_t bytes;
+    uint64_t maxBytes;
+
+    MemoryManagerStats() : hits(0), misses(0), evictions(0), bytes(0),
+    maxBytes(0) {
+    }
+
+    void add(const MemoryManagerStats &s) {
+        hits += s.hits;
+        misses += s.misses;
+        evictions += s.evictions;
+        bytes += s.bytes;
+        maxBytes += s.maxBytes;
+    }
+};
+
+#define MEMQUEUE_IN 0
+#define MEMQUEUE_MAIN 1
+
 template<class K>
 struct MemoryBlock {
     K *block;
-    K** parentBlock;
+    std::atomic<K*> *parentBlock;
     size_t bytes;
     int idx;
     int lock;
+
+    //Position in the queues of the policy
+    int queue;
+    int prev;
+    int next;
+    std::atomic<bool> referenced;
 };
 
 template<class K>
 class MemoryManager {
 private:
+    struct Queue {
+        int head;
+        int tail;
+        int count;
+        size_t bytes;
+    };
+
+    typedef std::pair<std::atomic<K*>*, int> GhostKey;
+
+    struct GhostKeyHasher {
+        std::size_t operator()(const GhostKey &k) const {
+            return std::hash<void*>()(k.first) ^ (std::size_t) k.second;
+        }
+    };
+
     const size_t cacheMaxSize;
+    const MemoryPolicy policy;
+    const size_t maxBytesIn;
     size_t bytes;
 
     MemoryBlock<K> **blocks;
-    int start;
     int end;
     int blocksLeft;
 
-    void removeOneBlock() {
-        if (blocksLeft < MAX_N_BLOCKS_IN_CACHE) {
-            if (start == MAX_N_BLOCKS_IN_CACHE) {
-                start = 0;
-            }
+    Queue queues[2];
 
-            //Check the block is not NULL
-            while (blocks[start] == NULL || blocks[start]->lock > 0) {
-                start++;
-                if (start == MAX_N_BLOCKS_IN_CACHE) {
-                    start = 0;
-                }
+    //A1out: blocks recently removed from A1in
+    std::list<GhostKey> ghosts;
+    std::unordered_map<GhostKey, typename std::list<GhostKey>::iterator,
+        GhostKeyHasher> ghostsIdx;
+
+    std::atomic<uint64_t> nAccesses, nMisses, nEvictions;
+
+#ifdef MT
+    //Recursive because removeBlock deletes the element, whose deconstructor
+    //calls removeBlockWithoutDeallocation
+    std::recursive_mutex mutex;
+#endif
+
+    void link(int idx, int queue) {
+        MemoryBlock<K> *b = blocks[idx];
+        Queue &q = queues[queue];
+        b->queue = queue;
+        b->prev = q.tail;
+        b->next = -1;
+        b->referenced = false;
+        if (q.tail != -1) {
+            blocks[q.tail]->next = idx;
+        } else {
+            q.head = idx;
+        }
+        q.tail = idx;
+        q.count++;
+        q.bytes += b->bytes;
+    }
+
+    void unlink(int idx) {
+        MemoryBlock<K> *b = blocks[idx];
+        Queue &q = queues[b->queue];
+        if (b->prev != -1) {
+            blocks[b->prev]->next = b->next;
+        } else {
+            q.head = b->next;
+        }
+        if (b->next != -1) {
+            blocks[b->next]->prev = b->prev;
+        } else {
+            q.tail = b->prev;
+        }
+        q.count--;
+        q.bytes -= b->bytes;
+    }
+
+    void remember(MemoryBlock<K> *b) {
+        GhostKey key(b->parentBlock, b->idx);
+        if (ghostsIdx.count(key)) {
+            return;
+        }
+        ghosts.push_back(key);
+        ghostsIdx[key] = std::prev(ghosts.end());
+        if (ghosts.size() > MEMORYMGR_MAX_GHOSTS) {
+            ghostsIdx.erase(ghosts.front());
+            ghosts.pop_front();
+        }
+    }
+
+    bool forget(std::atomic<K*> *parent, int idxInParent) {
+        auto itr = ghostsIdx.find(GhostKey(parent, idxInParent));
+        if (itr == ghostsIdx.end()) {
+            return false;
+        }
+        ghosts.erase(itr->second);
+        ghostsIdx.erase(itr);
+        return true;
+    }
+
+    //Oldest block of A1in that is not locked
+    int victimIn() {
+        int idx = queues[MEMQUEUE_IN].head;
+        while (idx != -1 && blocks[idx]->lock > 0) {
+            idx = blocks[idx]->next;
+        }
+        return idx;
+    }
+
+    //CLOCK on Am: the referenced and the locked blocks are moved to the tail
+    int victimMain() {
+        const int n = queues[MEMQUEUE_MAIN].count;
+        for (int i = 0; i < 2 * n; ++i) {
+            const int idx = queues[MEMQUEUE_MAIN].head;
+            MemoryBlock<K> *b = blocks[idx];
+            if (b->lock == 0 && !b->referenced) {
+                return idx;
             }
-            removeBlock(start++);
+            unlink(idx);
+            link(idx, MEMQUEUE_MAIN);
         }
+        return -1;
+    }
+
+    //Returns false if all the blocks are locked
+    bool removeOneBlock() {
+        int idx = -1;
+        if (policy == MEMPOLICY_2Q &&
+                queues[MEMQUEUE_IN].bytes <= maxBytesIn) {
+            idx = victimMain();
+        }
+        if (idx == -1) {
+            idx = victimIn();
+        }
+        if (idx == -1 && policy == MEMPOLICY_2Q) {
+            idx = victimMain();
+        }
+        if (idx == -1) {
+            return false;
+        }
+        if (policy == MEMPOLICY_2Q && blocks[idx]->queue == MEMQUEUE_IN) {
+            remember(blocks[idx]);
+        }
+        nEvictions++;
+        removeBlock(idx);
+        return true;
     }
 
 public:
-    MemoryManager(size_t cacheMaxSize) :
-        cacheMaxSize(cacheMaxSize) {
-            assert(cacheMaxSize > 0);
+    MemoryManager(size_t cacheMaxSize, MemoryPolicy policy = MEMPOLICY_2Q) :
+        cacheMaxSize(cacheMaxSize), policy(policy),
+        maxBytesIn(cacheMaxSize / 100 * MEMORYMGR_KIN_PERCENT),
+        nAccesses(0), nMisses(0), nEvictions(0) {
+        assert(cacheMaxSize > 0);
         bytes = 0;
         blocks = new MemoryBlock<K>*[MAX_N_BLOCKS_IN_CACHE];
         memset(blocks, 0, sizeof(MemoryBlock<K>*) * MAX_N_BLOCKS_IN_CACHE);
-        start = end = 0;
+        end = 0;
         blocksLeft = MAX_N_BLOCKS_IN_CACHE;
+        for (int i = 0; i < 2; ++i) {
+            queues[i].head = queues[i].tail = -1;
+            queues[i].count = 0;
+            queues[i].bytes = 0;
+        }
     }
 
     void update(int idx, size_t bytes) {
+#ifdef MT
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+#endif
         this->bytes -= blocks[idx]->bytes;
         this->bytes += bytes;
+        queues[blocks[idx]->queue].bytes -= blocks[idx]->bytes;
+        queues[blocks[idx]->queue].bytes += bytes;
         blocks[idx]->bytes = bytes;
     }
 
     void removeBlock(int idx) {
+#ifdef MT
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+#endif
         //Delete block. This will trigger the deconstructor of K which should remove the block and update all the datastructures
         bytes -= blocks[idx]->bytes;
+        unlink(idx);
         K *elToRemove = blocks[idx]->block;
         blocks[idx]->parentBlock[blocks[idx]->idx] = NULL;
         delete blocks[idx];
@@ -96,8 +290,12 @@ public:
     }
 
     void removeBlockWithoutDeallocation(int idx) {
+#ifdef MT
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+#endif
         if (blocks[idx] != NULL) {
             bytes -= blocks[idx]->bytes;
+            unlink(idx);
             delete blocks[idx];
             blocks[idx] = NULL;
             blocksLeft++;
@@ -116,18 +314,32 @@ public:
         blocks[idx]->lock--;
     }
 
-    int add(size_t bytes, K *element, int idxInParentArray, K **parentArray) {
-        if (this->bytes + bytes > cacheMaxSize) {
-            while (this->bytes >= cacheMaxSize || blocksLeft == 0) {
-                removeOneBlock();
+    //Called every time the element is read. The caller must hold the
+    //element, so the block cannot be removed in the meantime.
+    void access(int idx) {
+        nAccesses.fetch_add(1, std::memory_order_relaxed);
+        blocks[idx]->referenced.store(true, std::memory_order_relaxed);
+    }
+
+    int add(size_t bytes, K *element, int idxInParentArray,
+            std::atomic<K*> *parentArray) {
+#ifdef MT
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+#endif
+        nMisses++;
+        while ((this->bytes > 0 && this->bytes + bytes > cacheMaxSize) ||
+                blocksLeft == 0) {
+            if (!removeOneBlock()) {
+                if (blocksLeft == 0) {
+                    LOG(ERRORL) << "All the blocks in the cache are locked";
+                    throw 10;
+                }
+                break;
             }
         }
         this->bytes += bytes;
 
-        if (end == MAX_N_BLOCKS_IN_CACHE) {
-        end = 0;
-    }
-    while (blocks[end] != NULL) {
+        while (blocks[end] != NULL) {
             end = (end + 1) % MAX_N_BLOCKS_IN_CACHE;
         }
 
@@ -139,12 +351,39 @@ public:
         memoryBlock->lock = 0;
         blocks[end] = memoryBlock;
         blocksLeft--;
-        return end++;
+
+        //A block seen recently in A1in goes directly to the main queue
+        if (policy == MEMPOLICY_2Q && forget(parentArray, idxInParentArray)) {
+            link(end, MEMQUEUE_MAIN);
+        } else {
+            link(end, MEMQUEUE_IN);
+        }
+        const int idx = end;
+        end = (end + 1) % MAX_N_BLOCKS_IN_CACHE;
+        return idx;
+    }
+
+    MemoryManagerStats getStats() {
+#ifdef MT
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+#endif
+        MemoryManagerStats stats;
+        stats.misses = nMisses;
+        //The first access after a block is added is not a hit
+        const uint64_t accesses = nAccesses;
+        stats.hits = accesses > stats.misses ? accesses - stats.misses : 0;
+        stats.evictions = nEvictions;
+        stats.bytes = bytes;
+        stats.maxBytes = cacheMaxSize;
+        return stats;
     }
 
     ~MemoryManager() {
-        while (blocksLeft < MAX_N_BLOCKS_IN_CACHE) {
-            removeOneBlock();
+        for (int i = 0; i < MAX_N_BLOCKS_IN_CACHE && blocksLeft <
+                MAX_N_BLOCKS_IN_CACHE; ++i) {
+            if (blocks[i] != NULL) {
+                removeBlock(i);
+            }
         }
         delete[] blocks;
     }
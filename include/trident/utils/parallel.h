@@ -90,6 +90,15 @@ class ParallelTasks {
             ParallelTasks::nthreads = nthreads;
         }
 
+        //Number of threads used when the caller does not specify it
+        static int32_t getDefaultNThreads() {
+            if (ParallelTasks::nthreads != -1) {
+                return ParallelTasks::nthreads;
+            }
+            return std::max((unsigned int) 1,
+                    std::thread::hardware_concurrency() / 2);
+        }
+
         //Procedure inspired by https://stackoverflow.com/questions/24130307/performance-problems-in-parallel-mergesort-c
         template<typename It, typename Cmp>
             static void sort_int(It begin, It end, const Cmp &cmp, int32_t nthreads) {
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _PIPELINE_H
+#define _PIPELINE_H
+
+#include <kognac/logs.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+
+//Queue between two stages of a pipeline. push blocks while the queue is
+//full, so that a fast stage cannot run too far ahead of the next one
+template<typename T>
+class BoundedQueue {
+    private:
+        std::mutex mutex;
+        std::condition_variable notFull;
+        std::condition_variable notEmpty;
+        std::deque<T> elements;
+        const size_t capacity;
+        bool closed;
+
+    public:
+        BoundedQueue(const size_t capacity) : capacity(capacity),
+        closed(false) {
+        }
+
+        void push(T el) {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (elements.size() >= capacity) {
+                notFull.wait(lock);
+            }
+            elements.push_back(std::move(el));
+            lock.unlock();
+            notEmpty.notify_one();
+        }
+
+        //Returns false if the queue is closed and there are no more elements
+        bool pop(T &el) {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (elements.empty() && !closed) {
+                notEmpty.wait(lock);
+            }
+            if (elements.empty()) {
+                return false;
+            }
+            el = std::move(elements.front());
+            elements.pop_front();
+            lock.unlock();
+            notFull.notify_one();
+            return true;
+        }
+
+        //Called by the producer after the last element
+        void close() {
+            std::unique_lock<std::mutex> lock(mutex);
+            closed = true;
+            lock.unlock();
+            notEmpty.notify_all();
+        }
+};
+
+//Throughput of a stage of the loading. The time is measured from the
+//creation of the object, so the stages that run in parallel overlap
+class StageStats {
+    private:
+        const std::string name;
+        const std::string unit;
+        const std::chrono::system_clock::time_point start;
+        std::atomic<uint64_t> items;
+        std::atomic<uint64_t> bytes;
+
+    public:
+        StageStats(std::string name, std::string unit = "triples") :
+            name(name), unit(unit), start(std::chrono::system_clock::now()),
+            items(0), bytes(0) {
+        }
+
+        void add(const uint64_t nitems, const uint64_t nbytes = 0) {
+            items += nitems;
+            bytes += nbytes;
+        }
+
+        double getSeconds() const {
+            std::chrono::duration<double> sec =
+                std::chrono::system_clock::now() - start;
+            return sec.count();
+        }
+
+        void report() const {
+            const double sec = getSeconds();
+            LOG(INFOL) << "Stage " << name << ": " << items << " " << unit <<
+                " in " << sec << " sec. (" << (sec > 0 ? items / sec : 0) <<
+                " " << unit << "/sec" << (bytes > 0 ? ", " +
+                        std::to_string(sec > 0 ? bytes / sec / 1048576 : 0) +
+                        " MB/sec" : "") << ")";
+        }
+};
+
+#endif
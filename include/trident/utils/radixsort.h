@@ -0,0 +1,398 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#ifndef _RADIXSORT_H
+#define _RADIXSORT_H
+
+#include <inttypes.h>
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Key of the triples packed by PermSorter: three IDs of 5 bytes each (most
+//significant byte first), compared in the order of the offsets O1, O2, O3
+template<int O1, int O2, int O3>
+struct PackedTripleKey {
+    static const int nbytes = 15;
+
+    static unsigned char byte(const std::array<unsigned char, 15> &t,
+            const int i) {
+        return t[i < 5 ? O1 + i : (i < 10 ? O2 + i - 5 : O3 + i - 10)];
+    }
+};
+
+//Key of the triples with the fields first, second and third (e.g.,
+//L_Triple), compared in the order of the fields F1, F2, F3 (0=first,
+//1=second, 2=third)
+template<int F1, int F2, int F3>
+struct FieldsTripleKey {
+    static const int nbytes = 24;
+
+    template<typename T>
+        static uint64_t field(const T &t, const int f) {
+            return f == 0 ? t.first : (f == 1 ? t.second : t.third);
+        }
+
+    template<typename T>
+        static unsigned char byte(const T &t, const int i) {
+            const int f = i < 8 ? F1 : (i < 16 ? F2 : F3);
+            return (field(t, f) >> (56 - 8 * (i % 8))) & 0xFF;
+        }
+};
+
+/*
+ * In-place MSD radix sort (American flag sort) of records with a key of
+ * fixed width. The Key describes the bytes of the key, most significant
+ * first (see PackedTripleKey). The bytes that are equal in all the records
+ * are skipped, and the records whose key is made only of 0xFF bytes (the
+ * padding of the loader) are moved to the end before sorting. The large
+ * buckets are split by a pool of threads, while the small ones are sorted
+ * by a single thread with an LSD radix sort on a buffer that fits in the
+ * cache, or with an insertion sort. The sort is not stable.
+ */
+template<typename T, typename Key>
+class RadixSort {
+    private:
+        static const int64_t INSERTION_THRESHOLD = 32;
+        static const int64_t LSD_THRESHOLD = 4096;
+
+        struct Task {
+            T *begin;
+            T *end;
+            int depth;
+        };
+
+        //Positions of the bytes of the key that are not constant
+        std::vector<int> bytes;
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::deque<Task> tasks;
+        int64_t pending;
+        int64_t splitThreshold;
+
+        RadixSort() : pending(0), splitThreshold(0) {
+        }
+
+        static bool isMax(const T &r) {
+            for (int i = 0; i < Key::nbytes; ++i) {
+                if (Key::byte(r, i) != 0xFF) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //Finds the bytes of the key that change among the records
+        static void findVariableBytes(T *begin, T *end,
+                std::array<unsigned char, Key::nbytes> &first,
+                std::array<unsigned char, Key::nbytes> &diff, bool &found,
+                int64_t &nmax) {
+            diff.fill(0);
+            found = false;
+            nmax = 0;
+            for (T *r = begin; r < end; ++r) {
+                if (isMax(*r)) {
+                    nmax++;
+                    continue;
+                }
+                if (!found) {
+                    for (int i = 0; i < Key::nbytes; ++i) {
+                        first[i] = Key::byte(*r, i);
+                    }
+                    found = true;
+                    continue;
+                }
+                for (int i = 0; i < Key::nbytes; ++i) {
+                    diff[i] |= Key::byte(*r, i) ^ first[i];
+                }
+            }
+        }
+
+        //Returns whether a precedes b, starting from the depth-th variable
+        //byte
+        bool less(const T &a, const T &b, int depth) const {
+            for (; depth < (int) bytes.size(); ++depth) {
+                const unsigned char ba = Key::byte(a, bytes[depth]);
+                const unsigned char bb = Key::byte(b, bytes[depth]);
+                if (ba != bb) {
+                    return ba < bb;
+                }
+            }
+            return false;
+        }
+
+        void insertionSort(T *begin, T *end, int depth) const {
+            for (T *i = begin + 1; i < end; ++i) {
+                if (less(*i, *(i - 1), depth)) {
+                    T el = std::move(*i);
+                    T *j = i;
+                    do {
+                        *j = std::move(*(j - 1));
+                        --j;
+                    } while (j > begin && less(el, *(j - 1), depth));
+                    *j = std::move(el);
+                }
+            }
+        }
+
+        //Sorts a small bucket byte by byte, starting from the least
+        //significant one. All the histograms are computed in one pass
+        void lsdSort(T *begin, T *end, int depth) const {
+            const int64_t n = end - begin;
+            const int nbytes = bytes.size() - depth;
+            std::vector<int64_t> counts(nbytes * 256);
+            for (T *r = begin; r < end; ++r) {
+                for (int i = 0; i < nbytes; ++i) {
+                    counts[i * 256 + Key::byte(*r, bytes[depth + i])]++;
+                }
+            }
+            std::vector<T> buffer(n);
+            T *src = begin;
+            T *dst = &buffer[0];
+            int64_t offsets[256];
+            for (int i = nbytes - 1; i >= 0; --i) {
+                int64_t *count = &counts[i * 256];
+                if (*std::max_element(count, count + 256) == n) {
+                    continue;
+                }
+                int64_t sum = 0;
+                for (int c = 0; c < 256; ++c) {
+                    offsets[c] = sum;
+                    sum += count[c];
+                }
+                const int pos = bytes[depth + i];
+                for (int64_t j = 0; j < n; ++j) {
+                    dst[offsets[Key::byte(src[j], pos)]++] = std::move(src[j]);
+                }
+                std::swap(src, dst);
+            }
+            if (src != begin) {
+                std::move(src, src + n, begin);
+            }
+        }
+
+        //Moves the records in the buckets of the depth-th variable byte.
+        //Returns false if all the records are in the same bucket
+        bool partition(T *begin, T *end, int depth,
+                std::array<int64_t, 257> &limits) const {
+            const int pos = bytes[depth];
+            std::array<int64_t, 256> count;
+            count.fill(0);
+            for (T *r = begin; r < end; ++r) {
+                count[Key::byte(*r, pos)]++;
+            }
+            if (*std::max_element(count.begin(), count.end()) == end - begin) {
+                return false;
+            }
+            T *heads[256];
+            T *tails[256];
+            int64_t sum = 0;
+            for (int c = 0; c < 256; ++c) {
+                limits[c] = sum;
+                heads[c] = begin + sum;
+                sum += count[c];
+                tails[c] = begin + sum;
+            }
+            limits[256] = sum;
+            for (int c = 0; c < 256; ++c) {
+                while (heads[c] < tails[c]) {
+                    const int v = Key::byte(*heads[c], pos);
+                    if (v == c) {
+                        heads[c]++;
+                    } else {
+                        std::swap(*heads[c], *heads[v]);
+                        heads[v]++;
+                    }
+                }
+            }
+            return true;
+        }
+
+        void sortSeq(T *begin, T *end, int depth) const {
+            while (depth < (int) bytes.size()) {
+                const int64_t n = end - begin;
+                if (n <= INSERTION_THRESHOLD) {
+                    insertionSort(begin, end, depth);
+                    return;
+                }
+                if (n <= LSD_THRESHOLD) {
+                    lsdSort(begin, end, depth);
+                    return;
+                }
+                std::array<int64_t, 257> limits;
+                if (partition(begin, end, depth, limits)) {
+                    for (int c = 0; c < 256; ++c) {
+                        if (limits[c + 1] - limits[c] > 1) {
+                            sortSeq(begin + limits[c], begin + limits[c + 1],
+                                    depth + 1);
+                        }
+                    }
+                    return;
+                }
+                depth++;
+            }
+        }
+
+        void addTask(T *begin, T *end, int depth) {
+            Task t;
+            t.begin = begin;
+            t.end = end;
+            t.depth = depth;
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(t);
+            pending++;
+            cond.notify_one();
+        }
+
+        //The large buckets are split in smaller tasks, the others are sorted
+        //by a single thread
+        void worker() {
+            while (true) {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (tasks.empty() && pending > 0) {
+                    cond.wait(lock);
+                }
+                if (tasks.empty()) {
+                    return;
+                }
+                Task t = tasks.front();
+                tasks.pop_front();
+                lock.unlock();
+
+                int depth = t.depth;
+                if (t.end - t.begin > splitThreshold) {
+                    std::array<int64_t, 257> limits;
+                    while (depth < (int) bytes.size() &&
+                            !partition(t.begin, t.end, depth, limits)) {
+                        depth++;
+                    }
+                    if (depth < (int) bytes.size()) {
+                        for (int c = 0; c < 256; ++c) {
+                            if (limits[c + 1] - limits[c] > 1) {
+                                addTask(t.begin + limits[c],
+                                        t.begin + limits[c + 1], depth + 1);
+                            }
+                        }
+                    }
+                } else {
+                    sortSeq(t.begin, t.end, depth);
+                }
+
+                lock.lock();
+                pending--;
+                if (pending == 0) {
+                    cond.notify_all();
+                }
+            }
+        }
+
+    public:
+        static void sort(T *begin, T *end, int nthreads = 1) {
+            const int64_t n = end - begin;
+            if (n < 2) {
+                return;
+            }
+            if (nthreads < 1) {
+                nthreads = 1;
+            }
+            nthreads = (int) std::min((int64_t) nthreads,
+                    std::max((int64_t) 1, n / (LSD_THRESHOLD * 16)));
+
+            //Find the variable bytes and the padding records
+            std::vector<std::array<unsigned char, Key::nbytes>> first(nthreads);
+            std::vector<std::array<unsigned char, Key::nbytes>> diff(nthreads);
+            std::unique_ptr<bool[]> found(new bool[nthreads]);
+            std::vector<int64_t> nmax(nthreads);
+            std::vector<std::thread> threads;
+            const int64_t chunk = n / nthreads;
+            if (nthreads == 1) {
+                findVariableBytes(begin, end, first[0], diff[0], found[0],
+                        nmax[0]);
+            }
+            for (int i = 0; i < nthreads && nthreads > 1; ++i) {
+                T *b = begin + i * chunk;
+                T *e = i == nthreads - 1 ? end : b + chunk;
+                threads.push_back(std::thread(&RadixSort::findVariableBytes, b,
+                            e, std::ref(first[i]), std::ref(diff[i]),
+                            std::ref(found[i]), std::ref(nmax[i])));
+            }
+            for (auto &t : threads) {
+                t.join();
+            }
+            threads.clear();
+            std::array<unsigned char, Key::nbytes> globalFirst;
+            std::array<unsigned char, Key::nbytes> globalDiff;
+            globalFirst.fill(0);
+            globalDiff.fill(0);
+            bool anyFound = false;
+            int64_t totalMax = 0;
+            for (int i = 0; i < nthreads; ++i) {
+                totalMax += nmax[i];
+                if (!found[i]) {
+                    continue;
+                }
+                if (!anyFound) {
+                    globalFirst = first[i];
+                    anyFound = true;
+                }
+                for (int j = 0; j < Key::nbytes; ++j) {
+                    globalDiff[j] |= diff[i][j] | (first[i][j] ^ globalFirst[j]);
+                }
+            }
+
+            RadixSort sorter;
+            for (int j = 0; j < Key::nbytes; ++j) {
+                if (globalDiff[j]) {
+                    sorter.bytes.push_back(j);
+                }
+            }
+            if (totalMax > 0) {
+                end = std::partition(begin, end,
+                        [](const T &r) { return !isMax(r); });
+            }
+            if (sorter.bytes.empty() || end - begin < 2) {
+                return;
+            }
+
+            if (nthreads == 1) {
+                sorter.sortSeq(begin, end, 0);
+                return;
+            }
+            sorter.splitThreshold = std::max((int64_t) LSD_THRESHOLD,
+                    (int64_t) ((end - begin) / (nthreads * 8)));
+            sorter.addTask(begin, end, 0);
+            for (int i = 0; i < nthreads; ++i) {
+                threads.push_back(std::thread(&RadixSort::worker, &sorter));
+            }
+            for (auto &t : threads) {
+                t.join();
+            }
+        }
+};
+
+#endif
@@ -51,6 +51,13 @@ class DBLayer {
 
                 virtual bool first(uint64_t, bool, uint64_t, bool, uint64_t, bool) = 0;
 
+                //Asks the scan to skip the rows whose value at pos (1-3) is
+                //in [begin, end) but not in [lo, hi]. The scans are free to
+                //ignore it, so the filter must still be applied
+                virtual void addRangeFilter(int pos, uint64_t begin,
+                        uint64_t end, uint64_t lo, uint64_t hi) {
+                }
+
                 virtual ~Scan() {}
         };
 
@@ -122,6 +129,39 @@ class DBLayer {
                 ::Type::ID& type,
                 unsigned& subType) = 0;
 
+        //Looks up many IDs at once. The texts are copied in texts, and
+        //found[i] tells whether ids[i] exists
+        virtual void lookupManyById(const uint64_t *ids,
+                const size_t n,
+                std::string *texts,
+                ::Type::ID *types,
+                bool *found) {
+            for (size_t i = 0; i < n; ++i) {
+                const char *start, *stop;
+                unsigned subType;
+                found[i] = lookupById(ids[i], start, stop, types[i], subType);
+                if (found[i])
+                    texts[i].assign(start, stop);
+            }
+        }
+
+        //Searches the terms whose text contains pattern with an index.
+        //Returns false if there is no index or it is not selective enough.
+        //Otherwise, ids contains the sorted IDs of the matching terms. The
+        //IDs that are not below idsUpperBound are not covered
+        virtual bool searchText(const std::string &pattern,
+                const uint64_t maxCandidates,
+                std::vector<uint64_t> &ids,
+                uint64_t &idsUpperBound) {
+            return false;
+        }
+
+        //True if some literals are encoded in their IDs, in the order of
+        //their values (see InlineLiterals)
+        virtual bool inlinesLiterals() {
+            return false;
+        }
+
         virtual uint64_t getNextId() = 0;
 
         virtual double getScanCost(DBLayer::DataOrder order,
@@ -125,6 +125,11 @@ public:
         left->setHashKeys(keys, bitset);
    }
 
+    void addRangeFilter(Register* reg, uint64_t begin, uint64_t end, uint64_t lo, uint64_t hi) {
+        left->addRangeFilter(reg, begin, end, lo, hi);
+        right->addRangeFilter(reg, begin, end, lo, hi);
+    }
+
 };
 //---------------------------------------------------------------------------
 #endif
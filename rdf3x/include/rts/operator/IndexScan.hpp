@@ -87,6 +87,9 @@ public:
        hint.setKeys(keys, bitset);
    }
 
+   /// Push a range filter into the scan
+   void addRangeFilter(Register* reg, uint64_t begin, uint64_t end, uint64_t lo, uint64_t hi);
+
     /// Register parts of the tree that can be executed asynchronous
     void getAsyncInputCandidates(Scheduler& scheduler);
 
@@ -92,6 +92,10 @@ class MergeJoin : public Operator
    void setHashKeys(std::vector<uint64_t> *keys, int bitset) {
        left->setHashKeys(keys, bitset);
    }
+   void addRangeFilter(Register* reg, uint64_t begin, uint64_t end, uint64_t lo, uint64_t hi) {
+       left->addRangeFilter(reg, begin, end, lo, hi);
+       right->addRangeFilter(reg, begin, end, lo, hi);
+   }
 
 };
 //---------------------------------------------------------------------------
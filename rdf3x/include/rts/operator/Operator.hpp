@@ -54,6 +54,11 @@ class Operator
        // Default version is empty.
    }
 
+   /// Let the scans that produce reg skip the values in [begin,end) that are not in [lo,hi]. Only a hint, the values must still be filtered
+   virtual void addRangeFilter(Register* reg, uint64_t begin, uint64_t end, uint64_t lo, uint64_t hi) {
+       // Default version is empty.
+   }
+
    /// Disable scan skipping. Debugging only, this is a global property!
    static bool disableSkipping;
 };
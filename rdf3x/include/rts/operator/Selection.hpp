@@ -27,7 +27,7 @@ class Selection : public Operator {
         /// A predicate result
         struct Result {
             /// Possible flags
-            enum Flags { idAvailable = 1, stringAvailable = 2, typeAvailable = 4, subTypeAvailable = 8, booleanAvailable = 16 };
+            enum Flags { idAvailable = 1, stringAvailable = 2, typeAvailable = 4, subTypeAvailable = 8, booleanAvailable = 16, nullValue = 32 };
 
             /// The flags
             uint64_t flags;
@@ -57,6 +57,10 @@ class Selection : public Operator {
             bool hasString() const {
                 return flags & stringAvailable;
             }
+            /// The id is unbound or not in the dictionary (decoded as "NULL")?
+            bool isNull() const {
+                return flags & nullValue;
+            }
 
             /// Ensure that a string is available
             void ensureString(const Selection* selection);
@@ -440,9 +444,17 @@ class Selection : public Operator {
         };
         /// Builtin contains
         class BuiltinContains: public BinaryPredicate {
+            private:
+                /// The sorted ids of the terms that contain a constant pattern (see DBLayer::searchText)
+                std::vector<uint64_t> matches;
+                /// The ids below this bound that are not in matches do not contain the pattern
+                uint64_t matchesBound;
+                /// Was the text index already asked?
+                bool searched;
+
             public:
                 /// Constructor
-                BuiltinContains(Predicate* left, Predicate* right) : BinaryPredicate(left, right) {}
+                BuiltinContains(Predicate* left, Predicate* right) : BinaryPredicate(left, right), matchesBound(0), searched(false) {}
 
                 /// Evaluate the predicate
                 void eval(Result& result);
@@ -641,6 +653,10 @@ class Selection : public Operator {
         void setHashKeys(std::vector<uint64_t> *keys, int bitset) {
             input->setHashKeys(keys, bitset);
         }
+
+        void addRangeFilter(Register* reg, uint64_t begin, uint64_t end, uint64_t lo, uint64_t hi) {
+            input->addRangeFilter(reg, begin, end, lo, hi);
+        }
 };
 //---------------------------------------------------------------------------
 #endif
@@ -31,7 +31,9 @@
 #include <rts/operator/AggrFunctions.hpp>
 
 #include <trident/sparql/aggrhandler.h>
+#include <trident/kb/inlineliterals.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <map>
 #include <set>
@@ -510,7 +512,7 @@ static Selection::Predicate* buildSelection(Runtime &runtime, const map<unsigned
             return new Selection::Neg(buildSelection(runtime,bindings, *filter.arg1, plan, registers));
         case QueryGraph::Filter::Literal:
             if (~filter.id)
-                return new Selection::ConstantLiteral(filter.id);
+                return new Selection::ConstantLiteral(filter.valueid);
             else
                 return new Selection::TemporaryConstantLiteral(filter.value);
         case QueryGraph::Filter::Variable:
@@ -520,7 +522,7 @@ static Selection::Predicate* buildSelection(Runtime &runtime, const map<unsigned
                 return new Selection::Null();
         case QueryGraph::Filter::IRI:
             if (~filter.id)
-                return new Selection::ConstantIRI(filter.id);
+                return new Selection::ConstantIRI(filter.valueid);
             else
                 return new Selection::TemporaryConstantIRI(filter.value);
         case QueryGraph::Filter::Null:
@@ -712,6 +714,54 @@ static Operator* translateHaving(Runtime& runtime, const map<unsigned, Register*
     return result;
 }
 //---------------------------------------------------------------------------
+/// The largest range of values of the Filter operator (it allocates a bitmap of this size)
+static const uint64_t maxFilterRange = UINT64_C(1) << 24;
+//---------------------------------------------------------------------------
+static uint64_t constantId(const QueryGraph::Filter& filter)
+    // The whole ID of a constant
+{
+    return (~filter.id) ? filter.valueid : filter.id;
+}
+//---------------------------------------------------------------------------
+static void pushRangeFilter(Runtime& runtime, Operator* tree, map<unsigned, Register*>& bindings, const QueryGraph::Filter& filter)
+    // Let the scans skip the inlined literals that fail a comparison with a constant
+{
+    InlineLiterals::Cmp cmp;
+    switch (filter.type) {
+        case QueryGraph::Filter::Less: cmp = InlineLiterals::LESS; break;
+        case QueryGraph::Filter::LessOrEqual: cmp = InlineLiterals::LESSOREQUAL; break;
+        case QueryGraph::Filter::Greater: cmp = InlineLiterals::GREATER; break;
+        case QueryGraph::Filter::GreaterOrEqual: cmp = InlineLiterals::GREATEROREQUAL; break;
+        default: return;
+    }
+    const QueryGraph::Filter* var = filter.arg1, *constant = filter.arg2;
+    if ((var->type == QueryGraph::Filter::Literal) && (constant->type == QueryGraph::Filter::Variable)) {
+        // constant < ?x is ?x > constant
+        swap(var, constant);
+        switch (cmp) {
+            case InlineLiterals::LESS: cmp = InlineLiterals::GREATER; break;
+            case InlineLiterals::LESSOREQUAL: cmp = InlineLiterals::GREATEROREQUAL; break;
+            case InlineLiterals::GREATER: cmp = InlineLiterals::LESS; break;
+            case InlineLiterals::GREATEROREQUAL: cmp = InlineLiterals::LESSOREQUAL; break;
+        }
+    }
+    if ((var->type != QueryGraph::Filter::Variable) || (constant->type != QueryGraph::Filter::Literal) || (!~constant->id) || (!bindings.count(var->id)))
+        return;
+
+    // The constants that are not in the KB are not considered
+    const char* start, *stop;
+    ::Type::ID type;
+    unsigned subType;
+    if (!runtime.getDatabase().lookupById(constant->valueid, start, stop, type, subType))
+        return;
+    vector<InlineLiterals::Range> ranges;
+    if (!InlineLiterals::getRanges(start, stop - start, cmp, ranges))
+        return;
+    Register* reg = bindings[var->id];
+    for (vector<InlineLiterals::Range>::const_iterator iter = ranges.begin(), limit = ranges.end(); iter != limit; ++iter)
+        tree->addRangeFilter(reg, (*iter).begin, (*iter).end, (*iter).lo, (*iter).hi);
+}
+//---------------------------------------------------------------------------
 static Operator* translateFilter(Runtime& runtime, const map<unsigned, Register*>& context, const set<unsigned>& projection, map<unsigned, Register*>& bindings, const map<const QueryGraph::Node*, unsigned>& registers, Plan* plan)
     // Translate a filter into an operator tree
 {
@@ -729,19 +779,23 @@ static Operator* translateFilter(Runtime& runtime, const map<unsigned, Register*
         newProjection.insert(*iter);
     Operator* tree = translatePlan(runtime, context, newProjection, bindings, registers, plan->left);
 
+    // The range predicates on the inlined literals are also checked by the scans
+    if (runtime.getDatabase().inlinesLiterals())
+        pushRangeFilter(runtime, tree, bindings, filter);
+
     // Build the operator, try special cases first
     Operator* result = 0;
     if (((filter.type == QueryGraph::Filter::Equal) || (filter.type == QueryGraph::Filter::NotEqual)) && (filter.arg1->type == QueryGraph::Filter::Variable)) {
         if (((filter.arg2->type == QueryGraph::Filter::Literal) || (filter.arg2->type == QueryGraph::Filter::IRI)) && (bindings.count(filter.arg1->id))) {
             vector<uint64_t> values;
-            values.push_back(filter.arg2->id);
+            values.push_back(constantId(*filter.arg2));
             result = new Filter(tree, bindings[filter.arg1->id], values, filter.type == QueryGraph::Filter::NotEqual, plan->cardinality);
         }
     }
     if ((!result) && ((filter.type == QueryGraph::Filter::Equal) || (filter.type == QueryGraph::Filter::NotEqual)) && (filter.arg2->type == QueryGraph::Filter::Variable)) {
         if (((filter.arg1->type == QueryGraph::Filter::Literal) || (filter.arg1->type == QueryGraph::Filter::IRI)) && (bindings.count(filter.arg2->id))) {
             vector<uint64_t> values;
-            values.push_back(filter.arg1->id);
+            values.push_back(constantId(*filter.arg1));
             result = new Filter(tree, bindings[filter.arg2->id], values, filter.type == QueryGraph::Filter::NotEqual, plan->cardinality);
         }
     }
@@ -756,9 +810,12 @@ static Operator* translateFilter(Runtime& runtime, const map<unsigned, Register*
                     valid = false;
                     break;
                 }
-                values.push_back(iter->arg1->id);
+                values.push_back(constantId(*iter->arg1));
             }
         }
+        // The filter keeps a bitmap of the range of the values
+        if (valid && (!values.empty()) && ((*max_element(values.begin(), values.end()) - *min_element(values.begin(), values.end())) > maxFilterRange))
+            valid = false;
         if (valid) {
             result = new Filter(tree, bindings[filter.arg1->id], values, false, plan->cardinality);
         }
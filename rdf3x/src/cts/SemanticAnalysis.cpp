@@ -104,8 +104,14 @@ static bool encode(DBLayer& dict, DifferentialIndex* diffIndex, const SPARQLPars
                 } else if (element.subTypeValue == "http://www.w3.org/2001/XMLSchema#boolean") {
                     type = Type::Boolean;
                 } else {
-                    if (!lookup(dict, diffIndex, element.subTypeValue, Type::URI, 0, subType))
+                    if (!lookup(dict, diffIndex, element.subTypeValue, Type::URI, 0, subType)) {
+                        // The datatype is not a term of its own, but the literal can still be known (e.g., an inlined dateTime)
+                        if (lookup(dict, diffIndex, "\"" + element.value + "\"^^<" + element.subTypeValue + ">", Type::Literal, 0, id)) {
+                            constant = true;
+                            return true;
+                        }
                         return false;
+                    }
                     type = Type::CustomType;
                 }
                 if (lookup(dict, diffIndex, element.value, type, subType, id)) {
@@ -373,6 +379,8 @@ static bool encodeFilter(SemanticAnalysis *myself, DBLayer& dict, DifferentialIn
                                                     output.type = QueryGraph::Filter::Literal;
                                                     output.id = id;
                                                     output.value = input.value;
+                                                    //id has only 32 bits, valueid keeps the whole ID (e.g., of an inlined literal)
+                                                    output.valueid = id;
                                                 } else {
                                                     output.type = QueryGraph::Filter::Literal;
                                                     output.id = ~0u;
@@ -402,6 +410,7 @@ static bool encodeFilter(SemanticAnalysis *myself, DBLayer& dict, DifferentialIn
                                                 output.type = QueryGraph::Filter::IRI;
                                                 output.id = id;
                                                 output.value = input.value;
+                                                output.valueid = id;
                                             } else {
                                                 output.type = QueryGraph::Filter::IRI;
                                                 output.id = ~0u;
@@ -307,6 +307,17 @@ void IndexScan::addMergeHint(Register* reg1, Register* reg2)
     handleHints(reg1, reg2, value3, merge3);
 }
 //---------------------------------------------------------------------------
+void IndexScan::addRangeFilter(Register* reg, uint64_t begin, uint64_t end, uint64_t lo, uint64_t hi)
+// Push a range filter into the scan
+{
+    if ((value1 == reg) && (!bound1))
+        scan->addRangeFilter(1, begin, end, lo, hi);
+    else if ((value2 == reg) && (!bound2))
+        scan->addRangeFilter(2, begin, end, lo, hi);
+    else if ((value3 == reg) && (!bound3))
+        scan->addRangeFilter(3, begin, end, lo, hi);
+}
+//---------------------------------------------------------------------------
 void IndexScan::getAsyncInputCandidates(Scheduler& /*scheduler*/)
 // Register parts of the tree that can be executed asynchronous
 {
@@ -370,6 +370,22 @@ uint64_t ResultsPrinter::first()
     std::unique_ptr<char[]> buf_current(new char[buf_max]);
     size_t buf_size = 0;
 
+    // Decode the strings of the database at once
+    vector<uint64_t> batchIds;
+    if (!tempDict) {
+        for (map<uint64_t, CacheEntry>::iterator iter = stringCache.begin(),
+                limit = stringCache.end(); iter != limit; ++iter) {
+            if (!dictQuery || !dictQuery->hasID(iter->first))
+                batchIds.push_back(iter->first);
+        }
+    }
+    std::unique_ptr<std::string[]> batchTexts(new std::string[batchIds.size()]);
+    std::unique_ptr<Type::ID[]> batchTypes(new Type::ID[batchIds.size()]);
+    std::unique_ptr<bool[]> batchFound(new bool[batchIds.size()]);
+    dictionary.lookupManyById(batchIds.data(), batchIds.size(),
+            batchTexts.get(), batchTypes.get(), batchFound.get());
+    size_t batchIdx = 0;
+
     // Lookup the strings
     set<unsigned> subTypes;
     for (map<uint64_t, CacheEntry>::iterator iter = stringCache.begin(),
@@ -383,10 +399,18 @@ uint64_t ResultsPrinter::first()
             c.stop = pair.second;
             c.type = Type::Literal;
         } else {
-            if (tempDict)
+            if (tempDict) {
                 tempDict->lookupById((*iter).first, c.start, c.stop, c.type, c.subType);
-            else
-                dictionary.lookupById((*iter).first, c.start, c.stop, c.type, c.subType);
+            } else {
+                //batchIds follows the order of stringCache
+                const size_t k = batchIdx++;
+                if (batchFound[k]) {
+                    c.start = batchTexts[k].data();
+                    c.stop = c.start + batchTexts[k].size();
+                    c.type = batchTypes[k];
+                    c.subType = 0;
+                }
+            }
 
             //Copy the text in a permanent data structure
             const size_t len = c.stop - c.start;
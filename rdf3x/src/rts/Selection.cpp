@@ -6,8 +6,11 @@
 #include "cts/plangen/PlanGen.hpp"
 
 #include <trident/kb/dictmgmt.h>
+#include <trident/kb/consts.h>
+#include <trident/kb/inlineliterals.h>
 
 #include <sstream>
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <cstdio>
@@ -79,10 +82,11 @@ bool _endsWith(const std::string &s, const std::string &suffix) {
 Selection::NumType Selection::getNumType(std::string s) {
     std::string dbl = "^^<http://www.w3.org/2001/XMLSchema#double>";
     std::string flt = "^^<http://www.w3.org/2001/XMLSchema#float>";
+    std::string decimal = "^^<http://www.w3.org/2001/XMLSchema#decimal>";
     std::string integer = "^^<http://www.w3.org/2001/XMLSchema#integer>";
     std::string datetime = "^^<http://www.w3.org/2001/XMLSchema#dateTime>";
     std::string date = "^^<http://www.w3.org/2001/XMLSchema#date>";
-    if (_endsWith(s,dbl) || _endsWith(s,flt)) {
+    if (_endsWith(s,dbl) || _endsWith(s,flt) || _endsWith(s,decimal)) {
         return NumType::DECIMAL;
     } else if (_endsWith(s,integer)) {
         return NumType::INT;
@@ -157,6 +161,7 @@ void Selection::Result::ensureString(const Selection* selection)
                 flags |= typeAvailable;
             } else {
                 value = "NULL";
+                flags |= nullValue;
             }
         } else if (flags & booleanAvailable) {
             if (boolean)
@@ -181,6 +186,7 @@ void Selection::Result::ensureType(Selection* selection)
                 flags |= stringAvailable;
             } else {
                 type = Type::Literal; // XXX NULL type?
+                flags |= nullValue;
             }
         } else if (flags & booleanAvailable) {
             type = Type::Boolean;
@@ -392,7 +398,11 @@ void Selection::Less::eval(Result& result)
     bool num2 =  DictMgmt::isnumeric(r.id);
 
     if (!num1 && !num2) {
-        if (selection->isNumericComparison(l,r)) {
+        int res;
+        if ((l.flags & Result::idAvailable) && (r.flags & Result::idAvailable) && InlineLiterals::compare(l.id, r.id, res)) {
+            // Inlined literals are compared without decoding them
+            result.setBoolean(res < 0);
+        } else if (selection->isNumericComparison(l,r)) {
             result.setBoolean(selection->numLess(l,r));
         } else {
 	    r.ensureString(selection);
@@ -470,7 +480,11 @@ void Selection::LessOrEqual::eval(Result& result)
     bool num2 =  DictMgmt::isnumeric(r.id);
     
     if (!num1 && !num2) {
-        if (selection->isNumericComparison(l,r)) {
+        int res;
+        if ((l.flags & Result::idAvailable) && (r.flags & Result::idAvailable) && InlineLiterals::compare(l.id, r.id, res)) {
+            // Inlined literals are compared without decoding them
+            result.setBoolean(res <= 0);
+        } else if (selection->isNumericComparison(l,r)) {
             result.setBoolean(!selection->numLess(r,l));
         } else {
 	    l.ensureString(selection);
@@ -826,6 +840,13 @@ string Selection::BuiltinLangMatches::print(PlanPrinter& out)
     return  "langMatches(" + left->print(out) + "," + right->print(out) + ")";
 }
 //---------------------------------------------------------------------------
+static bool isConstant(Selection::Predicate* p)
+    // Is the predicate a constant?
+{
+    return dynamic_cast<Selection::ConstantLiteral*>(p) || dynamic_cast<Selection::TemporaryConstantLiteral*>(p) ||
+        dynamic_cast<Selection::ConstantIRI*>(p) || dynamic_cast<Selection::TemporaryConstantIRI*>(p);
+}
+//---------------------------------------------------------------------------
 void Selection::BuiltinContains::eval(Result& result)
     // Evaluate the predicate
 {
@@ -833,9 +854,27 @@ void Selection::BuiltinContains::eval(Result& result)
     left->eval(l);
     right->eval(r);
 
+    // A constant pattern is searched once in the text index. The terms of the dictionary that are not
+    // in the result can be discarded without decoding them. The ids that are not in the dictionary are
+    // null values, which never match
+    if (!searched) {
+        searched = true;
+        if (isConstant(right)) {
+            r.ensureString(selection);
+            if (r.hasString() && !r.isNull() &&
+                    !selection->runtime.getDatabase().searchText(r.value, TEXTIDX_MAX_FILTER_CANDIDATES, matches, matchesBound)) {
+                matchesBound = 0;
+            }
+        }
+    }
+    if (l.hasId() && l.id < matchesBound && !std::binary_search(matches.begin(), matches.end(), l.id)) {
+        result.setBoolean(false);
+        return;
+    }
+
     l.ensureString(selection);
     r.ensureString(selection);
-    if (!l.hasString() || !r.hasString()) {
+    if (!l.hasString() || !r.hasString() || l.isNull() || r.isNull()) {
         result.setBoolean(false);
         return;
     }
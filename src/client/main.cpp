@@ -27,6 +27,7 @@
 #include <trident/kb/updater.h>
 #include <trident/kb/kbconfig.h>
 #include <trident/kb/querier.h>
+#include <trident/kb/warmup.h>
 #include <trident/mining/miner.h>
 #include <trident/tests/common.h>
 
@@ -50,6 +51,7 @@
 #include <cstdlib>
 #include <sstream>
 #include <fstream>
+#include <unordered_map>
 
 using namespace std;
 
@@ -91,7 +93,17 @@ void lookup(DictMgmt *dict, ProgramArgs &vm) {
     }
 }
 
-void dump(KB *kb, string outputdir) {
+//Writes the text of a term, or its ID if it is not in the dictionary
+static void dumpTerm(zstr::ofstream &out, const int64_t id,
+        const std::string &text, const bool found) {
+    if (found) {
+        out << text;
+    } else {
+        out << "ID:" << id;
+    }
+}
+
+void dump(KB *kb, string outputdir, int nthreads) {
     if (Utils::exists(outputdir)) {
         LOG(INFOL) << "Removing the output directory ... " << outputdir;
         Utils::remove_all(outputdir);
@@ -107,36 +119,50 @@ void dump(KB *kb, string outputdir) {
     DictMgmt *dict = q->getDictMgmt();
     std::unique_ptr<char[]> supportBuffer = std::unique_ptr<char[]>(new char[MAX_TERM_SIZE + 2]);
 
+    //The subjects and objects are decoded in batches with getTexts. There
+    //are few predicates, so their texts are cached
     const bool print_p = kb->getGraphType() == GraphType::DEFAULT;
+    const size_t batchSize = 1000000;
+    std::vector<uint64_t> terms;
+    std::vector<int64_t> predicates;
+    std::unique_ptr<std::string[]> texts(new std::string[2 * batchSize]);
+    std::unique_ptr<bool[]> found(new bool[2 * batchSize]);
+    std::unordered_map<int64_t, std::string> relTexts;
     PairItr *itr = q->get(IDX_SOP, -1, -1, -1);
-    while (itr->hasNext()) {
-        int64_t s, p, o;
-        itr->next();
-        s = itr->getKey();
-        o = itr->getValue1();
-        bool resp = dict->getText(s, supportBuffer.get());
-        if (resp) {
-            out << supportBuffer.get() << "\t";
-        } else {
-            out << "ID:" << s << "\t";
+    bool hasNext = itr->hasNext();
+    while (hasNext) {
+        terms.clear();
+        predicates.clear();
+        while (hasNext && predicates.size() < batchSize) {
+            itr->next();
+            terms.push_back(itr->getKey());
+            terms.push_back(itr->getValue1());
+            predicates.push_back(print_p ? itr->getValue2() : 0);
+            hasNext = itr->hasNext();
         }
-        if (print_p) {
-            p = itr->getValue2();
-            int size;
-            resp = dict->getTextRel(p, supportBuffer.get(), size);
-            if (resp) {
-                out << supportBuffer.get() << "\t";
-            } else {
-                out << "ID:" << p << "\t";
+        dict->getTexts(terms.data(), terms.size(), texts.get(), found.get(),
+                nthreads);
+        for (size_t i = 0; i < predicates.size(); ++i) {
+            dumpTerm(out, terms[2 * i], texts[2 * i], found[2 * i]);
+            out << "\t";
+            if (print_p) {
+                const int64_t p = predicates[i];
+                auto rel = relTexts.find(p);
+                if (rel == relTexts.end()) {
+                    int size;
+                    if (dict->getTextRel(p, supportBuffer.get(), size)) {
+                        rel = relTexts.insert(std::make_pair(p,
+                                    std::string(supportBuffer.get(), size))).first;
+                    } else {
+                        rel = relTexts.insert(std::make_pair(p,
+                                    "ID:" + to_string(p))).first;
+                    }
+                }
+                out << rel->second << "\t";
             }
+            dumpTerm(out, terms[2 * i + 1], texts[2 * i + 1], found[2 * i + 1]);
+            out << std::endl;
         }
-        resp = dict->getText(o, supportBuffer.get());
-        if (resp) {
-            out << supportBuffer.get();
-        } else {
-            out << "ID:" << o;
-        }
-        out << std::endl;
     }
     LOG(INFOL) << "Finished dumping";
     q->releaseItr(itr);
@@ -182,6 +208,18 @@ void testkb(string kbDir, ProgramArgs &vm) {
         p.graphTransformation = vm["gf"].as<string>();
         p.storeDicts = vm["storedicts"].as<bool>();
         p.flatTree = vm["flatTree"].as<bool>();
+        p.packedTables = vm["packedTables"].as<bool>();
+        p.comprTables = vm["comprTables"].as<bool>();
+        p.coordTable = vm["coordTable"].as<bool>();
+        p.bulkTree = vm["bulkTree"].as<bool>();
+        p.fcDict = vm["fcDict"].as<bool>();
+        p.dictHashIndex = vm["dictHashIdx"].as<bool>();
+        p.textIndex = vm["textIdx"].as<bool>();
+        p.inlineLiterals = vm["inlineLits"].as<bool>();
+        p.derivePerms = vm["derivePerms"].as<bool>();
+        p.maxMemory = vm["maxMemory"].as<int64_t>();
+        p.resume = vm["resume"].as<bool>();
+        p.binIDSize = vm["binIDSize"].as<int>();
 
         loader.load(p);
     }
@@ -222,6 +260,14 @@ void testkb(string kbDir, ProgramArgs &vm) {
     test.test_moveto(permutations);
 }
 
+string cacheStatsToString(const MemoryManagerStats &stats) {
+    std::stringstream ss;
+    ss << "hits " << stats.hits << " misses " << stats.misses <<
+        " evictions " << stats.evictions << " bytes " << stats.bytes <<
+        "/" << stats.maxBytes;
+    return ss.str();
+}
+
 void printInfo(KB &kb) {
     if (kb.areRelIDsSeparated()) {
         cout << "Dictionary: entities and relations have different dictionaries" << endl;
@@ -239,6 +285,8 @@ void printInfo(KB &kb) {
     } else {
         cout << "Type: Directed Graph with labeled relations" << endl;
     }
+    cout << "Tree cache: " << cacheStatsToString(kb.getTreeCacheStats()) << endl;
+    cout << "Dictionary cache: " << cacheStatsToString(kb.getDictCacheStats()) << endl;
 }
 
 #ifdef SERVER
@@ -260,6 +308,13 @@ void printStats(KB &kb, Querier *q) {
     LOG(DEBUGL) << "RowLayouts: " << c.statsRow << " ClusterLayouts: " << c.statsCluster << " ColumnLayouts: " << c.statsColumn;
     LOG(DEBUGL) << "AggrIndices: " << c.aggrIndices << " NotAggrIndices: " << c.notAggrIndices << " CacheIndices: " << c.cacheIndices;
     LOG(DEBUGL) << "Permutations: spo " << c.spo << " ops " << c.ops << " pos " << c.pos << " sop " << c.sop << " osp " << c.osp << " pso " << c.pso;
+    LOG(DEBUGL) << "Tree cache: " << cacheStatsToString(c.treeCache);
+    LOG(DEBUGL) << "Dictionary cache: " << cacheStatsToString(c.dictCache);
+    DecodeCacheStats dstats = kb.getDecodeCacheStats();
+    LOG(DEBUGL) << "Decode cache: hits " << dstats.hits << " misses " <<
+        dstats.misses << " rejections " << dstats.rejections << " evictions "
+        << dstats.evictions << " bytes " << dstats.bytes << "/" <<
+        dstats.maxBytes;
     int64_t nblocks = 0;
     int64_t nbytes = 0;
     for (int i = 0; i < kb.getNDictionaries(); ++i) {
@@ -414,6 +469,11 @@ int main(int argc, const char** argv) {
             inputCompressed = true;
         } else {
             inputDir = vm["tripleFiles"].as<string>();
+            if (vm["inputformat"].as<string>() == "bin") {
+                //The binary triples can come with the dictionary of their IDs
+                dictDir = vm["comprdict"].as<string>();
+                dictDir_rel = vm["comprdict_rel"].as<string>();
+            }
         }
 
         ParamsLoad p;
@@ -449,6 +509,18 @@ int main(int argc, const char** argv) {
         p.storeDicts = vm["storedicts"].as<bool>();
         p.relsOwnIDs = vm["relsOwnIDs"].as<bool>();
         p.flatTree = vm["flatTree"].as<bool>();
+        p.packedTables = vm["packedTables"].as<bool>();
+        p.comprTables = vm["comprTables"].as<bool>();
+        p.coordTable = vm["coordTable"].as<bool>();
+        p.bulkTree = vm["bulkTree"].as<bool>();
+        p.fcDict = vm["fcDict"].as<bool>();
+        p.dictHashIndex = vm["dictHashIdx"].as<bool>();
+        p.textIndex = vm["textIdx"].as<bool>();
+        p.inlineLiterals = vm["inlineLits"].as<bool>();
+        p.derivePerms = vm["derivePerms"].as<bool>();
+        p.maxMemory = vm["maxMemory"].as<int64_t>();
+        p.resume = vm["resume"].as<bool>();
+        p.binIDSize = vm["binIDSize"].as<int>();
 
         loader.load(p);
 
@@ -491,10 +563,21 @@ int main(int argc, const char** argv) {
     } else if (cmd == "dump") {
         KBConfig config;
         KB kb(kbDir.c_str(), true, false, true, config);
-        dump(&kb, vm["output"].as<string>());
+        dump(&kb, vm["output"].as<string>(), vm["dumpThreads"].as<int>());
+    } else if (cmd == "warmup") {
+        Warmup::warmupKB(kbDir,
+                Warmup::parsePermutations(vm["warmupPerms"].as<string>()),
+                vm["warmupTree"].as<bool>(), vm["warmupDict"].as<bool>(),
+                vm["warmupThreads"].as<int>(), vm["warmupTimeout"].as<int>());
     } else if (cmd == "server") {
 #ifdef SERVER
         KBConfig config;
+        config.setParamBool(STORAGE_ACCESS_HINTS, vm["accessHints"].as<bool>());
+        config.setParam(WARMUP_PERMS, vm["warmupPerms"].as<string>());
+        config.setParamBool(WARMUP_TREE, vm["warmupTree"].as<bool>());
+        config.setParamBool(WARMUP_DICT, vm["warmupDict"].as<bool>());
+        config.setParamInt(WARMUP_THREADS, vm["warmupThreads"].as<int>());
+        config.setParamInt(WARMUP_TIMEOUT, vm["warmupTimeout"].as<int>());
         KB kb(kbDir.c_str(), true, false, true, config);
         startServer(kb, vm["port"].as<int>(), vm["webthreads"].as<int>());
 #else
@@ -38,6 +38,7 @@ void printHelp(const char *programName, string section,
         cout << "lookup\t\t\t lookup for values in the dictionary." << endl;
         cout << "info\t\t\t print some information about the KB." << endl;
         cout << "dump\t\t\t dump the graph on files." << endl;
+        cout << "warmup\t\t\t load the files of the KB in the page cache." << endl;
 
 #ifdef ANALYTICS
         cout << "analytics\t\t perform analytical operations on the graph." << endl;
@@ -87,6 +88,7 @@ bool checkParams(ProgramArgs &vm, int argc, const char** argv,
             && cmd != "mine"
             && cmd != "server"
             && cmd != "dump"
+            && cmd != "warmup"
             && cmd != "learn"
             && cmd != "predict"
             && cmd != "subcreate"
@@ -269,7 +271,7 @@ bool initParams(int argc, const char** argv, ProgramArgs &vm) {
     /***** LOAD *****/
     ParamsLoad p;
     ProgramArgs::GroupArgs& load_options = *vm.newGroup("Options for <load>");
-    load_options.add<string>("","inputformat", "rdf", "Input format. Can be either 'rdf' or 'snap'. Default is 'rdf'.", false);
+    load_options.add<string>("","inputformat", "rdf", "Input format. Can be either 'rdf', 'snap' or 'bin'. 'bin' reads triples of packed little-endian integer IDs (see binIDSize) from a file or a directory of files given with tripleFiles, and the optional dictionary of the IDs from comprdict. Default is 'rdf'.", false);
     load_options.add<string>("","comprinput", "", "Path to a file that contains a list of compressed triples.", false);
     load_options.add<string>("","comprdict", "", "Path to a file that contains the dictionary for the compressed triples.", false);
     load_options.add<string>("","comprdict_rel", "", "Path to a file that contains the dictionary for the relations used in compressed triples (used only if relsOwnIDs is set to true).", false);
@@ -304,6 +306,18 @@ bool initParams(int argc, const char** argv, ProgramArgs &vm) {
     load_options.add<string>("","gf", p.graphTransformation, "Possible graph transformations. 'unlabeled' removes the edge labels (but keeps it directed), 'undirected' makes the graph undirected and without edge labels", false);
     load_options.add<bool>("","relsOwnIDs", p.relsOwnIDs, "Should I give independent IDs to the terms that appear as predicates? (Useful for ML learning models). Default is DISABLED", false);
     load_options.add<bool>("","flatTree", p.flatTree, "Create a flat representation of the nodes' tree. This parameter is forced to tree if the graph is unlabeled. Default is DISABLED", false);
+    load_options.add<bool>("","packedTables", p.packedTables, "Store large tables with a bit-packed layout (smaller but not supported by the graph analytics). Default is DISABLED", false);
+    load_options.add<bool>("","comprTables", p.comprTables, "Compress the permutation files with LZ4 in blocks that are decompressed on demand (the KB becomes read-only and is not supported by the graph analytics). Default is DISABLED", false);
+    load_options.add<bool>("","coordTable", p.coordTable, "Store the coordinates of all the terms in a table indexed by the term ID, which replaces the tree for the lookups. It is not created if the IDs are too sparse. Default is ENABLED", false);
+    load_options.add<bool>("","bulkTree", p.bulkTree, "Build the tree of the coordinates bottom-up in parallel instead of inserting the keys one by one. Default is ENABLED", false);
+    load_options.add<bool>("","fcDict", p.fcDict, "Store the dictionary as a sorted pool of front-coded strings mapped in memory instead of the trees dict and invdict. It is smaller and faster to decode. Default is DISABLED", false);
+    load_options.add<bool>("","dictHashIdx", p.dictHashIndex, "Store a hash index of the dictionary, which replaces the tree to lookup the IDs of the terms in the read-only KBs. It is ignored with fcDict. Default is DISABLED", false);
+    load_options.add<bool>("","textIdx", p.textIndex, "Store an index of the trigrams of the terms, which is used to search the terms by substring (FILTER contains and search_id in python) in the read-only KBs. Default is DISABLED", false);
+    load_options.add<bool>("","inlineLits", p.inlineLiterals, "Encode the xsd:double, xsd:decimal and xsd:dateTime literals in their IDs, in the order of their values, instead of storing them in the dictionary. The range FILTERs on them are then also applied by the scans. Default is DISABLED", false);
+    load_options.add<bool>("","derivePerms", p.derivePerms, "Sort only SPO in main memory and derive the other permutations from the sorted ones with a bucket scatter and small local sorts, instead of sorting each of them. Ignored with createIndicesInBlocks and unlabeled graphs. Default is DISABLED", false);
+    load_options.add<int64_t>("","maxMemory", p.maxMemory, "Maximum main memory (in MB) of the buffers of the loader: the sorts, the caches of the dictionary and of the tree and the I/O buffers. The stages use smaller chunks to stay under it. It does not apply to the dictionary encoding of kognac. 0 means no limit. Default is 0", false);
+    load_options.add<bool>("","resume", p.resume, "Resume a load that failed from the files it left in the temporary directory. The encoding of the triples, the inlining of the literals and the sort of the permutations are not repeated if the parameters and the input files (names, sizes and modification times) are the same. The dictionary and the indices are always recreated. Default is false", false);
+    load_options.add<int>("","binIDSize", p.binIDSize, "Bytes of the IDs of the input with the format 'bin'. Can be either 4 or 8. Default is 8", false);
 
     /***** LOOKUP *****/
     ProgramArgs::GroupArgs& lookup_options = *vm.newGroup("Options for <lookup>");
@@ -324,6 +338,7 @@ bool initParams(int argc, const char** argv, ProgramArgs &vm) {
     ProgramArgs::GroupArgs& server_options = *vm.newGroup("Options for <server>");
     server_options.add<int>("", "port", 8080, "Port to listen to", false);
     server_options.add<int>("", "webthreads", 1, "N. of threads for the webserver", false);
+    server_options.add<bool>("", "accessHints", false, "Tell the OS that the permutations are read randomly, except during the scans. Default is DISABLED", false);
 
     /***** LEARN/PREDICT *****/
 #ifdef ML
@@ -348,9 +363,18 @@ bool initParams(int argc, const char** argv, ProgramArgs &vm) {
     ana_options.add<string>("", "oparg2", "", helpstring.c_str(), false);
 #endif
 
+    /***** WARMUP *****/
+    ProgramArgs::GroupArgs& warmup_options = *vm.newGroup("Options for <warmup> (also used by <server>)");
+    warmup_options.add<string>("", "warmupPerms", "", "Permutations to load, e.g., 'spo,pos' or 'all'", false);
+    warmup_options.add<bool>("", "warmupTree", false, "Load the files of the tree", false);
+    warmup_options.add<bool>("", "warmupDict", false, "Load the files of the dictionary", false);
+    warmup_options.add<int>("", "warmupThreads", 4, "N. of threads that read the files", false);
+    warmup_options.add<int>("", "warmupTimeout", 0, "Stop after this number of seconds (0 means no limit)", false);
+
     /***** DUMP *****/
     ProgramArgs::GroupArgs& dump_options = *vm.newGroup("Options for <dump>");
     dump_options.add<string>("", "output", "", "Output directory to store the graph", false);
+    dump_options.add<int>("", "dumpThreads", 4, "N. of threads that decode the terms (only with MT, otherwise 1)", false);
 
 #ifdef ML
     /***** SUBGRAPHS *****/
@@ -392,6 +416,7 @@ bool initParams(int argc, const char** argv, ProgramArgs &vm) {
     sections.insert(make_pair("analytics",&ana_options));
 #endif
     sections.insert(make_pair("dump",&dump_options));
+    sections.insert(make_pair("warmup",&warmup_options));
     sections.insert(make_pair("mine",&mine_options));
     sections.insert(make_pair("server",&server_options));
 #ifdef ML
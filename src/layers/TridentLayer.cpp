@@ -24,6 +24,7 @@
 
 #include <trident/kb/querier.h>
 #include <trident/kb/consts.h>
+#include <trident/utils/parallel.h>
 #include <trident/model/table.h>
 #include <layers/TridentLayer.hpp>
 #include <infra/util/Type.hpp>
@@ -33,6 +34,8 @@
 #include <limits>
 #include <inttypes.h>
 #include <set>
+#include <vector>
+#include <algorithm>
 
 bool TridentLayer::lookup(const std::string& text,
         ::Type::ID type,
@@ -130,6 +133,41 @@ bool TridentLayer::lookupById(uint64_t id,
     return resp;
 }
 
+void TridentLayer::lookupManyById(const uint64_t *ids,
+        const size_t n,
+        std::string *texts,
+        ::Type::ID *types,
+        bool *found) {
+    dict->getTexts(ids, n, texts, found, ParallelTasks::getDefaultNThreads());
+    for (size_t i = 0; i < n; ++i) {
+        if (found[i]) {
+            //Same conventions of lookupById
+            if (!texts[i].empty() && texts[i][0] == '<') {
+                texts[i] = texts[i].substr(1, texts[i].size() - 2);
+                types[i] = ::Type::ID::URI;
+            } else {
+                types[i] = ::Type::ID::Literal;
+            }
+        }
+    }
+}
+
+bool TridentLayer::searchText(const std::string &pattern,
+        const uint64_t maxCandidates,
+        std::vector<uint64_t> &ids,
+        uint64_t &idsUpperBound) {
+    if (!dict->searchText(pattern, false, ids, NULL, maxCandidates,
+                ParallelTasks::getDefaultNThreads())) {
+        return false;
+    }
+    idsUpperBound = dict->getTextIndexNIDs();
+    return true;
+}
+
+bool TridentLayer::inlinesLiterals() {
+    return dict != NULL && dict->inlinesLiterals();
+}
+
 uint64_t TridentLayer::getNextId() {
     return kb.getNextID();
 }
@@ -816,20 +854,34 @@ std::shared_ptr<TupleTable> TridentLayer::query(Querier * querier,
     //Create tuple table and return it
     std::shared_ptr<TupleTable> output(new TupleTable(vars));
     int i = 0;
-    while (itr && itr->hasNext() && (limit == -1 || i++ < limit)) {
-        itr->next();
-        for (int i = 0; i < nPosToCopy; ++i) {
-            switch (posToCopy[i]) {
-                case 0:
-                    output->addValue(itr->getKey());
-                    break;
-                case 1:
-                    output->addValue(itr->getValue1());
-                    break;
-                case 2:
-                    output->addValue(itr->getValue2());
-                    break;
+    if (itr) {
+        //Read the pairs in batches. All the pairs in a batch share the key.
+        const size_t batchSize = 1024;
+        std::vector<uint64_t> v1(batchSize), v2(batchSize);
+        while (limit == -1 || i < limit) {
+            const size_t max = limit == -1 ? batchSize :
+                std::min(batchSize, (size_t) (limit - i));
+            const size_t n = itr->nextBatch(v1.data(), v2.data(), max);
+            if (n == 0) {
+                break;
             }
+            const uint64_t key = itr->getKey();
+            for (size_t j = 0; j < n; ++j) {
+                for (int k = 0; k < nPosToCopy; ++k) {
+                    switch (posToCopy[k]) {
+                        case 0:
+                            output->addValue(key);
+                            break;
+                        case 1:
+                            output->addValue(v1[j]);
+                            break;
+                        case 2:
+                            output->addValue(v2[j]);
+                            break;
+                    }
+                }
+            }
+            i += n;
         }
     }
 
@@ -988,6 +1040,35 @@ uint64_t TridentScan::getCount() {
 }
 
 bool TridentScan::next() {
+    return skipRejected(nextRow());
+}
+
+void TridentScan::addRangeFilter(int pos, uint64_t begin, uint64_t end,
+        uint64_t lo, uint64_t hi) {
+    RangeFilter f = { pos, begin, end, lo, hi };
+    rangeFilters.push_back(f);
+}
+
+bool TridentScan::isRejected() {
+    for (const auto &f : rangeFilters) {
+        const uint64_t v = f.pos == 1 ? getValue1() :
+            (f.pos == 2 ? getValue2() : getValue3());
+        if (v >= f.begin && v < f.end && (v < f.lo || v > f.hi))
+            return true;
+    }
+    return false;
+}
+
+bool TridentScan::skipRejected(bool resp) {
+    if (rangeFilters.empty())
+        return resp;
+    while (resp && isRejected()) {
+        resp = nextRow();
+    }
+    return resp;
+}
+
+bool TridentScan::nextRow() {
 
     if (hint && countHint == 0) {
         uint64_t s = 0, p = 0, o = 0;
@@ -1030,7 +1111,7 @@ bool TridentScan::first() {
         bool resp = itr->hasNext();
         if (resp)
             itr->next();
-        return resp;
+        return skipRejected(resp);
     } else {
         itr = q->getPermuted(perm, -1, -1, -1, false);
         if (a == DBLayer::AGGR_SKIP_LAST)
@@ -1038,7 +1119,7 @@ bool TridentScan::first() {
         bool resp = itr->hasNext();
         if (resp)
             itr->next();
-        return resp;
+        return skipRejected(resp);
     }
 }
 
@@ -1053,7 +1134,7 @@ bool TridentScan::first(uint64_t el, bool constrained) {
 
     if (itr->hasNext()) {
         itr->next();
-        return true;
+        return skipRejected(true);
     } else {
         q->releaseItr(itr);
         itr = NULL;
@@ -1080,7 +1161,7 @@ bool TridentScan::first(uint64_t el1, bool constrained1, uint64_t el2, bool cons
     }
     if (itr->hasNext()) {
         itr->next();
-        return true;
+        return skipRejected(true);
     } else {
         q->releaseItr(itr);
         itr = NULL;
@@ -1115,7 +1196,7 @@ bool TridentScan::first(uint64_t el1, bool constrained1, uint64_t el2,
         q->releaseItr(itr);
         itr = NULL;
     }
-    return resp;
+    return skipRejected(resp);
 }
 
 TridentScan::~TridentScan() {
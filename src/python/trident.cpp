@@ -27,12 +27,17 @@
 #include <python/trident.h>
 #include <trident/kb/kb.h>
 #include <trident/kb/querier.h>
+#include <trident/kb/fcdict.h>
+#include <trident/utils/parallel.h>
 #include <trident/tree/stringbuffer.h>
 #include <trident/loader.h>
 
 #include <kognac/logs.h>
 #include <kognac/utils.h>
 
+//Number of pairs read at once from the storage layer
+#define PY_BATCH_SIZE 1024
+
 using namespace std;
 
 static PyObject *glob_set_logging_level(PyObject *self, PyObject *args) {
@@ -174,6 +179,34 @@ static PyObject *db_exists(PyObject *self, PyObject *args) {
     return PyBool_FromLong(nresults);
 }
 
+static PyObject *db_existsMany(PyObject *self, PyObject *args) {
+    PyObject *list;
+    if (!PyArg_ParseTuple(args, "O", &list))
+        return NULL;
+    PyObject *seq = PySequence_Fast(list, "The argument must be a list of triples");
+    if (seq == NULL)
+        return NULL;
+    const size_t n = PySequence_Fast_GET_SIZE(seq);
+    std::vector<int64_t> s(n), p(n), o(n);
+    for (size_t i = 0; i < n; ++i) {
+        PyObject *t = PySequence_Fast_GET_ITEM(seq, i);
+        if (!PyArg_ParseTuple(t, "lll", &s[i], &p[i], &o[i])) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+    }
+    Py_DECREF(seq);
+
+    Querier *q = ((trident_Db*)self)->q;
+    std::unique_ptr<bool[]> found(new bool[n]);
+    q->existsMany(s.data(), p.data(), o.data(), n, found.get());
+    PyObject *obj = PyList_New(n);
+    for (size_t i = 0; i < n; ++i) {
+        PyList_SetItem(obj, i, PyBool_FromLong(found[i]));
+    }
+    return obj;
+}
+
 static PyObject *db_existsQuery(PyObject *self, PyObject *args) {
     int64_t term;
     PyObject *tuple;
@@ -575,12 +608,14 @@ static PyObject *db_allo(PyObject *self, PyObject *args) {
     Querier *q = ((trident_Db*)self)->q;
     PyObject *obj = PyList_New(0);
     PairItr *itr = q->getPermuted(IDX_SPO, s, p, -1, true);
-    while (itr->hasNext()) {
-        itr->next();
-        int64_t o = itr->getValue2();
-        PyObject *value = PyLong_FromLong(o);
-        PyList_Append(obj, value);
-        Py_DECREF(value);
+    std::vector<uint64_t> v1(PY_BATCH_SIZE), v2(PY_BATCH_SIZE);
+    size_t n;
+    while ((n = itr->nextBatch(v1.data(), v2.data(), PY_BATCH_SIZE)) > 0) {
+        for (size_t i = 0; i < n; ++i) {
+            PyObject *value = PyLong_FromLong(v2[i]);
+            PyList_Append(obj, value);
+            Py_DECREF(value);
+        }
     }
 
     q->releaseItr(itr);
@@ -629,15 +664,16 @@ static PyObject *db_allpo(PyObject *self, PyObject *args) {
     Querier *q = ((trident_Db*)self)->q;
     PyObject *obj = PyList_New(0);
     PairItr *itr = q->getPermuted(IDX_SPO, s, -1, -1, true);
-    while (itr->hasNext()) {
-        itr->next();
-        int64_t p = itr->getValue1();
-        int64_t o = itr->getValue2();
-        PyObject *t = PyTuple_New(2);
-        PyTuple_SetItem(t, 0, PyLong_FromLong(p));
-        PyTuple_SetItem(t, 1, PyLong_FromLong(o));
-        PyList_Append(obj, t);
-        Py_DECREF(t);
+    std::vector<uint64_t> v1(PY_BATCH_SIZE), v2(PY_BATCH_SIZE);
+    size_t n;
+    while ((n = itr->nextBatch(v1.data(), v2.data(), PY_BATCH_SIZE)) > 0) {
+        for (size_t i = 0; i < n; ++i) {
+            PyObject *t = PyTuple_New(2);
+            PyTuple_SetItem(t, 0, PyLong_FromLong(v1[i]));
+            PyTuple_SetItem(t, 1, PyLong_FromLong(v2[i]));
+            PyList_Append(obj, t);
+            Py_DECREF(t);
+        }
     }
     q->releaseItr(itr);
     return obj;
@@ -650,15 +686,16 @@ static PyObject *db_allps(PyObject *self, PyObject *args) {
     Querier *q = ((trident_Db*)self)->q;
     PyObject *obj = PyList_New(0);
     PairItr *itr = q->getPermuted(IDX_OPS, o, -1, -1, true);
-    while (itr->hasNext()) {
-        itr->next();
-        int64_t p = itr->getValue1();
-        int64_t s = itr->getValue2();
-        PyObject *t = PyTuple_New(2);
-        PyTuple_SetItem(t, 0, PyLong_FromLong(p));
-        PyTuple_SetItem(t, 1, PyLong_FromLong(s));
-        PyList_Append(obj, t);
-        Py_DECREF(t);
+    std::vector<uint64_t> v1(PY_BATCH_SIZE), v2(PY_BATCH_SIZE);
+    size_t n;
+    while ((n = itr->nextBatch(v1.data(), v2.data(), PY_BATCH_SIZE)) > 0) {
+        for (size_t i = 0; i < n; ++i) {
+            PyObject *t = PyTuple_New(2);
+            PyTuple_SetItem(t, 0, PyLong_FromLong(v1[i]));
+            PyTuple_SetItem(t, 1, PyLong_FromLong(v2[i]));
+            PyList_Append(obj, t);
+            Py_DECREF(t);
+        }
     }
     q->releaseItr(itr);
     return obj;
@@ -671,15 +708,16 @@ static PyObject *db_allos(PyObject *self, PyObject *args) {
     Querier *q = ((trident_Db*)self)->q;
     PyObject *obj = PyList_New(0);
     PairItr *itr = q->getPermuted(IDX_POS, p, -1, -1, true);
-    while (itr->hasNext()) {
-        itr->next();
-        int64_t o = itr->getValue1();
-        int64_t s = itr->getValue2();
-        PyObject *t = PyTuple_New(2);
-        PyTuple_SetItem(t, 0, PyLong_FromLong(s));
-        PyTuple_SetItem(t, 1, PyLong_FromLong(o));
-        PyList_Append(obj, t);
-        Py_DECREF(t);
+    std::vector<uint64_t> v1(PY_BATCH_SIZE), v2(PY_BATCH_SIZE);
+    size_t n;
+    while ((n = itr->nextBatch(v1.data(), v2.data(), PY_BATCH_SIZE)) > 0) {
+        for (size_t i = 0; i < n; ++i) {
+            PyObject *t = PyTuple_New(2);
+            PyTuple_SetItem(t, 0, PyLong_FromLong(v2[i]));
+            PyTuple_SetItem(t, 1, PyLong_FromLong(v1[i]));
+            PyList_Append(obj, t);
+            Py_DECREF(t);
+        }
     }
     q->releaseItr(itr);
     return obj;
@@ -716,6 +754,40 @@ static PyObject * db_lookup_str(PyObject *self, PyObject *args) {
     }
 }
 
+static PyObject *db_lookup_strs(PyObject *self, PyObject *args) {
+    PyObject *list;
+    if (!PyArg_ParseTuple(args, "O", &list))
+        return NULL;
+    PyObject *seq = PySequence_Fast(list, "The argument must be a list of IDs");
+    if (seq == NULL)
+        return NULL;
+    const size_t n = PySequence_Fast_GET_SIZE(seq);
+    std::vector<uint64_t> ids(n);
+    for (size_t i = 0; i < n; ++i) {
+        ids[i] = PyLong_AsLong(PySequence_Fast_GET_ITEM(seq, i));
+    }
+    Py_DECREF(seq);
+    if (PyErr_Occurred())
+        return NULL;
+
+    KB *kb = ((trident_Db*)self)->kb;
+    std::unique_ptr<std::string[]> texts(new std::string[n]);
+    std::unique_ptr<bool[]> found(new bool[n]);
+    kb->getDictMgmt()->getTexts(ids.data(), n, texts.get(), found.get(),
+            ParallelTasks::getDefaultNThreads());
+    PyObject *obj = PyList_New(n);
+    for (size_t i = 0; i < n; ++i) {
+        if (found[i]) {
+            PyList_SetItem(obj, i, PyUnicode_FromStringAndSize(
+                        texts[i].c_str(), texts[i].size()));
+        } else {
+            Py_INCREF(Py_None);
+            PyList_SetItem(obj, i, Py_None);
+        }
+    }
+    return obj;
+}
+
 static PyObject * db_lookup_relstr(PyObject *self, PyObject *args) {
     int64_t id;
     if (!PyArg_ParseTuple(args, "l", &id))
@@ -734,21 +806,55 @@ static PyObject * db_lookup_relstr(PyObject *self, PyObject *args) {
 
 static PyObject * db_search_id(PyObject *self, PyObject *args) {
     const char *term;
-    if (!PyArg_ParseTuple(args, "s", &term))
+    int prefix = 0;
+    if (!PyArg_ParseTuple(args, "s|p", &term, &prefix))
         return NULL;
     KB *kb = ((trident_Db*)self)->kb;
     DictMgmt *mgmt = kb->getDictMgmt();
-    TreeItr *itr = mgmt->getInvDictIterator();
-    StringBuffer *sb = mgmt->getStringBuffer();
     string sTermToSearch(term);
     PyObject *obj = PyList_New(0);
+    std::vector<uint64_t> ids;
+    std::vector<string> texts;
+    if (mgmt->searchText(sTermToSearch, prefix, ids, &texts, UINT64_MAX,
+                ParallelTasks::getDefaultNThreads())) {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            PyObject *t = PyTuple_New(2);
+            PyTuple_SetItem(t, 0, PyLong_FromLong(ids[i]));
+            PyTuple_SetItem(t, 1, PyUnicode_FromStringAndSize(texts[i].c_str(),
+                        texts[i].size()));
+            PyList_Append(obj, t);
+            Py_DECREF(t);
+        }
+        return obj;
+    }
+    //Without the text index all the terms are scanned
+    FCDict *fcdict = mgmt->getFCDict();
+    if (fcdict != NULL) {
+        char text[MAX_TERM_SIZE];
+        for (uint64_t rank = 0; rank < fcdict->getNTerms(); ++rank) {
+            const int size = fcdict->getTextAtRank(rank, text);
+            string sTerm(text, size);
+            const size_t pos = sTerm.find(sTermToSearch);
+            if (pos != string::npos && (!prefix || pos == 0)) {
+                PyObject *t = PyTuple_New(2);
+                PyTuple_SetItem(t, 0, PyLong_FromLong(fcdict->getIDAtRank(rank)));
+                PyTuple_SetItem(t, 1, PyUnicode_FromStringAndSize(text, size));
+                PyList_Append(obj, t);
+                Py_DECREF(t);
+            }
+        }
+        return obj;
+    }
+    TreeItr *itr = mgmt->getInvDictIterator();
+    StringBuffer *sb = mgmt->getStringBuffer();
     while (itr->hasNext()) {
         int64_t value;
         int64_t key = itr->next(value);
         int size;
         const char *text = sb->get(value, size);
         string sTerm(text, size);
-        if (sTerm.find(sTermToSearch) != string::npos) {
+        const size_t pos = sTerm.find(sTermToSearch);
+        if (pos != string::npos && (!prefix || pos == 0)) {
             PyObject *t = PyTuple_New(2);
             PyTuple_SetItem(t, 0, PyLong_FromLong(key));
             PyTuple_SetItem(t, 1, PyUnicode_FromStringAndSize(text, size));
@@ -788,6 +894,7 @@ static PyMethodDef Db_methods[] = {
     {"count_o", db_counto, METH_VARARGS, "Get the number of triples with the same object" },
     {"count_p", db_countp, METH_VARARGS, "Get the number of triples with the same predicate" },
     {"exists", db_exists, METH_VARARGS, "Check if the given triple exists" },
+    {"exists_many", db_existsMany, METH_VARARGS, "Check which triples of a list exist. Returns a list of booleans." },
     {"existsQuery", db_existsQuery, METH_VARARGS, "Check if the given triple exists among the results of a given pattern" },
     {"n_terms", db_nterms, METH_VARARGS, "Get the number of terms in the graph" },
     {"n_relations", db_nrels, METH_VARARGS, "Get the number of relations in the graph. This method works only if the KG used independent encoding for the relations." },
@@ -801,8 +908,9 @@ static PyMethodDef Db_methods[] = {
     {"outdegree", db_outdegree, METH_VARARGS, "Get the list of all nodes with their outdegrees" },
     {"lookup_id", db_lookup_id, METH_VARARGS, "Lookup for the ID of an input term" },
     {"lookup_str", db_lookup_str, METH_VARARGS, "Lookup for the textual version of an entity ID" },
+    {"lookup_strs", db_lookup_strs, METH_VARARGS, "Lookup for the textual versions of a list of entity IDs. Returns a list with None for the unknown IDs." },
     {"lookup_relstr", db_lookup_relstr, METH_VARARGS, "Lookup for the textual version of a relation ID" },
-    {"search_id", db_search_id, METH_VARARGS, "Search for the IDs of terms" },
+    {"search_id", db_search_id, METH_VARARGS, "Search for the IDs of the terms that contain a string (or start with it, if the second argument is True)" },
     {"load", (PyCFunction) db_loadFromFiles, METH_VARARGS | METH_KEYWORDS, "Load a graph from a set of files." },
     {NULL, NULL, 0, NULL}        /* Sentinel */
 };
@@ -46,6 +46,9 @@ bool Trident_TNGraph::getNodeInfo(TermCoordinates &coord,
             const char nbytes1 = (strategy >> 3) & 3;
             const char nbytes2 = (strategy >> 1) & 3;
             FactoryNewRowTable::getReader(nbytes1, nbytes2, &ospReader);
+        } else if (storageType == PACKED_STORAGE) {
+            LOG(ERRORL) << "Packed tables do not support random access";
+            throw 10;
         } else {
             const char nbytes1 = (strategy >> 3) & 3;
             const char nbytes2 = (strategy >> 1) & 3;
@@ -81,6 +84,9 @@ bool Trident_TNGraph::getNodeInfo(TermCoordinates &coord,
             const char nbytes1 = (strategy >> 3) & 3;
             const char nbytes2 = (strategy >> 1) & 3;
             FactoryNewRowTable::getReader(nbytes1, nbytes2, &sopReader);
+        } else if (storageType == PACKED_STORAGE) {
+            LOG(ERRORL) << "Packed tables do not support random access";
+            throw 10;
         } else {
             const char nbytes1 = (strategy >> 3) & 3;
             const char nbytes2 = (strategy >> 1) & 3;
@@ -0,0 +1,366 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/binarytables/batchreaders.h>
+
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define BATCH_X86 1
+#include <immintrin.h>
+#else
+#define BATCH_X86 0
+#endif
+
+template<int nbytes>
+static inline uint64_t readBE(const char *buffer) {
+    uint64_t v = 0;
+    for (int i = 0; i < nbytes; ++i) {
+        v = (v << 8) | (uint8_t) buffer[i];
+    }
+    return v;
+}
+
+static inline uint64_t readBE(const char *buffer, const uint8_t nbytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < nbytes; ++i) {
+        v = (v << 8) | (uint8_t) buffer[i];
+    }
+    return v;
+}
+
+template<int nbytes>
+static void scalarColumn(const char *buffer, const size_t n, uint64_t *out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = readBE<nbytes>(buffer);
+        buffer += nbytes;
+    }
+}
+
+static void scalarColumn(const char *buffer, const uint8_t nbytes,
+        const size_t n, uint64_t *out) {
+    switch (nbytes) {
+        case 1:
+            scalarColumn<1>(buffer, n, out);
+            break;
+        case 2:
+            scalarColumn<2>(buffer, n, out);
+            break;
+        case 3:
+            scalarColumn<3>(buffer, n, out);
+            break;
+        case 4:
+            scalarColumn<4>(buffer, n, out);
+            break;
+        case 5:
+            scalarColumn<5>(buffer, n, out);
+            break;
+        default:
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = readBE(buffer, nbytes);
+                buffer += nbytes;
+            }
+    }
+}
+
+static void scalarRows(const char *buffer, const uint8_t nbytes1,
+        const uint8_t nbytes2, const size_t n, uint64_t *out1,
+        uint64_t *out2) {
+    for (size_t i = 0; i < n; ++i) {
+        out1[i] = readBE(buffer, nbytes1);
+        buffer += nbytes1;
+        out2[i] = readBE(buffer, nbytes2);
+        buffer += nbytes2;
+    }
+}
+
+static inline uint32_t loadWord(const char *buffer, const size_t idx) {
+    uint32_t w;
+    memcpy(&w, buffer + idx * 4, 4);
+    return w;
+}
+
+static void scalarUnpack(const char *buffer, const uint8_t bits,
+        uint32_t *out) {
+    const uint32_t mask = bits == 32 ? ~0u : (1u << bits) - 1;
+    for (int lane = 0; lane < 4; ++lane) {
+        size_t word = 0;
+        int shift = 0;
+        uint32_t w = loadWord(buffer, lane);
+        for (int j = 0; j < 32; ++j) {
+            uint64_t v = w >> shift;
+            shift += bits;
+            if (shift >= 32) {
+                shift -= 32;
+                if (j < 31) {
+                    w = loadWord(buffer, ++word * 4 + lane);
+                    if (shift > 0) {
+                        v |= (uint64_t) w << (bits - shift);
+                    }
+                }
+            }
+            out[j * 4 + lane] = (uint32_t) v & mask;
+        }
+    }
+}
+
+#if BATCH_X86
+//SSE2 is always available on x86-64
+static void sse2Unpack(const char *buffer, const uint8_t bits,
+        uint32_t *out) {
+    const __m128i mask = _mm_set1_epi32(bits == 32 ? ~0u : (1u << bits) - 1);
+    const __m128i *in = (const __m128i*) buffer;
+    __m128i w = _mm_loadu_si128(in++);
+    int shift = 0;
+    for (int j = 0; j < 32; ++j) {
+        __m128i v = _mm_srl_epi32(w, _mm_cvtsi32_si128(shift));
+        shift += bits;
+        if (shift >= 32) {
+            shift -= 32;
+            if (j < 31) {
+                w = _mm_loadu_si128(in++);
+                if (shift > 0) {
+                    v = _mm_or_si128(v, _mm_sll_epi32(w,
+                                _mm_cvtsi32_si128(bits - shift)));
+                }
+            }
+        }
+        _mm_storeu_si128((__m128i*) (out + j * 4), _mm_and_si128(v, mask));
+    }
+}
+
+//Fill the shuffle mask so that the big-endian value of "nbytes" that starts
+//at "offset" ends up in the 64-bit lane "lane"
+static void setLane(uint8_t *mask, const int lane, const int offset,
+        const int nbytes) {
+    for (int j = 0; j < 8; ++j) {
+        mask[lane * 8 + j] = j < nbytes ? offset + nbytes - 1 - j : 0x80;
+    }
+}
+
+__attribute__((target("ssse3")))
+static size_t ssse3Column(const char *buffer, const uint8_t nbytes,
+        const size_t n, const char *limit, uint64_t *out) {
+    uint8_t m[16];
+    setLane(m, 0, 0, nbytes);
+    setLane(m, 1, nbytes, nbytes);
+    const __m128i mask = _mm_loadu_si128((const __m128i*) m);
+    const size_t step = 2 * nbytes;
+    size_t i = 0;
+    while (i + 2 <= n && buffer + 16 <= limit) {
+        const __m128i x = _mm_loadu_si128((const __m128i*) buffer);
+        _mm_storeu_si128((__m128i*) (out + i), _mm_shuffle_epi8(x, mask));
+        buffer += step;
+        i += 2;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t avx2Column(const char *buffer, const uint8_t nbytes,
+        const size_t n, const char *limit, uint64_t *out) {
+    //The shuffle works within each 128-bit half, so both halves get the
+    //same mask and the second half is loaded 2 values further
+    uint8_t m[32];
+    setLane(m, 0, 0, nbytes);
+    setLane(m, 1, nbytes, nbytes);
+    setLane(m, 2, 0, nbytes);
+    setLane(m, 3, nbytes, nbytes);
+    const __m256i mask = _mm256_loadu_si256((const __m256i*) m);
+    const size_t step = 4 * nbytes;
+    size_t i = 0;
+    while (i + 4 <= n && buffer + 2 * nbytes + 16 <= limit) {
+        const __m128i lo = _mm_loadu_si128((const __m128i*) buffer);
+        const __m128i hi = _mm_loadu_si128((const __m128i*)
+                (buffer + 2 * nbytes));
+        const __m256i x = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(lo), hi, 1);
+        _mm256_storeu_si256((__m256i*) (out + i),
+                _mm256_shuffle_epi8(x, mask));
+        buffer += step;
+        i += 4;
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+static size_t ssse3Rows(const char *buffer, const uint8_t nbytes1,
+        const uint8_t nbytes2, const size_t n, const char *limit,
+        uint64_t *out1, uint64_t *out2) {
+    //One row per shuffle: first value in the low lane, second in the high
+    uint8_t m[16];
+    setLane(m, 0, 0, nbytes1);
+    setLane(m, 1, nbytes1, nbytes2);
+    const __m128i mask = _mm_loadu_si128((const __m128i*) m);
+    const size_t rowsize = nbytes1 + nbytes2;
+    size_t i = 0;
+    while (i + 2 <= n && buffer + rowsize + 16 <= limit) {
+        const __m128i a = _mm_shuffle_epi8(
+                _mm_loadu_si128((const __m128i*) buffer), mask);
+        const __m128i b = _mm_shuffle_epi8(
+                _mm_loadu_si128((const __m128i*) (buffer + rowsize)), mask);
+        _mm_storeu_si128((__m128i*) (out1 + i), _mm_unpacklo_epi64(a, b));
+        _mm_storeu_si128((__m128i*) (out2 + i), _mm_unpackhi_epi64(a, b));
+        buffer += 2 * rowsize;
+        i += 2;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t avx2Rows(const char *buffer, const uint8_t nbytes1,
+        const uint8_t nbytes2, const size_t n, const char *limit,
+        uint64_t *out1, uint64_t *out2) {
+    uint8_t m[32];
+    setLane(m, 0, 0, nbytes1);
+    setLane(m, 1, nbytes1, nbytes2);
+    setLane(m, 2, 0, nbytes1);
+    setLane(m, 3, nbytes1, nbytes2);
+    const __m256i mask = _mm256_loadu_si256((const __m256i*) m);
+    const size_t rowsize = nbytes1 + nbytes2;
+    size_t i = 0;
+    while (i + 4 <= n && buffer + 3 * rowsize + 16 <= limit) {
+        //x = rows 0 and 1, y = rows 2 and 3
+        const __m256i x = _mm256_shuffle_epi8(_mm256_inserti128_si256(
+                    _mm256_castsi128_si256(
+                        _mm_loadu_si128((const __m128i*) buffer)),
+                    _mm_loadu_si128((const __m128i*) (buffer + rowsize)), 1),
+                mask);
+        const __m256i y = _mm256_shuffle_epi8(_mm256_inserti128_si256(
+                    _mm256_castsi128_si256(
+                        _mm_loadu_si128((const __m128i*)
+                            (buffer + 2 * rowsize))),
+                    _mm_loadu_si128((const __m128i*)
+                        (buffer + 3 * rowsize)), 1),
+                mask);
+        //unpack gives rows (0,2 | 1,3). Permute to restore the order.
+        const __m256i v1 = _mm256_permute4x64_epi64(
+                _mm256_unpacklo_epi64(x, y), 0xD8);
+        const __m256i v2 = _mm256_permute4x64_epi64(
+                _mm256_unpackhi_epi64(x, y), 0xD8);
+        _mm256_storeu_si256((__m256i*) (out1 + i), v1);
+        _mm256_storeu_si256((__m256i*) (out2 + i), v2);
+        buffer += 4 * rowsize;
+        i += 4;
+    }
+    return i;
+}
+#endif
+
+static int detectMode() {
+#if BATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return BATCH_AVX2;
+    } else if (__builtin_cpu_supports("ssse3")) {
+        return BATCH_SSSE3;
+    }
+#endif
+    return BATCH_SCALAR;
+}
+
+static const int supportedMode = detectMode();
+static int currentMode = supportedMode;
+
+int BatchReader::getMode() {
+    return currentMode;
+}
+
+void BatchReader::setMode(int mode) {
+    currentMode = mode < supportedMode ? mode : supportedMode;
+}
+
+void BatchReader::readColumn(const char *buffer, const uint8_t nbytes,
+        const size_t n, const char *limit, uint64_t *out) {
+    size_t done = 0;
+#if BATCH_X86
+    if (nbytes <= 8) {
+        if (currentMode == BATCH_AVX2) {
+            done = avx2Column(buffer, nbytes, n, limit, out);
+        }
+        if (currentMode >= BATCH_SSSE3) {
+            done += ssse3Column(buffer + done * nbytes, nbytes, n - done,
+                    limit, out + done);
+        }
+    }
+#endif
+    scalarColumn(buffer + done * nbytes, nbytes, n - done, out + done);
+}
+
+void BatchReader::readRows(const char *buffer, const uint8_t nbytes1,
+        const uint8_t nbytes2, const size_t n, const char *limit,
+        uint64_t *out1, uint64_t *out2) {
+    size_t done = 0;
+    const size_t rowsize = nbytes1 + nbytes2;
+#if BATCH_X86
+    if (nbytes1 <= 8 && nbytes2 <= 8) {
+        if (currentMode == BATCH_AVX2) {
+            done = avx2Rows(buffer, nbytes1, nbytes2, n, limit, out1, out2);
+        }
+        if (currentMode >= BATCH_SSSE3) {
+            done += ssse3Rows(buffer + done * rowsize, nbytes1, nbytes2,
+                    n - done, limit, out1 + done, out2 + done);
+        }
+    }
+#endif
+    scalarRows(buffer + done * rowsize, nbytes1, nbytes2, n - done,
+            out1 + done, out2 + done);
+}
+
+void BatchReader::unpackBits(const char *buffer, const uint8_t bits,
+        uint32_t *out) {
+    if (bits == 0) {
+        memset(out, 0, sizeof(uint32_t) * 128);
+        return;
+    }
+#if BATCH_X86
+    if (currentMode != BATCH_SCALAR) {
+        sse2Unpack(buffer, bits, out);
+        return;
+    }
+#endif
+    scalarUnpack(buffer, bits, out);
+}
+
+void BatchReader::packBits(const uint32_t *values, const uint8_t bits,
+        char *out) {
+    if (bits == 0) {
+        return;
+    }
+    const uint32_t mask = bits == 32 ? ~0u : (1u << bits) - 1;
+    for (int lane = 0; lane < 4; ++lane) {
+        size_t word = 0;
+        int shift = 0;
+        uint32_t acc = 0;
+        for (int j = 0; j < 32; ++j) {
+            const uint32_t v = values[j * 4 + lane] & mask;
+            acc |= (uint32_t) ((uint64_t) v << shift);
+            shift += bits;
+            if (shift >= 32) {
+                memcpy(out + (word * 4 + lane) * 4, &acc, 4);
+                word++;
+                shift -= 32;
+                acc = shift > 0 ? v >> (bits - shift) : 0;
+            }
+        }
+    }
+}
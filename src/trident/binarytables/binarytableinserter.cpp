@@ -22,6 +22,8 @@
 
 #include <trident/binarytables/binarytableinserter.h>
 
+#include <algorithm>
+
 string BinaryTableInserter::getRootDir() {
     return manager->getCacheDir();
 }
@@ -41,6 +43,16 @@ void BinaryTableInserter::overwriteVLong2(short file, uint64_t pos, int64_t numb
     manager->overwriteVLong2At(file, pos, number);
 }
 
+void BinaryTableInserter::writeBytes(const char *bytes, const uint64_t size) {
+    uint64_t written = 0;
+    while (written < size) {
+        const int len = (int) std::min(size - written, (uint64_t) 1024 * 1024);
+        manager->append((char*) bytes + written, len);
+        written += len;
+    }
+    currentPos += size;
+}
+
 //reserve "bytes" consecutive bytes
 void BinaryTableInserter::reserveBytes(const uint8_t bytes) {
     manager->reserveBytes(bytes);
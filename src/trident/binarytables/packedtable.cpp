@@ -0,0 +1,245 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/binarytables/packedtable.h>
+#include <trident/binarytables/batchreaders.h>
+
+#include <kognac/utils.h>
+
+#include <algorithm>
+#include <cstring>
+
+void PackedTable::setup(const char* start, const char *end) {
+    initializeConstraints();
+    this->start = start;
+    this->end = end;
+
+    const uint8_t header1 = (uint8_t) start[0];
+    bytesPerFirstEntry = header1 >> 4;
+    bytesPerSecondEntry = header1 & 15;
+    bytesPerOffset = (uint8_t) start[1];
+    bytesPerDirectoryEntry = 2 * (bytesPerFirstEntry + bytesPerSecondEntry)
+        + bytesPerOffset;
+    int offset = 2;
+    nRows = Utils::decode_vlong2(start, &offset);
+    nUniqueFirstTerms = Utils::decode_vlong2(start, &offset);
+    nBlocks = (nRows + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE;
+    directory = start + offset;
+    data = directory + nBlocks * bytesPerDirectoryEntry;
+
+    startRow = currentRow = lastRow = 0;
+    endRow = nRows;
+    currentValue1 = currentValue2 = -1;
+    count = 1;
+    isSecondColumnIgnored = false;
+    decodedBlock = -1;
+}
+
+void PackedTable::setup(int64_t c1, const char* s, const char *e) {
+    setup(s, e);
+    const uint64_t row = findRow(c1, -1, 0);
+    if (row < endRow) {
+        readRow(row);
+    }
+    if (row < endRow && currentValue1 == c1) {
+        startRow = row;
+        endRow = findRow(c1 + 1, -1, row);
+        nUniqueFirstTerms = 1;
+    } else {
+        //Make it fail
+        startRow = endRow;
+        nUniqueFirstTerms = 0;
+    }
+    currentRow = lastRow = startRow;
+    currentValue1 = currentValue2 = -1;
+}
+
+void PackedTable::setup(int64_t c1, int64_t c2, const char* s, const char *e) {
+    setup(s, e);
+    const uint64_t row = findRow(c1, c2, 0);
+    if (row < endRow) {
+        readRow(row);
+    }
+    if (row < endRow && currentValue1 == c1 && currentValue2 == c2) {
+        startRow = row;
+        endRow = row + 1;
+        nUniqueFirstTerms = 1;
+    } else {
+        //Make it fail
+        startRow = endRow;
+        nUniqueFirstTerms = 0;
+    }
+    currentRow = lastRow = startRow;
+    currentValue1 = currentValue2 = -1;
+}
+
+const char *PackedTable::decodeColumn(const char *buffer, uint64_t *out) {
+    const uint8_t bits = (uint8_t) buffer[0];
+    const uint8_t nexceptions = (uint8_t) buffer[1];
+    buffer += 2;
+    uint32_t tmp[PACKED_BLOCK_SIZE];
+    BatchReader::unpackBits(buffer, bits, tmp);
+    for (int i = 0; i < PACKED_BLOCK_SIZE; ++i) {
+        out[i] = tmp[i];
+    }
+    buffer += 16 * bits;
+
+    //Patch the values that did not fit in "bits" bits
+    int offset = 0;
+    for (int i = 0; i < nexceptions; ++i) {
+        const uint8_t pos = (uint8_t) buffer[offset++];
+        const uint64_t high = Utils::decode_vlong2(buffer, &offset);
+        out[pos] |= high << bits;
+    }
+    return buffer + offset;
+}
+
+void PackedTable::decodeBlock(const uint64_t block) {
+    if (decodedBlock == (int64_t) block) {
+        return;
+    }
+    assert(block < nBlocks);
+    const char *entry = directory + block * bytesPerDirectoryEntry;
+    const uint64_t firstValue1 = Utils::decode_longFixedBytes(entry,
+            bytesPerFirstEntry);
+    const uint64_t firstValue2 = Utils::decode_longFixedBytes(
+            entry + bytesPerFirstEntry, bytesPerSecondEntry);
+    const uint64_t offset = Utils::decode_longFixedBytes(
+            entry + 2 * (bytesPerFirstEntry + bytesPerSecondEntry),
+            bytesPerOffset);
+
+    const char *buffer = data + offset;
+    buffer = decodeColumn(buffer, values1);
+    decodeColumn(buffer, values2);
+
+    //The first column contains the deltas. The second contains the deltas
+    //if the first value did not change, otherwise the value itself
+    values1[0] = firstValue1;
+    values2[0] = firstValue2;
+    const size_t n = std::min((uint64_t) PACKED_BLOCK_SIZE,
+            nRows - block * PACKED_BLOCK_SIZE);
+    for (size_t i = 1; i < n; ++i) {
+        if (values1[i] == 0) {
+            values1[i] = values1[i - 1];
+            values2[i] += values2[i - 1];
+        } else {
+            values1[i] += values1[i - 1];
+        }
+    }
+    decodedBlock = block;
+}
+
+bool PackedTable::isBlockBefore(const uint64_t block, const int64_t c1,
+        const int64_t c2) const {
+    //Compare (c1,c2) with the last pair of the block
+    const char *entry = directory + block * bytesPerDirectoryEntry
+        + bytesPerFirstEntry + bytesPerSecondEntry;
+    const int64_t last1 = Utils::decode_longFixedBytes(entry,
+            bytesPerFirstEntry);
+    if (last1 != c1) {
+        return last1 < c1;
+    }
+    const int64_t last2 = Utils::decode_longFixedBytes(
+            entry + bytesPerFirstEntry, bytesPerSecondEntry);
+    return last2 < c2;
+}
+
+uint64_t PackedTable::findRow(const int64_t c1, const int64_t c2,
+        const uint64_t from) {
+    if (from >= endRow) {
+        return endRow;
+    }
+
+    //Search on the directory for the first block that can contain the pair.
+    //First gallop from the block of "from", then binary search
+    const char *ps = directory + (from / PACKED_BLOCK_SIZE) * bytesPerDirectoryEntry;
+    const char *pe = directory + ((endRow - 1) / PACKED_BLOCK_SIZE + 1) *
+        bytesPerDirectoryEntry;
+    gallop(ps, pe, bytesPerDirectoryEntry, [this, c1, c2](const char *p) {
+            return isBlockBefore((p - directory) / bytesPerDirectoryEntry, c1, c2);
+            });
+    uint64_t s = (ps - directory) / bytesPerDirectoryEntry;
+    uint64_t e = (pe - directory) / bytesPerDirectoryEntry;
+    while (s < e) {
+        const uint64_t middle = s + (e - s) / 2;
+        if (isBlockBefore(middle, c1, c2)) {
+            s = middle + 1;
+        } else {
+            e = middle;
+        }
+    }
+    if (s * PACKED_BLOCK_SIZE >= endRow) {
+        return endRow;
+    }
+
+    //Binary search within the block
+    decodeBlock(s);
+    const uint64_t base = s * PACKED_BLOCK_SIZE;
+    uint64_t lo = std::max(from, base) - base;
+    uint64_t hi = std::min(endRow - base, (uint64_t) PACKED_BLOCK_SIZE);
+    while (lo < hi) {
+        const uint64_t middle = lo + (hi - lo) / 2;
+        const int64_t v1 = values1[middle];
+        if (v1 < c1 || (v1 == c1 && (int64_t) values2[middle] < c2)) {
+            lo = middle + 1;
+        } else {
+            hi = middle;
+        }
+    }
+    return base + lo;
+}
+
+void PackedTable::moveto(const int64_t c1, const int64_t c2) {
+    assert(currentValue1 != -1);
+    assert(isSecondColumnIgnored || currentValue2 != -1);
+    if (c1 > currentValue1 ||
+            (!isSecondColumnIgnored && c1 == currentValue1 && c2 > currentValue2)) {
+        currentRow = findRow(c1, isSecondColumnIgnored ? -1 : c2, currentRow);
+    } else {
+        //Go back so that next() returns the current entry again
+        currentRow = lastRow;
+    }
+}
+
+size_t PackedTable::nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+    if (isSecondColumnIgnored) {
+        return AbsNewTable::nextBatch(v1, v2, max);
+    }
+    size_t n = 0;
+    while (n < max && currentRow < endRow) {
+        const uint64_t block = currentRow / PACKED_BLOCK_SIZE;
+        decodeBlock(block);
+        const uint64_t base = block * PACKED_BLOCK_SIZE;
+        const size_t toread = std::min((size_t) (std::min(endRow,
+                        base + PACKED_BLOCK_SIZE) - currentRow), max - n);
+        memcpy(v1 + n, values1 + (currentRow - base), sizeof(uint64_t) * toread);
+        memcpy(v2 + n, values2 + (currentRow - base), sizeof(uint64_t) * toread);
+        currentRow += toread;
+        n += toread;
+    }
+    if (n > 0) {
+        lastRow = currentRow - 1;
+        currentValue1 = v1[n - 1];
+        currentValue2 = v2[n - 1];
+    }
+    return n;
+}
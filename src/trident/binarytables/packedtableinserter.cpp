@@ -0,0 +1,241 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/binarytables/packedtableinserter.h>
+#include <trident/binarytables/batchreaders.h>
+
+#include <kognac/utils.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+static int nbits(uint64_t v) {
+    int n = 0;
+    while (v > 0) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+}
+
+void PackedTableInserter::compressColumn(const uint64_t *values,
+        std::vector<char> &out) {
+    //Pick the number of bits that minimizes the space. Every value that
+    //needs w > bits bits costs one byte for the position plus the high bits
+    int hist[65];
+    memset(hist, 0, sizeof(int) * 65);
+    for (int i = 0; i < PACKED_BLOCK_SIZE; ++i) {
+        hist[nbits(values[i])]++;
+    }
+    uint8_t bits = 32;
+    int64_t minCost = INT64_MAX;
+    for (int b = 0; b <= 32; ++b) {
+        int64_t cost = 16 * b;
+        for (int w = b + 1; w <= 64; ++w) {
+            cost += hist[w] * (1 + (w - b + 6) / 7);
+        }
+        if (cost < minCost) {
+            minCost = cost;
+            bits = b;
+        }
+    }
+
+    uint32_t low[PACKED_BLOCK_SIZE];
+    uint8_t nexceptions = 0;
+    for (int i = 0; i < PACKED_BLOCK_SIZE; ++i) {
+        low[i] = (uint32_t) values[i];
+        if (nbits(values[i]) > bits) {
+            nexceptions++;
+        }
+    }
+    out.push_back(bits);
+    out.push_back(nexceptions);
+    const size_t pos = out.size();
+    out.resize(pos + 16 * bits);
+    BatchReader::packBits(low, bits, out.data() + pos);
+
+    char buffer[16];
+    for (int i = 0; i < PACKED_BLOCK_SIZE; ++i) {
+        if (nbits(values[i]) > bits) {
+            buffer[0] = (char) i;
+            const int len = Utils::encode_vlong2(buffer, 1, values[i] >> bits);
+            out.insert(out.end(), buffer, buffer + len);
+        }
+    }
+}
+
+void PackedTableInserter::compressBlock(const uint64_t *v1, const uint64_t *v2,
+        const size_t n, std::vector<char> &out) {
+    assert(n > 0 && n <= PACKED_BLOCK_SIZE);
+    //The first pair is stored in the directory. Unused rows are zero.
+    uint64_t d1[PACKED_BLOCK_SIZE];
+    uint64_t d2[PACKED_BLOCK_SIZE];
+    d1[0] = d2[0] = 0;
+    for (size_t i = 1; i < n; ++i) {
+        d1[i] = v1[i] - v1[i - 1];
+        if (d1[i] == 0) {
+            d2[i] = v2[i] - v2[i - 1];
+        } else {
+            d2[i] = v2[i];
+        }
+    }
+    for (size_t i = n; i < PACKED_BLOCK_SIZE; ++i) {
+        d1[i] = d2[i] = 0;
+    }
+    compressColumn(d1, out);
+    compressColumn(d2, out);
+}
+
+uint64_t PackedTableInserter::estimateSize(const int64_t *v1,
+        const int64_t *v2, const size_t n) {
+    uint64_t size = 0;
+    int64_t maxValue1 = 0;
+    int64_t maxValue2 = 0;
+    std::vector<char> tmp;
+    uint64_t b1[PACKED_BLOCK_SIZE];
+    uint64_t b2[PACKED_BLOCK_SIZE];
+    for (size_t i = 0; i < n; i += PACKED_BLOCK_SIZE) {
+        const size_t m = std::min((size_t) PACKED_BLOCK_SIZE, n - i);
+        for (size_t j = 0; j < m; ++j) {
+            b1[j] = v1[i + j];
+            b2[j] = v2[i + j];
+            maxValue1 = std::max(maxValue1, v1[i + j]);
+            maxValue2 = std::max(maxValue2, v2[i + j]);
+        }
+        tmp.clear();
+        compressBlock(b1, b2, m, tmp);
+        size += tmp.size();
+    }
+    const uint64_t nblocks = (n + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE;
+    const uint64_t sizeEntry = 2 * (Utils::numBytesFixedLength(maxValue1) +
+            Utils::numBytesFixedLength(maxValue2)) +
+        Utils::numBytesFixedLength(size);
+    return size + nblocks * sizeEntry + 10;
+}
+
+void PackedTableInserter::startAppend() {
+    values1.clear();
+    values2.clear();
+    directory.clear();
+    blocks.clear();
+    largestElement1 = largestElement2 = 0;
+    nRows = nUniqueFirstTerms = 0;
+    prevel1 = -1;
+    offloadedBytes = 0;
+    fileopen = false;
+}
+
+void PackedTableInserter::append(int64_t t1, int64_t t2) {
+    if (t1 != prevel1) {
+        nUniqueFirstTerms++;
+        prevel1 = t1;
+    }
+    if (t1 > largestElement1) {
+        largestElement1 = t1;
+    }
+    if (t2 > largestElement2) {
+        largestElement2 = t2;
+    }
+    values1.push_back(t1);
+    values2.push_back(t2);
+    nRows++;
+    if (values1.size() == PACKED_BLOCK_SIZE) {
+        flushBlock();
+    }
+}
+
+void PackedTableInserter::flushBlock() {
+    directory.push_back(values1.front());
+    directory.push_back(values2.front());
+    directory.push_back(values1.back());
+    directory.push_back(values2.back());
+    directory.push_back(offloadedBytes + blocks.size());
+    compressBlock(values1.data(), values2.data(), values1.size(), blocks);
+    values1.clear();
+    values2.clear();
+
+    //Offload the blocks to disk if they take too much space
+    if (blocks.size() >= thresholdToOffload) {
+        if (!fileopen) {
+            offloadfile.open(getRootDir() + "/tmpfilep" + to_string(perm));
+            fileopen = true;
+        }
+        offloadfile.write(blocks.data(), blocks.size());
+        if (offloadfile.fail()) {
+            LOG(ERRORL) << "Failed in writing the offload file";
+            throw 10;
+        }
+        offloadedBytes += blocks.size();
+        blocks.clear();
+    }
+}
+
+void PackedTableInserter::stopAppend() {
+    if (!values1.empty()) {
+        flushBlock();
+    }
+    const uint64_t totalSize = offloadedBytes + blocks.size();
+    const uint8_t bytesPerFirstEntry = Utils::numBytesFixedLength(largestElement1);
+    const uint8_t bytesPerSecondEntry = Utils::numBytesFixedLength(largestElement2);
+    const uint8_t bytesPerOffset = Utils::numBytesFixedLength(totalSize);
+    if (bytesPerFirstEntry == 0 || bytesPerSecondEntry == 0 ||
+            bytesPerOffset == 0) {
+        LOG(ERRORL) << "Bytes are incorrect";
+        throw 10;
+    }
+
+    //Write the header
+    writeByte((bytesPerFirstEntry << 4) + (bytesPerSecondEntry & 15));
+    writeByte(bytesPerOffset);
+    writeVLong2(nRows);
+    writeVLong2(nUniqueFirstTerms);
+
+    //Write the directory
+    for (size_t i = 0; i < directory.size(); i += 5) {
+        writeLong(bytesPerFirstEntry, directory[i]);
+        writeLong(bytesPerSecondEntry, directory[i + 1]);
+        writeLong(bytesPerFirstEntry, directory[i + 2]);
+        writeLong(bytesPerSecondEntry, directory[i + 3]);
+        writeLong(bytesPerOffset, directory[i + 4]);
+    }
+
+    //Write the blocks that were offloaded
+    if (offloadedBytes > 0) {
+        assert(fileopen);
+        offloadfile.close();
+        offloadfile_r.open(getRootDir() + "/tmpfilep" + to_string(perm));
+        std::vector<char> buffer(16 * 1024 * 1024);
+        uint64_t remaining = offloadedBytes;
+        while (remaining > 0) {
+            const uint64_t toread = std::min(remaining, (uint64_t) buffer.size());
+            offloadfile_r.read(buffer.data(), toread);
+            writeBytes(buffer.data(), toread);
+            remaining -= toread;
+        }
+        offloadfile_r.close();
+        Utils::remove(getRootDir() + "/tmpfilep" + to_string(perm));
+    }
+
+    //Write the other blocks
+    writeBytes(blocks.data(), blocks.size());
+}
@@ -72,6 +72,9 @@ PairItr *StorageStrat::getBinaryTable(const char signature) {
         if (signature & 1)
             ncount = 4;
         return f6->get(nbytes1, nbytes2, ncount);
+    } else if (storageType == PACKED_STORAGE) {
+        PackedTable *ph = f7->get();
+        return ph;
     } else {
         throw 10;
     }
@@ -122,6 +125,9 @@ BinaryTableInserter *StorageStrat::getBinaryTableInserter(const char signature)
         }
         ph->setSizes(nbytes1, nbytes2, ncount);
         return ph;
+    } else if (storageType == PACKED_STORAGE) {
+        PackedTableInserter *ph = f7i->get();
+        return ph;
     } else {
         throw 10;
     }
@@ -332,6 +338,7 @@ char StorageStrat::determineStrategy(int64_t *v1, int64_t *v2, const int size,
         const int64_t nTermsInInput,
         const size_t nTermsClusterColumn,
         const bool useRowForLargeTables,
+        const bool usePackedTables,
         Statistics &stats) {
     unsigned strat = 0;
     if (size < THRESHOLD_KEEP_MEMORY) {
@@ -360,8 +367,23 @@ char StorageStrat::determineStrategy(int64_t *v1, int64_t *v2, const int size,
             }
         }
 
+        //Is the bit-packed layout smaller than the byte-aligned ones?
+        bool packed = false;
+        if (usePackedTables && size >= PACKED_BLOCK_SIZE * 4) {
+            const int64_t b1 = Utils::numBytesFixedLength(maxValue1);
+            const int64_t b2 = Utils::numBytesFixedLength(maxValue2);
+            const int64_t spaceRow = size * (b1 + b2);
+            const int64_t spaceCluster = ngroups * (b1 +
+                    (maxGroupSize <= 255 ? 1 : 4)) + size * b2;
+            packed = (int64_t) PackedTableInserter::estimateSize(v1, v2, size)
+                < std::min(spaceRow, spaceCluster);
+        }
+
         //I have all info I need. Decide between row and cluster
-        if (ngroups >= nTermsClusterColumn) {
+        if (packed) {
+            strat = setStorageType(strat, PACKED_STORAGE);
+            stats.nPackedStrategies++;
+        } else if (ngroups >= nTermsClusterColumn) {
             strat = setStorageType(strat, NEWCOLUMN_ITR);
             stats.nList2Strategies++;
         } else {
@@ -408,7 +430,11 @@ char StorageStrat::determineStrategy(int64_t *v1, int64_t *v2, const int size,
         }
         stats.exact++;
     } else {
-        if (useRowForLargeTables) {
+        if (usePackedTables) {
+            //Long lists are where the bit-packed layout saves the most
+            strat = setStorageType(strat, PACKED_STORAGE);
+            stats.nPackedStrategies++;
+        } else if (useRowForLargeTables) {
             strat = setStorageType(strat, NEWROW_ITR);
             strat = setBytesField1(strat, 3);
             strat = setBytesField2(strat, 3);
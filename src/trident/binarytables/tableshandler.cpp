@@ -24,15 +24,20 @@
 
 #include <kognac/utils.h>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <fstream>
 #include <stdlib.h>
 #include <stdio.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
-void FileMarks::parse(string path) {
+void FileMarks::parse(string path, int64_t sizefile) {
     if (!Utils::exists(path)) {
         LOG(ERRORL) << "File non-existent: " << path;
         throw 10;
@@ -46,7 +51,7 @@ void FileMarks::parse(string path) {
     char *raw_input = this->mappedFile->getData();
 
     //Size marks
-    this->sizefile = Utils::fileSize(path.substr(0, path.size() - 4));
+    this->sizefile = sizefile;
     this->sizeMarks = Utils::decode_long(raw_input, 0);
     this->begin = raw_input + 8;
     this->end = this->begin + this->sizeMarks * 11;
@@ -55,8 +60,10 @@ void FileMarks::parse(string path) {
 TableStorage::TableStorage(bool readOnly, string pathDir, int64_t maxFileSize,
         int maxNFiles,
         MemoryManager<FileDescriptor> *bytesTracker,
+        BlockCache *blockCache,
         Stats &stats, int perm) :
-    readOnly(readOnly), marks(), marksLoaded(), stats(stats), perm(perm) {
+    readOnly(readOnly), marks(), marksLoaded(), blockCache(blockCache),
+    comprFiles(), stats(stats), perm(perm) {
         strcpy(this->pathDir, pathDir.c_str());
         this->sizePathDir = strlen(this->pathDir);
         this->pathDir[sizePathDir++] = CDIR_SEP;
@@ -64,6 +71,7 @@ TableStorage::TableStorage(bool readOnly, string pathDir, int64_t maxFileSize,
         //Determine the highest number of a file
         lastCreatedFile = 0;
         sizeLastCreatedFile = 0;
+        compressed = false;
         if (Utils::exists(pathDir) && Utils::isDirectory(pathDir)) {
             auto children = Utils::getFiles(pathDir);
             for(auto child : children) {
@@ -72,11 +80,21 @@ TableStorage::TableStorage(bool readOnly, string pathDir, int64_t maxFileSize,
                     lastCreatedFile = (short) idx;
             }
 
-            cache = new FileManager<FileDescriptor, FileDescriptor>(pathDir,
-                    readOnly, maxFileSize, maxNFiles, lastCreatedFile,
-                    bytesTracker, &stats);
-
-            sizeLastCreatedFile = cache->sizeFile(lastCreatedFile);
+            compressed = Utils::exists(pathDir + DIR_SEP + "0.cmp");
+            if (compressed) {
+                if (!readOnly || blockCache == NULL) {
+                    LOG(ERRORL) << "The compressed partition " << pathDir <<
+                        " can only be opened in read-only mode";
+                    throw 10;
+                }
+                cache = NULL;
+            } else {
+                cache = new FileManager<FileDescriptor, FileDescriptor>(pathDir,
+                        readOnly, maxFileSize, maxNFiles, lastCreatedFile,
+                        bytesTracker, &stats);
+
+                sizeLastCreatedFile = cache->sizeFile(lastCreatedFile);
+            }
         } else {
             //Create the directory if it does not exist
             if (!readOnly) {
@@ -87,6 +105,12 @@ TableStorage::TableStorage(bool readOnly, string pathDir, int64_t maxFileSize,
                     readOnly, maxFileSize, maxNFiles, lastCreatedFile,
                     bytesTracker, &stats);
         }
+        accessHints = false;
+        prefetcher = NULL;
+        for (int i = 0; i < MAX_N_FILES; ++i) {
+            nScans[i] = 0;
+            prefetchFds[i] = -1;
+        }
         indicesWritten = false;
         insertHandler = NULL;
         nTriplesInserted = 0;
@@ -94,64 +118,163 @@ TableStorage::TableStorage(bool readOnly, string pathDir, int64_t maxFileSize,
         filePreviousIndex = 0;
     }
 
-bool TableStorage::doesFileHaveCoordinates(short file) {
+FileMarks *TableStorage::getMarks(short file) {
     if (!marksLoaded[file]) {
-        sprintf(pathDir + sizePathDir, "%d.idx", file);
-        FileMarks *m = new FileMarks();
-        m->parse(string(pathDir));
-        marks[file] = m;
-        marksLoaded[file] = true;
+#ifdef MT
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!marksLoaded[file]) {
+#endif
+            int64_t sizefile;
+            if (compressed) {
+                sizefile = getComprFile(file)->getFileLength();
+            } else {
+                sprintf(pathDir + sizePathDir, "%d", file);
+                sizefile = Utils::fileSize(string(pathDir));
+            }
+            sprintf(pathDir + sizePathDir, "%d.idx", file);
+            FileMarks *m = new FileMarks();
+            m->parse(string(pathDir), sizefile);
+            marks[file] = m;
+            marksLoaded[file] = true;
+#ifdef MT
+        }
+        lock.unlock();
+#endif
     }
-    return marks[file] != NULL;
+    return marks[file];
 }
 
-const char *TableStorage::getBeginTableCoordinates(short file) {
-    if (!marksLoaded[file]) {
-        sprintf(pathDir + sizePathDir, "%d.idx", file);
-        FileMarks *m = new FileMarks();
-        m->parse(string(pathDir));
-        marks[file] = m;
-        marksLoaded[file] = true;
+ComprFileDescriptor *TableStorage::getComprFile(short file) {
+    //Called by getMarks while holding the lock
+    if (comprFiles[file] == NULL) {
+        sprintf(pathDir + sizePathDir, "%d.cmp", file);
+        comprFiles[file] = new ComprFileDescriptor(string(pathDir), perm,
+                file, blockCache);
     }
-    return marks[file]->getBeginTableCoordinates();
+    return comprFiles[file];
+}
+
+bool TableStorage::doesFileHaveCoordinates(short file) {
+    return getMarks(file) != NULL;
+}
+
+const char *TableStorage::getBeginTableCoordinates(short file) {
+    return getMarks(file)->getBeginTableCoordinates();
 }
 
 const char *TableStorage::getEndTableCoordinates(short file) {
-    if (!marksLoaded[file]) {
-        sprintf(pathDir + sizePathDir, "%d.idx", file);
-        FileMarks *m = new FileMarks();
-        m->parse(string(pathDir));
-        marks[file] = m;
-        marksLoaded[file] = true;
+    return getMarks(file)->getEndTableCoordinates();
+}
+
+void TableStorage::setAccessHints() {
+    //The compressed files are read through the block cache
+    if (!compressed) {
+        accessHints = true;
+        cache->setAccessPattern(ACCESS_RANDOM);
     }
-    return marks[file]->getEndTableCoordinates();
 }
 
-std::string TableStorage::getPath() {
-    return std::string(pathDir, sizePathDir);
+void TableStorage::startScan(short file) {
+    if (accessHints) {
+#ifdef MT
+        std::unique_lock<std::mutex> lock(mutex);
+#endif
+        if (nScans[file]++ == 0) {
+            cache->setAccessPattern(file, ACCESS_SEQUENTIAL);
+        }
+    }
 }
 
-std::pair<const char*, const char*> TableStorage::getTable(short file, int64_t mark) {
-    //I assume all the table is in one file
-    if (!marksLoaded[file]) {
+void TableStorage::stopScan(short file) {
+    if (accessHints) {
 #ifdef MT
         std::unique_lock<std::mutex> lock(mutex);
-        if (!marksLoaded[file]) {
 #endif
-            sprintf(pathDir + sizePathDir, "%d.idx", file);
-            FileMarks *m = new FileMarks();
-            m->parse(string(pathDir));
-            marks[file] = m;
-            marksLoaded[file] = true;
+        if (--nScans[file] == 0) {
+            cache->setAccessPattern(file, ACCESS_RANDOM);
+        }
+    }
+}
+
+AccessPattern TableStorage::getAccessPattern(short file) {
+    if (!accessHints) {
+        return ACCESS_NORMAL;
+    }
 #ifdef MT
+    std::unique_lock<std::mutex> lock(mutex);
+#endif
+    return nScans[file] > 0 ? ACCESS_SEQUENTIAL : ACCESS_RANDOM;
+}
+
+int TableStorage::getPrefetchFd(short file) {
+#ifdef MT
+    std::unique_lock<std::mutex> lock(mutex);
+#endif
+#if !defined(_WIN32)
+    if (prefetchFds[file] == -1) {
+        sprintf(pathDir + sizePathDir, "%d", file);
+        prefetchFds[file] = ::open(pathDir, O_RDONLY);
+        if (prefetchFds[file] == -1) {
+            LOG(ERRORL) << "Failed opening the file " << pathDir;
+            throw 10;
         }
-        lock.unlock();
+    }
+#endif
+    return prefetchFds[file];
+}
+
+void TableStorage::prefetch(short file, int64_t mark) {
+    if (prefetcher == NULL || !readOnly) {
+        return;
+    }
+    const std::pair<uint64_t,uint64_t> coord = getMarks(file)->getPos(mark);
+    if (compressed) {
+        //Decompress the block in the cache
+        ComprFileDescriptor *f = comprFiles[file];
+        prefetcher->run([f, coord]() {
+                BlockCache::Block pin;
+                f->getBuffer(coord.first, coord.second - coord.first, pin);
+                });
+    } else {
+#if !defined(_WIN32)
+        prefetcher->read(getPrefetchFd(file), coord.first,
+                coord.second - coord.first);
 #endif
     }
-    std::pair<uint64_t,uint64_t> coord = marks[file]->getPos(mark);
+}
+
+std::string TableStorage::getPath() {
+    return std::string(pathDir, sizePathDir);
+}
+
+std::pair<const char*, const char*> TableStorage::getTable(short file, int64_t mark) {
+    if (compressed) {
+        LOG(ERRORL) << "Raw pointers to the tables are not available if the"
+            " files are compressed";
+        throw 10;
+    }
+    //I assume all the table is in one file
+    std::pair<uint64_t,uint64_t> coord = getMarks(file)->getPos(mark);
     uint64_t realLen = (int) - 1;
     const char *start = cache->getBuffer(file, coord.first, &realLen);
+    return make_pair(start, start + (coord.second - coord.first));
+}
+
+std::pair<const char*, const char*> TableStorage::getTable(short file,
+        int64_t mark, TablePin &pin) {
+    std::pair<uint64_t,uint64_t> coord = getMarks(file)->getPos(mark);
     const uint64_t len = coord.second - coord.first;
+    const char *start;
+    if (compressed) {
+        BlockCache::Block block;
+        start = comprFiles[file]->getBuffer(coord.first, len, block);
+        pin = block;
+    } else {
+        FileTable<FileDescriptor>::Handle f = cache->getHandle(file);
+        uint64_t realLen = (int) - 1;
+        start = f->getBuffer(coord.first, &realLen);
+        pin = f;
+    }
     const char *end = start + len;
     return make_pair(start, end);
 }
@@ -271,6 +394,11 @@ void TableStorage::stopInsert() {
 }
 
 std::vector<const char*> TableStorage::loadAllFiles() {
+    if (compressed) {
+        LOG(ERRORL) << "The files cannot be loaded in memory if they are"
+            " compressed";
+        throw 10;
+    }
     std::vector<const char*> files;
     for(int i = 0; i <= cache->getIdLastFile(); ++i) {
         uint64_t length = std::numeric_limits<uint64_t>::max();
@@ -287,6 +415,42 @@ TableStorage::~TableStorage() {
         if (marks[i] != NULL) {
             delete marks[i];
         }
+        if (comprFiles[i] != NULL) {
+            delete comprFiles[i];
+        }
+#if !defined(_WIN32)
+        if (prefetchFds[i] != -1) {
+            ::close(prefetchFds[i]);
+        }
+#endif
+    }
+    if (cache != NULL) {
+        delete cache;
+    }
+}
+
+void TableStorage::compressFiles(string pathDir) {
+    if (!Utils::exists(pathDir)) {
+        return;
+    }
+    for (int i = 0; ; ++i) {
+        const string file = pathDir + DIR_SEP + to_string(i);
+        if (!Utils::exists(file)) {
+            break;
+        }
+        std::vector<uint64_t> tableStarts;
+        if (Utils::exists(file + ".idx")) {
+            FileMarks m;
+            m.parse(file + ".idx", Utils::fileSize(file));
+            const char *c = m.getBeginTableCoordinates();
+            for (; c < m.getEndTableCoordinates(); c += 11) {
+                tableStarts.push_back(Utils::decode_longFixedBytes(c, 5));
+            }
+            std::sort(tableStarts.begin(), tableStarts.end());
+        }
+        ComprFileDescriptor::compress(file, tableStarts, file + ".cmp");
+        LOG(DEBUGL) << "Compressed " << file << " from " << Utils::fileSize(file)
+            << " to " << Utils::fileSize(file + ".cmp") << " bytes";
+        Utils::remove(file);
     }
-    delete cache;
 }
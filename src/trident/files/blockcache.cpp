@@ -0,0 +1,90 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/files/blockcache.h>
+
+BlockCache::BlockCache(const uint64_t maxBytes) : maxBytes(maxBytes) {
+    bytes = 0;
+    hits = misses = evictions = 0;
+    decompressedBytes = decompressionTime = 0;
+}
+
+BlockCache::Block BlockCache::get(const int perm, const short file,
+        const uint64_t block) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto itr = entries.find(getKey(perm, file, block));
+    if (itr == entries.end()) {
+        misses++;
+        return Block();
+    }
+    hits++;
+    lru.splice(lru.begin(), lru, itr->second.pos);
+    return itr->second.block;
+}
+
+BlockCache::Block BlockCache::put(const int perm, const short file,
+        const uint64_t block, Block data, const uint64_t decompressionTime) {
+    const uint64_t key = getKey(perm, file, block);
+    std::lock_guard<std::mutex> lock(mutex);
+    this->decompressedBytes += data->size();
+    this->decompressionTime += decompressionTime;
+    auto itr = entries.find(key);
+    if (itr != entries.end()) {
+        return itr->second.block;
+    }
+
+    //Evict the least recently used blocks
+    while (!lru.empty() && bytes + data->size() > maxBytes) {
+        auto toremove = entries.find(lru.back());
+        bytes -= toremove->second.block->size();
+        entries.erase(toremove);
+        lru.pop_back();
+        evictions++;
+    }
+
+    lru.push_front(key);
+    Entry &e = entries[key];
+    e.block = data;
+    e.pos = lru.begin();
+    bytes += data->size();
+    return data;
+}
+
+BlockCacheStats BlockCache::getStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    BlockCacheStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.evictions = evictions;
+    stats.decompressedBytes = decompressedBytes;
+    stats.decompressionTime = decompressionTime;
+    stats.bytes = bytes;
+    stats.maxBytes = maxBytes;
+    return stats;
+}
+
+void BlockCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    lru.clear();
+    bytes = 0;
+}
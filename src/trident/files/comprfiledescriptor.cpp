@@ -0,0 +1,167 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/files/comprfiledescriptor.h>
+#include <trident/kb/consts.h>
+
+#include <kognac/logs.h>
+
+#include <lz4.h>
+
+#include <chrono>
+#include <fstream>
+#include <assert.h>
+
+ComprFileDescriptor::ComprFileDescriptor(std::string file, int perm, short id,
+        BlockCache *cache) : perm(perm), id(id), cache(cache) {
+    mappedFile = std::unique_ptr<MemoryMappedFile>(new MemoryMappedFile(file));
+    const char *buffer = mappedFile->getData();
+    nBlocks = Utils::decode_long(buffer);
+    uncompressedSize = Utils::decode_long(buffer + 8);
+    directory = buffer + 16;
+    data = directory + nBlocks * 16;
+    sizeData = mappedFile->getLength() - (data - buffer);
+}
+
+BlockCache::Block ComprFileDescriptor::decompress(const uint64_t block) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const uint64_t size = getStart(block + 1) - getStart(block);
+    const uint64_t compressedSize = getOffset(block + 1) - getOffset(block);
+    BlockCache::Block out(new std::vector<char>(size));
+    const int res = LZ4_decompress_safe(data + getOffset(block), out->data(),
+            compressedSize, size);
+    if (res != (int64_t) size) {
+        LOG(ERRORL) << "Failed decompressing block " << block << " of file "
+            << id << " (perm " << perm << ")";
+        throw 10;
+    }
+    const uint64_t usec = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    return cache->put(perm, id, block, out, usec);
+}
+
+const char *ComprFileDescriptor::getBuffer(const uint64_t offset,
+        const uint64_t length, BlockCache::Block &pin) {
+    //Binary search for the block that contains offset
+    uint64_t s = 0;
+    uint64_t e = nBlocks;
+    while (s < e) {
+        const uint64_t middle = s + (e - s) / 2;
+        if (getStart(middle) <= offset) {
+            s = middle + 1;
+        } else {
+            e = middle;
+        }
+    }
+    assert(s > 0);
+    const uint64_t block = s - 1;
+    const uint64_t start = getStart(block);
+    const uint64_t end = getStart(block + 1);
+    if (offset + length > end) {
+        LOG(ERRORL) << "The range " << offset << "-" << offset + length <<
+            " crosses the end of the compressed block (" << end << ")";
+        throw 10;
+    }
+
+    const uint64_t compressedSize = getOffset(block + 1) - getOffset(block);
+    if (compressedSize == end - start) {
+        //The block is stored raw
+        pin = BlockCache::Block();
+        return data + getOffset(block) + (offset - start);
+    }
+    pin = cache->get(perm, id, block);
+    if (!pin) {
+        pin = decompress(block);
+    }
+    return pin->data() + (offset - start);
+}
+
+void ComprFileDescriptor::compress(std::string input,
+        const std::vector<uint64_t> &tableStarts,
+        std::string output) {
+    const uint64_t size = Utils::fileSize(input);
+    std::unique_ptr<MemoryMappedFile> mf;
+    const char *buffer = NULL;
+    if (size > 0) {
+        mf = std::unique_ptr<MemoryMappedFile>(new MemoryMappedFile(input));
+        buffer = mf->getData();
+    }
+
+    //Cut the blocks at the first table after COMPR_BLOCK_SIZE bytes
+    std::vector<uint64_t> blocks;
+    if (size > 0) {
+        blocks.push_back(0);
+    }
+    for (auto pos : tableStarts) {
+        if (pos >= size) {
+            break;
+        }
+        if (pos - blocks.back() >= COMPR_BLOCK_SIZE) {
+            blocks.push_back(pos);
+        }
+    }
+
+    std::ofstream out(output, std::ios_base::binary);
+    char tmp[16];
+    Utils::encode_long(tmp, 0, blocks.size());
+    Utils::encode_long(tmp, 8, size);
+    out.write(tmp, 16);
+    //The directory is filled in at the end
+    std::vector<char> dir(blocks.size() * 16);
+    out.write(dir.data(), dir.size());
+
+    std::vector<char> compressed;
+    uint64_t offset = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        const uint64_t start = blocks[i];
+        const uint64_t len = (i + 1 < blocks.size() ? blocks[i + 1] : size)
+            - start;
+        Utils::encode_long(dir.data(), i * 16, start);
+        Utils::encode_long(dir.data(), i * 16 + 8, offset);
+        int compressedSize = 0;
+        if (len <= LZ4_MAX_INPUT_SIZE) {
+            compressed.resize(LZ4_compressBound(len));
+#if LZ4_VERSION_MAJOR > 1 || LZ4_VERSION_MINOR >= 7
+            compressedSize = LZ4_compress_default(buffer + start,
+                    compressed.data(), len, compressed.size());
+#else
+            // LZ4_compress_default does not exist in older lz4 versions
+            compressedSize = LZ4_compress_limitedOutput(buffer + start,
+                    compressed.data(), len, compressed.size());
+#endif
+        }
+        if (compressedSize > 0 && compressedSize < len) {
+            out.write(compressed.data(), compressedSize);
+            offset += compressedSize;
+        } else {
+            out.write(buffer + start, len);
+            offset += len;
+        }
+    }
+    out.seekp(16);
+    out.write(dir.data(), dir.size());
+    out.close();
+    if (out.fail()) {
+        LOG(ERRORL) << "Failed writing the compressed file " << output;
+        throw 10;
+    }
+}
@@ -67,7 +67,7 @@ void FileDescriptor::mapFile(uint64_t requiredIncrement) {
 
 FileDescriptor::FileDescriptor(bool readOnly, int id, std::string file,
                                uint64_t fileMaxSize, MemoryManager<FileDescriptor> *tracker,
-                               FileDescriptor **parents, Stats * const stats) :
+                               std::atomic<FileDescriptor*> *parents, Stats * const stats) :
     filePath(file), readOnly(readOnly), id(id), parentArray(parents) {
     this->tracker = tracker;
     memoryTrackerId = -1;
@@ -88,6 +88,9 @@ FileDescriptor::FileDescriptor(bool readOnly, int id, std::string file,
 }
 
 char* FileDescriptor::getBuffer(uint64_t offset, uint64_t *length) {
+    if (tracker) {
+        tracker->access(memoryTrackerId);
+    }
     if (*length > size - offset) {
         *length = size - offset;
     }
@@ -121,6 +124,9 @@ char* FileDescriptor::getBuffer(uint64_t offset, uint64_t *length,
                                 int &memoryBlock, const int sesID) {
     //sedID is used only by the comprfiledescriptor.
     memoryBlock = memoryTrackerId;
+    if (tracker) {
+        tracker->access(memoryTrackerId);
+    }
     if (*length > size - offset) {
         *length = size - offset;
     }
@@ -208,7 +214,8 @@ bool FileDescriptor::isUsed() {
         else
             return false;
     } else {
-        return true;
+        //The FileManager pins the files if there is no tracker
+        return false;
     }
 }
 
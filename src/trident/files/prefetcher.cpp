@@ -0,0 +1,380 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/files/prefetcher.h>
+#include <trident/kb/consts.h>
+
+#include <kognac/logs.h>
+
+#if defined(IO_URING)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+
+#if defined(IO_URING)
+//Minimal wrapper around the io_uring system calls, so that liburing is not
+//required. Only one thread can use it.
+class IOUring {
+    private:
+        int fd;
+        char *sq, *cq;
+        size_t sqSize, cqSize;
+        struct io_uring_sqe *sqes;
+        size_t sqesSize;
+        unsigned *sqTail, *sqMask, *sqArray;
+        unsigned *cqHead, *cqTail, *cqMask;
+        struct io_uring_cqe *cqes;
+
+        IOUring() : fd(-1), sq(NULL), cq(NULL), sqSize(0), cqSize(0),
+        sqes(NULL), sqesSize(0) {
+        }
+
+    public:
+        //Returns NULL if io_uring is not supported by the kernel
+        static IOUring *create(const unsigned depth) {
+            struct io_uring_params p;
+            memset(&p, 0, sizeof(p));
+            const int fd = (int) syscall(__NR_io_uring_setup, depth, &p);
+            if (fd < 0) {
+                return NULL;
+            }
+            std::unique_ptr<IOUring> r(new IOUring());
+            r->fd = fd;
+            r->sqSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+            r->cqSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+            bool singleMmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+            if (p.features & IORING_FEAT_SINGLE_MMAP) {
+                singleMmap = true;
+                r->sqSize = r->cqSize = std::max(r->sqSize, r->cqSize);
+            }
+#endif
+            void *sq = mmap(NULL, r->sqSize, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sq == MAP_FAILED) {
+                return NULL;
+            }
+            r->sq = (char*) sq;
+            if (singleMmap) {
+                r->cq = r->sq;
+            } else {
+                void *cq = mmap(NULL, r->cqSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+                if (cq == MAP_FAILED) {
+                    return NULL;
+                }
+                r->cq = (char*) cq;
+            }
+            r->sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+            void *sqes = mmap(NULL, r->sqesSize, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (sqes == MAP_FAILED) {
+                return NULL;
+            }
+            r->sqes = (struct io_uring_sqe*) sqes;
+            r->sqTail = (unsigned*) (r->sq + p.sq_off.tail);
+            r->sqMask = (unsigned*) (r->sq + p.sq_off.ring_mask);
+            r->sqArray = (unsigned*) (r->sq + p.sq_off.array);
+            r->cqHead = (unsigned*) (r->cq + p.cq_off.head);
+            r->cqTail = (unsigned*) (r->cq + p.cq_off.tail);
+            r->cqMask = (unsigned*) (r->cq + p.cq_off.ring_mask);
+            r->cqes = (struct io_uring_cqe*) (r->cq + p.cq_off.cqes);
+            return r.release();
+        }
+
+        //The caller guarantees that there is space in the queue
+        void prepareRead(const int file, const uint64_t offset,
+                struct iovec *iov, const uint64_t id) {
+            const unsigned tail = *sqTail;
+            const unsigned idx = tail & *sqMask;
+            struct io_uring_sqe *sqe = sqes + idx;
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_READV;
+            sqe->fd = file;
+            sqe->off = offset;
+            sqe->addr = (uint64_t) iov;
+            sqe->len = 1;
+            sqe->user_data = id;
+            sqArray[idx] = idx;
+            __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        }
+
+        int submit(const unsigned n, const unsigned minComplete) {
+            return (int) syscall(__NR_io_uring_enter, fd, n, minComplete,
+                    minComplete > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        }
+
+        bool getCompletion(uint64_t &id, int &res) {
+            const unsigned head = *cqHead;
+            if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+                return false;
+            }
+            const struct io_uring_cqe *cqe = cqes + (head & *cqMask);
+            id = cqe->user_data;
+            res = cqe->res;
+            __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        ~IOUring() {
+            if (sqes != NULL) {
+                munmap(sqes, sqesSize);
+            }
+            if (cq != NULL && cq != sq) {
+                munmap(cq, cqSize);
+            }
+            if (sq != NULL) {
+                munmap(sq, sqSize);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+};
+#else
+class IOUring {
+};
+#endif
+
+Prefetcher::Prefetcher(const int nthreads, const bool useIOUring) :
+    nthreads(nthreads), useIOUring(useIOUring), started(false), pending(0),
+    stop(false), requests(0), dropped(0), bytes(0), nTasks(0) {
+    }
+
+void Prefetcher::start() {
+    started = true;
+#if defined(IO_URING)
+    if (useIOUring) {
+        ring = std::unique_ptr<IOUring>(IOUring::create(PREFETCH_QUEUE_DEPTH));
+        if (!ring) {
+            LOG(INFOL) << "io_uring is not available (" << strerror(errno)
+                << "). The tables are prefetched by a pool of threads";
+        }
+    }
+#endif
+    if (ring) {
+        ringThread = std::thread(&Prefetcher::ringLoop, this);
+    }
+    for (int i = 0; i < std::max(1, nthreads); ++i) {
+        threads.push_back(std::thread(&Prefetcher::worker, this));
+    }
+}
+
+void Prefetcher::read(const int fd, uint64_t offset, uint64_t len) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!started) {
+        start();
+    }
+    requests++;
+    if (pending + (len + PREFETCH_CHUNK_SIZE - 1) / PREFETCH_CHUNK_SIZE >
+            PREFETCH_MAX_PENDING) {
+        dropped++;
+        return;
+    }
+    while (len > 0) {
+        ReadRequest r;
+        r.fd = fd;
+        r.offset = offset;
+        r.len = std::min(len, (uint64_t) PREFETCH_CHUNK_SIZE);
+        reads.push_back(r);
+        pending++;
+        offset += r.len;
+        len -= r.len;
+    }
+    lock.unlock();
+    if (ring) {
+        ringCond.notify_one();
+    } else {
+        cond.notify_all();
+    }
+}
+
+void Prefetcher::run(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!started) {
+        start();
+    }
+    requests++;
+    if (pending >= PREFETCH_MAX_PENDING) {
+        dropped++;
+        return;
+    }
+    tasks.push_back(std::move(task));
+    pending++;
+    lock.unlock();
+    cond.notify_one();
+}
+
+void Prefetcher::done(const uint64_t n) {
+    std::unique_lock<std::mutex> lock(mutex);
+    pending -= n;
+    if (pending == 0) {
+        idle.notify_all();
+    }
+}
+
+void Prefetcher::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return pending == 0 || stop; });
+}
+
+void Prefetcher::worker() {
+    std::vector<char> buffer(PREFETCH_CHUNK_SIZE);
+    while (true) {
+        std::function<void()> task;
+        ReadRequest r;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [this] {
+                    return stop || !tasks.empty() || (!ring && !reads.empty());
+                    });
+            if (stop) {
+                break;
+            }
+            if (!tasks.empty()) {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            } else {
+                r = reads.front();
+                reads.pop_front();
+            }
+        }
+        if (task) {
+            try {
+                task();
+            } catch (int) {
+                LOG(DEBUGL) << "A prefetching task has failed";
+            }
+            nTasks++;
+        } else {
+#if !defined(_WIN32)
+            //The content is not needed. It is only loaded in the page cache
+            const ssize_t res = pread(r.fd, buffer.data(), r.len, r.offset);
+            if (res > 0) {
+                bytes += res;
+            }
+#endif
+        }
+        done(1);
+    }
+}
+
+void Prefetcher::ringLoop() {
+#if defined(IO_URING)
+    std::vector<char> buffers((uint64_t) PREFETCH_QUEUE_DEPTH * PREFETCH_CHUNK_SIZE);
+    std::vector<struct iovec> iovecs(PREFETCH_QUEUE_DEPTH);
+    std::vector<uint64_t> freeSlots;
+    for (int i = PREFETCH_QUEUE_DEPTH - 1; i >= 0; --i) {
+        freeSlots.push_back(i);
+    }
+    uint64_t inflight = 0;
+    uint64_t unsubmitted = 0;
+    std::vector<ReadRequest> batch;
+    while (true) {
+        batch.clear();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (inflight == 0) {
+                ringCond.wait(lock, [this] { return stop || !reads.empty(); });
+            }
+            if (stop) {
+                //Only wait for the reads that were already submitted
+                if (inflight == 0) {
+                    break;
+                }
+            } else {
+                while (!reads.empty() && batch.size() < freeSlots.size()) {
+                    batch.push_back(reads.front());
+                    reads.pop_front();
+                }
+            }
+        }
+
+        for (const auto &r : batch) {
+            const uint64_t slot = freeSlots.back();
+            freeSlots.pop_back();
+            iovecs[slot].iov_base = buffers.data() + slot * PREFETCH_CHUNK_SIZE;
+            iovecs[slot].iov_len = r.len;
+            ring->prepareRead(r.fd, r.offset, &iovecs[slot], slot);
+        }
+        inflight += batch.size();
+        unsubmitted += batch.size();
+        //Block only if there is nothing new to submit
+        const int res = ring->submit(unsubmitted, unsubmitted == 0 ? 1 : 0);
+        if (res >= 0) {
+            unsubmitted -= res;
+        } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            LOG(ERRORL) << "io_uring_enter failed: " << strerror(errno);
+        }
+
+        uint64_t slot;
+        int nbytes;
+        uint64_t completed = 0;
+        while (ring->getCompletion(slot, nbytes)) {
+            freeSlots.push_back(slot);
+            if (nbytes > 0) {
+                bytes += nbytes;
+            }
+            completed++;
+        }
+        if (completed > 0) {
+            inflight -= completed;
+            done(completed);
+        }
+    }
+#endif
+}
+
+PrefetchStats Prefetcher::getStats() {
+    PrefetchStats stats;
+    stats.requests = requests;
+    stats.dropped = dropped;
+    stats.bytes = bytes;
+    stats.tasks = nTasks;
+    stats.iouring = ring != NULL;
+    return stats;
+}
+
+Prefetcher::~Prefetcher() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cond.notify_all();
+    ringCond.notify_all();
+    idle.notify_all();
+    for (auto &t : threads) {
+        t.join();
+    }
+    if (ringThread.joinable()) {
+        ringThread.join();
+    }
+}
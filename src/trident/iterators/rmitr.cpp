@@ -112,6 +112,22 @@ void RmItr::next() {
     hnc = false;
 }
 
+size_t RmItr::nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+    //hasNext() moves the main iterator on the following pair, so I can stop
+    //before its key changes
+    size_t n = 0;
+    while (n < max && hasNext()) {
+        if (n > 0 && itr->getKey() != getKey()) {
+            break;
+        }
+        next();
+        v1[n] = getValue1();
+        v2[n] = getValue2();
+        n++;
+    }
+    return n;
+}
+
 int64_t RmItr::getCount() {
     return curCount;
 }
@@ -52,6 +52,7 @@ void ScanItr::init(int idx, Querier *q) {
     } else
         itr2 = NULL;
     storage = q->getTableStorage(idx);
+    scannedFile = -1;
     strat = q->getStorageStrat();
     ignseccolumn = false;
     hnc = hn = false;
@@ -154,6 +155,7 @@ void ScanItr::next() {
                 char strategy = itr1->getCurrentStrat();
                 short file = itr1->getCurrentFile();
                 int64_t mark = itr1->getCurrentMark();
+                scanFile(file);
                 currentTable = q->get(idx, key, file, mark, strategy,
                                       -1, -1, false, false);
                 if (ignseccolumn)
@@ -201,6 +203,7 @@ bool ScanItr::next(int64_t &v1, int64_t &v2, int64_t &v3) {
                 char strategy = itr1->getCurrentStrat();
                 short file = itr1->getCurrentFile();
                 int64_t mark = itr1->getCurrentMark();
+                scanFile(file);
                 //cerr << "New table for key " << key << " itr2 " << itr2->getKey() << " mark=" << mark << " file=" << file << endl;
                 currentTable = q->get(idx, key, file, mark, strategy,
                                       -1, -1, false, false);
@@ -236,6 +239,20 @@ bool ScanItr::next(int64_t &v1, int64_t &v2, int64_t &v3) {
     return hasNext;
 }
 
+size_t ScanItr::nextBatch(uint64_t *v1, uint64_t *v2, const size_t max) {
+    if (max == 0 || !hasNext()) {
+        return 0;
+    }
+    //next() opens the table of the following key if needed
+    next();
+    v1[0] = getValue1();
+    v2[0] = getValue2();
+    //The remaining pairs must have the same key, so I only read from the
+    //current table
+    PairItr *itr = reversedItr ? reversedItr : currentTable;
+    return 1 + itr->nextBatch(v1 + 1, v2 + 1, max - 1);
+}
+
 void ScanItr::clear() {
     if (currentTable)
         q->releaseItr(currentTable);
@@ -246,6 +263,22 @@ void ScanItr::clear() {
     if (reversedItr) {
         q->releaseItr(reversedItr);
     }
+    if (storage != NULL && scannedFile != -1) {
+        storage->stopScan(scannedFile);
+    }
+    storage = NULL;
+    scannedFile = -1;
+}
+
+void ScanItr::scanFile(short file) {
+    //Only the file that is being read is switched to sequential
+    if (storage != NULL && file != scannedFile) {
+        if (scannedFile != -1) {
+            storage->stopScan(scannedFile);
+        }
+        storage->startScan(file);
+        scannedFile = file;
+    }
 }
 
 void ScanItr::mark() {
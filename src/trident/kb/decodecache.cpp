@@ -0,0 +1,191 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/kb/decodecache.h>
+
+#include <algorithm>
+#include <cstring>
+
+#define DECODECACHE_SHARDS 16
+//Approximate cost of an entry in the map and in the LRU list
+#define DECODECACHE_ENTRYOVERHEAD 96
+//Average size of a text, used to size the sketch
+#define DECODECACHE_AVGTEXTSIZE 64
+
+static uint64_t _mix(uint64_t key) {
+    key ^= key >> 33;
+    key *= UINT64_C(0xff51afd7ed558ccd);
+    key ^= key >> 33;
+    key *= UINT64_C(0xc4ceb9fe1a85ec53);
+    key ^= key >> 33;
+    return key;
+}
+
+DecodeCache::FrequencySketch::FrequencySketch(const uint64_t width) {
+    uint64_t w = 64;
+    while (w < width) {
+        w <<= 1;
+    }
+    counters.resize(w);
+    mask = w - 1;
+    additions = 0;
+    sampleSize = 10 * w;
+}
+
+uint64_t DecodeCache::FrequencySketch::getIndex(const uint64_t key,
+        const int row) const {
+    return _mix(key + UINT64_C(0x9E3779B97F4A7C15) * (row + 1)) & mask;
+}
+
+void DecodeCache::FrequencySketch::increment(const uint64_t key) {
+    bool added = false;
+    for (int row = 0; row < 4; ++row) {
+        uint8_t &c = counters[getIndex(key, row)];
+        if (c < 15) {
+            c++;
+            added = true;
+        }
+    }
+    if (added && ++additions == sampleSize) {
+        reset();
+    }
+}
+
+int DecodeCache::FrequencySketch::estimate(const uint64_t key) const {
+    int freq = 15;
+    for (int row = 0; row < 4; ++row) {
+        freq = std::min(freq, (int) counters[getIndex(key, row)]);
+    }
+    return freq;
+}
+
+void DecodeCache::FrequencySketch::reset() {
+    //Halve all the counters, so the old requests count less
+    for (auto &c : counters) {
+        c >>= 1;
+    }
+    additions >>= 1;
+}
+
+uint64_t DecodeCache::getSize(const int sizeText) {
+    return sizeText + DECODECACHE_ENTRYOVERHEAD;
+}
+
+DecodeCache::DecodeCache(const uint64_t maxBytes) : maxBytes(maxBytes),
+    maxBytesShard(maxBytes / DECODECACHE_SHARDS) {
+    const uint64_t sketchWidth = maxBytesShard /
+        (DECODECACHE_AVGTEXTSIZE + DECODECACHE_ENTRYOVERHEAD);
+    for (int i = 0; i < DECODECACHE_SHARDS; ++i) {
+        shards.push_back(std::unique_ptr<Shard>(new Shard(sketchWidth)));
+    }
+}
+
+bool DecodeCache::get(const uint64_t id, char *text, int &size) {
+    Shard &shard = getShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.sketch.increment(id);
+    auto itr = shard.entries.find(id);
+    if (itr == shard.entries.end()) {
+        shard.misses++;
+        return false;
+    }
+    shard.hits++;
+    shard.lru.splice(shard.lru.begin(), shard.lru, itr->second.pos);
+    size = itr->second.text.size();
+    memcpy(text, itr->second.text.c_str(), size);
+    return true;
+}
+
+bool DecodeCache::get(const uint64_t id, std::string &text) {
+    Shard &shard = getShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.sketch.increment(id);
+    auto itr = shard.entries.find(id);
+    if (itr == shard.entries.end()) {
+        shard.misses++;
+        return false;
+    }
+    shard.hits++;
+    shard.lru.splice(shard.lru.begin(), shard.lru, itr->second.pos);
+    text = itr->second.text;
+    return true;
+}
+
+void DecodeCache::put(const uint64_t id, const char *text, const int size) {
+    const uint64_t sizeEntry = getSize(size);
+    if (sizeEntry > maxBytesShard) {
+        return;
+    }
+    Shard &shard = getShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.entries.count(id)) {
+        return;
+    }
+
+    if (shard.bytes + sizeEntry > maxBytesShard) {
+        //Admit the text only if it is more popular than the victim
+        const int freq = shard.sketch.estimate(id);
+        if (freq <= shard.sketch.estimate(shard.lru.back())) {
+            shard.rejections++;
+            return;
+        }
+        while (shard.bytes + sizeEntry > maxBytesShard) {
+            auto toremove = shard.entries.find(shard.lru.back());
+            shard.bytes -= getSize(toremove->second.text.size());
+            shard.entries.erase(toremove);
+            shard.lru.pop_back();
+            shard.evictions++;
+        }
+    }
+
+    shard.lru.push_front(id);
+    Entry &e = shard.entries[id];
+    e.text.assign(text, size);
+    e.pos = shard.lru.begin();
+    shard.bytes += sizeEntry;
+    shard.admissions++;
+}
+
+DecodeCacheStats DecodeCache::getStats() {
+    DecodeCacheStats stats = DecodeCacheStats();
+    stats.maxBytes = maxBytes;
+    for (auto &s : shards) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        stats.hits += s->hits;
+        stats.misses += s->misses;
+        stats.admissions += s->admissions;
+        stats.rejections += s->rejections;
+        stats.evictions += s->evictions;
+        stats.entries += s->entries.size();
+        stats.bytes += s->bytes;
+    }
+    return stats;
+}
+
+void DecodeCache::clear() {
+    for (auto &s : shards) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        s->entries.clear();
+        s->lru.clear();
+        s->bytes = 0;
+    }
+}
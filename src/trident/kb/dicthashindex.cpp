@@ -0,0 +1,131 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/kb/dicthashindex.h>
+#include <trident/tree/root.h>
+#include <trident/tree/stringbuffer.h>
+#include <trident/tree/treeitr.h>
+
+#include <kognac/utils.h>
+#include <kognac/logs.h>
+
+#include <cstring>
+
+#define DICTHASH_HEADER_SIZE 16
+
+DictHashIndex::DictHashIndex(std::string path, StringBuffer *sb) : sb(sb) {
+    file = std::unique_ptr<MemoryMappedFile>(new MemoryMappedFile(path, true));
+    const char *raw = file->getData();
+    if (file->getLength() < DICTHASH_HEADER_SIZE) {
+        LOG(ERRORL) << "The hash index of the dictionary " << path << " is corrupted";
+        throw 10;
+    }
+    const uint64_t nSlots = Utils::decode_long(raw, 0);
+    if ((nSlots & (nSlots - 1)) != 0 || file->getLength() !=
+            DICTHASH_HEADER_SIZE + nSlots * sizeof(Slot)) {
+        LOG(ERRORL) << "The hash index of the dictionary " << path << " is corrupted";
+        throw 10;
+    }
+    mask = nSlots - 1;
+    slots = (const Slot*) (raw + DICTHASH_HEADER_SIZE);
+    //The lookups are random
+    file->advise(ACCESS_RANDOM);
+}
+
+uint64_t DictHashIndex::hash(const char *text, const int size) {
+    //FNV-1a followed by the finalizer of MurmurHash3 to spread the bits
+    uint64_t h = UINT64_C(14695981039346656037);
+    for (int i = 0; i < size; ++i) {
+        h ^= (uint8_t) text[i];
+        h *= UINT64_C(1099511628211);
+    }
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+    return h == 0 ? 1 : h;
+}
+
+bool DictHashIndex::get(const char *text, const int size, nTerm *id) const {
+    const uint64_t h = hash(text, size);
+    uint64_t idx = h & mask;
+    while (slots[idx].hash != 0) {
+        if (slots[idx].hash == h && sb->cmp(slots[idx].coordinates,
+                    (char*) text, size) == 0) {
+            *id = slots[idx].id;
+            return true;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return false;
+}
+
+void DictHashIndex::create(Root *dict, StringBuffer *sb, std::string path) {
+    uint64_t nTerms = 0;
+    TreeItr *itr = dict->itr();
+    while (itr->hasNext()) {
+        int64_t value;
+        itr->next(value);
+        nTerms++;
+    }
+    delete itr;
+
+    //The load factor is at most 0.75, and there is always an empty slot
+    uint64_t nSlots = 2;
+    while (nSlots * 3 < (nTerms + 1) * 4) {
+        nSlots *= 2;
+    }
+    const uint64_t length = DICTHASH_HEADER_SIZE + nSlots * sizeof(Slot);
+    if (Utils::exists(path)) {
+        Utils::remove(path);
+    }
+    //The new file is filled with zeros (empty slots)
+    Utils::resizeFile(path, length);
+    {
+        MemoryMappedFile out(path, false, 0, length);
+        char *raw = out.getData();
+        Utils::encode_long(raw, 0, nSlots);
+        Utils::encode_long(raw, 8, nTerms);
+        Slot *slots = (Slot*) (raw + DICTHASH_HEADER_SIZE);
+        const uint64_t mask = nSlots - 1;
+        itr = dict->itr();
+        while (itr->hasNext()) {
+            int64_t id;
+            const int64_t coordinates = itr->next(id);
+            int size;
+            const char *text = sb->get(coordinates, size);
+            const uint64_t h = hash(text, size);
+            uint64_t idx = h & mask;
+            while (slots[idx].hash != 0) {
+                idx = (idx + 1) & mask;
+            }
+            slots[idx].hash = h;
+            slots[idx].id = id;
+            slots[idx].coordinates = coordinates;
+        }
+        delete itr;
+        out.flushAll();
+    }
+    LOG(DEBUGL) << "Hash index of the dictionary: " << nTerms << " terms in "
+        << nSlots << " slots";
+}
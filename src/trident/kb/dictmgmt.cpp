@@ -21,9 +21,15 @@
 
 
 #include <trident/kb/dictmgmt.h>
+#include <trident/kb/fcdict.h>
+#include <trident/kb/textindex.h>
+#include <trident/kb/dicthashindex.h>
+#include <trident/kb/inlineliterals.h>
 #include <trident/tree/root.h>
 #include <trident/tree/stringbuffer.h>
 #include <trident/tree/treeitr.h>
+#include <trident/utils/parallel.h>
+#include <trident/utils/memorybudget.h>
 
 #include <kognac/hashfunctions.h>
 #include <kognac/lz4io.h>
@@ -32,12 +38,13 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 using namespace std;
 
 DictMgmt::DictMgmt(Dict mainDict, string dirToStoreGUD, bool hash, string e2r,
         string e2s) :
-    hash(hash) {
+    hash(hash), inlineLits(false) {
         nTuples = 0;
         printTuples = false;
         sTuples = 0;
@@ -100,17 +107,33 @@ DictMgmt::DictMgmt(Dict mainDict, string dirToStoreGUD, bool hash, string e2r,
     }
 
 TreeItr *DictMgmt::getInvDictIterator() {
+    if (!dictionaries[0].invdict) {
+        LOG(ERRORL) << "The dictionary is front-coded and has no trees. Use getFCDict() to iterate over it";
+        throw 10;
+    }
     return dictionaries[0].invdict->itr();
 }
 
 TreeItr *DictMgmt::getDictIterator() {
+    if (!dictionaries[0].dict) {
+        LOG(ERRORL) << "The dictionary is front-coded and has no trees. Use getFCDict() to iterate over it";
+        throw 10;
+    }
     return dictionaries[0].dict->itr();
 }
 
 StringBuffer *DictMgmt::getStringBuffer() {
+    if (!dictionaries[0].sb) {
+        LOG(ERRORL) << "The dictionary is front-coded and has no StringBuffer";
+        throw 10;
+    }
     return dictionaries[0].sb.get();
 }
 
+FCDict *DictMgmt::getFCDict() {
+    return dictionaries[0].fcdict.get();
+}
+
 void DictMgmt::putInUpdateDict(const uint64_t id,
         const char *term,
         const size_t len) {
@@ -137,14 +160,31 @@ bool DictMgmt::getTextRel(nTerm key, char *value, int &size) {
 }
 
 bool DictMgmt::getText(nTerm key, char *value) {
+    if (inlineLits && InlineLiterals::isInlined(key)) {
+        InlineLiterals::decode(key, value);
+        return true;
+    }
+    int size = 0;
+    if (decodeCache && decodeCache->get(key, value, size)) {
+        value[size] = '\0';
+        return true;
+    }
     int64_t coordinates;
     int idx = 0;
     while (idx < beginrange.size() - 1 && key >= beginrange[idx + 1]) {
         idx++;
     }
-    if (dictionaries[idx].invdict->get(key, coordinates)) {
-        int size = 0;
+    if (dictionaries[idx].fcdict) {
+        if (dictionaries[idx].fcdict->getText(key, value, size)) {
+            if (decodeCache)
+                decodeCache->put(key, value, size);
+            value[size] = '\0';
+            return true;
+        }
+    } else if (dictionaries[idx].invdict->get(key, coordinates)) {
         dictionaries[idx].sb->get(coordinates, value, size);
+        if (decodeCache)
+            decodeCache->put(key, value, size);
         value[size] = '\0';
         return true;
     }
@@ -161,15 +201,34 @@ bool DictMgmt::getText(nTerm key, char *value) {
 }
 
 bool DictMgmt::getText(nTerm key, std::string &value) {
+    if (inlineLits && InlineLiterals::isInlined(key)) {
+        char rawvalue[MAX_TERM_SIZE];
+        value = std::string(rawvalue, InlineLiterals::decode(key, rawvalue));
+        return true;
+    }
+    if (decodeCache && decodeCache->get(key, value)) {
+        return true;
+    }
     int64_t coordinates;
     int idx = 0;
     while (idx < beginrange.size() - 1 && key >= beginrange[idx + 1]) {
         idx++;
     }
-    if (dictionaries[idx].invdict->get(key, coordinates)) {
+    if (dictionaries[idx].fcdict) {
+        int size = 0;
+        char rawvalue[MAX_TERM_SIZE];
+        if (dictionaries[idx].fcdict->getText(key, rawvalue, size)) {
+            value = std::string(rawvalue, size);
+            if (decodeCache)
+                decodeCache->put(key, rawvalue, size);
+            return true;
+        }
+    } else if (dictionaries[idx].invdict->get(key, coordinates)) {
         int size = 0;
         char *rawvalue = dictionaries[idx].sb->get(coordinates, size);
         value = std::string(rawvalue, size);
+        if (decodeCache)
+            decodeCache->put(key, rawvalue, size);
         return true;
     }
     if (!gud_idtext.empty()) {
@@ -184,13 +243,28 @@ bool DictMgmt::getText(nTerm key, std::string &value) {
 }
 
 bool DictMgmt::getText(nTerm key, char *value, int &size) {
+    if (inlineLits && InlineLiterals::isInlined(key)) {
+        size = InlineLiterals::decode(key, value);
+        return true;
+    }
+    if (decodeCache && decodeCache->get(key, value, size)) {
+        return true;
+    }
     int64_t coordinates;
     int idx = 0;
     while (idx < beginrange.size() - 1 && key >= beginrange[idx + 1]) {
         idx++;
     }
-    if (dictionaries[idx].invdict->get(key, coordinates)) {
+    if (dictionaries[idx].fcdict) {
+        if (dictionaries[idx].fcdict->getText(key, value, size)) {
+            if (decodeCache)
+                decodeCache->put(key, value, size);
+            return true;
+        }
+    } else if (dictionaries[idx].invdict->get(key, coordinates)) {
         dictionaries[idx].sb->get(coordinates, value, size);
+        if (decodeCache)
+            decodeCache->put(key, value, size);
         return true;
     }
     if (!gud_idtext.empty()) {
@@ -204,16 +278,192 @@ bool DictMgmt::getText(nTerm key, char *value, int &size) {
     return false;
 }
 
+//A distinct ID of getTexts. Its positions in the input are in
+//positions[begin, end)
+struct TextRequest {
+    uint64_t id;
+    //Dictionary that contains the text. -1 if it is not in the trees, -2 if
+    //the text is already decoded
+    int dict;
+    int64_t coordinates;
+    size_t begin, end;
+};
+
+static bool _sort_by_coordinates(const TextRequest &r1, const TextRequest &r2) {
+    return r1.dict < r2.dict || (r1.dict == r2.dict &&
+            r1.coordinates < r2.coordinates);
+}
+
+static void scatterText(const TextRequest &r,
+        const std::vector<std::pair<uint64_t, size_t>> &positions,
+        const char *text, const int size, std::string *output, bool *found) {
+    for (size_t i = r.begin; i < r.end; ++i) {
+        output[positions[i].second].assign(text, size);
+        found[positions[i].second] = true;
+    }
+}
+
+//Finds the coordinates of the texts. The IDs are sorted, so consecutive
+//lookups on invdict touch the same leaves
+struct LocateTexts {
+    std::vector<DictMgmt::Dict> &dictionaries;
+    const std::vector<uint64_t> &beginrange;
+    std::vector<TextRequest> &requests;
+    const std::vector<std::pair<uint64_t, size_t>> &positions;
+    std::string *output;
+    bool *found;
+    const bool inlineLits;
+    DecodeCache *cache;
+
+    void operator()(const ParallelRange &range) {
+        std::unique_ptr<char[]> text(new char[MAX_TERM_SIZE]);
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            TextRequest &r = requests[i];
+            int size;
+            if (inlineLits && InlineLiterals::isInlined(r.id)) {
+                size = InlineLiterals::decode(r.id, text.get());
+                scatterText(r, positions, text.get(), size, output, found);
+                r.dict = -2;
+                continue;
+            }
+            if (cache && cache->get(r.id, text.get(), size)) {
+                scatterText(r, positions, text.get(), size, output, found);
+                r.dict = -2;
+                continue;
+            }
+            int idx = 0;
+            while (idx < beginrange.size() - 1 && r.id >= beginrange[idx + 1]) {
+                idx++;
+            }
+            if (dictionaries[idx].fcdict) {
+                if (dictionaries[idx].fcdict->getText(r.id, text.get(), size)) {
+                    if (cache)
+                        cache->put(r.id, text.get(), size);
+                    scatterText(r, positions, text.get(), size, output, found);
+                    r.dict = -2;
+                }
+            } else if (dictionaries[idx].invdict->get(r.id, r.coordinates)) {
+                r.dict = idx;
+            }
+        }
+    }
+};
+
+//Decodes the texts sorted by coordinates, so every block of the
+//StringBuffer is decompressed once
+struct DecodeTexts {
+    std::vector<DictMgmt::Dict> &dictionaries;
+    const std::vector<TextRequest> &requests;
+    const std::vector<std::pair<uint64_t, size_t>> &positions;
+    std::string *output;
+    bool *found;
+    DecodeCache *cache;
+
+    void operator()(const ParallelRange &range) {
+        std::unique_ptr<char[]> text(new char[MAX_TERM_SIZE]);
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            const TextRequest &r = requests[i];
+            int size = 0;
+            dictionaries[r.dict].sb->get(r.coordinates, text.get(), size);
+            if (cache)
+                cache->put(r.id, text.get(), size);
+            scatterText(r, positions, text.get(), size, output, found);
+        }
+    }
+};
+
+void DictMgmt::getTexts(const uint64_t *ids, const size_t n,
+        std::string *output, bool *found, int nthreads) {
+    //The trees and the StringBuffer can be shared only if they are read-only.
+    //Without MT the trees load their nodes without locks
+    for (const auto &d : dictionaries) {
+        if (!d.fcdict && !d.sb->isReadOnly()) {
+            nthreads = 1;
+        }
+#ifndef MT
+        if (!d.fcdict) {
+            nthreads = 1;
+        }
+#endif
+    }
+    for (size_t i = 0; i < n; ++i) {
+        found[i] = false;
+    }
+
+    std::vector<std::pair<uint64_t, size_t>> positions(n);
+    for (size_t i = 0; i < n; ++i) {
+        positions[i] = std::make_pair(ids[i], i);
+    }
+    ParallelTasks::sort_int(positions.begin(), positions.end(), nthreads);
+    std::vector<TextRequest> requests;
+    for (size_t i = 0; i < n; ++i) {
+        if (i == 0 || positions[i].first != positions[i - 1].first) {
+            TextRequest r;
+            r.id = positions[i].first;
+            r.dict = -1;
+            r.coordinates = -1;
+            r.begin = i;
+            requests.push_back(r);
+        }
+        requests.back().end = i + 1;
+    }
+
+    LocateTexts locate = { dictionaries, beginrange, requests, positions,
+        output, found, inlineLits, decodeCache.get() };
+    ParallelTasks::parallel_for(0, requests.size(), 1024, locate, nthreads);
+
+    //The texts in the trees go first, sorted by dictionary and coordinates
+    auto endTrees = std::partition(requests.begin(), requests.end(),
+            [](const TextRequest &r) { return r.dict >= 0; });
+    ParallelTasks::sort_int(requests.begin(), endTrees, _sort_by_coordinates,
+            nthreads);
+    DecodeTexts decode = { dictionaries, requests, positions, output, found,
+        decodeCache.get() };
+    ParallelTasks::parallel_for(0, endTrees - requests.begin(), 1024, decode,
+            nthreads);
+
+    //The remaining IDs can be in the global update dictionary
+    if (!gud_idtext.empty()) {
+        for (auto r = endTrees; r != requests.end(); ++r) {
+            if (r->dict == -1) {
+                auto it = gud_idtext.find(r->id);
+                if (it != gud_idtext.end()) {
+                    scatterText(*r, positions, it->second.c_str(),
+                            it->second.size(), output, found);
+                }
+            }
+        }
+    }
+}
+
 void DictMgmt::getTextFromCoordinates(int64_t coordinates, char *output,
         int &sizeOutput) {
+    //The front-coded dictionary has no coordinates
+    if (!dictionaries[0].sb) {
+        LOG(ERRORL) << "The dictionary is front-coded and has no coordinates";
+        throw 10;
+    }
     dictionaries[0].sb->get(coordinates, output, sizeOutput);
     output[sizeOutput] = '\0';
 }
 
 bool DictMgmt::getNumber(const char *key, const int sizeKey, nTerm *value) {
+    uint64_t inlined;
+    if (inlineLits && InlineLiterals::encode(key, sizeKey, inlined)) {
+        *value = inlined;
+        return true;
+    }
     int i = 0;
     while (i < dictionaries.size()) {
-        if (!dictionaries[i].dict->get((tTerm*) key, sizeKey, value)) {
+        bool found;
+        if (dictionaries[i].fcdict) {
+            found = dictionaries[i].fcdict->getNumber(key, sizeKey, value);
+        } else if (dictionaries[i].hashidx) {
+            found = dictionaries[i].hashidx->get(key, sizeKey, value);
+        } else {
+            found = dictionaries[i].dict->get((tTerm*) key, sizeKey, value);
+        }
+        if (!found) {
             i++;
         } else {
             return true;
@@ -240,6 +490,89 @@ void DictMgmt::appendPair(const char *key, int sizeKey, nTerm &value) {
         largestID = value;
 }
 
+void DictMgmt::createHashIndex(string path) {
+    DictHashIndex::create(dictionaries[0].dict.get(),
+            dictionaries[0].sb.get(), path);
+}
+
+void DictMgmt::createTextIndex(string dir) {
+    //It runs while the loader sorts the permutations
+    MemoryReservation buffer(MemoryBudget::getInstance(), "textidx",
+            TEXTIDX_SORT_BUFFER, LOADER_MIN_SORT_BUFFER);
+    TextIndexBuilder builder(dir, buffer.getSize());
+    const Dict &d = dictionaries[0];
+    if (d.fcdict) {
+        char text[MAX_TERM_SIZE];
+        for (uint64_t rank = 0; rank < d.fcdict->getNTerms(); ++rank) {
+            const int size = d.fcdict->getTextAtRank(rank, text);
+            builder.add(text, size, d.fcdict->getIDAtRank(rank));
+        }
+    } else {
+        TreeItr *itr = d.dict->itr();
+        while (itr->hasNext()) {
+            int64_t id;
+            const int64_t coordinates = itr->next(id);
+            int size;
+            const char *text = d.sb->get(coordinates, size);
+            builder.add(text, size, id);
+        }
+        delete itr;
+    }
+    builder.finish();
+}
+
+bool DictMgmt::searchText(const std::string &pattern, bool prefix,
+        std::vector<uint64_t> &ids, std::vector<std::string> *texts,
+        uint64_t maxCandidates, int nthreads) {
+    ids.clear();
+    if (texts) {
+        texts->clear();
+    }
+    if (!dictionaries[0].textidx) {
+        return false;
+    }
+    std::vector<uint64_t> candidates;
+    if (!dictionaries[0].textidx->getCandidates(pattern.c_str(),
+                pattern.size(), maxCandidates, candidates)) {
+        return false;
+    }
+
+    //The trigrams can match in different positions, so the candidates are
+    //verified on their texts
+    std::unique_ptr<std::string[]> candTexts(new std::string[candidates.size()]);
+    std::unique_ptr<bool[]> found(new bool[candidates.size()]);
+    getTexts(candidates.data(), candidates.size(), candTexts.get(),
+            found.get(), nthreads);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (!found[i]) {
+            continue;
+        }
+        const std::string &text = candTexts[i];
+        const bool match = prefix ? text.compare(0, pattern.size(), pattern) == 0
+            : text.find(pattern) != std::string::npos;
+        if (match) {
+            ids.push_back(candidates[i]);
+            if (texts) {
+                texts->push_back(std::move(candTexts[i]));
+            }
+        }
+    }
+    return true;
+}
+
+uint64_t DictMgmt::getTextIndexNIDs() {
+    if (!dictionaries[0].textidx) {
+        return 0;
+    }
+    return dictionaries[0].textidx->getNIDs();
+}
+
+void DictMgmt::registerInsertedTerms(int64_t nTerms, int64_t largest) {
+    insertedNewTerms[0] += nTerms;
+    if (largest > largestID)
+        largestID = largest;
+}
+
 bool DictMgmt::putPair(const char *key, int sizeKey, nTerm &value) {
     int64_t coordinates = dictionaries[0].sb->getSize();
     if (dictionaries[0].dict->insertIfNotExists((tTerm*) key, sizeKey, value)) {
@@ -286,6 +619,34 @@ bool DictMgmt::putInvDict(const nTerm key, const int64_t coordinates) {
     return true;
 }
 
+MemoryManagerStats DictMgmt::getCacheStats() {
+    MemoryManagerStats stats;
+    for (auto &d : dictionaries) {
+        if (d.dict) {
+            stats.add(d.dict->getCacheStats());
+        }
+        if (d.invdict) {
+            stats.add(d.invdict->getCacheStats());
+        }
+    }
+    return stats;
+}
+
+void DictMgmt::setDecodeCache(uint64_t maxBytes) {
+    if (maxBytes > 0) {
+        decodeCache = std::unique_ptr<DecodeCache>(new DecodeCache(maxBytes));
+    } else {
+        decodeCache = NULL;
+    }
+}
+
+DecodeCacheStats DictMgmt::getDecodeCacheStats() {
+    if (decodeCache) {
+        return decodeCache->getStats();
+    }
+    return DecodeCacheStats();
+}
+
 void DictMgmt::addUpdates(std::vector<Dict> &updates) {
     //Add the updates
     for (int i = 0; i < updates.size(); ++i) {
@@ -0,0 +1,336 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/kb/fcdict.h>
+
+#include <kognac/lz4io.h>
+#include <kognac/logs.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <queue>
+
+#define FCDICT_META_SIZE 22
+
+bool FCDict::exists(std::string dir) {
+    return Utils::exists(dir + DIR_SEP + "meta");
+}
+
+FCDict::FCDict(std::string dir) {
+    std::ifstream meta(dir + DIR_SEP + "meta", std::ios_base::binary);
+    char header[FCDICT_META_SIZE];
+    meta.read(header, FCDICT_META_SIZE);
+    if (meta.gcount() != FCDICT_META_SIZE) {
+        LOG(ERRORL) << "The front-coded dictionary " << dir << " is corrupted";
+        throw 10;
+    }
+    meta.close();
+    nTerms = Utils::decode_long(header, 0);
+    nIDs = Utils::decode_long(header, 8);
+    bytesPerID = (uint8_t) header[16];
+    bytesPerRank = (uint8_t) header[17];
+    termsPerBlock = Utils::decode_int(header, 18);
+    nBlocks = (nTerms + termsPerBlock - 1) / termsPerBlock;
+
+    strings = blocks = ids = ranks = NULL;
+    if (nTerms > 0) {
+        fStrings = std::unique_ptr<MemoryMappedFile>(
+                new MemoryMappedFile(dir + DIR_SEP + "strings", true));
+        fBlocks = std::unique_ptr<MemoryMappedFile>(
+                new MemoryMappedFile(dir + DIR_SEP + "blocks", true));
+        fIds = std::unique_ptr<MemoryMappedFile>(
+                new MemoryMappedFile(dir + DIR_SEP + "ids", true));
+        fRanks = std::unique_ptr<MemoryMappedFile>(
+                new MemoryMappedFile(dir + DIR_SEP + "ranks", true));
+        if (fBlocks->getLength() != nBlocks * 8 ||
+                fIds->getLength() != nTerms * bytesPerID ||
+                fRanks->getLength() != nIDs * bytesPerRank) {
+            LOG(ERRORL) << "The front-coded dictionary " << dir << " is corrupted";
+            throw 10;
+        }
+        strings = fStrings->getData();
+        blocks = fBlocks->getData();
+        ids = fIds->getData();
+        ranks = fRanks->getData();
+        //The lookups are random
+        fStrings->advise(ACCESS_RANDOM);
+        fRanks->advise(ACCESS_RANDOM);
+    }
+}
+
+int FCDict::decode(const char *block, int pos, char *output) const {
+    int offset = 0;
+    int size = (int) Utils::decode_vlong2(block, &offset);
+    memcpy(output, block + offset, size);
+    offset += size;
+    for (int i = 0; i < pos; ++i) {
+        const int prefix = (int) Utils::decode_vlong2(block, &offset);
+        const int suffix = (int) Utils::decode_vlong2(block, &offset);
+        memcpy(output + prefix, block + offset, suffix);
+        offset += suffix;
+        size = prefix + suffix;
+    }
+    return size;
+}
+
+bool FCDict::getText(nTerm id, char *output, int &size) const {
+    if (id < 0 || (uint64_t) id >= nIDs) {
+        return false;
+    }
+    const uint64_t rank = Utils::decode_longFixedBytes(
+            ranks + id * bytesPerRank, bytesPerRank);
+    if (rank == 0) {
+        return false;
+    }
+    size = getTextAtRank(rank - 1, output);
+    return true;
+}
+
+int FCDict::compare(const char *t1, const int s1, const char *t2,
+        const int s2) {
+    const int ret = memcmp(t1, t2, std::min(s1, s2));
+    if (ret != 0) {
+        return ret;
+    }
+    return s1 - s2;
+}
+
+bool FCDict::getNumber(const char *text, const int size, nTerm *id) const {
+    if (nTerms == 0) {
+        return false;
+    }
+    //Find the last block whose first term is not larger than text
+    uint64_t low = 0, high = nBlocks;
+    while (high - low > 1) {
+        const uint64_t mid = (low + high) / 2;
+        const char *block = getBlock(mid);
+        int offset = 0;
+        const int s = (int) Utils::decode_vlong2(block, &offset);
+        if (compare(block + offset, s, text, size) <= 0) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    //Scan the block
+    char term[MAX_TERM_SIZE];
+    const char *block = getBlock(low);
+    int offset = 0;
+    int s = (int) Utils::decode_vlong2(block, &offset);
+    memcpy(term, block + offset, s);
+    offset += s;
+    const uint64_t first = low * termsPerBlock;
+    const int n = (int) std::min((uint64_t) termsPerBlock, nTerms - first);
+    for (int i = 0; ; ++i) {
+        const int cmp = compare(term, s, text, size);
+        if (cmp == 0) {
+            *id = getIDAtRank(first + i);
+            return true;
+        } else if (cmp > 0 || i + 1 == n) {
+            return false;
+        }
+        const int prefix = (int) Utils::decode_vlong2(block, &offset);
+        const int suffix = (int) Utils::decode_vlong2(block, &offset);
+        memcpy(term + prefix, block + offset, suffix);
+        offset += suffix;
+        s = prefix + suffix;
+    }
+}
+
+FCDictBuilder::FCDictBuilder(std::string dir, uint64_t maxMemory) :
+    dir(dir), maxMemory(maxMemory), largestID(-1), nAdded(0), nDuplicates(0) {
+        Utils::create_directories(dir);
+    }
+
+void FCDictBuilder::add(const char *text, const int size, const nTerm id) {
+    if (texts.size() + (terms.size() + 1) * sizeof(Term) + size > maxMemory
+            && !terms.empty()) {
+        flushRun();
+    }
+    Term t;
+    t.offset = texts.size();
+    t.size = size;
+    t.id = id;
+    texts.insert(texts.end(), text, text + size);
+    terms.push_back(t);
+    nAdded++;
+    largestID = std::max(largestID, id);
+}
+
+void FCDictBuilder::flushRun() {
+    const char *data = texts.data();
+    std::sort(terms.begin(), terms.end(), [data](const Term &t1, const Term &t2) {
+            const int cmp = FCDict::compare(data + t1.offset, t1.size,
+                    data + t2.offset, t2.size);
+            return cmp < 0 || (cmp == 0 && t1.id < t2.id);
+            });
+    const std::string file = dir + DIR_SEP + "run" + std::to_string(runs.size());
+    LZ4Writer writer(file);
+    for (const auto &t : terms) {
+        writer.writeLong(t.id);
+        writer.writeString(data + t.offset, t.size);
+    }
+    runs.push_back(file);
+    LOG(DEBUGL) << "Sorted " << terms.size() << " terms in " << file;
+    terms.clear();
+    texts.clear();
+}
+
+struct FCDictRun {
+    std::unique_ptr<LZ4Reader> reader;
+    std::string text;
+    nTerm id;
+
+    bool next() {
+        if (reader->isEof()) {
+            return false;
+        }
+        id = reader->parseLong();
+        int size;
+        const char *t = reader->parseString(size);
+        text.assign(t, size);
+        return true;
+    }
+};
+
+struct FCDictRunCmp {
+    bool operator()(const FCDictRun *r1, const FCDictRun *r2) const {
+        const int cmp = FCDict::compare(r1->text.c_str(), r1->text.size(),
+                r2->text.c_str(), r2->text.size());
+        return cmp > 0 || (cmp == 0 && r1->id > r2->id);
+    }
+};
+
+uint64_t FCDictBuilder::finish() {
+    if (!terms.empty()) {
+        flushRun();
+    }
+    std::vector<FCDictRun> openRuns(runs.size());
+    std::priority_queue<FCDictRun*, std::vector<FCDictRun*>, FCDictRunCmp> queue;
+    for (int i = 0; i < runs.size(); ++i) {
+        openRuns[i].reader = std::unique_ptr<LZ4Reader>(new LZ4Reader(runs[i]));
+        if (openRuns[i].next()) {
+            queue.push(&openRuns[i]);
+        }
+    }
+
+    //The ranks are written at random positions, so they are mapped in memory
+    const uint64_t nIDs = largestID + 1;
+    const uint8_t bytesPerID = Utils::numBytesFixedLength(std::max(largestID,
+                (nTerm) 1));
+    const uint8_t bytesPerRank = Utils::numBytesFixedLength(nAdded + 1);
+    std::unique_ptr<MemoryMappedFile> fRanks;
+    char *ranks = NULL;
+    if (nIDs > 0) {
+        //The new file is filled with zeros (no term)
+        if (Utils::exists(dir + DIR_SEP + "ranks")) {
+            Utils::remove(dir + DIR_SEP + "ranks");
+        }
+        Utils::resizeFile(dir + DIR_SEP + "ranks", nIDs * bytesPerRank);
+        fRanks = std::unique_ptr<MemoryMappedFile>(new MemoryMappedFile(
+                    dir + DIR_SEP + "ranks", false, 0, nIDs * bytesPerRank));
+        ranks = fRanks->getData();
+    }
+
+    std::ofstream fStrings(dir + DIR_SEP + "strings", std::ios_base::binary);
+    std::ofstream fBlocks(dir + DIR_SEP + "blocks", std::ios_base::binary);
+    std::ofstream fIds(dir + DIR_SEP + "ids", std::ios_base::binary);
+    std::vector<char> buffer(2 * MAX_TERM_SIZE + 20);
+    std::string previous;
+    bool hasPrevious = false;
+    uint64_t offset = 0;
+    uint64_t rank = 0;
+    while (!queue.empty()) {
+        FCDictRun *run = queue.top();
+        queue.pop();
+        const std::string &text = run->text;
+        if (hasPrevious && text == previous) {
+            LOG(TRACEL) << "The term " << text << " is already in the dictionary."
+                " The ID " << run->id << " is ignored";
+            nDuplicates++;
+        } else {
+            int pos = 0;
+            if (rank % FCDICT_BLOCK_TERMS == 0) {
+                char off[8];
+                Utils::encode_long(off, 0, offset);
+                fBlocks.write(off, 8);
+                pos = Utils::encode_vlong2(buffer.data(), pos, text.size());
+                memcpy(buffer.data() + pos, text.c_str(), text.size());
+                pos += text.size();
+            } else {
+                const int prefix = Utils::commonPrefix(previous.c_str(), 0,
+                        previous.size(), text.c_str(), 0, text.size());
+                pos = Utils::encode_vlong2(buffer.data(), pos, prefix);
+                pos = Utils::encode_vlong2(buffer.data(), pos,
+                        text.size() - prefix);
+                memcpy(buffer.data() + pos, text.c_str() + prefix,
+                        text.size() - prefix);
+                pos += text.size() - prefix;
+            }
+            fStrings.write(buffer.data(), pos);
+            offset += pos;
+
+            char id[8];
+            Utils::encode_longNBytes(id, bytesPerID, run->id);
+            fIds.write(id, bytesPerID);
+            Utils::encode_longNBytes(ranks + run->id * bytesPerRank,
+                    bytesPerRank, rank + 1);
+            rank++;
+            previous = text;
+            hasPrevious = true;
+        }
+        if (run->next()) {
+            queue.push(run);
+        }
+    }
+    fStrings.close();
+    fBlocks.close();
+    fIds.close();
+    if (fStrings.fail() || fBlocks.fail() || fIds.fail()) {
+        LOG(ERRORL) << "Failed in writing the front-coded dictionary in " << dir;
+        throw 10;
+    }
+    if (fRanks) {
+        fRanks->flushAll();
+        fRanks = NULL;
+    }
+    openRuns.clear();
+    for (const auto &run : runs) {
+        Utils::remove(run);
+    }
+    runs.clear();
+
+    char header[FCDICT_META_SIZE];
+    Utils::encode_long(header, 0, rank);
+    Utils::encode_long(header, 8, nIDs);
+    header[16] = bytesPerID;
+    header[17] = bytesPerRank;
+    Utils::encode_int(header, 18, FCDICT_BLOCK_TERMS);
+    std::ofstream meta(dir + DIR_SEP + "meta", std::ios_base::binary);
+    meta.write(header, FCDICT_META_SIZE);
+    meta.close();
+    LOG(DEBUGL) << "Front-coded dictionary: " << rank << " terms in " <<
+        offset << " bytes";
+    return rank;
+}
@@ -0,0 +1,436 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/kb/inlineliterals.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define XSD_PREFIX "\"^^<http://www.w3.org/2001/XMLSchema#"
+
+//Keys of the positive numbers have this bit set
+#define INLINELITS_POSITIVE (UINT64_C(1) << 36)
+//Bits of the mantissa of a double that are kept in the key
+#define INLINELITS_MANTISSA_BITS 30
+#define INLINELITS_MANTISSA ((UINT64_C(1) << INLINELITS_MANTISSA_BITS) - 1)
+#define INLINELITS_DROPPED_BITS (52 - INLINELITS_MANTISSA_BITS)
+//Exponents in [-31, 31] are stored in six bits, zero is reserved for 0.0
+#define INLINELITS_EXP_BIAS 32
+#define INLINELITS_MAX_EXP 31
+//Days between 0001-01-01 and 1970-01-01
+#define INLINELITS_EPOCH_DAYS INT64_C(719162)
+//Days between 0001-01-01 and 1900-01-01, the first day of the inlined
+//dateTimes. 2^36 seconds cover the years until 3999
+#define INLINELITS_DATETIME_DAYS INT64_C(693595)
+#define INLINELITS_MIN_YEAR 1900
+#define INLINELITS_MAX_YEAR 3999
+
+static const char *typeNames[] = { "double>", "decimal>", "dateTime>" };
+
+//Returns the datatype of a literal, or -1 if it is not a double, decimal
+//or dateTime. The lexical form is in [text + 1, text + 1 + lexSize)
+static int parseType(const char *text, const int size, int &lexSize) {
+    if (size < 2 || text[0] != '"')
+        return -1;
+    const char *end = (const char*) memchr(text + 1, '"', size - 1);
+    if (end == NULL)
+        return -1;
+    lexSize = end - text - 1;
+    const int prefixSize = sizeof(XSD_PREFIX) - 1;
+    const int remaining = size - (end - text);
+    if (remaining <= prefixSize || memcmp(end, XSD_PREFIX, prefixSize) != 0)
+        return -1;
+    for (int i = 0; i < 3; ++i) {
+        const int len = strlen(typeNames[i]);
+        if (remaining - prefixSize == len &&
+                memcmp(end + prefixSize, typeNames[i], len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//Parses a number that spans the whole lexical form
+static bool parseNumber(const char *lex, const int lexSize, double &value) {
+    char buffer[64];
+    if (lexSize == 0 || lexSize >= (int) sizeof(buffer))
+        return false;
+    memcpy(buffer, lex, lexSize);
+    buffer[lexSize] = '\0';
+    char *end;
+    value = strtod(buffer, &end);
+    return end == buffer + lexSize && std::isfinite(value);
+}
+
+//Writes the shortest digits that give back the value, without exponent
+static int formatNumber(const double value, char *out) {
+    if (value == 0) {
+        out[0] = '0';
+        return 1;
+    }
+    char buffer[40];
+    for (int p = 1; p <= 17; ++p) {
+        snprintf(buffer, sizeof(buffer), "%.*e", p - 1, value);
+        if (strtod(buffer, NULL) == value)
+            break;
+    }
+    //buffer is [-]d[.ddd]e<exp>
+    int n = 0;
+    const char *c = buffer;
+    if (*c == '-') {
+        out[n++] = '-';
+        c++;
+    }
+    char digits[20];
+    int nDigits = 0;
+    for (; *c != 'e'; ++c) {
+        if (*c != '.')
+            digits[nDigits++] = *c;
+    }
+    const int exp = atoi(c + 1);
+    if (exp < 0) {
+        out[n++] = '0';
+        out[n++] = '.';
+        for (int i = 0; i < -exp - 1; ++i)
+            out[n++] = '0';
+        memcpy(out + n, digits, nDigits);
+        n += nDigits;
+    } else if (exp + 1 >= nDigits) {
+        memcpy(out + n, digits, nDigits);
+        n += nDigits;
+        for (int i = nDigits; i < exp + 1; ++i)
+            out[n++] = '0';
+    } else {
+        memcpy(out + n, digits, exp + 1);
+        n += exp + 1;
+        out[n++] = '.';
+        memcpy(out + n, digits + exp + 1, nDigits - exp - 1);
+        n += nDigits - exp - 1;
+    }
+    return n;
+}
+
+//Days since 0001-01-01 (proleptic Gregorian calendar)
+static int64_t daysFromCivil(int64_t y, const unsigned m, const unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned) (y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t) doe - 719468 + INLINELITS_EPOCH_DAYS;
+}
+
+static void civilFromDays(int64_t days, int &y, int &m, int &d) {
+    days += 719468 - INLINELITS_EPOCH_DAYS;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = (unsigned) (days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int) (yoe + era * 400 + (m <= 2));
+}
+
+static bool isLeap(const int y) {
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+static int daysInMonth(const int y, const int m) {
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    return m == 2 && isLeap(y) ? 29 : days[m - 1];
+}
+
+static bool parseDigits(const char *text, const int n, int &value) {
+    value = 0;
+    for (int i = 0; i < n; ++i) {
+        if (text[i] < '0' || text[i] > '9')
+            return false;
+        value = value * 10 + text[i] - '0';
+    }
+    return true;
+}
+
+static bool isValidDateTime(const int y, const int mo, const int d,
+        const int h, const int mi, const int s) {
+    return y >= 1 && y <= 9999 && mo >= 1 && mo <= 12 && d >= 1 &&
+        d <= daysInMonth(y, mo) && h <= 23 && mi <= 59 && s <= 59;
+}
+
+//Parses YYYY-MM-DDThh:mm:ss[Z] into the payload of a dateTime
+static bool parseDateTime(const char *lex, const int lexSize, uint64_t &payload) {
+    if ((lexSize != 19 && lexSize != 20) || lex[4] != '-' || lex[7] != '-' ||
+            lex[10] != 'T' || lex[13] != ':' || lex[16] != ':') {
+        return false;
+    }
+    int y, mo, d, h, mi, s;
+    if (!parseDigits(lex, 4, y) || !parseDigits(lex + 5, 2, mo) ||
+            !parseDigits(lex + 8, 2, d) || !parseDigits(lex + 11, 2, h) ||
+            !parseDigits(lex + 14, 2, mi) || !parseDigits(lex + 17, 2, s) ||
+            !isValidDateTime(y, mo, d, h, mi, s) ||
+            y < INLINELITS_MIN_YEAR || y > INLINELITS_MAX_YEAR) {
+        return false;
+    }
+    const bool z = lexSize == 20;
+    if (z && lex[19] != 'Z')
+        return false;
+
+    const int64_t seconds = (daysFromCivil(y, mo, d) -
+            INLINELITS_DATETIME_DAYS) * 86400 + h * 3600 + mi * 60 + s;
+    payload = ((uint64_t) seconds << 1) | (uint64_t) z;
+    return true;
+}
+
+bool InlineLiterals::getKey(double value, uint64_t &key, bool &exact) {
+    exact = true;
+    if (value == 0) {
+        key = INLINELITS_POSITIVE;
+        return true;
+    }
+    if (!std::isfinite(value))
+        return false;
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(double));
+    const int exp = (int) ((bits >> 52) & 0x7FF) - 1023;
+    if (exp < -INLINELITS_MAX_EXP || exp > INLINELITS_MAX_EXP)
+        return false;
+    //The magnitude is truncated, so it is the one of the largest inlined
+    //value whose absolute value is not larger
+    exact = (bits & ((UINT64_C(1) << INLINELITS_DROPPED_BITS) - 1)) == 0;
+    const uint64_t magnitude = ((uint64_t) (exp + INLINELITS_EXP_BIAS) <<
+            INLINELITS_MANTISSA_BITS) |
+        ((bits >> INLINELITS_DROPPED_BITS) & INLINELITS_MANTISSA);
+    if (bits >> 63) {
+        key = INLINELITS_POSITIVE - 1 - magnitude;
+        if (!exact) {
+            if (key == 0)
+                return false;
+            key--;
+        }
+    } else {
+        key = INLINELITS_POSITIVE | magnitude;
+    }
+    return true;
+}
+
+double InlineLiterals::getValue(uint64_t key) {
+    uint64_t sign = 0;
+    uint64_t magnitude;
+    if (key & INLINELITS_POSITIVE) {
+        magnitude = key & (INLINELITS_POSITIVE - 1);
+    } else {
+        sign = UINT64_C(1) << 63;
+        magnitude = INLINELITS_POSITIVE - 1 - key;
+    }
+    if (magnitude == 0)
+        return 0;
+    const int exp = (int) (magnitude >> INLINELITS_MANTISSA_BITS) -
+        INLINELITS_EXP_BIAS;
+    const uint64_t bits = sign | ((uint64_t) (exp + 1023) << 52) |
+        ((magnitude & INLINELITS_MANTISSA) << INLINELITS_DROPPED_BITS);
+    double value;
+    memcpy(&value, &bits, sizeof(double));
+    return value;
+}
+
+bool InlineLiterals::encode(const char *text, const int size, uint64_t &id) {
+    int lexSize;
+    const int type = parseType(text, size, lexSize);
+    if (type < 0)
+        return false;
+    const char *lex = text + 1;
+    uint64_t payload;
+    if (type == INLINELITS_DATETIME) {
+        if (!parseDateTime(lex, lexSize, payload))
+            return false;
+    } else {
+        double value;
+        bool exact;
+        if (!parseNumber(lex, lexSize, value) || !getKey(value, payload, exact) ||
+                !exact)
+            return false;
+        //Only the canonical text can be reconstructed
+        char canonical[64];
+        const int canonicalSize = formatNumber(value, canonical);
+        if (canonicalSize != lexSize || memcmp(canonical, lex, lexSize) != 0)
+            return false;
+    }
+    id = getClassBegin(type) | payload;
+    return true;
+}
+
+int InlineLiterals::decode(const uint64_t id, char *text) {
+    const int type = getClass(id);
+    const uint64_t payload = id & INLINELITS_PAYLOAD_MASK;
+    int n = 0;
+    text[n++] = '"';
+    if (type == INLINELITS_DATETIME) {
+        const bool z = payload & 1;
+        const int64_t seconds = getSeconds(id);
+        int y, mo, d;
+        civilFromDays(seconds / 86400, y, mo, d);
+        const int daySeconds = seconds % 86400;
+        n += sprintf(text + n, "%04d-%02d-%02dT%02d:%02d:%02d", y, mo, d,
+                daySeconds / 3600, (daySeconds / 60) % 60, daySeconds % 60);
+        if (z)
+            text[n++] = 'Z';
+    } else {
+        n += formatNumber(getValue(payload), text + n);
+    }
+    const int prefixSize = sizeof(XSD_PREFIX) - 1;
+    memcpy(text + n, XSD_PREFIX, prefixSize);
+    n += prefixSize;
+    const int typeSize = strlen(typeNames[type]);
+    memcpy(text + n, typeNames[type], typeSize);
+    n += typeSize;
+    text[n] = '\0';
+    return n;
+}
+
+double InlineLiterals::getDouble(const uint64_t id) {
+    return getValue(id & INLINELITS_PAYLOAD_MASK);
+}
+
+int64_t InlineLiterals::getSeconds(const uint64_t id) {
+    return (int64_t) ((id & INLINELITS_PAYLOAD_MASK) >> 1) +
+        INLINELITS_DATETIME_DAYS * 86400;
+}
+
+bool InlineLiterals::compare(const uint64_t id1, const uint64_t id2, int &res) {
+    if (!isInlined(id1) || !isInlined(id2))
+        return false;
+    const int c1 = getClass(id1);
+    const int c2 = getClass(id2);
+    uint64_t v1, v2;
+    if (c1 != INLINELITS_DATETIME && c2 != INLINELITS_DATETIME) {
+        //Doubles and decimals share the same keys
+        v1 = id1 & INLINELITS_PAYLOAD_MASK;
+        v2 = id2 & INLINELITS_PAYLOAD_MASK;
+    } else if (c1 == INLINELITS_DATETIME && c2 == INLINELITS_DATETIME) {
+        v1 = getSeconds(id1);
+        v2 = getSeconds(id2);
+    } else {
+        return false;
+    }
+    res = v1 < v2 ? -1 : (v1 > v2 ? 1 : 0);
+    return true;
+}
+
+bool InlineLiterals::getRanges(const char *constant, const int size,
+        const Cmp cmp, std::vector<Range> &ranges) {
+    int lexSize;
+    const char *lex = constant + 1;
+    //Bounds of the keys that satisfy the comparison
+    int64_t lo = 0, hi = INLINELITS_PAYLOAD_MASK;
+    int type = parseType(constant, size, lexSize);
+    if (type < 0) {
+        //Integers and floats are compared with the inlined numbers too
+        const char *integer = XSD_PREFIX "integer>";
+        const char *flt = XSD_PREFIX "float>";
+        const char *end = (const char*) memchr(lex, '"', size - 1);
+        if (end == NULL)
+            return false;
+        const int suffixSize = size - (end - constant);
+        if ((suffixSize != (int) strlen(integer) ||
+                    memcmp(end, integer, suffixSize) != 0) &&
+                (suffixSize != (int) strlen(flt) ||
+                 memcmp(end, flt, suffixSize) != 0)) {
+            return false;
+        }
+        lexSize = end - lex;
+        type = INLINELITS_DOUBLE;
+    }
+
+    if (type == INLINELITS_DATETIME) {
+        //The comparisons ignore the timezones
+        int y, mo, d, h, mi, s;
+        if (lexSize < 19 || lex[4] != '-' || lex[7] != '-' ||
+                lex[10] != 'T' || lex[13] != ':' || lex[16] != ':' ||
+                !parseDigits(lex, 4, y) || !parseDigits(lex + 5, 2, mo) ||
+                !parseDigits(lex + 8, 2, d) || !parseDigits(lex + 11, 2, h) ||
+                !parseDigits(lex + 14, 2, mi) || !parseDigits(lex + 17, 2, s) ||
+                !isValidDateTime(y, mo, d, h, mi, s)) {
+            return false;
+        }
+        //Seconds since the first inlined dateTime. They can be negative
+        //or beyond the last one, then the range is empty or covers all
+        const int64_t seconds = (daysFromCivil(y, mo, d) -
+                INLINELITS_DATETIME_DAYS) * 86400 + h * 3600 + mi * 60 + s;
+        //The fractions of the constant are ignored, like Selection does
+        //when the filter is not pushed
+        switch (cmp) {
+            case LESS:
+                hi = seconds * 2 - 1;
+                break;
+            case LESSOREQUAL:
+                hi = (seconds + 1) * 2 - 1;
+                break;
+            case GREATER:
+                lo = (seconds + 1) * 2;
+                break;
+            case GREATEROREQUAL:
+                lo = seconds * 2;
+                break;
+        }
+        const uint64_t begin = getClassBegin(INLINELITS_DATETIME);
+        ranges.push_back({ begin, getClassEnd(INLINELITS_DATETIME),
+                begin + lo, begin + hi });
+        return true;
+    }
+
+    double value;
+    uint64_t key;
+    bool exact;
+    if (!parseNumber(lex, lexSize, value) || !getKey(value, key, exact))
+        return false;
+    if (!exact) {
+        //No inlined value is equal to the constant. key is the one of the
+        //largest smaller value
+        if (cmp == LESS || cmp == LESSOREQUAL) {
+            hi = key;
+        } else {
+            lo = key + 1;
+        }
+    } else {
+        switch (cmp) {
+            case LESS:
+                hi = (int64_t) key - 1;
+                break;
+            case LESSOREQUAL:
+                hi = key;
+                break;
+            case GREATER:
+                lo = key + 1;
+                break;
+            case GREATEROREQUAL:
+                lo = key;
+                break;
+        }
+    }
+    for (int c = INLINELITS_DOUBLE; c <= INLINELITS_DECIMAL; ++c) {
+        const uint64_t begin = getClassBegin(c);
+        ranges.push_back({ begin, getClassEnd(c), begin + lo, begin + hi });
+    }
+    return true;
+}
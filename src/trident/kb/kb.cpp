@@ -26,8 +26,14 @@
 #include <trident/kb/inserter.h>
 #include <trident/kb/consts.h>
 #include <trident/kb/kbconfig.h>
+#include <trident/kb/warmup.h>
+#include <trident/kb/fcdict.h>
+#include <trident/kb/textindex.h>
+#include <trident/kb/dicthashindex.h>
 #include <trident/tree/root.h>
 #include <trident/tree/flatroot.h>
+#include <trident/tree/coordtable.h>
+#include <trident/tree/treebuilder.h>
 #include <trident/tree/stringbuffer.h>
 #include <trident/binarytables/tableshandler.h>
 
@@ -144,6 +150,8 @@ KB::KB(const char *path,
             map.setInt(MAX_NODES_IN_CACHE, config.getParamInt(TREE_MAXNODESINCACHE));
             map.setInt(NODE_MIN_BYTES, config.getParamInt(TREE_NODEMINBYTES));
             map.setLong(CACHE_MAX_SIZE, config.getParamLong(TREE_MAXSIZECACHETREE));
+            map.setInt(CACHE_POLICY,
+                    getMemoryPolicy(config.getParam(CACHE_REPLACEMENT_POLICY)));
             map.setInt(FILE_MAX_SIZE, config.getParamInt(TREE_MAXFILESIZE));
             map.setInt(MAX_N_OPENED_FILES, config.getParamInt(TREE_MAXNFILES));
             map.setInt(MAX_EL_PER_NODE, config.getParamInt(TREE_MAXELEMENTSNODE));
@@ -161,6 +169,13 @@ KB::KB(const char *path,
             map.setInt(NODE_KEYS_PREALL_FACTORY_SIZE,
                     config.getParamInt(TREE_NODE_KEYS_PREALL_FACTORY_SIZE));
             tree = new Root(fileTree, NULL, readOnly, map);
+
+            //Lookup the coordinates without traversing the tree
+            string coordsTable = fileTree + string("coords");
+            if (readOnly && config.getParamBool(TREE_COORDTABLE) &&
+                    Utils::exists(coordsTable)) {
+                tree->setCoordinatesTable(new CoordinatesTable(coordsTable));
+            }
         }
 
         std::chrono::duration<double> sec = std::chrono::system_clock::now()
@@ -168,6 +183,7 @@ KB::KB(const char *path,
         LOG(DEBUGL) << "Time init tree KB = " << sec.count() * 1000 << " ms and " << Utils::get_max_mem() << " MB occupied";
 
         //Initialize the dictionaries
+        dictManager = NULL;
         if (dictEnabled) {
             loadDict(&config);
             sec = std::chrono::system_clock::now() - start;
@@ -176,20 +192,41 @@ KB::KB(const char *path,
                 Utils::get_max_mem() << " MB occupied";
             dictManager = new DictMgmt(*maindict.get(), string(path) + DIR_SEP + "_diff",
                     dictHash, string(path) + DIR_SEP + "e2r", string(path) + DIR_SEP + "e2s");
+            //Some literals are encoded in the IDs and not in the dictionary
+            if (Utils::exists(string(path) + DIR_SEP + "inlinelits")) {
+                dictManager->setInlineLiterals(true);
+            }
+            if (readOnly) {
+                dictManager->setDecodeCache(
+                        config.getParamLong(DICT_DECODECACHE_SIZE));
+            }
         }
 
         //Initialize the memory tracker for the storage partitions
+        const MemoryPolicy cachePolicy = getMemoryPolicy(
+                config.getParam(CACHE_REPLACEMENT_POLICY));
         bytesTracker[0] = new MemoryManager<FileDescriptor>(
-                config.getParamLong(STORAGE_CACHE_SIZE));
+                config.getParamLong(STORAGE_CACHE_SIZE), cachePolicy);
         for (int i = 1; i < nindices; ++i) {
             if (!readOnly) {
                 bytesTracker[i] = new MemoryManager<FileDescriptor>(
-                        config.getParamLong(STORAGE_CACHE_SIZE));
+                        config.getParamLong(STORAGE_CACHE_SIZE), cachePolicy);
             } else {
                 bytesTracker[i] = NULL;
             }
         }
 
+        //Shared by the partitions whose files are compressed
+        if (readOnly) {
+            blockCache = std::unique_ptr<BlockCache>(new BlockCache(
+                        config.getParamLong(STORAGE_BLOCKCACHE_SIZE)));
+            if (config.getParamInt(STORAGE_PREFETCH_THREADS) > 0) {
+                prefetcher = std::unique_ptr<Prefetcher>(new Prefetcher(
+                            config.getParamInt(STORAGE_PREFETCH_THREADS),
+                            config.getParamBool(STORAGE_PREFETCH_IOURING)));
+            }
+        }
+
         if (nindices == 3) {
             pso = new CacheIdx();
             osp = new CacheIdx();
@@ -208,7 +245,8 @@ KB::KB(const char *path,
                     files[i] = new TableStorage(readOnly, is.str(),
                             config.getParamLong(STORAGE_MAX_FILE_SIZE),
                             config.getParamInt(STORAGE_MAX_N_FILES),
-                            NULL, stats, i);
+                            NULL, blockCache.get(), stats, i);
+                    files[i]->setPrefetcher(prefetcher.get());
                 } else {
                     files[i] = NULL;
                 }
@@ -220,6 +258,27 @@ KB::KB(const char *path,
             }
         }
 
+        //Access hints and warmup of the files (only for reading)
+        if (readOnly) {
+            if (config.getParamBool(STORAGE_ACCESS_HINTS)) {
+                for (int i = 0; i < nindices; ++i) {
+                    if (files[i] != NULL) {
+                        files[i]->setAccessHints();
+                    }
+                }
+            }
+            std::vector<int> warmupPerms = Warmup::parsePermutations(
+                    config.getParam(WARMUP_PERMS));
+            if (!warmupPerms.empty() || config.getParamBool(WARMUP_TREE) ||
+                    config.getParamBool(WARMUP_DICT)) {
+                Warmup::warmupKB(path, warmupPerms,
+                        config.getParamBool(WARMUP_TREE),
+                        config.getParamBool(WARMUP_DICT),
+                        config.getParamInt(WARMUP_THREADS),
+                        config.getParamInt(WARMUP_TIMEOUT));
+            }
+        }
+
         //Is there some sample data available?
         string sampleDir = path + DIR_SEP + string("_sample");
         if (Utils::exists(sampleDir)) {
@@ -309,6 +368,44 @@ KB::KB(const char *path,
         LOG(DEBUGL) << "Time init KB = " << sec.count() * 1000 << " ms and " << Utils::get_max_mem() << " MB occupied";
     }
 
+TreeBuilder *KB::bulkLoadTree(int nPartitions) {
+    if (readOnly) {
+        LOG(ERRORL) << "The tree cannot be loaded if the knowledge base is opened in read_only mode.";
+        throw 10;
+    }
+    //The empty tree is written when it is deleted. Remove it.
+    string fileTree = path + DIR_SEP + string("tree") + DIR_SEP;
+    if (tree != NULL) {
+        delete tree;
+        tree = NULL;
+    }
+    Utils::remove_all(fileTree);
+    Utils::create_directories(fileTree);
+    return new TreeBuilder(fileTree,
+            config.getParamInt(TREE_MAXELEMENTSNODE),
+            config.getParamInt(TREE_MAXFILESIZE),
+            config.getParamInt(TREE_NODEMINBYTES),
+            nPartitions);
+}
+
+MemoryManagerStats KB::getTreeCacheStats() {
+    return tree->getCacheStats();
+}
+
+DecodeCacheStats KB::getDecodeCacheStats() {
+    if (dictManager != NULL) {
+        return dictManager->getDecodeCacheStats();
+    }
+    return DecodeCacheStats();
+}
+
+MemoryManagerStats KB::getDictCacheStats() {
+    if (dictManager != NULL) {
+        return dictManager->getCacheStats();
+    }
+    return MemoryManagerStats();
+}
+
 Root *KB::getRootTree() {
     string fileTree = path + DIR_SEP + string("tree") + DIR_SEP;
     PropertyMap map;
@@ -321,6 +418,8 @@ Root *KB::getRootTree() {
     map.setInt(MAX_NODES_IN_CACHE, config.getParamInt(TREE_MAXNODESINCACHE));
     map.setInt(NODE_MIN_BYTES, config.getParamInt(TREE_NODEMINBYTES));
     map.setLong(CACHE_MAX_SIZE, config.getParamLong(TREE_MAXSIZECACHETREE));
+    map.setInt(CACHE_POLICY,
+            getMemoryPolicy(config.getParam(CACHE_REPLACEMENT_POLICY)));
     map.setInt(FILE_MAX_SIZE, config.getParamInt(TREE_MAXFILESIZE));
     map.setInt(MAX_N_OPENED_FILES, config.getParamInt(TREE_MAXNFILES));
     map.setInt(MAX_EL_PER_NODE, config.getParamInt(TREE_MAXELEMENTSNODE));
@@ -343,6 +442,21 @@ Root *KB::getRootTree() {
 void KB::loadDict(KBConfig *config) {
     maindict = std::shared_ptr<DictMgmt::Dict>(new DictMgmt::Dict());
 
+    //The text index is not updated, so it is used only if the KB is static
+    const string textdir = path + DIR_SEP + "textidx";
+    if (readOnly && TextIndex::exists(textdir)) {
+        LOG(DEBUGL) << "Load the text index of the dictionary " << textdir;
+        maindict->textidx = std::shared_ptr<TextIndex>(new TextIndex(textdir));
+    }
+
+    //Static KBs can store the dictionary in the front-coded format
+    const string fcdir = path + DIR_SEP + "fcdict";
+    if (FCDict::exists(fcdir)) {
+        LOG(DEBUGL) << "Load the front-coded dictionary " << fcdir;
+        maindict->fcdict = std::shared_ptr<FCDict>(new FCDict(fcdir));
+        return;
+    }
+
     PropertyMap map;
     map.setBool(TEXT_KEYS, true);
     map.setBool(TEXT_VALUES, false);
@@ -353,6 +467,8 @@ void KB::loadDict(KBConfig *config) {
     map.setInt(MAX_NODES_IN_CACHE, config->getParamInt(DICT_MAXNODESINCACHE));
     map.setInt(NODE_MIN_BYTES, config->getParamInt(DICT_NODEMINBYTES));
     map.setLong(CACHE_MAX_SIZE, config->getParamLong(DICT_MAXSIZECACHETREE));
+    map.setInt(CACHE_POLICY,
+            getMemoryPolicy(config->getParam(CACHE_REPLACEMENT_POLICY)));
     map.setInt(FILE_MAX_SIZE, config->getParamInt(DICT_MAXFILESIZE));
     map.setInt(MAX_N_OPENED_FILES, config->getParamInt(DICT_MAXNFILES));
     map.setInt(MAX_EL_PER_NODE, config->getParamInt(DICT_MAXELEMENTSNODE));
@@ -368,6 +484,13 @@ void KB::loadDict(KBConfig *config) {
                 config->getParamLong(SB_CACHESIZE),
                 maindict->stats.get()));
     maindict->dict = std::shared_ptr<Root>(new Root(ss1.str(), maindict->sb.get(), readOnly, map));
+    //The hash index is not updated, so it is used only if the KB is static
+    const string hashfile = path + DIR_SEP + "dicthash";
+    if (readOnly && Utils::exists(hashfile)) {
+        LOG(DEBUGL) << "Load the hash index of the dictionary " << hashfile;
+        maindict->hashidx = std::shared_ptr<DictHashIndex>(
+                new DictHashIndex(hashfile, maindict->sb.get()));
+    }
 
     //Initialize the inverse dictionaries
     map.setBool(TEXT_KEYS, false);
@@ -465,6 +588,16 @@ void KB::close() {
             dictManager = NULL;
         }
     }
+    //The pending reads use the files of the partitions
+    if (prefetcher) {
+        PrefetchStats pstats = prefetcher->getStats();
+        if (pstats.requests > 0) {
+            LOG(DEBUGL) << "Prefetcher: requests " << pstats.requests <<
+                " dropped " << pstats.dropped << " read " << pstats.bytes <<
+                " bytes" << (pstats.iouring ? " (io_uring)" : "");
+        }
+        prefetcher = NULL;
+    }
     for (int i = 0; i < nindices; ++i) {
         if (files[i] != NULL) {
             delete files[i];
@@ -472,6 +605,18 @@ void KB::close() {
         }
     }
 
+    if (blockCache) {
+        BlockCacheStats bstats = blockCache->getStats();
+        if (bstats.hits + bstats.misses > 0) {
+            LOG(DEBUGL) << "Block cache: hits " << bstats.hits << " misses "
+                << bstats.misses << " hit rate " << bstats.getHitRate()
+                << " evictions " << bstats.evictions << " decompressed "
+                << bstats.decompressedBytes << " bytes in "
+                << bstats.decompressionTime / 1000 << " ms";
+        }
+        blockCache = NULL;
+    }
+
     // Delete bytesTrackers after deleting all files, because
     // in read-only case, all files share the same bytesTracker. --Ceriel
     for (int i = 0; i < nindices; ++i) {
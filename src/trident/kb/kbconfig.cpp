@@ -48,6 +48,7 @@ KBConfig::KBConfig() {
     internalMap.setInt(TREE_NODEMINBYTES, 12000);
     internalMap.setInt(TREE_MAXFILESIZE, 512 * 1024 * 1024);
     internalMap.setInt(TREE_MAXNFILES, MAX_N_FILES);
+    internalMap.setBool(TREE_COORDTABLE, true);
 
     //Leaves in the tree
     internalMap.setInt(TREE_MAXPREALLINTERNALLINES, 10000000);
@@ -89,11 +90,24 @@ KBConfig::KBConfig() {
     internalMap.setLong(STORAGE_CACHE_SIZE, INT64_C(5000000000));
     internalMap.setLong(STORAGE_MAX_FILE_SIZE, INT64_C(20) * 1024 * 1024 * 1024);
     internalMap.setInt(STORAGE_MAX_N_FILES, MAX_N_FILES);
+    internalMap.setLong(STORAGE_BLOCKCACHE_SIZE, INT64_C(1024) * 1024 * 1024);
+    internalMap.setBool(STORAGE_ACCESS_HINTS, false);
+    internalMap.setInt(STORAGE_PREFETCH_THREADS, 4);
+    internalMap.setBool(STORAGE_PREFETCH_IOURING, true);
+    internalMap.set(CACHE_REPLACEMENT_POLICY, "2q");
+
+    //Warmup
+    internalMap.set(WARMUP_PERMS, "");
+    internalMap.setBool(WARMUP_TREE, false);
+    internalMap.setBool(WARMUP_DICT, false);
+    internalMap.setInt(WARMUP_THREADS, 4);
+    internalMap.setInt(WARMUP_TIMEOUT, 0);
 
     //String buffer
     internalMap.setBool(SB_COMPRESSDOMAINS, false);
     internalMap.setInt(SB_PREALLBUFFERS, 1000);
     internalMap.setLong(SB_CACHESIZE, INT64_C(128) * 1024 * 1024); //128MB
+    internalMap.setLong(DICT_DECODECACHE_SIZE, INT64_C(64) * 1024 * 1024); //64MB
 }
 
 void KBConfig::setParam(KBParam key, string value) {
@@ -25,10 +25,20 @@
 #include <trident/kb/kb.h>
 #include <trident/kb/schema.h>
 #include <trident/kb/permsorter.h>
+#include <trident/kb/fcdict.h>
+#include <trident/kb/textindex.h>
+#include <trident/kb/inlineliterals.h>
+#include <trident/binarytables/tableshandler.h>
 #include <trident/tree/nodemanager.h>
 #include <trident/tree/flatroot.h>
+#include <trident/tree/coordtable.h>
+#include <trident/tree/treebuilder.h>
 #include <trident/utils/tridentutils.h>
 #include <trident/utils/parallel.h>
+#include <trident/utils/pipeline.h>
+#include <trident/utils/memorybudget.h>
+#include <trident/utils/radixsort.h>
+#include <trident/utils/memoryfile.h>
 
 #include <kognac/lz4io.h>
 #include <kognac/utils.h>
@@ -42,6 +52,7 @@
 #include <zstr/zstr.hpp>
 
 #include <mutex>
+#include <algorithm>
 #include <condition_variable>
 #include <sstream>
 #include <limits>
@@ -52,6 +63,8 @@
 #include <cstdio>
 #include <unordered_map>
 #include <cstdlib>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 bool _sorter_spo(const Triple &a, const Triple &b) {
     if (a.s < b.s) {
@@ -395,18 +408,12 @@ void _convertDictFile(std::vector<string> ins, string out) {
     delete[] support;
 }
 
-int64_t Loader::createPermsAndDictsFromFiles(string inputtriples,
-        bool separateDictEntRels,
+//Convert the dictionary of the terms (and of the relations) given with an
+//input that is already encoded
+static void _convertInputDicts(bool separateDictEntRels,
         string inputdict,
         string inputdictr,
-        string *permDirs,
-        int nperms,
-        int signaturePerm,
-        string fileNameDictionaries,
-        int nreadThreads,
-        int nthreads) {
-
-    //Create the dictionary output file
+        string fileNameDictionaries) {
     if (inputdict != "") {
         LOG(DEBUGL) << "Start converting dictionary file(s)";
         //Check whether it is a file or a sequence of files...
@@ -442,6 +449,22 @@ int64_t Loader::createPermsAndDictsFromFiles(string inputtriples,
     } else {
         LOG(DEBUGL) << "No dict file was provided";
     }
+}
+
+int64_t Loader::createPermsAndDictsFromFiles(string inputtriples,
+        bool separateDictEntRels,
+        string inputdict,
+        string inputdictr,
+        string *permDirs,
+        int nperms,
+        int signaturePerm,
+        string fileNameDictionaries,
+        int nreadThreads,
+        int nthreads) {
+
+    //Create the dictionary output file
+    _convertInputDicts(separateDictEntRels, inputdict, inputdictr,
+            fileNameDictionaries);
 
     //Create the permutations
     int64_t ntriples = 0;
@@ -521,6 +544,118 @@ int64_t Loader::createPermsAndDictsFromFiles(string inputtriples,
     return ntriples;
 }
 
+static inline uint64_t _readBinID(const unsigned char *p, int idSize) {
+    //The IDs are little-endian, whatever the byte order of the machine
+    uint64_t v = 0;
+    for (int i = idSize - 1; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+//Copy the triples [start, end) of the concatenation of the mapped files in
+//a file of the permutation
+static void _convertBinTriples(
+        std::vector<std::unique_ptr<MemoryMappedFile>> *files,
+        int idSize,
+        uint64_t start,
+        uint64_t end,
+        string outputFile,
+        bool *tooLarge) {
+    const uint64_t sizeTriple = 3 * idSize;
+    //The permutations are sorted on five bytes per term
+    const uint64_t maxID = ((uint64_t)1 << 40) - 1;
+    LZ4Writer writer(outputFile);
+    uint64_t offset = 0;
+    for (auto &f : *files) {
+        const uint64_t ntriples = f->getLength() / sizeTriple;
+        if (offset + ntriples > start && offset < end) {
+            uint64_t first = max(start, offset) - offset;
+            uint64_t last = min(end, offset + ntriples) - offset;
+            const unsigned char *data = (const unsigned char*) f->getData();
+            for (uint64_t i = first; i < last; ++i) {
+                const unsigned char *t = data + i * sizeTriple;
+                const uint64_t s = _readBinID(t, idSize);
+                const uint64_t p = _readBinID(t + idSize, idSize);
+                const uint64_t o = _readBinID(t + 2 * idSize, idSize);
+                if (s > maxID || p > maxID || o > maxID) {
+                    *tooLarge = true;
+                    return;
+                }
+                writer.writeLong(s);
+                writer.writeLong(p);
+                writer.writeLong(o);
+            }
+        }
+        offset += ntriples;
+    }
+}
+
+int64_t Loader::createPermsFromBinFiles(string inputtriples,
+        int idSize,
+        bool separateDictEntRels,
+        string inputdict,
+        string inputdictr,
+        string *permDirs,
+        string fileNameDictionaries,
+        int nthreads) {
+    if (idSize != 4 && idSize != 8) {
+        LOG(ERRORL) << "The IDs of the binary triples must have 4 or 8 bytes, not " << idSize;
+        throw 10;
+    }
+    _convertInputDicts(separateDictEntRels, inputdict, inputdictr,
+            fileNameDictionaries);
+
+    //The input is a file or a directory of files, read in the order of
+    //their names
+    std::vector<string> inputfiles;
+    if (Utils::isDirectory(inputtriples)) {
+        inputfiles = Utils::getFiles(inputtriples);
+        std::sort(inputfiles.begin(), inputfiles.end());
+    } else {
+        inputfiles.push_back(inputtriples);
+    }
+    std::vector<std::unique_ptr<MemoryMappedFile>> files;
+    uint64_t ntriples = 0;
+    for (auto &f : inputfiles) {
+        const uint64_t size = Utils::fileSize(f);
+        if (size % (3 * idSize) != 0) {
+            LOG(ERRORL) << "The size of " << f << " is not a multiple of " << 3 * idSize << " bytes. Is the size of the IDs correct?";
+            throw 10;
+        }
+        if (size > 0) {
+            files.push_back(std::unique_ptr<MemoryMappedFile>(
+                        new MemoryMappedFile(f, true, 0, size)));
+            ntriples += size / (3 * idSize);
+        }
+    }
+    LOG(DEBUGL) << "Start converting " << ntriples << " binary triples from " << files.size() << " file(s)";
+
+    //Every thread copies an equal range of triples in its own file
+    std::vector<std::thread> threads(nthreads);
+    std::unique_ptr<bool[]> tooLarge(new bool[nthreads]);
+    const uint64_t chunk = (ntriples + nthreads - 1) / nthreads;
+    for (int i = 0; i < nthreads; ++i) {
+        tooLarge[i] = false;
+        const uint64_t start = min(ntriples, i * chunk);
+        const uint64_t end = min(ntriples, start + chunk);
+        threads[i] = std::thread(std::bind(&_convertBinTriples, &files,
+                    idSize, start, end,
+                    permDirs[0] + DIR_SEP + "input-" + to_string(i),
+                    tooLarge.get() + i));
+    }
+    for (int i = 0; i < nthreads; ++i) {
+        threads[i].join();
+    }
+    for (int i = 0; i < nthreads; ++i) {
+        if (tooLarge[i]) {
+            LOG(ERRORL) << "The binary triples contain IDs that do not fit in 40 bits";
+            throw 10;
+        }
+    }
+    return ntriples;
+}
+
 void Loader::parallelmerge(FileMerger<Triple> *merger,
         int buffersize,
         std::vector<int64_t*> *buffers,
@@ -660,24 +795,32 @@ void Loader::dumpPermutation(std::vector<K> &input,
         string out,
         char sorter) {
     LOG(DEBUGL) << "Start sorting";
+    //Same order as K::sLess, K::sLess_sop, ...
+    K *begin = input.data();
     switch (sorter) {
         case IDX_SPO:
-            ParallelTasks::sort_int(input.begin(), input.begin() + maxValue, K::sLess, parallelProcesses);
+            RadixSort<K, FieldsTripleKey<0, 1, 2>>::sort(begin,
+                    begin + maxValue, parallelProcesses);
             break;
         case IDX_SOP:
-            ParallelTasks::sort_int(input.begin(), input.begin() + maxValue, K::sLess_sop, parallelProcesses);
+            RadixSort<K, FieldsTripleKey<0, 2, 1>>::sort(begin,
+                    begin + maxValue, parallelProcesses);
             break;
         case IDX_OSP:
-            ParallelTasks::sort_int(input.begin(), input.begin() + maxValue, K::sLess_osp, parallelProcesses);
+            RadixSort<K, FieldsTripleKey<2, 0, 1>>::sort(begin,
+                    begin + maxValue, parallelProcesses);
             break;
         case IDX_OPS:
-            ParallelTasks::sort_int(input.begin(), input.begin() + maxValue, K::sLess_ops, parallelProcesses);
+            RadixSort<K, FieldsTripleKey<2, 1, 0>>::sort(begin,
+                    begin + maxValue, parallelProcesses);
             break;
         case IDX_POS:
-            ParallelTasks::sort_int(input.begin(), input.begin() + maxValue, K::sLess_pos, parallelProcesses);
+            RadixSort<K, FieldsTripleKey<1, 2, 0>>::sort(begin,
+                    begin + maxValue, parallelProcesses);
             break;
         case IDX_PSO:
-            ParallelTasks::sort_int(input.begin(), input.begin() + maxValue, K::sLess_pso, parallelProcesses);
+            RadixSort<K, FieldsTripleKey<1, 0, 2>>::sort(begin,
+                    begin + maxValue, parallelProcesses);
             break;
         default:
             throw 10;
@@ -975,6 +1118,7 @@ void Loader::sortAndInsert(ParamSortAndInsert params) {
     bool removeInput = params.removeInput;
     int64_t estimatedSize = params.estimatedSize;
     bool deletePreviousExt = params.deletePreviousExt;
+    const bool keepInput = params.keepInput;
 
     SimpleTripleWriter *posWriter = NULL;
     if (POSoutputDir != NULL) {
@@ -984,8 +1128,16 @@ void Loader::sortAndInsert(ParamSortAndInsert params) {
 
     //Sort the triples and store them into files.
     LOG(DEBUGL) << "Start sorting...";
-    //Calculate the maximum amount of main memory I can use
+    //Calculate the maximum amount of main memory I can use. The indices are
+    //sorted at the same time and share the budget
     int64_t mem = Utils::getSystemMemory() * 0.7 / nindices;
+    std::unique_ptr<MemoryReservation> sortBuffer;
+    if (!inputSorted) {
+        sortBuffer = std::unique_ptr<MemoryReservation>(new MemoryReservation(
+                    MemoryBudget::getInstance(), "sortAndInsert", mem,
+                    LOADER_MIN_SORT_BUFFER));
+        mem = sortBuffer->getSize();
+    }
     int64_t nelements = mem / sizeof(L_Triple);
     LOG(DEBUGL) << "Triples I can store in main memory: " << nelements <<
         " size triple " << sizeof(L_Triple);
@@ -999,9 +1151,12 @@ void Loader::sortAndInsert(ParamSortAndInsert params) {
                 !inputSorted, estimatedSize, nelements, 16, true,
                 additionalPermutations);
     }
+    sortBuffer = NULL;
     LOG(DEBUGL) << "...completed.";
 
     LOG(DEBUGL) << "Start inserting...";
+    StageStats stageStats("insert" + to_string(permutation) +
+            (aggregated ? "/aggr" : ""));
     int64_t ps, pp, po; //Previous values. Used to remove duplicates.
     ps = pp = po = -1;
     int64_t count = 0;
@@ -1010,7 +1165,8 @@ void Loader::sortAndInsert(ParamSortAndInsert params) {
     assert(sampleWriter == NULL || randThreshold > 0);
 
     auto inputmerge = Utils::getFiles(inputDir, true);
-    FileMerger<Triple> merger(inputmerge, true, deletePreviousExt);
+    FileMerger<Triple> merger(inputmerge, !keepInput,
+            deletePreviousExt && !keepInput);
     LZ4Writer *plainWriter = NULL;
     if (storeRaw) {
         std::string file = ins->getPathPermutationStorage(permutation) + std::string("raw");
@@ -1161,7 +1317,7 @@ void Loader::sortAndInsert(ParamSortAndInsert params) {
     if (printstats) {
         Statistics *stat = ins->getStats(permutation);
         if (stat != NULL) {
-            LOG(DEBUGL) << "Perm " << permutation << ": RowLayout" << stat->nListStrategies << " ClusterLayout " << stat->nGroupStrategies << " ColumnLayout " << stat->nList2Strategies;
+            LOG(DEBUGL) << "Perm " << permutation << ": RowLayout" << stat->nListStrategies << " ClusterLayout " << stat->nGroupStrategies << " ColumnLayout " << stat->nList2Strategies << " PackedLayout " << stat->nPackedStrategies;
             LOG(DEBUGL) << "Perm " << permutation << ": Exact " << stat->exact << " Approx " << stat->approximate;
             LOG(DEBUGL) << "Perm " << permutation << ": FirstElemCompr1 " << stat->nFirstCompr1 << " FirstElemCompr2 " << stat->nFirstCompr2;
             LOG(DEBUGL) << "Perm " << permutation << ": SecondElemCompr1 " << stat->nSecondCompr1 << " SecondElemCompr2 " << stat->nSecondCompr2;
@@ -1177,16 +1333,19 @@ void Loader::sortAndInsert(ParamSortAndInsert params) {
     }
 
     //Remove the files
-    if (removeInput) {
+    if (removeInput && !keepInput) {
         LOG(DEBUGL) << "Removing " << inputDir;
         Utils::remove_all(inputDir);
     }
     LOG(DEBUGL) << "...completed. Added " << count << " triples out of " << countInput;
+    stageStats.add(countInput);
+    stageStats.report();
 }
 
 void Loader::insertDictionary(const int part, DictMgmt *dict, string
         dictFileInput, bool insertDictionary, bool insertInverseDictionary,
-        bool storeNumbersCoordinates, nTerm *maxValueCounter) {
+        bool storeNumbersCoordinates, nTerm *maxValueCounter,
+        bool removeInput) {
     LZ4Writer *tmpWriter = NULL;
     if (storeNumbersCoordinates) {
         tmpWriter = new LZ4Writer(dictFileInput + ".tmp");
@@ -1194,6 +1353,9 @@ void Loader::insertDictionary(const int part, DictMgmt *dict, string
     std::vector<string> alldictfiles = Compressor::getAllDictFiles(dictFileInput);
     //Insert the common terms at the end...
     //alldictfiles.insert(alldictfiles.begin(), dictFileInput);
+    //The inlined literals keep their key but are not stored
+    const bool skipInlined = dict->inlinesLiterals();
+    uint64_t inlined;
 
     //Read n. popular terms
     //nTerm key = ((int64_t)1 << 40);
@@ -1218,6 +1380,10 @@ void Loader::insertDictionary(const int part, DictMgmt *dict, string
             in.parseLong();
             int size;
             const char *value = in.parseString(size);
+            if (skipInlined && InlineLiterals::encode(value, size, inlined)) {
+                key++;
+                continue;
+            }
             bool resp = true;
             if (insertDictionary && insertInverseDictionary) {
                 if (!storeNumbersCoordinates) {
@@ -1257,6 +1423,11 @@ void Loader::insertDictionary(const int part, DictMgmt *dict, string
             in.parseLong();
             int size;
             const char *value = in.parseString(size);
+            if (skipInlined && InlineLiterals::encode(value + 2, size - 2,
+                        inlined)) {
+                key++;
+                continue;
+            }
 
             bool resp = true;
             if (insertDictionary && insertInverseDictionary) {
@@ -1322,10 +1493,69 @@ void Loader::insertDictionary(const int part, DictMgmt *dict, string
         Utils::remove(dictFileInput + ".tmp");
     }
 
-    for (auto f = alldictfiles.begin(); f != alldictfiles.end(); ++f) {
-        Utils::remove(*f);
+    if (removeInput) {
+        for (auto f = alldictfiles.begin(); f != alldictfiles.end(); ++f) {
+            Utils::remove(*f);
+        }
+        Utils::remove(dictFileInput);
+    }
+}
+
+void Loader::insertFCDictionary(string dictFileInput,
+        FCDictBuilder *builder, bool skipInlined, nTerm *maxValueCounter, bool removeInput) {
+    //The IDs are assigned as in insertDictionary: first the non-popular
+    //terms, starting after the popular ones, then the popular terms from 0
+    std::vector<string> alldictfiles = Compressor::getAllDictFiles(dictFileInput);
+    uint64_t inlined;
+    nTerm key = 0;
+    if (Utils::exists(dictFileInput)) {
+        LZ4Reader in(dictFileInput);
+        while (!in.isEof()) {
+            in.parseLong();
+            int size;
+            in.parseString(size);
+            key++;
+        }
+    }
+
+    for (auto dictfile = alldictfiles.begin(); dictfile != alldictfiles.end(); ++dictfile) {
+        LZ4Reader in(*dictfile);
+        LOG(DEBUGL) << "Parsing " << *dictfile;
+        while (!in.isEof()) {
+            in.parseLong();
+            int size;
+            const char *value = in.parseString(size);
+            if (!skipInlined || !InlineLiterals::encode(value, size, inlined)) {
+                builder->add(value, size, key);
+            }
+            key++;
+        }
+    }
+    *maxValueCounter = key - 1;
+
+    if (Utils::exists(dictFileInput)) {
+        LZ4Reader in(dictFileInput);
+        LOG(DEBUGL) << "Parsing " << dictFileInput;
+        key = 0;
+        while (!in.isEof()) {
+            in.parseLong();
+            int size;
+            const char *value = in.parseString(size);
+            if (!skipInlined || !InlineLiterals::encode(value + 2, size - 2,
+                        inlined)) {
+                builder->add(value + 2, size - 2, key);
+            }
+            key++;
+        }
+    }
+    *maxValueCounter = max(key - 1, *maxValueCounter);
+
+    if (removeInput) {
+        for (auto f = alldictfiles.begin(); f != alldictfiles.end(); ++f) {
+            Utils::remove(*f);
+        }
+        Utils::remove(dictFileInput);
     }
-    Utils::remove(dictFileInput);
 }
 
 void Loader::exportFiles(string tripleDir, string* dictFiles,
@@ -1389,10 +1619,208 @@ void Loader::addSchemaTerms(const int dictPartitions, nTerm highestNumber, DictM
     }
 }
 
+LoadManifest::LoadManifest(string file) : file(file) {
+    if (Utils::exists(file)) {
+        std::ifstream ifs(file);
+        string line;
+        while (std::getline(ifs, line)) {
+            if (line == "") {
+                continue;
+            }
+            auto pos = line.find(' ');
+            if (pos == string::npos) {
+                stages[line] = "";
+            } else {
+                stages[line.substr(0, pos)] = line.substr(pos + 1);
+            }
+        }
+    }
+}
+
+string LoadManifest::getValue(string stage) {
+    if (!isDone(stage)) {
+        LOG(ERRORL) << "The stage " << stage << " is not in the manifest " << file;
+        throw 10;
+    }
+    return stages[stage];
+}
+
+void LoadManifest::setDone(string stage, string value) {
+    stages[stage] = value;
+    //Flushed immediately, the load can fail at any point after it
+    std::ofstream ofs(file, std::ios_base::app);
+    ofs << stage << " " << value << std::endl;
+    ofs.close();
+}
+
+void LoadManifest::clear() {
+    stages.clear();
+    if (Utils::exists(file)) {
+        Utils::remove(file);
+    }
+}
+
+static bool _isKeptToResume(string path) {
+    string name = Utils::filename(path);
+    return name == "load-manifest" || Utils::starts_with(name, "permtmp-") ||
+        Utils::starts_with(name, "dict-");
+}
+
+static void _removeAllExceptResumable(string dir, bool resumable) {
+    for (auto &f : Utils::getFiles(dir)) {
+        if (!resumable || !_isKeptToResume(f)) {
+            Utils::remove(f);
+        }
+    }
+    for (auto &d : Utils::getSubdirs(dir)) {
+        if (!resumable || !_isKeptToResume(d)) {
+            Utils::remove_all(d);
+        }
+    }
+}
+
+//Size and modification time of every input file, so that an input that is
+//regenerated at the same path does not resume from the old files
+static string _getInputSignature(string path) {
+    std::vector<string> files;
+    if (Utils::isDirectory(path)) {
+        files = Utils::getFiles(path);
+    } else if (Utils::exists(path)) {
+        files.push_back(path);
+    }
+    std::sort(files.begin(), files.end());
+    string signature;
+    for (auto &f : files) {
+        struct stat st;
+        if (stat(f.c_str(), &st) != 0) {
+            LOG(ERRORL) << "Cannot read the size of the input file " << f;
+            throw 10;
+        }
+        signature += ";" + Utils::filename(f) + ":" +
+            to_string((int64_t) st.st_size) + ":" +
+            to_string((int64_t) st.st_mtime);
+    }
+    return signature;
+}
+
+bool Loader::prepareResume(ParamsLoad &p) {
+    if (p.resume) {
+        if (p.graphTransformation != "" || p.inputformat == "snap") {
+            LOG(WARNL) << "Resuming the load is not supported with graph transformations or SNAP files. I disable it";
+            p.resume = false;
+        } else if (p.createIndicesInBlocks || p.onlyCompress) {
+            LOG(WARNL) << "Resuming the load is not supported with createIndicesInBlocks or onlyCompress. I disable it";
+            p.resume = false;
+        }
+    }
+    if (!p.resume) {
+        manifest = NULL;
+        if (Utils::exists(p.kbDir)) {
+            Utils::remove_all(p.kbDir);
+        }
+        Utils::create_directories(p.kbDir);
+        if (p.tmpDir != p.kbDir) {
+            if (Utils::exists(p.tmpDir)) {
+                Utils::remove_all(p.tmpDir);
+            }
+            Utils::create_directories(p.tmpDir);
+        }
+        return false;
+    }
+
+    //The parameters that change the content of the temporary files
+    string signature = p.triplesInputDir +
+        _getInputSignature(p.triplesInputDir) +
+        ";" + p.dictDir + ";" + p.dictDir_rel +
+        ";" + p.inputformat +
+        ";" + to_string(p.inputCompressed) +
+        ";" + to_string(p.binIDSize) +
+        ";" + to_string(p.dictionaries) +
+        ";" + to_string(p.nindices) +
+        ";" + to_string(p.aggrIndices) +
+        ";" + to_string(p.relsOwnIDs) +
+        ";" + to_string(p.inlineLiterals) +
+        ";" + to_string(p.storeDicts) +
+        ";" + p.dictMethod;
+    //Only spaces separate the values in the manifest
+    std::replace(signature.begin(), signature.end(), ' ', '_');
+
+    Utils::create_directories(p.tmpDir);
+    manifest = std::unique_ptr<LoadManifest>(new LoadManifest(
+                p.tmpDir + DIR_SEP + "load-manifest"));
+    bool resuming = manifest->isDone("encoded") &&
+        manifest->getValue("params") == signature;
+    //A rewrite of the literals that was interrupted cannot be recognized
+    if (resuming && p.inlineLiterals && !manifest->isDone("inlined")) {
+        LOG(WARNL) << "The previous load stopped while inlining the literals";
+        resuming = false;
+    }
+
+    string permDir0 = p.tmpDir + DIR_SEP + "permtmp-0";
+    if (resuming && !manifest->isDone("sorted")) {
+        //sortChunks removes the unsorted files only after all the
+        //permutations are written
+        string encoded = manifest->getValue("encoded");
+        size_t nfiles = std::stoul(encoded.substr(encoded.find(' ') + 1));
+        std::vector<string> sorted;
+        size_t unsorted = 0;
+        for (auto &f : Utils::getFiles(permDir0)) {
+            if (Utils::starts_with(Utils::filename(f), "sorted-")) {
+                sorted.push_back(f);
+            } else {
+                unsorted++;
+            }
+        }
+        if (unsorted == nfiles) {
+            //The sort is repeated
+            for (auto &f : sorted) {
+                Utils::remove(f);
+            }
+            for (auto &d : Utils::getSubdirs(p.tmpDir)) {
+                string name = Utils::filename(d);
+                if (Utils::starts_with(name, "permtmp-") && name != "permtmp-0") {
+                    _removeAllExceptResumable(d, false);
+                }
+            }
+        } else if (!sorted.empty()) {
+            manifest->setDone("sorted");
+        } else {
+            resuming = false;
+        }
+    }
+
+    if (resuming) {
+        LOG(INFOL) << "Resume the load from the files in " << p.tmpDir;
+        if (p.tmpDir != p.kbDir) {
+            if (Utils::exists(p.kbDir)) {
+                Utils::remove_all(p.kbDir);
+            }
+            Utils::create_directories(p.kbDir);
+        }
+        _removeAllExceptResumable(p.tmpDir, true);
+    } else {
+        if (Utils::exists(p.kbDir)) {
+            Utils::remove_all(p.kbDir);
+        }
+        Utils::create_directories(p.kbDir);
+        if (p.tmpDir != p.kbDir) {
+            if (Utils::exists(p.tmpDir)) {
+                Utils::remove_all(p.tmpDir);
+            }
+            Utils::create_directories(p.tmpDir);
+        }
+        manifest->clear();
+        manifest->setDone("params", signature);
+    }
+    return resuming;
+}
+
 void Loader::load(ParamsLoad p) {
     LOG(DEBUGL) << "Params: " << p.tostring();
     std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
     LOG(DEBUGL) << "Start loading ...";
+    MemoryBudget &budget = MemoryBudget::getInstance();
+    budget.setLimit(p.maxMemory * 1024 * 1024);
 
     //Start a monitoring thread ...
     std::thread monitor;
@@ -1406,19 +1834,6 @@ void Loader::load(ParamsLoad p) {
 #endif
     }
 
-    //Check if kbDir exists
-    if (Utils::exists(p.kbDir)) {
-        Utils::remove_all(p.kbDir);
-    }
-    Utils::create_directories(p.kbDir);
-
-    if (p.tmpDir != p.kbDir) {
-        if (Utils::exists(p.tmpDir)) {
-            Utils::remove_all(p.tmpDir);
-        }
-        Utils::create_directories(p.tmpDir);
-    }
-
     //How many to use dictionaries?
     int ncores = Utils::getNumberPhysicalCores();
     if (p.parallelThreads > ncores) {
@@ -1438,6 +1853,10 @@ void Loader::load(ParamsLoad p) {
 
     LOG(DEBUGL) << "Set number of dictionaries to " << p.dictionaries << " parallel threads=" << p.parallelThreads << " readingThreads=" << p.maxReadingThreads;
 
+    //Prepare the directories. The files of a previous load are kept if it
+    //can be resumed
+    const bool resuming = prepareResume(p);
+
     //Create data structures to compress the input
     int nperms = 1;
     int signaturePerm = 0;
@@ -1493,7 +1912,33 @@ void Loader::load(ParamsLoad p) {
         fileNameDictionaries[i] = p.tmpDir + DIR_SEP + string("dict-") + to_string(i);
     }
 
-    if (p.inputformat == "snap") { /*** LOAD SNAP FILES ***/
+    if (p.inputformat == "bin" ||
+            (p.inputformat != "snap" && p.inputCompressed)) {
+        if (p.dictDir_rel != "") {
+            LOG(INFOL) << "I force the parameter relsOwnIDs to true since the path to a dictionary for the relations is not null";
+            p.relsOwnIDs = true;
+        }
+        if (p.dictDir == "" && p.dictDir_rel == "" && p.storeDicts) {
+            LOG(INFOL) << "I force storeDicts to false since no directory for the dictionary was given";
+            p.storeDicts = false;
+        }
+    }
+
+    StageStats encodeStats("encode");
+    if (resuming) {
+        string encoded = manifest->getValue("encoded");
+        totalCount = std::stoll(encoded.substr(0, encoded.find(' ')));
+        LOG(INFOL) << "The " << totalCount << " triples were already encoded by the load that is resumed";
+    } else if (p.inputformat == "bin") { /*** LOAD BINARY TRIPLES ***/
+        totalCount = createPermsFromBinFiles(p.triplesInputDir,
+                p.binIDSize,
+                p.relsOwnIDs,
+                p.dictDir,
+                p.dictDir_rel,
+                p.graphTransformation != "" ? permDirs + 3 : permDirs,
+                fileNameDictionaries[0],
+                p.parallelThreads);
+    } else if (p.inputformat == "snap") { /*** LOAD SNAP FILES ***/
         if (p.graphTransformation == "") {
             p.graphTransformation = "undirected";
         }
@@ -1546,10 +1991,6 @@ void Loader::load(ParamsLoad p) {
                 return;
             }
         } else {
-            if (p.dictDir_rel != "") {
-                LOG(INFOL) << "I force the parameter relsOwnIDs to true since the path to a dictionary for the relations is not null";
-                p.relsOwnIDs = true;
-            }
             totalCount = createPermsAndDictsFromFiles(p.triplesInputDir,
                     p.relsOwnIDs,
                     p.dictDir,
@@ -1560,12 +2001,14 @@ void Loader::load(ParamsLoad p) {
                     fileNameDictionaries[0],
                     p.maxReadingThreads,
                     p.parallelThreads);
-            if (p.dictDir == "" && p.dictDir_rel == "" && p.storeDicts) {
-                LOG(INFOL) << "I force storeDicts to false since no directory for the dictionary was given";
-                p.storeDicts = false;
-            }
         }
     }
+    if (manifest && !resuming) {
+        manifest->setDone("encoded", to_string(totalCount) + " " +
+                to_string(Utils::getFiles(permDirs[0]).size()));
+    }
+    encodeStats.add(totalCount);
+    encodeStats.report();
 
     KBConfig config;
     config.setParamInt(DICTPARTITIONS, p.dictionaries);
@@ -1577,6 +2020,15 @@ void Loader::load(ParamsLoad p) {
     config.setParamBool(RELSOWNIDS, p.relsOwnIDs);
     LOG(DEBUGL) << "Optimizing memory management for " << totalCount << " triples";
     MemoryOptimizer::optimizeForWriting(totalCount, config);
+    //The caches get at most a quarter of the budget, the rest is left to the
+    //sorts
+    uint64_t cachesSize = MemoryOptimizer::getCachesSizeForWriting(
+            p.dictionaries, config);
+    if (budget.getLimit() > 0) {
+        cachesSize = min(cachesSize, budget.getLimit() / 4);
+    }
+    cachesSize = budget.reserve("caches", cachesSize, LOADER_MIN_SORT_BUFFER);
+    MemoryOptimizer::limitCachesForWriting(cachesSize, p.dictionaries, config);
     if (p.dictMethod == DICT_HASH) {
         config.setParamBool(DICTHASH, true);
     }
@@ -1591,12 +2043,41 @@ void Loader::load(ParamsLoad p) {
             p.storeDicts,
             p.relsOwnIDs);
 
+    if (p.comprTables) {
+        if (p.graphTransformation != "") {
+            LOG(WARNL) << "Compressed tables are not supported with graph transformations. I disable them";
+        } else {
+            //The files must be closed before they can be compressed
+            kb = NULL;
+            LOG(DEBUGL) << "Compress the permutation files ...";
+            for (int i = 0; i < p.nindices; ++i) {
+                TableStorage::compressFiles(p.kbDir + DIR_SEP + "p" + to_string(i));
+            }
+        }
+    }
+
     /*** CLEANUP ***/
+    kb = NULL;
+    budget.release("caches", cachesSize);
+    budget.report();
     delete[] permDirs;
     delete[] fileNameDictionaries;
     if (p.tmpDir != p.kbDir) {
         Utils::remove_all(p.tmpDir);
+    } else if (manifest) {
+        //Remove the files that were kept to resume the load
+        for (auto &f : Utils::getFiles(p.kbDir)) {
+            if (_isKeptToResume(f)) {
+                Utils::remove(f);
+            }
+        }
+        for (auto &d : Utils::getSubdirs(p.kbDir)) {
+            if (_isKeptToResume(d)) {
+                Utils::remove_all(d);
+            }
+        }
     }
+    manifest = NULL;
     std::unique_lock<std::mutex> lck(mtx);
     isFinished = true;
     cv.notify_all();
@@ -1638,10 +2119,90 @@ void Loader::rewriteKG(string inputdir, std::unordered_map<int64_t,int64_t> &map
     }
 }
 
+bool Loader::loadKB_inlineLiterals(string dictFileInput,
+        string tripleDir) {
+    //Find the keys of the literals that can be inlined. The keys are
+    //assigned as in insertDictionary
+    std::unordered_map<int64_t,int64_t> map;
+    std::vector<string> alldictfiles = Compressor::getAllDictFiles(dictFileInput);
+    uint64_t inlined;
+    nTerm key = 0;
+    if (Utils::exists(dictFileInput)) {
+        LZ4Reader in(dictFileInput);
+        while (!in.isEof()) {
+            in.parseLong();
+            int size;
+            in.parseString(size);
+            key++;
+        }
+    }
+    for (auto dictfile = alldictfiles.begin(); dictfile != alldictfiles.end(); ++dictfile) {
+        LZ4Reader in(*dictfile);
+        while (!in.isEof()) {
+            in.parseLong();
+            int size;
+            const char *value = in.parseString(size);
+            if (InlineLiterals::encode(value, size, inlined)) {
+                map.insert(std::make_pair(key, (int64_t) inlined));
+            }
+            key++;
+        }
+    }
+    if (Utils::exists(dictFileInput)) {
+        LZ4Reader in(dictFileInput);
+        key = 0;
+        while (!in.isEof()) {
+            in.parseLong();
+            int size;
+            const char *value = in.parseString(size);
+            if (InlineLiterals::encode(value + 2, size - 2, inlined)) {
+                map.insert(std::make_pair(key, (int64_t) inlined));
+            }
+            key++;
+        }
+    }
+    if ((uint64_t) key > INLINELITS_FLAG) {
+        //The inlined IDs start there
+        LOG(WARNL) << "The dictionary has " << key << " terms. Inlined literals require less than " << INLINELITS_FLAG << " terms. I disable them";
+        return false;
+    }
+    LOG(DEBUGL) << "Inline " << map.size() << " literals";
+
+    //Replace their keys in the triples
+    if (!map.empty()) {
+        auto files = Utils::getFiles(tripleDir);
+        for (auto pathfile : files) {
+            {
+                LZ4Reader reader(pathfile);
+                LZ4Writer writer(pathfile + "-new");
+                while (!reader.isEof()) {
+                    int64_t s = reader.parseLong();
+                    int64_t p = reader.parseLong();
+                    int64_t o = reader.parseLong();
+                    auto itr = map.find(s);
+                    if (itr != map.end())
+                        s = itr->second;
+                    itr = map.find(o);
+                    if (itr != map.end())
+                        o = itr->second;
+                    writer.writeLong(s);
+                    writer.writeLong(p);
+                    writer.writeLong(o);
+                }
+            }
+            Utils::remove(pathfile);
+            Utils::rename(pathfile + "-new", pathfile);
+        }
+    }
+    return true;
+}
+
 void Loader::loadKB_storeDicts(KB &kb,
         int dictionaries,
         string dictMethod,
-        string *fileNameDictionaries) {
+        string *fileNameDictionaries,
+        bool hashIndex,
+        bool textIndex) {
     std::thread *threads;
     LOG(DEBUGL) << "Insert the dictionary in the trees";
     threads = new std::thread[dictionaries - 1];
@@ -1649,17 +2210,25 @@ void Loader::loadKB_storeDicts(KB &kb,
     if (dictMethod != DICT_SMART) {
         if (dictionaries > 1) throw 10;
         insertDictionary(0, kb.getDictMgmt(), fileNameDictionaries[0],
-                dictMethod != DICT_HASH, true, false, maxValues);
+                dictMethod != DICT_HASH, true, false, maxValues, !manifest);
         for (int i = 1; i < dictionaries; ++i) {
             threads[i - 1].join();
         }
     } else {
         insertDictionary(0, kb.getDictMgmt(), fileNameDictionaries[0], true,
-                true, true, maxValues);
+                true, true, maxValues, !manifest);
     }
 #ifdef REASONING
     addSchemaTerms(dictionaries, maxValues[0], kb.getDictMgmt());
 #endif
+    if (hashIndex && dictMethod != DICT_HASH) {
+        LOG(DEBUGL) << "Create the hash index of the dictionary...";
+        kb.getDictMgmt()->createHashIndex(kb.getPath() + DIR_SEP + "dicthash");
+    }
+    if (textIndex) {
+        LOG(DEBUGL) << "Create the text index of the dictionary...";
+        kb.getDictMgmt()->createTextIndex(kb.getPath() + DIR_SEP + "textidx");
+    }
     delete[] maxValues;
     delete[] threads;
     /*** Close the dictionaries ***/
@@ -1667,6 +2236,57 @@ void Loader::loadKB_storeDicts(KB &kb,
     kb.closeMainDict();
 }
 
+void Loader::loadKB_storeFCDict(KB &kb,
+        int dictionaries,
+        string *fileNameDictionaries,
+        bool textIndex) {
+    if (dictionaries > 1) {
+        LOG(ERRORL) << "The front-coded dictionary is supported only if the dictionary is stored on one partition";
+        throw 10;
+    }
+    LOG(DEBUGL) << "Store the dictionary in the front-coded format";
+    MemoryBudget &budget = MemoryBudget::getInstance();
+    std::unique_ptr<MemoryReservation> sortBuffer(new MemoryReservation(
+                budget, "fcdict", FCDICT_SORT_BUFFER, LOADER_MIN_SORT_BUFFER));
+    FCDictBuilder builder(kb.getPath() + DIR_SEP + "fcdict",
+            sortBuffer->getSize());
+    nTerm maxValue;
+    insertFCDictionary(fileNameDictionaries[0], &builder,
+            kb.getDictMgmt()->inlinesLiterals(), &maxValue, !manifest);
+#ifdef REASONING
+    //The schema terms that are already in the input are discarded when the
+    //terms are merged, since they have a larger ID
+    vector<string> schemaTerms = Schema::getAllSchemaTerms();
+    for (vector<string>::iterator itr = schemaTerms.begin(); itr != schemaTerms.end(); itr++) {
+        builder.add(itr->c_str(), itr->size(), ++maxValue);
+    }
+#endif
+    const uint64_t nTerms = builder.finish();
+    sortBuffer = NULL;
+    if (builder.getNDuplicates() > 0) {
+        LOG(DEBUGL) << "Discarded " << builder.getNDuplicates() <<
+            " duplicated terms";
+    }
+    kb.getDictMgmt()->registerInsertedTerms(nTerms, maxValue);
+    if (textIndex) {
+        //The dictionary of the KB is not the new one yet
+        LOG(DEBUGL) << "Create the text index of the dictionary...";
+        FCDict fcdict(kb.getPath() + DIR_SEP + "fcdict");
+        MemoryReservation textBuffer(budget, "textidx", TEXTIDX_SORT_BUFFER,
+                LOADER_MIN_SORT_BUFFER);
+        TextIndexBuilder textBuilder(kb.getPath() + DIR_SEP + "textidx",
+                textBuffer.getSize());
+        char text[MAX_TERM_SIZE];
+        for (uint64_t rank = 0; rank < fcdict.getNTerms(); ++rank) {
+            const int size = fcdict.getTextAtRank(rank, text);
+            textBuilder.add(text, size, fcdict.getIDAtRank(rank));
+        }
+        textBuilder.finish();
+    }
+    LOG(DEBUGL) << "Closing dict...";
+    kb.closeMainDict();
+}
+
 void Loader::loadKB_handleGraphTransformations(KB &kb,
         string graphTransformation,
         string *permDirs,
@@ -1797,6 +2417,8 @@ void Loader::loadKB_createSamples(string kbDir,
     samplep.limitSpace = 0;
     samplep.remoteLocation = "";
     samplep.sample = false;
+    //The sample is rebuilt by every load, it is not checkpointed
+    std::unique_ptr<LoadManifest> m = std::move(manifest);
     loadKB(kb,
             samplep,
             totalCount * p.sampleRate,
@@ -1806,6 +2428,7 @@ void Loader::loadKB_createSamples(string kbDir,
             NULL,
             false,
             false);
+    manifest = std::move(m);
 
     delete[] samplePermDirs;
 }
@@ -1816,7 +2439,9 @@ void Loader::loadKB_createTree(KB &kb,
         bool storeDicts,
         string graphTransformation,
         Inserter *ins,
-        int nindices) {
+        int nindices,
+        bool bulkTree,
+        int nthreads) {
 
     std::thread *threads;
     threads = new std::thread[2];
@@ -1828,27 +2453,35 @@ void Loader::loadKB_createTree(KB &kb,
     }
 
     LOG(DEBUGL) << "Start creating the tree...";
-    std::unique_ptr<SharedStructs> structs = std::unique_ptr<SharedStructs>(
-            new SharedStructs());
-    structs->bufferToFill = structs->bufferToReturn = &structs->buffer1;
-    structs->isFinished = false;
-    structs->buffersReady = 0;
-
-    ParamsMergeCoordinates params;
-    params.coordinates = sTreeWriters;
-    params.ncoordinates = graphTransformation != "" ? 2 : 6;
-
-    params.bufferToFill = structs->bufferToFill;
-    params.isFinished = &structs->isFinished;
-    params.buffersReady = &structs->buffersReady;
-    params.buffer1 = &structs->buffer1;
-    params.buffer2 = &structs->buffer2;
-    params.cond = &structs->cond;
-    params.mut = &structs->mut;
-    threads[0] = std::thread(
-            std::bind(&Loader::mergeTermCoordinates, params));
-    processTermCoordinates(ins, structs.get());
-    threads[0].join();
+    const int ncoordinates = graphTransformation != "" ? 2 : 6;
+    if (bulkTree) {
+        loadKB_bulkLoadTree(kb, sTreeWriters, ncoordinates, nindices,
+                nthreads);
+    } else {
+        MemoryReservation structsMem(MemoryBudget::getInstance(),
+                "coordinates", sizeof(SharedStructs), sizeof(SharedStructs));
+        std::unique_ptr<SharedStructs> structs = std::unique_ptr<SharedStructs>(
+                new SharedStructs());
+        structs->bufferToFill = structs->bufferToReturn = &structs->buffer1;
+        structs->isFinished = false;
+        structs->buffersReady = 0;
+
+        ParamsMergeCoordinates params;
+        params.coordinates = sTreeWriters;
+        params.ncoordinates = ncoordinates;
+
+        params.bufferToFill = structs->bufferToFill;
+        params.isFinished = &structs->isFinished;
+        params.buffersReady = &structs->buffersReady;
+        params.buffer1 = &structs->buffer1;
+        params.buffer2 = &structs->buffer2;
+        params.cond = &structs->cond;
+        params.mut = &structs->mut;
+        threads[0] = std::thread(
+                std::bind(&Loader::mergeTermCoordinates, params));
+        processTermCoordinates(ins, structs.get());
+        threads[0].join();
+    }
     if (storeDicts) {
         threads[1].join();
     }
@@ -1861,6 +2494,71 @@ void Loader::loadKB_createTree(KB &kb,
     delete[] threads;
 }
 
+void Loader::loadKB_bulkLoadTreePartition(string *coordinates,
+        int ncoordinates,
+        nTerm startKey,
+        nTerm endKey,
+        TreeBuilder *builder,
+        int partition) {
+    CoordinatesMerger merger(coordinates, ncoordinates, startKey, endKey);
+    nTerm key;
+    TermCoordinates *value = NULL;
+    while ((value = merger.get(key)) != NULL) {
+        builder->append(partition, key, value);
+    }
+}
+
+void Loader::loadKB_bulkLoadTree(KB &kb,
+        string *coordinates,
+        int ncoordinates,
+        int nindices,
+        int nthreads) {
+    //Split the keys in ranges with a similar number of entries, using the
+    //largest file of the coordinates
+    int64_t maxEntries = 0;
+    int largestFile = 0;
+    for (int i = 0; i < nindices; ++i) {
+        if (Utils::exists(coordinates[i])) {
+            int64_t nentries = Utils::fileSize(coordinates[i]) / 23;
+            if (nentries > maxEntries) {
+                maxEntries = nentries;
+                largestFile = i;
+            }
+        }
+    }
+    std::vector<nTerm> startKeys;
+    startKeys.push_back(0);
+    if (nthreads > 1 && maxEntries > nthreads) {
+        ifstream in(coordinates[largestFile], ios_base::binary);
+        char buffer[8];
+        for (int i = 1; i < nthreads; ++i) {
+            in.seekg((maxEntries * i / nthreads) * 23);
+            in.read(buffer, 8);
+            nTerm key = Utils::decode_long(buffer, 0);
+            if (key > startKeys.back()) {
+                startKeys.push_back(key);
+            }
+        }
+        in.close();
+    }
+
+    const int npartitions = startKeys.size();
+    LOG(DEBUGL) << "Bulk-load the tree with " << npartitions << " threads";
+    std::unique_ptr<TreeBuilder> builder(kb.bulkLoadTree(npartitions));
+    std::vector<std::thread> threads(npartitions);
+    for (int i = 0; i < npartitions; ++i) {
+        nTerm endKey = i < npartitions - 1 ? startKeys[i + 1] : INT64_MAX;
+        threads[i] = std::thread(
+                std::bind(&Loader::loadKB_bulkLoadTreePartition,
+                    coordinates, ncoordinates, startKeys[i], endKey,
+                    builder.get(), i));
+    }
+    for (int i = 0; i < npartitions; ++i) {
+        threads[i].join();
+    }
+    builder->finish();
+}
+
 void Loader::loadKB(KB &kb,
         ParamsLoad &p,
         int64_t totalCount,
@@ -1891,9 +2589,57 @@ void Loader::loadKB(KB &kb,
     bool flatTree = p.flatTree;
     //End init params
 
+    if (p.inlineLiterals) {
+        if (!storeDicts || dictionaries > 1 || flatTree ||
+                graphTransformation != "") {
+            LOG(WARNL) << "Inlined literals require a stored dictionary on one partition and are not supported with flat trees. I disable them";
+        } else {
+            LOG(DEBUGL) << "Inline the literals in the IDs ...";
+            bool inlined = true;
+            if (manifest && manifest->isDone("inlined")) {
+                LOG(DEBUGL) << "The triples were already rewritten by the load that is resumed";
+            } else {
+                inlined = loadKB_inlineLiterals(fileNameDictionaries[0], permDirs[0]);
+                if (manifest && inlined) {
+                    manifest->setDone("inlined");
+                }
+            }
+            if (inlined) {
+                //The KB decodes the inlined IDs only if this file exists
+                std::ofstream marker(kb.getPath() + DIR_SEP + "inlinelits");
+                marker.close();
+                kb.getDictMgmt()->setInlineLiterals(true);
+            }
+        }
+    }
+
+    //Create n threads where the triples are sorted and inserted in the knowledge base
+    //The inserter reads the number of terms of the dictionary, so it is
+    //created before the dictionary is stored
+    Inserter *ins = kb.insert();
+
+    //The dictionary does not depend on the indices. It is stored while the
+    //permutations are sorted and inserted, and it must be finished before
+    //the tree is created
+    std::thread dictThread;
+    if (storeDicts && p.fcDict && dictionaries > 1) {
+        LOG(ERRORL) << "The front-coded dictionary is supported only if the dictionary is stored on one partition";
+        throw 10;
+    }
     if (storeDicts) {
-        loadKB_storeDicts(kb, dictionaries, dictMethod, fileNameDictionaries);
-    } else {
+        dictThread = std::thread([&]() {
+            StageStats stageStats("dictionary", "terms");
+            if (p.fcDict) {
+                loadKB_storeFCDict(kb, dictionaries, fileNameDictionaries,
+                        p.textIndex);
+            } else {
+                loadKB_storeDicts(kb, dictionaries, dictMethod,
+                        fileNameDictionaries, p.dictHashIndex, p.textIndex);
+            }
+            stageStats.add(kb.getDictMgmt()->getNTermsInserted());
+            stageStats.report();
+        });
+    } else if (!manifest) {
         if (fileNameDictionaries && Utils::exists(fileNameDictionaries[0])) {
             std::vector<string> alldictfiles =
                 Compressor::getAllDictFiles(fileNameDictionaries[0]);
@@ -1929,8 +2675,13 @@ void Loader::loadKB(KB &kb,
         sampleWriter = new SimpleTripleWriter(sampleDir, "input", false);
     }
 
-    //Create n threads where the triples are sorted and inserted in the knowledge base
-    Inserter *ins = kb.insert();
+    if (p.packedTables) {
+        if (flatTree || graphTransformation != "") {
+            LOG(WARNL) << "Packed tables are not supported with flat trees. I disable them";
+        } else {
+            ins->setUsagePackedTables();
+        }
+    }
     LOG(DEBUGL) << "Start sortAndInsert";
 
     if (nindices != 6) {
@@ -1954,7 +2705,8 @@ void Loader::loadKB(KB &kb,
             remoteLocation,
             limitSpace,
             totalCount,
-            nindices);
+            nindices,
+            p.derivePerms);
 
     if (nindices != 6)
         nindices = 6; //restore
@@ -1963,8 +2715,12 @@ void Loader::loadKB(KB &kb,
         treeWriters[i]->finish();
     }
 
+    if (dictThread.joinable()) {
+        dictThread.join();
+    }
     loadKB_createTree(kb, sTreeWriters, treeWriters, storeDicts,
-            graphTransformation, ins, nindices);
+            graphTransformation, ins, nindices, p.bulkTree,
+            parallelProcesses);
     delete ins;
 
     if (flatTree || graphTransformation != "") {
@@ -1982,6 +2738,12 @@ void Loader::loadKB(KB &kb,
                 flatfile, root.get(),
                 graphTransformation != "",
                 graphTransformation == "undirected");
+    } else if (p.coordTable) {
+        LOG(DEBUGL) << "Create the table of the coordinates ...";
+        kb.close();
+        std::unique_ptr<Root> root(kb.getRootTree());
+        CoordinatesTable::create(root.get(),
+                kbDir + DIR_SEP + "tree" + DIR_SEP + "coords");
     }
 
     if (sample) {
@@ -2148,184 +2910,166 @@ void Loader::parallel_createIndices(
         string remotePath,
         int64_t limitSpace,
         int64_t estimatedSize,
-        int nindices) {
+        int nindices,
+        bool derivePerms) {
 
     if (aggrIndices && nindices != 6) {
         LOG(ERRORL) << "Inconsistency on the input parameters. AggrIndices=true but set less than 6 permutations...";
         throw 10;
     }
 
-    //Sort chunks of the triple in main memory
-    std::vector<std::pair<string, char>> outputdirs;
-    if (nindices == 1) {
-        PermSorter::sortChunks(permDirs[3],
-                maxReadingThreads,
-                parallelProcesses,
-                estimatedSize,
-                false,
-                outputdirs);
-    } else if (nindices == 2) {
-        outputdirs.push_back(make_pair(permDirs[4], IDX_OSP));
-        PermSorter::sortChunks(permDirs[3],
-                maxReadingThreads,
-                parallelProcesses,
-                estimatedSize,
-                false,
-                outputdirs);
-    } else {
-        if (aggrIndices) {
-            outputdirs.push_back(make_pair(permDirs[2], IDX_SOP));
-            outputdirs.push_back(make_pair(permDirs[1], IDX_OPS));
-            outputdirs.push_back(make_pair(permDirs[3], IDX_OSP));
-        } else {
-            outputdirs.push_back(make_pair(permDirs[3], IDX_SOP));
-            outputdirs.push_back(make_pair(permDirs[1], IDX_OPS));
-            outputdirs.push_back(make_pair(permDirs[4], IDX_OSP));
-            outputdirs.push_back(make_pair(permDirs[2], IDX_POS));
-            outputdirs.push_back(make_pair(permDirs[5], IDX_PSO));
-        }
-        PermSorter::sortChunks(permDirs[0],
-                maxReadingThreads,
-                parallelProcesses,
-                estimatedSize,
-                true,
-                outputdirs);
-    }
-
     int nperms = aggrIndices ? 4 : 6;
-    std::thread ts[3];
-    std::thread at1, at2;
+    //The indices are created from the sorted permutations. Each index is
+    //created as soon as its permutation is on disk, while the others are
+    //still sorted
+    std::vector<ParamSortAndInsert> tasks;
+    ParamSortAndInsert params;
+    params.nindices = nperms;
+    params.parallelProcesses = parallelProcesses;
+    params.maxReadingThreads = maxReadingThreads;
+    params.ins = ins;
+    params.inputSorted = true;
+    params.storeRaw = false;
+    params.sampleWriter = NULL;
+    params.sampleRate = 0.0;
+    params.aggregated = false;
+    //params.logPtr = NULL;
+    params.removeInput = true;
+    params.printstats = printStats;
+    params.POSoutputDir = NULL;
+    params.estimatedSize = estimatedSize;
+    params.deletePreviousExt = true;
+    //The sorted permutations are kept until the end if the load can be
+    //resumed
+    params.keepInput = manifest != NULL;
     if (!aggrIndices) {
-        ParamSortAndInsert params;
-        params.nindices = nperms;
-        params.parallelProcesses = parallelProcesses;
-        params.maxReadingThreads = maxReadingThreads;
-        params.ins = ins;
-        params.inputSorted = true;
-        params.storeRaw = false;
-        params.sampleWriter = NULL;
-        params.sampleRate = 0.0;
-        params.aggregated = false;
-        //params.logPtr = NULL;
-        params.removeInput = true;
-        params.printstats = printStats;
-        params.POSoutputDir = NULL;
-        params.estimatedSize = estimatedSize;
-        params.deletePreviousExt = true;
-
         params.permutation = 1;
         params.inputDir = permDirs[1];
         params.treeWriter = treeWriters[1];
         params.canSkipTables = false;
-
-        ts[0] = std::thread(
-                std::bind(&Loader::sortAndInsert, params));
+        tasks.push_back(params);
 
         params.permutation = 3;
         params.inputDir = permDirs[3];
         params.treeWriter = treeWriters[3];
         params.canSkipTables = canSkipTables;
-
-        ts[1] = std::thread(
-                std::bind(&Loader::sortAndInsert, params));
+        tasks.push_back(params);
 
         params.permutation = 4;
         params.inputDir = permDirs[4];
         params.treeWriter = treeWriters[4];
         params.canSkipTables = canSkipTables;
+        tasks.push_back(params);
 
-        ts[2] = std::thread(
-                std::bind(&Loader::sortAndInsert, params));
-
-        //Start two more threads
         params.permutation = 2;
         params.inputDir = permDirs[2];
         params.treeWriter = treeWriters[2];
         params.canSkipTables = false;
-
-        at1 = std::thread(std::bind(&Loader::sortAndInsert, params));
+        tasks.push_back(params);
 
         params.permutation = 5;
         params.inputDir = permDirs[5];
         params.treeWriter = treeWriters[5];
         params.canSkipTables = canSkipTables;
-
-        at2 = std::thread(std::bind(&Loader::sortAndInsert, params));
-
+        tasks.push_back(params);
     } else {
-        ParamSortAndInsert params;
-        params.nindices = nperms;
-        params.parallelProcesses = parallelProcesses;
-        params.maxReadingThreads = maxReadingThreads;
-        params.ins = ins;
-        params.inputSorted = true;
-        params.storeRaw = false;
-        params.sampleWriter = NULL;
-        params.sampleRate = 0.0;
-        params.aggregated = false;
-        //params.logPtr = NULL;
-        params.removeInput = true;
-        params.printstats = printStats;
-        params.estimatedSize = estimatedSize;
-        params.deletePreviousExt = true;
-
         params.permutation = 1;
         params.inputDir = permDirs[1];
         params.treeWriter = treeWriters[1];
         params.POSoutputDir = &aggr1Dir;
         params.canSkipTables = false;
-
-        ts[0] = std::thread(
-                std::bind(&Loader::sortAndInsert, params));
+        tasks.push_back(params);
 
         params.permutation = 3;
         params.inputDir = permDirs[2];
         params.treeWriter = treeWriters[3];
         params.POSoutputDir = NULL;
         params.canSkipTables = canSkipTables;
-
-        ts[1] = std::thread(
-                std::bind(&Loader::sortAndInsert, params));
+        tasks.push_back(params);
 
         params.permutation = 4;
         params.inputDir = permDirs[3];
         params.treeWriter = treeWriters[4];
         params.POSoutputDir = NULL;
         params.canSkipTables = canSkipTables;
-
-        ts[2] = std::thread(
-                std::bind(&Loader::sortAndInsert, params));
+        tasks.push_back(params);
     }
 
-    ParamSortAndInsert params;
-    params.parallelProcesses = parallelProcesses;
-    params.maxReadingThreads = maxReadingThreads;
     params.permutation = 0;
-    params.nindices = nperms;
-    params.inputSorted = true;
     params.inputDir = permDirs[0];
     params.POSoutputDir = aggrIndices ? &aggr2Dir : NULL;
     params.treeWriter = treeWriters[0];
-    params.ins = ins;
-    params.aggregated = false;
     params.canSkipTables = false;
     params.storeRaw = storePlainList;
     params.sampleWriter = sampleWriter;
     params.sampleRate = sampleRate;
-    params.printstats = printStats;
-    //params.logPtr = logPtr;
-    params.removeInput = true;
-    params.estimatedSize = estimatedSize;
-    params.deletePreviousExt = true;
+    tasks.push_back(params);
 
-    sortAndInsert(params);
-    for (int i = 0; i < 3; ++i) {
-        ts[i].join();
+    std::vector<std::thread> threads(tasks.size());
+    auto startInsert = [&tasks, &threads](string dir) {
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            if (tasks[i].inputDir == dir && !threads[i].joinable()) {
+                LOG(DEBUGL) << "Start creating index " << tasks[i].permutation;
+                threads[i] = std::thread(
+                        std::bind(&Loader::sortAndInsert, tasks[i]));
+            }
+        }
+    };
+
+    //Sort chunks of the triple in main memory
+    std::vector<std::pair<string, char>> outputdirs;
+    if (manifest && manifest->isDone("sorted")) {
+        LOG(INFOL) << "The permutations were already sorted by the load that is resumed";
+    } else if (nindices == 1) {
+        PermSorter::sortChunks(permDirs[3],
+                maxReadingThreads,
+                parallelProcesses,
+                estimatedSize,
+                false,
+                false,
+                outputdirs,
+                startInsert);
+    } else if (nindices == 2) {
+        outputdirs.push_back(make_pair(permDirs[4], IDX_OSP));
+        PermSorter::sortChunks(permDirs[3],
+                maxReadingThreads,
+                parallelProcesses,
+                estimatedSize,
+                false,
+                false,
+                outputdirs,
+                startInsert);
+    } else {
+        if (aggrIndices) {
+            outputdirs.push_back(make_pair(permDirs[2], IDX_SOP));
+            outputdirs.push_back(make_pair(permDirs[1], IDX_OPS));
+            outputdirs.push_back(make_pair(permDirs[3], IDX_OSP));
+        } else {
+            outputdirs.push_back(make_pair(permDirs[3], IDX_SOP));
+            outputdirs.push_back(make_pair(permDirs[1], IDX_OPS));
+            outputdirs.push_back(make_pair(permDirs[4], IDX_OSP));
+            outputdirs.push_back(make_pair(permDirs[2], IDX_POS));
+            outputdirs.push_back(make_pair(permDirs[5], IDX_PSO));
+        }
+        PermSorter::sortChunks(permDirs[0],
+                maxReadingThreads,
+                parallelProcesses,
+                estimatedSize,
+                true,
+                derivePerms,
+                outputdirs,
+                startInsert);
+    }
+    if (manifest) {
+        manifest->setDone("sorted");
     }
 
-    if (!aggrIndices) {
-        at1.join();
-        at2.join();
+    //The indices whose input was not produced by sortChunks
+    for (auto &task : tasks) {
+        startInsert(task.inputDir);
+    }
+    for (auto &t : threads) {
+        t.join();
     }
 
     //Aggregated
@@ -2345,6 +3089,7 @@ void Loader::parallel_createIndices(
         params.printstats = printStats;
         params.estimatedSize = estimatedSize;
         params.deletePreviousExt = true;
+        params.keepInput = false;
 
         params.permutation = 2;
         params.inputDir = aggr1Dir;
@@ -2408,6 +3153,7 @@ void Loader::seq_createIndices(
     params.removeInput = false;
     params.estimatedSize = estimatedSize;
     params.deletePreviousExt = false;
+    params.keepInput = false;
 
     sortAndInsert(params);
 
@@ -2522,6 +3268,7 @@ void Loader::seq_createIndices(
         params.removeInput = false;
         params.estimatedSize = estimatedSize;
         params.deletePreviousExt = false;
+        params.keepInput = false;
 
         sortAndInsert(params);
         LOG(DEBUGL) << "Memory used so far: " << Utils::getUsedMemory();
@@ -2547,6 +3294,7 @@ void Loader::seq_createIndices(
         params.removeInput = true;
         params.estimatedSize = estimatedSize;
         params.deletePreviousExt = false;
+        params.keepInput = false;
 
         sortAndInsert(params);
         LOG(DEBUGL) << "Memory used so far: " << Utils::getUsedMemory();
@@ -2580,6 +3328,7 @@ void Loader::seq_createIndices(
         params.removeInput = false;
         params.estimatedSize = estimatedSize;
         params.deletePreviousExt = false;
+        params.keepInput = false;
 
         sortAndInsert(params);
         LOG(DEBUGL) << "Memory used so far: " << Utils::getUsedMemory();
@@ -2607,6 +3356,7 @@ void Loader::seq_createIndices(
         params.removeInput = true;
         params.estimatedSize = estimatedSize;
         params.deletePreviousExt = false;
+        params.keepInput = false;
 
         sortAndInsert(params);
         LOG(DEBUGL) << "Memory used so far: " << Utils::getUsedMemory();
@@ -2631,7 +3381,8 @@ void Loader::createIndices(
         string remotePath,
         int64_t limitSpace,
         int64_t estimatedSize,
-        int nindices) {
+        int nindices,
+        bool derivePerms) {
     if (createIndicesInBlocks) {
         seq_createIndices(parallelProcesses, maxReadingThreads,
                 ins, createIndicesInBlocks, aggrIndices, canSkipTables,
@@ -2643,7 +3394,7 @@ void Loader::createIndices(
                 ins, createIndicesInBlocks, aggrIndices, canSkipTables,
                 storePlainList, permDirs, outputDirs, aggr1Dir, aggr2Dir,
                 treeWriters, sampleWriter, sampleRate, remotePath,
-                limitSpace, estimatedSize, nindices);
+                limitSpace, estimatedSize, nindices, derivePerms);
     }
 }
 
@@ -2959,11 +3710,32 @@ bool CoordinatesMerger::getFirst(TreeEl *el, ifstream *buffer) {
         el->nElements = Utils::decode_long(supportBuffer, 8);
         el->pos = Utils::decode_int(supportBuffer, 18);
         el->strat = supportBuffer[22];
-        return true;
+        return el->key < endKey;
     }
     return false;
 }
 
+void CoordinatesMerger::seek(ifstream *buffer, nTerm startKey) {
+    if (startKey <= 0 || !buffer->good()) {
+        return;
+    }
+    //The entries have a fixed size and are sorted by key
+    buffer->seekg(0, ios_base::end);
+    int64_t start = 0;
+    int64_t end = buffer->tellg() / 23;
+    while (start < end) {
+        const int64_t middle = (start + end) / 2;
+        buffer->seekg(middle * 23);
+        buffer->read(supportBuffer, 8);
+        if (Utils::decode_long(supportBuffer, 0) < startKey) {
+            start = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    buffer->seekg(start * 23);
+}
+
 bool L_Triple::sLess_sop(const L_Triple &t1, const L_Triple &t2) {
     if (t1.first < t2.first) {
         return true;
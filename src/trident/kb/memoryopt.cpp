@@ -115,6 +115,31 @@ void MemoryOptimizer::optimizeForWriting(int64_t inputTriples, KBConfig &config)
     config.setParamLong(STORAGE_MAX_N_FILES, 4);
 }
 
+uint64_t MemoryOptimizer::getCachesSizeForWriting(int ndicts,
+        KBConfig &config) {
+    return config.getParamLong(TREE_MAXSIZECACHETREE) +
+           ndicts * (config.getParamLong(DICT_MAXSIZECACHETREE) +
+                     config.getParamLong(INVDICT_MAXSIZECACHETREE) +
+                     config.getParamLong(SB_CACHESIZE));
+}
+
+void MemoryOptimizer::limitCachesForWriting(uint64_t maxMemory, int ndicts,
+        KBConfig &config) {
+    const uint64_t total = getCachesSizeForWriting(ndicts, config);
+    if (total <= maxMemory) {
+        return;
+    }
+    //All the caches are shrunk by the same factor
+    const double factor = (double) maxMemory / total;
+    const KBParam params[] = {TREE_MAXSIZECACHETREE, DICT_MAXSIZECACHETREE,
+                              INVDICT_MAXSIZECACHETREE, SB_CACHESIZE
+                             };
+    for (auto param : params) {
+        config.setParamLong(param, std::max((int64_t) SB_BLOCK_SIZE,
+                                            (int64_t) (config.getParamLong(param) * factor)));
+    }
+}
+
 void MemoryOptimizer::optimizeForReasoning(int ndicts, KBConfig &config) {
     uint64_t totalMemory = (uint64_t) std::min((double)128000000, (double)(Utils::getSystemMemory() * 0.10));
 
@@ -22,12 +22,17 @@
 
 #include <trident/kb/permsorter.h>
 #include <trident/utils/parallel.h>
+#include <trident/utils/pipeline.h>
+#include <trident/utils/memorybudget.h>
+#include <trident/utils/radixsort.h>
 #include <kognac/utils.h>
 #include <kognac/compressor.h>
 
 #include <thread>
 #include <functional>
 #include <array>
+#include <atomic>
+#include <mutex>
 
 struct __PermSorter_sorter {
     char *rawinput;
@@ -60,16 +65,13 @@ struct __PermSorter_sorter {
 
 typedef std::array<unsigned char, 15> __PermSorter_triple;
 
-bool __PermSorter_triple_sorter(const __PermSorter_triple &a,
-        const __PermSorter_triple &b) {
-    return a < b;
-}
-
 void PermSorter::sortPermutation(char *start, char *end, int nthreads) {
     __PermSorter_triple *sstart = (__PermSorter_triple*) start;
     __PermSorter_triple *send = (__PermSorter_triple*) end;
     std::chrono::system_clock::time_point starttime = std::chrono::system_clock::now();
-    ParallelTasks::sort_int(sstart, send, &__PermSorter_triple_sorter, nthreads);
+    //The IDs in the buffers are already in the order of the permutation
+    RadixSort<__PermSorter_triple, PackedTripleKey<0, 5, 10>>::sort(sstart,
+            send, nthreads);
     std::chrono::duration<double> duration = std::chrono::system_clock::now() - starttime;
     LOG(DEBUGL) << "Time sorting: " << duration.count() << "s.";
 }
@@ -440,20 +442,306 @@ struct _Offset {
     char third;
 };
 
+//Offsets of s, p and o in the records of a permutation
+static _Offset _getOffsets(char perm) {
+    _Offset o;
+    switch (perm) {
+        case IDX_SPO:
+            o.first = 0;
+            o.second = 5;
+            o.third = 10;
+            break;
+        case IDX_SOP:
+            o.first = 0;
+            o.second = 10;
+            o.third = 5;
+            break;
+        case IDX_OPS:
+            o.first = 10;
+            o.second = 5;
+            o.third = 0;
+            break;
+        case IDX_OSP:
+            o.first = 5;
+            o.second = 10;
+            o.third = 0;
+            break;
+        case IDX_POS:
+            o.first = 10;
+            o.second = 0;
+            o.third = 5;
+            break;
+        case IDX_PSO:
+            o.first = 5;
+            o.second = 0;
+            o.third = 10;
+            break;
+        default:
+            throw 10;
+    }
+    return o;
+}
+
+//field is 0 for s, 1 for p and 2 for o
+static int _offsetOf(const _Offset &o, int field) {
+    return field == 0 ? o.first : (field == 1 ? o.second : o.third);
+}
+
+static int _fieldAt(const _Offset &o, int offset) {
+    return o.first == offset ? 0 : (o.second == offset ? 1 : 2);
+}
+
+static void _runInParallel(int nthreads, std::function<void(int)> f) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < nthreads; ++i) {
+        threads.push_back(std::thread(f, i));
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+//Largest s, p and o in the first n records of a buffer in SPO order
+static void _maxTerms(char *spo, const int64_t n, const int nthreads,
+        int64_t *maxTerms) {
+    std::vector<std::array<int64_t, 3>> partial(nthreads);
+    const int64_t chunk = n / nthreads + 1;
+    _runInParallel(nthreads, [&](int t) {
+        std::array<int64_t, 3> m = {{0, 0, 0}};
+        const int64_t end = min(n, (t + 1) * chunk);
+        for (int64_t i = t * chunk; i < end; ++i) {
+            char *r = spo + i * 15;
+            for (int f = 0; f < 3; ++f) {
+                m[f] = max(m[f], PermSorter::readTermFromBuffer(r + f * 5));
+            }
+        }
+        partial[t] = m;
+    });
+    maxTerms[0] = maxTerms[1] = maxTerms[2] = 0;
+    for (auto &m : partial) {
+        for (int f = 0; f < 3; ++f) {
+            maxTerms[f] = max(maxTerms[f], m[f]);
+        }
+    }
+}
+
+//Whether the records of source are sorted by the second and the third term
+//of target. In this case, a stable scatter by the first term of target leaves
+//every term of target with its records already sorted
+static bool _keepsOrder(const _Offset &source, const _Offset &target) {
+    return _offsetOf(source, _fieldAt(target, 5)) <
+        _offsetOf(source, _fieldAt(target, 10));
+}
+
+//Order in which the permutations are derived from SPO (the first one).
+//Every pair is <target,source>, and the source is sorted before the target.
+//The sources that keep the order of the target are preferred
+static std::vector<std::pair<int, int>> _planDerivations(
+        const std::vector<_Offset> &offsets) {
+    std::vector<std::pair<int, int>> plan;
+    std::vector<bool> done(offsets.size(), false);
+    done[0] = true;
+    for (size_t n = 1; n < offsets.size(); ++n) {
+        int target = -1;
+        int source = 0;
+        for (int t = 1; t < offsets.size() && target == -1; ++t) {
+            if (done[t])
+                continue;
+            for (int s = 0; s < offsets.size(); ++s) {
+                if (done[s] && _keepsOrder(offsets[s], offsets[t])) {
+                    target = t;
+                    source = s;
+                    break;
+                }
+            }
+        }
+        if (target == -1) {
+            //No good source: the buckets are sorted from scratch
+            target = 1;
+            while (done[target])
+                target++;
+        }
+        done[target] = true;
+        plan.push_back(make_pair(target, source));
+    }
+    return plan;
+}
+
+#define DERIVE_BUCKET_BITS 16
+
+//Writes the first n records of src, which is sorted, in dst in the order of
+//another permutation. The records are scattered in buckets by the high bits
+//of their new first term (histogram, prefix sums and a stable scatter), and
+//then every bucket is sorted on its own if it is not sorted already. If src
+//keeps the order of dst, the buckets only need a stable sort on the low bits
+//of their first term. The records from n to size are filled with 0xFF like
+//in the unsorted buffers
+static void _derivePermutation(char *src, const _Offset os,
+        char *dst, const _Offset od,
+        const int64_t n, const int64_t size,
+        const int64_t maxFirst, const int nthreads) {
+    const int xoff = _offsetOf(os, _fieldAt(od, 0));
+    int bits = 0;
+    while ((maxFirst >> bits) > 0) {
+        bits++;
+    }
+    const int shift = max(0, bits - DERIVE_BUCKET_BITS);
+    const int64_t nbuckets = (maxFirst >> shift) + 1;
+    const int64_t chunk = n / nthreads + 1;
+
+    //Histogram of every chunk
+    std::vector<int64_t> pos(nbuckets * nthreads);
+    _runInParallel(nthreads, [&](int t) {
+        int64_t *hist = pos.data() + t * nbuckets;
+        const int64_t end = min(n, (t + 1) * chunk);
+        for (int64_t i = t * chunk; i < end; ++i) {
+            hist[PermSorter::readTermFromBuffer(src + i * 15 + xoff) >> shift]++;
+        }
+    });
+
+    //Prefix sums, so that the chunks are scattered in their order
+    std::vector<int64_t> bucketStart(nbuckets + 1);
+    int64_t sum = 0;
+    for (int64_t b = 0; b < nbuckets; ++b) {
+        bucketStart[b] = sum;
+        for (int t = 0; t < nthreads; ++t) {
+            const int64_t c = pos[t * nbuckets + b];
+            pos[t * nbuckets + b] = sum;
+            sum += c;
+        }
+    }
+    bucketStart[nbuckets] = sum;
+
+    _runInParallel(nthreads, [&](int t) {
+        int64_t *next = pos.data() + t * nbuckets;
+        const int64_t end = min(n, (t + 1) * chunk);
+        for (int64_t i = t * chunk; i < end; ++i) {
+            char *r = src + i * 15;
+            const int64_t b = PermSorter::readTermFromBuffer(r + xoff) >> shift;
+            char *d = dst + (next[b]++) * 15;
+            memcpy(d + od.first, r + os.first, 5);
+            memcpy(d + od.second, r + os.second, 5);
+            memcpy(d + od.third, r + os.third, 5);
+        }
+    });
+    memset(dst + n * 15, 0xFF, (size - n) * 15);
+
+    //Local sorts
+    const bool keepsOrder = _keepsOrder(os, od);
+    std::atomic<int64_t> nextBucket(0);
+    _runInParallel(nthreads, [&](int t) {
+        std::vector<char> tmp;
+        int64_t b;
+        while ((b = nextBucket++) < nbuckets) {
+            const int64_t start = bucketStart[b];
+            const int64_t end = bucketStart[b + 1];
+            bool isSorted = true;
+            for (int64_t i = start + 1; i < end && isSorted; ++i) {
+                isSorted = memcmp(dst + (i - 1) * 15, dst + i * 15, 15) <= 0;
+            }
+            if (isSorted) {
+                continue;
+            }
+            if (!keepsOrder) {
+                RadixSort<__PermSorter_triple, PackedTripleKey<0, 5, 10>>::sort(
+                        (__PermSorter_triple*) (dst + start * 15),
+                        (__PermSorter_triple*) (dst + end * 15), 1);
+                continue;
+            }
+            //LSD on the bits of the first term below shift
+            tmp.resize((end - start) * 15);
+            char *in = dst + start * 15;
+            char *out = tmp.data();
+            for (int low = 0; low < shift; low += 8) {
+                const int64_t mask = (1 << min(8, shift - low)) - 1;
+                int64_t pos[256];
+                memset(pos, 0, sizeof(pos));
+                for (int64_t i = 0; i < end - start; ++i) {
+                    pos[(PermSorter::readTermFromBuffer(in + i * 15) >> low) & mask]++;
+                }
+                int64_t sum = 0;
+                for (int d = 0; d <= mask; ++d) {
+                    const int64_t c = pos[d];
+                    pos[d] = sum;
+                    sum += c;
+                }
+                for (int64_t i = 0; i < end - start; ++i) {
+                    const int64_t d = (PermSorter::readTermFromBuffer(
+                                in + i * 15) >> low) & mask;
+                    memcpy(out + (pos[d]++) * 15, in + i * 15, 15);
+                }
+                std::swap(in, out);
+            }
+            if (in != dst + start * 15) {
+                memcpy(dst + start * 15, in, (end - start) * 15);
+            }
+        }
+    });
+}
+
+void PermSorter::derivePermutations(char *spo, const int64_t n,
+        const int64_t size,
+        const std::vector<std::pair<char*, char>> &others,
+        const int nthreads,
+        std::function<void(int, int)> onDerived) {
+    std::vector<char*> buffers;
+    std::vector<_Offset> offsets;
+    buffers.push_back(spo);
+    offsets.push_back(_getOffsets(IDX_SPO));
+    for (auto &o : others) {
+        buffers.push_back(o.first);
+        offsets.push_back(_getOffsets(o.second));
+    }
+
+    PermSorter::sortPermutation(spo, spo + 15 * size, nthreads);
+    if (onDerived) {
+        onDerived(0, -1);
+    }
+    int64_t maxTerms[3];
+    _maxTerms(spo, n, nthreads, maxTerms);
+    for (auto &step : _planDerivations(offsets)) {
+        const _Offset od = offsets[step.first];
+        _derivePermutation(buffers[step.second], offsets[step.second],
+                buffers[step.first], od, n, size, maxTerms[_fieldAt(od, 0)],
+                nthreads);
+        if (onDerived) {
+            onDerived(step.first, step.second);
+        }
+    }
+}
+
 void PermSorter::sortChunks(string inputdir,
         int maxReadingThreads,
         int parallelProcesses,
         int64_t estimatedSize,
         bool outputSPO,
-        std::vector<std::pair<string, char>> &additionalPermutations) {
+        bool derivePerms,
+        std::vector<std::pair<string, char>> &additionalPermutations,
+        std::function<void(string)> onSorted) {
 
     LOG(DEBUGL) << "Start sortChunks";
-    //calculate the number of elements
+    if (derivePerms && !outputSPO) {
+        LOG(WARNL) << "The permutations can be derived only from SPO. I disable it";
+        derivePerms = false;
+    }
+    StageStats readStats("sortChunks/read");
+    StageStats sortStats("sortChunks/sort");
+    StageStats dumpStats("sortChunks/dump");
+    //The buffers of the LZ4 readers and of the writers of the dumps
+    MemoryBudget &budget = MemoryBudget::getInstance();
+    const uint64_t ioMem = (uint64_t) 2 * parallelProcesses * 3 *
+        LOADER_LZ4_BUFFER_SIZE;
+    budget.reserve("sortChunks/io", ioMem, ioMem);
+
+    //calculate the number of elements. If the memory budget is lower, the
+    //triples are sorted in more rounds
     int64_t mem = Utils::getSystemMemory() * 0.4; //it's low because merge sort requires doubles the amount...
     int nperms = additionalPermutations.size() + 1;
-    int64_t nelements = mem / (15 * nperms);
-    int64_t elementsMainMem = max((int64_t)parallelProcesses,
-            min(nelements, (int64_t)(estimatedSize * 1.2)));
+    const uint64_t sortMem = budget.reserve("sortChunks",
+            min(mem, (int64_t)(estimatedSize * 1.2) * 15 * nperms),
+            LOADER_MIN_SORT_BUFFER);
+    int64_t nelements = sortMem / (15 * nperms);
+    int64_t elementsMainMem = max((int64_t)parallelProcesses, nelements);
     //Make sure elementsMainMem is a multiple of parallelProcesses
     elementsMainMem += parallelProcesses - (elementsMainMem % parallelProcesses);
 
@@ -500,6 +788,21 @@ void PermSorter::sortChunks(string inputdir,
     }
 
     LOG(DEBUGL) << "Creating vectors of " << elementsMainMem << ". done";
+
+    //If the permutations are derived from SPO, the triples are loaded only
+    //in the first buffer
+    std::vector<std::pair<string, char>> copiedPermutations;
+    std::vector<std::pair<int, int>> plan;
+    std::vector<_Offset> allOffsets;
+    allOffsets.push_back(_getOffsets(IDX_SPO));
+    for(auto p : additionalPermutations) {
+        allOffsets.push_back(_getOffsets(p.second));
+    }
+    if (derivePerms) {
+        plan = _planDerivations(allOffsets);
+    } else {
+        copiedPermutations = additionalPermutations;
+    }
     int64_t maxInserts = max((int64_t)1, (int64_t)(elementsMainMem / parallelProcesses));
     bool isFinished = false;
     int iter = 0;
@@ -516,7 +819,7 @@ void PermSorter::sortChunks(string inputdir,
                         (i * 15 * maxInserts),
                         ((i+1) * 15 * maxInserts),
                         &(counts[i]),
-                        additionalPermutations,
+                        copiedPermutations,
                         outputSPO));
         }
         for (int i = 0; i < parallelProcesses; ++i) {
@@ -535,37 +838,7 @@ void PermSorter::sortChunks(string inputdir,
         }
         std::vector<_Offset> offsets;
         for(auto p : additionalPermutations) {
-            _Offset o;
-            switch (p.second) {
-                case IDX_SOP:
-                    o.first = 0;
-                    o.second = 10;
-                    o.third = 5;
-                    break;
-                case IDX_OPS:
-                    o.first = 10;
-                    o.second = 5;
-                    o.third = 0;
-                    break;
-                case IDX_OSP:
-                    o.first = 5;
-                    o.second = 10;
-                    o.third = 0;
-                    break;
-                case IDX_POS:
-                    o.first = 10;
-                    o.second = 0;
-                    o.third = 5;
-                    break;
-                case IDX_PSO:
-                    o.first = 5;
-                    o.second = 0;
-                    o.third = 10;
-                    break;
-                default:
-                    throw 10;
-            }
-            offsets.push_back(o);
+            offsets.push_back(_getOffsets(p.second));
         }
         while (curPart < parallelProcesses && !openedStreams.empty()) {
             if (counts[curPart] < maxInserts) {
@@ -592,7 +865,7 @@ void PermSorter::sortChunks(string inputdir,
                     }
 
                     //Copy the triples also in the other permutations
-                    for(int i = 0; i < additionalPermutations.size(); ++i) {
+                    for(int i = 0; i < copiedPermutations.size(); ++i) {
                         char *startperm = rawTriples[i + 1].get() + startp;
                         const _Offset o = offsets[i];
                         PermSorter::writeTermInBuffer(startperm + starto + o.first, first);
@@ -615,40 +888,11 @@ void PermSorter::sortChunks(string inputdir,
             }
         }
         LOG(DEBUGL) << "Finished filling holes";
-
-        LOG(DEBUGL) << "Start sorting. Processes per permutation=" << max(1, (int)(parallelProcesses / nperms));
-        int nthreads = max(1, (int)(parallelProcesses / 6));
-        std::thread *threads = new std::thread[additionalPermutations.size()];
-        for(int i = 0; i < additionalPermutations.size(); ++i) {
-            threads[i] = std::thread(
-                    std::bind(&PermSorter::sortPermutation,
-                        rawTriples[i+1].get(), rawTriples[i+1].get() + 15 * maxInserts * parallelProcesses, nthreads));
-        }
-        PermSorter::sortPermutation(rawTriples[0].get(), rawTriples[0].get() + 15 * maxInserts * parallelProcesses, nthreads);
-        for(int i = 0; i < additionalPermutations.size(); ++i) {
-            threads[i].join();
-        }
-        delete[] threads;
-        LOG(DEBUGL) << "End sorting";
-
-        LOG(DEBUGL) << "Start dumping";
-        int64_t maxValue = maxInserts * parallelProcesses;
-        int j = 1;
-        for(auto perm : additionalPermutations) {
-            string outputFile = perm.first + DIR_SEP + string("sorted-") + to_string(iter++);
-            PermSorter::dumpPermutation(rawTriples[j++].get(),
-                    maxValue,
-                    parallelProcesses,
-                    maxReadingThreads,
-                    outputFile);
+        int64_t nloaded = 0;
+        for (auto c : counts) {
+            nloaded += c;
         }
-        string outputFile = inputdir + DIR_SEP + string("sorted-") + to_string(iter++);
-        PermSorter::dumpPermutation(rawTriples[0].get(),
-                maxValue,
-                parallelProcesses,
-                maxReadingThreads,
-                outputFile);
-        LOG(DEBUGL) << "End dumping";
+        readStats.add(nloaded, nloaded * 15);
 
         //Are all files read?
         int i = 0;
@@ -661,7 +905,94 @@ void PermSorter::sortChunks(string inputdir,
         if (!isFinished) {
             LOG(DEBUGL) << "One round is not enough";
         }
+
+        //Every permutation is dumped as soon as it is sorted, so the disk is
+        //used while the other permutations are sorted
+        LOG(DEBUGL) << "Start sorting and dumping. Processes per permutation=" << max(1, (int)(parallelProcesses / nperms));
+        int nthreads = max(1, (int)(parallelProcesses / 6));
+        const int64_t maxValue = maxInserts * parallelProcesses;
+        BoundedQueue<int> sorted(nperms);
+        std::vector<std::thread> sorters;
+        //A buffer is freed once it is dumped and no longer read by the
+        //derivations
+        std::mutex mutexFree;
+        std::vector<int> pendingReads(nperms);
+        std::vector<bool> dumped(nperms);
+        if (derivePerms) {
+            for(auto &step : plan) {
+                pendingReads[step.second]++;
+            }
+            //SPO is sorted with all the threads. Then every other
+            //permutation is scattered from one that is already sorted
+            std::vector<std::pair<char*, char>> others;
+            for(int i = 0; i < additionalPermutations.size(); ++i) {
+                others.push_back(make_pair(rawTriples[i + 1].get(),
+                            additionalPermutations[i].second));
+            }
+            sorters.push_back(std::thread([&, others]() {
+                PermSorter::derivePermutations(rawTriples[0].get(), nloaded,
+                    maxValue, others, parallelProcesses,
+                    [&](int target, int source) {
+                    sortStats.add(nloaded);
+                    if (source >= 0) {
+                        std::lock_guard<std::mutex> lock(mutexFree);
+                        pendingReads[source]--;
+                        if (isFinished && dumped[source] &&
+                            pendingReads[source] == 0) {
+                            rawTriples[source] = NULL;
+                        }
+                    }
+                    sorted.push(target);
+                    });
+            }));
+        } else {
+            for(int i = 0; i < nperms; ++i) {
+                sorters.push_back(std::thread([&rawTriples, &sorted,
+                    &sortStats, i, maxValue, nthreads, nloaded]() {
+                    PermSorter::sortPermutation(rawTriples[i].get(),
+                        rawTriples[i].get() + 15 * maxValue, nthreads);
+                    sortStats.add(nloaded);
+                    sorted.push(i);
+                }));
+            }
+        }
+        for(int n = 0; n < nperms; ++n) {
+            int idx;
+            sorted.pop(idx);
+            const string dir = idx == 0 ? inputdir :
+                additionalPermutations[idx - 1].first;
+            string outputFile = dir + DIR_SEP + string("sorted-") + to_string(iter++);
+            PermSorter::dumpPermutation(rawTriples[idx].get(),
+                    maxValue,
+                    parallelProcesses,
+                    maxReadingThreads,
+                    outputFile);
+            dumpStats.add(nloaded, nloaded * 15);
+            if (isFinished) {
+                //The permutation is complete. The input directory still
+                //contains the unsorted files, so it is notified at the end
+                {
+                    std::lock_guard<std::mutex> lock(mutexFree);
+                    dumped[idx] = true;
+                    if (pendingReads[idx] == 0) {
+                        rawTriples[idx] = NULL;
+                    }
+                }
+                if (onSorted && idx > 0) {
+                    onSorted(dir);
+                }
+            }
+        }
+        for(auto &t : sorters) {
+            t.join();
+        }
+        LOG(DEBUGL) << "End sorting and dumping";
     }
+    readStats.report();
+    sortStats.report();
+    dumpStats.report();
+    budget.release("sortChunks", sortMem);
+    budget.release("sortChunks/io", ioMem);
 
     for(int i = 0; i < maxReadingThreads; ++i) {
         delete readers[i];
@@ -670,4 +1001,7 @@ void PermSorter::sortChunks(string inputdir,
         Utils::remove(inputFile);
     delete[] readers;
     delete[] threads;
+    if (onSorted) {
+        onSorted(inputdir);
+    }
 }
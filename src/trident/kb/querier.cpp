@@ -32,6 +32,7 @@
 #include <iostream>
 #include <inttypes.h>
 #include <cmath>
+#include <algorithm>
 
 using namespace std;
 
@@ -65,7 +66,7 @@ Querier::Querier(Root* tree, DictMgmt *dict, TableStorage** files,
         lastKeyFound = false;
         lastKeyQueried = -1;
         strat.init(/*&listFactory, &comprFactory, &list2Factory,*/ &ncFactory, &nrFactory, &ncluFactory,
-                NULL, NULL, NULL, NULL, NULL, NULL);
+                &packedFactory, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         aggrIndices = notAggrIndices = cacheIndices = 0;
         spo = sop = pos = pso = ops = osp = 0;
 
@@ -535,6 +536,185 @@ bool Querier::isEmpty(const int64_t s, const int64_t p, const int64_t o) {
     }
 }
 
+Querier::BatchQuery::BatchQuery(Querier *q, const int idx, const int64_t s,
+        const int64_t p, const int64_t o, const size_t pos) :
+    idx(idx), s(s), p(p), o(o), pos(pos) {
+        const int64_t terms[3] = { s, p, o };
+        const int *order = q->getOrder(idx);
+        key = terms[order[0]];
+        v1 = terms[order[1]];
+        v2 = terms[order[2]];
+    }
+
+void Querier::lookupMany(std::vector<BatchQuery> &queries,
+        std::vector<size_t> &groups,
+        std::vector<TermCoordinates> &values,
+        std::unique_ptr<bool[]> &found) {
+    std::sort(queries.begin(), queries.end());
+    std::vector<int64_t> keys;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        if (i == 0 || queries[i].key != queries[i - 1].key) {
+            groups.push_back(i);
+            keys.push_back(queries[i].key);
+        }
+    }
+    groups.push_back(queries.size());
+
+    //Negative keys are variables. They are sorted first
+    size_t firstKey = 0;
+    while (firstKey < keys.size() && keys[firstKey] < 0) {
+        firstKey++;
+    }
+    values.resize(keys.size());
+    found = std::unique_ptr<bool[]>(new bool[keys.size()]);
+    for (size_t i = 0; i < firstKey; ++i) {
+        values[i].clear();
+        found[i] = false;
+    }
+    if (firstKey < keys.size()) {
+        tree->getMany(keys.data() + firstKey, keys.size() - firstKey,
+                values.data() + firstKey, found.get() + firstKey);
+    }
+}
+
+void Querier::setCurrentKey(const int64_t key, TermCoordinates &value,
+        const bool found) {
+    if (key >= 0) {
+        currentValue.copyFrom(&value);
+        lastKeyFound = found;
+        lastKeyQueried = key;
+    }
+}
+
+void Querier::existsOnTable(BatchQuery *begin, BatchQuery *end, bool *out) {
+    const int idx = begin->idx;
+    const int64_t key = begin->key;
+    if (!diffIndices.empty() || !lastKeyFound || !currentValue.exists(idx) ||
+            StorageStrat::isAggregated(currentValue.getStrategy(idx))) {
+        //Updates, reversed or aggregated tables: one iterator per query
+        for (BatchQuery *q = begin; q < end; ++q) {
+            PairItr *itr = get(idx, q->s, q->p, q->o);
+            out[q->pos] = false;
+            if (itr->getTypeItr() != EMPTY_ITR) {
+                out[q->pos] = itr->hasNext();
+                releaseItr(itr);
+            }
+        }
+        return;
+    }
+
+    //The queries are sorted, so a single iterator on the table can move
+    //forward to each of them
+    notAggrIndices++;
+    PairItr *itr = getPairIterator(&currentValue, idx, key, -1, -1, false,
+            true);
+    bool hasCurrent = itr->hasNext();
+    if (hasCurrent) {
+        itr->next();
+    }
+    for (BatchQuery *q = begin; q < end; ++q) {
+        if (hasCurrent && (itr->getValue1() < q->v1 ||
+                    (itr->getValue1() == q->v1 && itr->getValue2() < q->v2))) {
+            itr->moveto(q->v1, q->v2);
+            hasCurrent = itr->hasNext();
+            if (hasCurrent) {
+                itr->next();
+            }
+        }
+        out[q->pos] = hasCurrent && itr->getValue1() == q->v1 &&
+            itr->getValue2() == q->v2;
+    }
+    releaseItr(itr);
+}
+
+void Querier::getMany(const int idx, const int64_t *s, const int64_t *p,
+        const int64_t *o, const size_t n, PairItr **out) {
+    std::vector<BatchQuery> queries;
+    queries.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        queries.push_back(BatchQuery(this, idx, s[i], p[i], o[i], i));
+    }
+    std::vector<size_t> groups;
+    std::vector<TermCoordinates> values;
+    std::unique_ptr<bool[]> found;
+    lookupMany(queries, groups, values, found);
+
+    for (size_t g = 0; g + 1 < groups.size(); ++g) {
+        setCurrentKey(queries[groups[g]].key, values[g], found[g]);
+        for (size_t i = groups[g]; i < groups[g + 1]; ++i) {
+            const BatchQuery &q = queries[i];
+            out[q.pos] = get(idx, q.s, q.p, q.o);
+        }
+    }
+}
+
+void Querier::existsMany(const int64_t *s, const int64_t *p,
+        const int64_t *o, const size_t n, bool *out) {
+    //Same index used by exists()
+    std::vector<BatchQuery> queries;
+    queries.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        if (s[i] < 0 || p[i] < 0 || o[i] < 0) {
+            out[i] = exists(s[i], p[i], o[i]);
+        } else {
+            queries.push_back(BatchQuery(this, IDX_POS, s[i], p[i], o[i], i));
+        }
+    }
+    std::vector<size_t> groups;
+    std::vector<TermCoordinates> values;
+    std::unique_ptr<bool[]> found;
+    lookupMany(queries, groups, values, found);
+
+    for (size_t g = 0; g + 1 < groups.size(); ++g) {
+        setCurrentKey(queries[groups[g]].key, values[g], found[g]);
+        existsOnTable(queries.data() + groups[g],
+                queries.data() + groups[g + 1], out);
+    }
+}
+
+void Querier::getCardMany(const int64_t *s, const int64_t *p,
+        const int64_t *o, const size_t n, int64_t *out) {
+    std::vector<BatchQuery> queries;
+    queries.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        if (s[i] < 0 && p[i] < 0 && o[i] < 0) {
+            out[i] = getInputSize();
+        } else {
+            queries.push_back(BatchQuery(this, getIndex(s[i], p[i], o[i]),
+                        s[i], p[i], o[i], i));
+        }
+    }
+    std::vector<size_t> groups;
+    std::vector<TermCoordinates> values;
+    std::unique_ptr<bool[]> found;
+    lookupMany(queries, groups, values, found);
+
+    std::unique_ptr<bool[]> exist(new bool[n]);
+    for (size_t g = 0; g + 1 < groups.size(); ++g) {
+        setCurrentKey(queries[groups[g]].key, values[g], found[g]);
+        size_t i = groups[g];
+        while (i < groups[g + 1]) {
+            BatchQuery &q = queries[i];
+            if (q.s < 0 || q.p < 0 || q.o < 0) {
+                out[q.pos] = getCard(q.s, q.p, q.o);
+                i++;
+                continue;
+            }
+            //The cardinality of a fully bound query is 1 if it exists
+            size_t e = i + 1;
+            while (e < groups[g + 1] && queries[e].idx == q.idx &&
+                    queries[e].v1 >= 0 && queries[e].v2 >= 0) {
+                e++;
+            }
+            existsOnTable(queries.data() + i, queries.data() + e,
+                    exist.get());
+            for (; i < e; ++i) {
+                out[queries[i].pos] = exist[queries[i].pos] ? 1 : 0;
+            }
+        }
+    }
+}
+
 int Querier::getIndex(int64_t s, int64_t p, int64_t o) {
     if (nindices == 1) {
         return IDX_SPO;
@@ -611,10 +791,19 @@ void Querier::initNewIterator(TableStorage *storage,
         int64_t v1,
         int64_t v2,
         const bool setConstraints) {
-    std::pair<const char*, const char*> coord = storage->getTable(file, mark);
+    TablePin pin;
+    std::pair<const char*, const char*> coord = storage->getTable(file, mark,
+            pin);
 
     assert(t->getTypeItr() == NEWROW_ITR || t->getTypeItr() == NEWCLUSTER_ITR
-            || t->getTypeItr() == NEWCOLUMN_ITR);
+            || t->getTypeItr() == NEWCOLUMN_ITR || t->getTypeItr() == PACKED_ITR);
+    ((AbsNewTable*)t)->setPin(pin);
+    if (v1 == -1 && storage->useAccessHints() &&
+            coord.second - coord.first >= THRESHOLD_KEEP_MEMORY) {
+        //The large table will be read entirely. Start reading it ahead
+        MemoryMappedFile::advise(coord.first, coord.second - coord.first,
+                ACCESS_WILLNEED);
+    }
     if (v1 != -1) {
         if (setConstraints) {
             if (v2 == -1) {
@@ -667,6 +856,31 @@ PairItr *Querier::getPermuted(const int idx, const int64_t el1, const int64_t el
     throw 10;
 }
 
+void Querier::prefetch(const int perm, const std::vector<int64_t> &keys) {
+    TermCoordinates coord;
+    for (const auto key : keys) {
+        if (!tree->get(key, &coord)) {
+            continue;
+        }
+        //Same fallback of get() if the permutation is not stored
+        int idx = perm;
+        if (!coord.exists(idx) && idx - 3 >= 0 && coord.exists(idx - 3)) {
+            idx -= 3;
+        }
+        if (coord.exists(idx) && files[idx] != NULL) {
+            files[idx]->prefetch(coord.getFileIdx(idx), coord.getMark(idx));
+        }
+    }
+}
+
+bool Querier::canPrefetch(const int perm) {
+    TableStorage *storage = getTableStorage(perm);
+    if (storage == NULL && perm - 3 >= 0) {
+        storage = getTableStorage(perm - 3);
+    }
+    return storage != NULL && storage->hasPrefetcher();
+}
+
 PairItr *Querier::getTermList(const int perm) {
     PairItr *finalItr = getKBTermList(perm, false);
 
@@ -769,6 +983,29 @@ PairItr *Querier::summaryDiff(const int perm, DiffIndex::TypeUpdate tp) {
     return finalItr;
 }
 
+Querier::Counters Querier::getCounters() {
+    Counters c;
+    c.statsRow = strat.statsRow;
+    c.statsColumn = strat.statsColumn;
+    c.statsCluster = strat.statsCluster;
+    c.aggrIndices = aggrIndices;
+    c.notAggrIndices = notAggrIndices;
+    c.cacheIndices = cacheIndices;
+    c.spo = spo;
+    c.ops = ops;
+    c.pos = pos;
+    c.sop = sop;
+    c.osp = osp;
+    c.pso = pso;
+    if (tree != NULL) {
+        c.treeCache = tree->getCacheStats();
+    }
+    if (dict != NULL) {
+        c.dictCache = dict->getCacheStats();
+    }
+    return c;
+}
+
 bool Querier::existKey(int perm, int64_t key) {
     PairItr *itr = getPermuted(perm, key, -1, -1, true);
     bool resp;
@@ -1135,14 +1372,21 @@ void Querier::releaseItr(PairItr * itr) {
     AggrItr *citr;
     switch (itr->getTypeItr()) {
         case NEWCOLUMN_ITR:
+            ((AbsNewTable *) itr)->setPin(TablePin());
             ncFactory.release((NewColumnTable *) itr);
             break;
         case NEWROW_ITR:
+            ((AbsNewTable *) itr)->setPin(TablePin());
             nrFactory.release((AbsNewTable *) itr);
             break;
         case NEWCLUSTER_ITR:
+            ((AbsNewTable *) itr)->setPin(TablePin());
             ncluFactory.release((AbsNewTable *) itr);
             break;
+        case PACKED_ITR:
+            ((AbsNewTable *) itr)->setPin(TablePin());
+            packedFactory.release((PackedTable *) itr);
+            break;
         case ARRAY_ITR:
             itr->clear();
             factory2.release((ArrayItr*) itr);
@@ -0,0 +1,304 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/kb/textindex.h>
+
+#include <kognac/lz4io.h>
+#include <kognac/logs.h>
+#include <kognac/utils.h>
+
+#include <algorithm>
+#include <fstream>
+#include <queue>
+
+#define TEXTIDX_META_SIZE 16
+//A pair <trigram,ID> is stored in one number: the trigram in the 24 most
+//significant bits and the ID in the others
+#define TEXTIDX_ID_BITS 40
+#define TEXTIDX_ID_MASK ((UINT64_C(1) << TEXTIDX_ID_BITS) - 1)
+//The posting lists that are this many times longer than the candidates are
+//not intersected
+#define TEXTIDX_MAX_RATIO 64
+
+bool TextIndex::exists(std::string dir) {
+    return Utils::exists(dir + DIR_SEP + "meta");
+}
+
+TextIndex::TextIndex(std::string dir) {
+    std::ifstream meta(dir + DIR_SEP + "meta", std::ios_base::binary);
+    char header[TEXTIDX_META_SIZE];
+    meta.read(header, TEXTIDX_META_SIZE);
+    if (meta.gcount() != TEXTIDX_META_SIZE) {
+        LOG(ERRORL) << "The text index " << dir << " is corrupted";
+        throw 10;
+    }
+    meta.close();
+    nGrams = Utils::decode_long(header, 0);
+    nIDs = Utils::decode_long(header, 8);
+
+    grams = NULL;
+    postings = NULL;
+    if (nGrams > 0) {
+        fGrams = std::unique_ptr<MemoryMappedFile>(
+                new MemoryMappedFile(dir + DIR_SEP + "grams", true));
+        fPostings = std::unique_ptr<MemoryMappedFile>(
+                new MemoryMappedFile(dir + DIR_SEP + "postings", true));
+        if (fGrams->getLength() != nGrams * sizeof(Gram)) {
+            LOG(ERRORL) << "The text index " << dir << " is corrupted";
+            throw 10;
+        }
+        grams = (const Gram*) fGrams->getData();
+        postings = fPostings->getData();
+    }
+}
+
+//The offsets in the posting lists may not fit in an int
+static uint64_t decodeDelta(const char *&list) {
+    int offset = 0;
+    const uint64_t delta = Utils::decode_vlong2(list, &offset);
+    list += offset;
+    return delta;
+}
+
+const TextIndex::Gram *TextIndex::find(uint64_t gram) const {
+    const Gram *end = grams + nGrams;
+    const Gram *g = std::lower_bound(grams, end, gram,
+            [](const Gram &g, const uint64_t gram) {
+            return g.gram < gram;
+            });
+    if (g == end || g->gram != gram) {
+        return NULL;
+    }
+    return g;
+}
+
+bool TextIndex::getCandidates(const char *pattern, const int size,
+        const uint64_t maxCandidates,
+        std::vector<uint64_t> &candidates) const {
+    candidates.clear();
+    if (size < 3) {
+        return false;
+    }
+    std::vector<uint64_t> patternGrams;
+    for (int i = 0; i + 3 <= size; ++i) {
+        patternGrams.push_back(getGram(pattern + i));
+    }
+    std::sort(patternGrams.begin(), patternGrams.end());
+    patternGrams.erase(std::unique(patternGrams.begin(), patternGrams.end()),
+            patternGrams.end());
+    std::vector<const Gram*> lists;
+    for (auto gram : patternGrams) {
+        const Gram *g = find(gram);
+        if (g == NULL) {
+            //No term contains the pattern
+            return true;
+        }
+        lists.push_back(g);
+    }
+
+    //Start from the shortest list, so that the intersections only shrink it
+    std::sort(lists.begin(), lists.end(), [](const Gram *g1, const Gram *g2) {
+            return g1->count < g2->count;
+            });
+    if (lists[0]->count > maxCandidates) {
+        return false;
+    }
+    const char *list = postings + lists[0]->offset;
+    uint64_t id = 0;
+    candidates.reserve(lists[0]->count);
+    for (uint64_t i = 0; i < lists[0]->count; ++i) {
+        id += decodeDelta(list);
+        candidates.push_back(id);
+    }
+    for (int l = 1; l < lists.size() && !candidates.empty(); ++l) {
+        //Scanning a much longer list costs more than verifying the texts
+        if (lists[l]->count / TEXTIDX_MAX_RATIO > candidates.size()) {
+            break;
+        }
+        list = postings + lists[l]->offset;
+        id = 0;
+        size_t in = 0, out = 0;
+        for (uint64_t i = 0; i < lists[l]->count && in < candidates.size();
+                ++i) {
+            id += decodeDelta(list);
+            while (in < candidates.size() && candidates[in] < id) {
+                in++;
+            }
+            if (in < candidates.size() && candidates[in] == id) {
+                candidates[out++] = id;
+                in++;
+            }
+        }
+        candidates.resize(out);
+    }
+    return true;
+}
+
+TextIndexBuilder::TextIndexBuilder(std::string dir, uint64_t maxMemory) :
+    dir(dir), maxMemory(maxMemory), largestID(-1) {
+        Utils::create_directories(dir);
+    }
+
+void TextIndexBuilder::add(const char *text, const int size, const nTerm id) {
+    if (id < 0 || (uint64_t) id > TEXTIDX_ID_MASK) {
+        LOG(ERRORL) << "The ID " << id << " cannot be stored in the text index";
+        throw 10;
+    }
+    termGrams.clear();
+    for (int i = 0; i + 3 <= size; ++i) {
+        termGrams.push_back(TextIndex::getGram(text + i));
+    }
+    std::sort(termGrams.begin(), termGrams.end());
+    termGrams.erase(std::unique(termGrams.begin(), termGrams.end()),
+            termGrams.end());
+    if ((pairs.size() + termGrams.size()) * sizeof(uint64_t) > maxMemory
+            && !pairs.empty()) {
+        flushRun();
+    }
+    for (auto gram : termGrams) {
+        pairs.push_back((gram << TEXTIDX_ID_BITS) | id);
+    }
+    largestID = std::max(largestID, id);
+}
+
+void TextIndexBuilder::flushRun() {
+    std::sort(pairs.begin(), pairs.end());
+    const std::string file = dir + DIR_SEP + "run" + std::to_string(runs.size());
+    LZ4Writer writer(file);
+    uint64_t previous = 0;
+    for (auto pair : pairs) {
+        writer.writeLong(pair - previous);
+        previous = pair;
+    }
+    runs.push_back(file);
+    LOG(DEBUGL) << "Sorted " << pairs.size() << " trigrams in " << file;
+    pairs.clear();
+}
+
+struct TextIndexRun {
+    std::unique_ptr<LZ4Reader> reader;
+    uint64_t pair;
+
+    bool next() {
+        if (reader->isEof()) {
+            return false;
+        }
+        pair += reader->parseLong();
+        return true;
+    }
+};
+
+struct TextIndexRunCmp {
+    bool operator()(const TextIndexRun *r1, const TextIndexRun *r2) const {
+        return r1->pair > r2->pair;
+    }
+};
+
+uint64_t TextIndexBuilder::finish() {
+    if (!pairs.empty()) {
+        flushRun();
+    }
+    std::vector<TextIndexRun> openRuns(runs.size());
+    std::priority_queue<TextIndexRun*, std::vector<TextIndexRun*>,
+        TextIndexRunCmp> queue;
+    for (int i = 0; i < runs.size(); ++i) {
+        openRuns[i].reader = std::unique_ptr<LZ4Reader>(new LZ4Reader(runs[i]));
+        openRuns[i].pair = 0;
+        if (openRuns[i].next()) {
+            queue.push(&openRuns[i]);
+        }
+    }
+
+    std::ofstream fGrams(dir + DIR_SEP + "grams", std::ios_base::binary);
+    std::ofstream fPostings(dir + DIR_SEP + "postings", std::ios_base::binary);
+    char buffer[10];
+    uint64_t nGrams = 0;
+    uint64_t offset = 0;
+    uint64_t gram = 0;
+    uint64_t gramOffset = 0;
+    uint64_t count = 0;
+    uint64_t previousID = 0;
+    auto writeGram = [&]() {
+        TextIndex::Gram g;
+        g.gram = gram;
+        g.offset = gramOffset;
+        g.count = count;
+        fGrams.write((const char*) &g, sizeof(g));
+        nGrams++;
+    };
+    bool first = true;
+    uint64_t previousPair = 0;
+    while (!queue.empty()) {
+        TextIndexRun *run = queue.top();
+        queue.pop();
+        const uint64_t pair = run->pair;
+        if (run->next()) {
+            queue.push(run);
+        }
+        //The same term was added twice
+        if (!first && pair == previousPair) {
+            continue;
+        }
+        const uint64_t g = pair >> TEXTIDX_ID_BITS;
+        if (first || g != gram) {
+            if (!first) {
+                writeGram();
+            }
+            gram = g;
+            gramOffset = offset;
+            count = 0;
+            previousID = 0;
+        }
+        const uint64_t id = pair & TEXTIDX_ID_MASK;
+        const int size = Utils::encode_vlong2(buffer, 0, id - previousID);
+        fPostings.write(buffer, size);
+        offset += size;
+        count++;
+        previousID = id;
+        previousPair = pair;
+        first = false;
+    }
+    if (!first) {
+        writeGram();
+    }
+    fGrams.close();
+    fPostings.close();
+    if (fGrams.fail() || fPostings.fail()) {
+        LOG(ERRORL) << "Failed in writing the text index in " << dir;
+        throw 10;
+    }
+    openRuns.clear();
+    for (const auto &run : runs) {
+        Utils::remove(run);
+    }
+    runs.clear();
+
+    char header[TEXTIDX_META_SIZE];
+    Utils::encode_long(header, 0, nGrams);
+    Utils::encode_long(header, 8, largestID + 1);
+    std::ofstream meta(dir + DIR_SEP + "meta", std::ios_base::binary);
+    meta.write(header, TEXTIDX_META_SIZE);
+    meta.close();
+    LOG(DEBUGL) << "Text index: " << nGrams << " trigrams in " << offset <<
+        " bytes";
+    return nGrams;
+}
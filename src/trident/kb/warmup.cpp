@@ -0,0 +1,206 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/kb/warmup.h>
+#include <trident/kb/consts.h>
+#include <trident/utils/memoryfile.h>
+
+#include <kognac/utils.h>
+#include <kognac/logs.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#define WARMUP_CHUNK_SIZE (64 * 1024 * 1024)
+//Part of the available memory that the warmup can fill
+#define WARMUP_MEMORY_FRACTION 0.8
+
+std::vector<int> Warmup::parsePermutations(std::string perms) {
+    std::vector<int> out;
+    if (perms == "all") {
+        for (int i = 0; i < N_PARTITIONS; ++i) {
+            out.push_back(i);
+        }
+        return out;
+    }
+    std::stringstream ss(perms);
+    std::string perm;
+    while (std::getline(ss, perm, ',')) {
+        if (perm == "spo") {
+            out.push_back(IDX_SPO);
+        } else if (perm == "ops") {
+            out.push_back(IDX_OPS);
+        } else if (perm == "pos") {
+            out.push_back(IDX_POS);
+        } else if (perm == "sop") {
+            out.push_back(IDX_SOP);
+        } else if (perm == "osp") {
+            out.push_back(IDX_OSP);
+        } else if (perm == "pso") {
+            out.push_back(IDX_PSO);
+        } else if (perm != "") {
+            LOG(ERRORL) << "Permutation " << perm << " not recognized";
+            throw 10;
+        }
+    }
+    return out;
+}
+
+void Warmup::getFiles(std::string dir, std::vector<std::string> &files) {
+    if (!Utils::exists(dir)) {
+        return;
+    }
+    if (!Utils::isDirectory(dir)) {
+        files.push_back(dir);
+        return;
+    }
+    for (auto file : Utils::getFiles(dir)) {
+        if (Utils::isDirectory(file)) {
+            getFiles(file, files);
+        } else {
+            files.push_back(file);
+        }
+    }
+}
+
+uint64_t Warmup::warmupKB(std::string kbdir, std::vector<int> perms,
+        bool tree, bool dict, int nthreads, int timeout) {
+    std::vector<std::string> files;
+    if (tree) {
+        getFiles(kbdir + DIR_SEP + "tree", files);
+    }
+    if (dict) {
+        getFiles(kbdir + DIR_SEP + "dict", files);
+        getFiles(kbdir + DIR_SEP + "invdict", files);
+        getFiles(kbdir + DIR_SEP + "fcdict", files);
+        getFiles(kbdir + DIR_SEP + "dicthash", files);
+        getFiles(kbdir + DIR_SEP + "textidx", files);
+    }
+    for (auto perm : perms) {
+        getFiles(kbdir + DIR_SEP + "p" + std::to_string(perm), files);
+    }
+    return loadFiles(files, nthreads, timeout,
+            getAvailableMemory() * WARMUP_MEMORY_FRACTION);
+}
+
+uint64_t Warmup::getAvailableMemory() {
+#if defined(__linux__)
+    //It includes the page cache that can be reclaimed
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    while (std::getline(meminfo, line)) {
+        if (line.compare(0, 13, "MemAvailable:") == 0) {
+            return std::stoull(line.substr(13)) * 1024;
+        }
+    }
+#endif
+    return Utils::getSystemMemory();
+}
+
+uint64_t Warmup::loadFiles(const std::vector<std::string> &files,
+        int nthreads, int timeout, uint64_t maxBytes) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point deadline = start +
+        std::chrono::seconds(timeout);
+
+    //Map the files and split them in chunks, in the order of the files,
+    //until maxBytes
+    std::vector<std::unique_ptr<MemoryMappedFile>> mappings;
+    std::vector<std::pair<size_t, uint64_t>> chunks;
+    uint64_t totalBytes = 0;
+    size_t nfiles = 0;
+    for (auto &file : files) {
+        const uint64_t size = Utils::fileSize(file);
+        if (size == 0) {
+            continue;
+        }
+        if (maxBytes > 0 && totalBytes >= maxBytes) {
+            LOG(WARNL) << "Warmup skips " << files.size() - nfiles <<
+                " files because only " << maxBytes / (1024 * 1024) <<
+                " MB of memory are available";
+            break;
+        }
+        mappings.push_back(std::unique_ptr<MemoryMappedFile>(
+                    new MemoryMappedFile(file)));
+        nfiles++;
+        for (uint64_t pos = 0; pos < size; pos += WARMUP_CHUNK_SIZE) {
+            if (maxBytes > 0 && totalBytes >= maxBytes) {
+                break;
+            }
+            chunks.push_back(std::make_pair(mappings.size() - 1, pos));
+            totalBytes += std::min((uint64_t) WARMUP_CHUNK_SIZE, size - pos);
+        }
+    }
+
+    //Every thread touches one page at a time of the next chunk
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<uint64_t> bytesRead(0);
+    std::atomic<bool> timedOut(false);
+    const int pageSize = MemoryMappedFile::alignment();
+    auto worker = [&]() {
+        uint64_t checksum = 0;
+        size_t idx;
+        while ((idx = nextChunk++) < chunks.size()) {
+            if (timeout > 0 && std::chrono::steady_clock::now() > deadline) {
+                timedOut = true;
+                break;
+            }
+            MemoryMappedFile *m = mappings[chunks[idx].first].get();
+            const char *data = m->getData();
+            const uint64_t begin = chunks[idx].second;
+            const uint64_t end = std::min((uint64_t) m->getLength(),
+                    begin + WARMUP_CHUNK_SIZE);
+            //Only the chunk that is read now, so the hint does not ask for
+            //more than what is read
+            MemoryMappedFile::advise(data + begin, end - begin,
+                    ACCESS_WILLNEED);
+            for (uint64_t pos = begin; pos < end; pos += pageSize) {
+                checksum += data[pos];
+            }
+            bytesRead += end - begin;
+        }
+        //Prevent the compiler from removing the reads
+        volatile uint64_t sink = checksum;
+        (void) sink;
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < nthreads; ++i) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    std::chrono::duration<double> sec = std::chrono::steady_clock::now() - start;
+    if (timedOut) {
+        LOG(WARNL) << "Warmup stopped after " << timeout << " seconds";
+    }
+    LOG(INFOL) << "Warmup loaded " << bytesRead.load() / (1024 * 1024) << " MB of "
+        << nfiles << " files in " << sec.count() << " sec.";
+    return bytesRead;
+}
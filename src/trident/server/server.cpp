@@ -195,7 +195,19 @@ void TridentServer::execSPARQLQuery(string sparqlquery,
         if (jsonstats) {
             jsonstats->put("runtime", to_string(durationQ.count()));
             jsonstats->put("nresults", to_string(p->getPrintedRows()));
-
+            //The cache is shared by all the queries
+            DecodeCacheStats dstats = db.getKB()->getDecodeCacheStats();
+            JSON decodecache;
+            decodecache.put("hits", dstats.hits);
+            decodecache.put("misses", dstats.misses);
+            decodecache.put("hitrate", dstats.getHitRate());
+            decodecache.put("admissions", dstats.admissions);
+            decodecache.put("rejections", dstats.rejections);
+            decodecache.put("evictions", dstats.evictions);
+            decodecache.put("entries", dstats.entries);
+            decodecache.put("bytes", dstats.bytes);
+            decodecache.put("maxbytes", dstats.maxBytes);
+            jsonstats->add_child("decodecache", decodecache);
         }
         if (printstdout) {
             uint64_t nElements = p->getPrintedRows();
@@ -76,6 +76,9 @@ int64_t NestedMergeJoinItr::executePlan() {
                 continue;
             }
         }
+        if (idxCurrentPattern == 0 && prefetchItr != NULL) {
+            prefetchNextKeys();
+        }
 
 skipNext:
 
@@ -435,12 +438,69 @@ int NestedMergeJoinItr::try_merge_join(PairItr **iterators, int idxCurrentPatter
     }
 }
 
+void NestedMergeJoinItr::initPrefetch() {
+    prefetchItr = NULL;
+    if (currentItr == NULL || plan->nPatterns < 2 || nJoins[1] == 0) {
+        return;
+    }
+    //The iterator of the second pattern must be opened on a value of the
+    //first one, and the first pattern must have a fixed key
+    const JoinPoint &join = allJoins[1][0];
+    if (join.posIndex != 0 || join.sourcePattern != 0 ||
+            (join.sourcePosIndex != 1 && join.sourcePosIndex != 2) ||
+            plan->patterns[0].getNVars() == 3 ||
+            !q->canPrefetch(plan->patterns[1].idx())) {
+        return;
+    }
+    prefetchItr = getFirstIterator(plan->patterns[0]);
+    prefetchPos = join.sourcePosIndex;
+    prefetchTrigger1 = prefetchTrigger2 = INT64_MIN;
+    prefetchEnd1 = prefetchEnd2 = INT64_MAX;
+}
+
+void NestedMergeJoinItr::prefetchNextKeys() {
+    const int64_t v1 = currentItr->getValue1();
+    const int64_t v2 = currentItr->getValue2();
+    if (v1 < prefetchTrigger1 || (v1 == prefetchTrigger1 && v2 < prefetchTrigger2)) {
+        return;
+    }
+    //The outer iterator reached the last batch. Read the following one, so
+    //that the tables are loaded one batch ahead
+    if (v1 > prefetchEnd1 || (v1 == prefetchEnd1 && v2 > prefetchEnd2)) {
+        //A merge join moved the outer iterator beyond the batch
+        prefetchItr->moveto(v1, v2);
+    }
+    const size_t n = prefetchItr->nextBatch(prefetchV1, prefetchV2,
+            PREFETCH_JOIN_BATCH);
+    if (n == 0) {
+        q->releaseItr(prefetchItr);
+        prefetchItr = NULL;
+        return;
+    }
+    const uint64_t *values = prefetchPos == 1 ? prefetchV1 : prefetchV2;
+    prefetchKeys.clear();
+    for (size_t i = 0; i < n; ++i) {
+        if (prefetchKeys.empty() || prefetchKeys.back() != (int64_t) values[i]) {
+            prefetchKeys.push_back(values[i]);
+        }
+    }
+    q->prefetch(plan->patterns[1].idx(), prefetchKeys);
+    prefetchTrigger1 = prefetchV1[0];
+    prefetchTrigger2 = prefetchV2[0];
+    prefetchEnd1 = prefetchV1[n - 1];
+    prefetchEnd2 = prefetchV2[n - 1];
+}
+
 void NestedMergeJoinItr::cleanup() {
     // Release the iterators
     for (int i = 0; i < plan->nPatterns; ++i) {
         if (iterators[i] != NULL)
             q->releaseItr(iterators[i]);
     }
+    if (prefetchItr != NULL) {
+        q->releaseItr(prefetchItr);
+        prefetchItr = NULL;
+    }
 
     // Remove references to the iterators
     int lastPattern = plan->nPatterns - 1;
@@ -492,6 +552,8 @@ void NestedMergeJoinItr::init(PairItr *firstIterator, TupleTable *outputR, int64
 
     currentBuffer = NULL;
     remainingInBuffer = 0;
+
+    initPrefetch();
 }
 
 bool NestedMergeJoinItr::hasNext() {
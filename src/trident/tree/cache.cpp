@@ -24,6 +24,7 @@
 #include <trident/tree/intermediatenode.h>
 #include <trident/tree/leaf.h>
 #include <trident/tree/treecontext.h>
+#include <trident/utils/epochs.h>
 
 #include <iostream>
 #include <string>
@@ -32,8 +33,8 @@
 using namespace std;
 
 void Cache::init(TreeContext *context, std::string path, int fileMaxSize,
-        int maxNFiles, int64_t cacheMaxSize, int sizeLeavesFactory,
-        int sizePreallLeavesFactory, int nodeMinBytes) {
+        int maxNFiles, int64_t cacheMaxSize, MemoryPolicy cachePolicy,
+        int sizeLeavesFactory, int sizePreallLeavesFactory, int nodeMinBytes) {
     //      LOG(DEBUGL) << "file_max_size: " << fileMaxSize << " cache_max_size: " << cacheMaxSize << " size_leaf_factory: " << sizeLeavesFactory <<
     //      " preall: " << sizePreallLeavesFactory <<
     //      " nodes_min_bytes: " << nodeMinBytes;
@@ -42,7 +43,7 @@ void Cache::init(TreeContext *context, std::string path, int fileMaxSize,
     this->factory = new LeafFactory(context, sizePreallLeavesFactory,
             sizeLeavesFactory);
     this->manager = new NodeManager(context, nodeMinBytes, fileMaxSize,
-            maxNFiles, cacheMaxSize, path);
+            maxNFiles, cacheMaxSize, cachePolicy, path);
 }
 
 Node *Cache::getNodeFromCache(int64_t id) {
@@ -115,12 +116,32 @@ void Cache::registerNode(Node *node) {
         registeredNodes.pop_front();
 
         if (n->getParent() != NULL) {
-            flushNode(n, true);
+            if (context->isReadOnly()) {
+                retireNode(n);
+            } else {
+                flushNode(n, true);
+            }
         }
     }
     registeredNodes.push_back(node);
 }
 
+void Cache::retireNode(Node *node) {
+    //Other threads can still read the leaf without locks. Unlink it now
+    //but release it only when all of them are done
+    node->getParent()->cacheChild(node);
+    retiredNodes.push_back(std::make_pair(Epochs::retire(), node));
+    reclaimNodes(false);
+}
+
+void Cache::reclaimNodes(const bool all) {
+    const uint64_t oldest = all ? UINT64_MAX : Epochs::getOldestActive();
+    while (!retiredNodes.empty() && retiredNodes.front().first < oldest) {
+        factory->release((Leaf*) retiredNodes.front().second);
+        retiredNodes.pop_front();
+    }
+}
+
 void Cache::flushAllCache() {
     while (!registeredNodes.empty()) {
         Node *n = registeredNodes.front();
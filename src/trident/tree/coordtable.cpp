@@ -0,0 +1,165 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/tree/coordtable.h>
+#include <trident/tree/root.h>
+#include <trident/tree/treeitr.h>
+
+#include <kognac/utils.h>
+#include <kognac/logs.h>
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#define COORDTABLE_HEADER_SIZE 11
+
+CoordinatesTable::CoordinatesTable(std::string path) {
+    file = std::unique_ptr<MemoryMappedFile>(new MemoryMappedFile(path, true));
+    const char *raw = file->getData();
+    if (file->getLength() < COORDTABLE_HEADER_SIZE) {
+        LOG(ERRORL) << "The table of the coordinates " << path << " is corrupted";
+        throw 10;
+    }
+    nKeys = Utils::decode_long(raw, 0);
+    bytesPerCount = (uint8_t) raw[8];
+    bytesPerFile = (uint8_t) raw[9];
+    bytesPerMark = (uint8_t) raw[10];
+    sizeEntry = bytesPerCount + 1 + bytesPerFile + bytesPerMark;
+    sizeRecord = N_PARTITIONS * sizeEntry;
+    records = raw + COORDTABLE_HEADER_SIZE;
+    if (file->getLength() != COORDTABLE_HEADER_SIZE + nKeys * sizeRecord) {
+        LOG(ERRORL) << "The table of the coordinates " << path << " is corrupted";
+        throw 10;
+    }
+    //The lookups are random
+    file->advise(ACCESS_RANDOM);
+}
+
+bool CoordinatesTable::get(nTerm key, TermCoordinates *value) const {
+    value->clear();
+    if (key < 0 || (uint64_t) key >= nKeys) {
+        return false;
+    }
+    bool found = false;
+    const char *entry = records + key * sizeRecord;
+    for (int perm = 0; perm < N_PARTITIONS; ++perm) {
+        const int64_t count = Utils::decode_longFixedBytes(entry,
+                bytesPerCount);
+        if (count > 0) {
+            const char strat = entry[bytesPerCount];
+            const short fileIdx = (short) Utils::decode_longFixedBytes(
+                    entry + bytesPerCount + 1, bytesPerFile);
+            const int64_t mark = Utils::decode_longFixedBytes(
+                    entry + bytesPerCount + 1 + bytesPerFile, bytesPerMark);
+            value->set(perm, fileIdx, mark, count, strat);
+            found = true;
+        }
+        entry += sizeEntry;
+    }
+    return found;
+}
+
+bool CoordinatesTable::create(Root *tree, std::string path) {
+    //First pass: number of keys and sizes of the fields
+    int64_t largestKey = -1;
+    uint64_t nKeys = 0;
+    int64_t maxCount = 0, maxFile = 0, maxMark = 0;
+    TermCoordinates coord;
+    TreeItr *itr = tree->itr();
+    while (itr->hasNext()) {
+        const int64_t key = itr->next(&coord);
+        largestKey = key;
+        nKeys++;
+        for (int perm = 0; perm < N_PARTITIONS; ++perm) {
+            if (coord.exists(perm)) {
+                maxCount = std::max(maxCount, coord.getNElements(perm));
+                maxFile = std::max(maxFile, (int64_t) coord.getFileIdx(perm));
+                maxMark = std::max(maxMark, coord.getMark(perm));
+            }
+        }
+    }
+    delete itr;
+
+    if (nKeys == 0 || (uint64_t) largestKey + 1 > COORDTABLE_MAX_SPARSITY * nKeys) {
+        LOG(INFOL) << "The keys are too sparse (" << nKeys << " keys, largest "
+            << largestKey << "). The table of the coordinates is not created";
+        return false;
+    }
+
+    //At least one byte per field, also if the values are all 0
+    const uint8_t bytesPerCount = std::max((uint8_t) 1,
+            Utils::numBytesFixedLength(maxCount));
+    const uint8_t bytesPerFile = std::max((uint8_t) 1,
+            Utils::numBytesFixedLength(maxFile));
+    const uint8_t bytesPerMark = std::max((uint8_t) 1,
+            Utils::numBytesFixedLength(maxMark));
+    const int sizeEntry = bytesPerCount + 1 + bytesPerFile + bytesPerMark;
+    const int sizeRecord = N_PARTITIONS * sizeEntry;
+
+    std::ofstream out(path, std::ios_base::binary);
+    char header[COORDTABLE_HEADER_SIZE];
+    Utils::encode_long(header, 0, largestKey + 1);
+    header[8] = bytesPerCount;
+    header[9] = bytesPerFile;
+    header[10] = bytesPerMark;
+    out.write(header, COORDTABLE_HEADER_SIZE);
+
+    //Second pass: the records. The missing keys are left empty
+    std::vector<char> record(sizeRecord);
+    const std::vector<char> empty(sizeRecord, 0);
+    int64_t nextKey = 0;
+    itr = tree->itr();
+    while (itr->hasNext()) {
+        const int64_t key = itr->next(&coord);
+        for (; nextKey < key; ++nextKey) {
+            out.write(empty.data(), sizeRecord);
+        }
+        char *entry = record.data();
+        for (int perm = 0; perm < N_PARTITIONS; ++perm) {
+            if (coord.exists(perm)) {
+                Utils::encode_longNBytes(entry, bytesPerCount,
+                        coord.getNElements(perm));
+                entry[bytesPerCount] = coord.getStrategy(perm);
+                Utils::encode_longNBytes(entry + bytesPerCount + 1,
+                        bytesPerFile, coord.getFileIdx(perm));
+                Utils::encode_longNBytes(entry + bytesPerCount + 1 +
+                        bytesPerFile, bytesPerMark, coord.getMark(perm));
+            } else {
+                memset(entry, 0, sizeEntry);
+            }
+            entry += sizeEntry;
+        }
+        out.write(record.data(), sizeRecord);
+        nextKey = key + 1;
+    }
+    delete itr;
+
+    out.close();
+    if (out.fail()) {
+        LOG(ERRORL) << "Failed in writing the table of the coordinates";
+        throw 10;
+    }
+    LOG(DEBUGL) << "Table of the coordinates: " << nKeys << " keys, " <<
+        sizeRecord << " bytes per key";
+    return true;
+}
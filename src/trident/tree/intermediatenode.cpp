@@ -32,10 +32,18 @@
 
 #define CHILD_NOT_FOUND -1
 
+//Like memmove, with dest > src. The pointers are atomic
+static void moveChildren(std::atomic<Node*> *dest, std::atomic<Node*> *src,
+        int n) {
+    for (int i = n - 1; i >= 0; --i) {
+        dest[i] = src[i].load();
+    }
+}
+
 IntermediateNode::IntermediateNode(TreeContext *context, Node *child1,
         Node *child2) :
     Node(context) {
-        children = new Node*[context->getMaxElementsPerNode() + 1];
+        children = new std::atomic<Node*>[context->getMaxElementsPerNode() + 1];
         idChildren = new int64_t[context->getMaxElementsPerNode() + 1];
 
         if (context->textKeys()) {
@@ -59,7 +67,7 @@ int IntermediateNode::unserialize(char *bytes, int pos) {
     pos = Node::unserialize(bytes, pos);
 
     if (children == NULL) {
-        children = new Node*[getCurrentSize() + 1];
+        children = new std::atomic<Node*>[getCurrentSize() + 1];
         idChildren = new int64_t[getCurrentSize() + 1];
     }
 
@@ -78,7 +86,7 @@ int IntermediateNode::serialize(char *bytes, int pos) {
     for (int i = 0; i < getCurrentSize() + 1; ++i) {
         int64_t id;
         if (children[i] != NULL) {
-            id = children[i]->getId();
+            id = children[i].load()->getId();
         } else {
             id = idChildren[i];
         }
@@ -93,13 +101,11 @@ Node *IntermediateNode::getChildForKey(int64_t key) {
     if (p < 0) {
         p = -p - 1;
     }
-    ensureChildIsLoaded(p);
-    return children[p];
+    return ensureChildIsLoaded(p);
 }
 
 Node *IntermediateNode::getChildAtPos(int p) {
-    ensureChildIsLoaded(p);
-    return children[p];
+    return ensureChildIsLoaded(p);
 }
 
 int IntermediateNode::getPosChild(Node *child) {
@@ -127,23 +133,19 @@ int IntermediateNode::getPosChild(Node *child) {
 }
 
 int64_t IntermediateNode::smallestNumericKey() {
-    ensureChildIsLoaded(0);
-    return children[0]->smallestNumericKey();
+    return ensureChildIsLoaded(0)->smallestNumericKey();
 }
 
 int64_t IntermediateNode::largestNumericKey() {
-    ensureChildIsLoaded(getCurrentSize());
-    return children[getCurrentSize()]->largestNumericKey();
+    return ensureChildIsLoaded(getCurrentSize())->largestNumericKey();
 }
 
 tTerm *IntermediateNode::smallestTextualKey(int *size) {
-    ensureChildIsLoaded(0);
-    return children[0]->smallestTextualKey(size);
+    return ensureChildIsLoaded(0)->smallestTextualKey(size);
 }
 
 tTerm *IntermediateNode::largestTextualKey(int *size) {
-    ensureChildIsLoaded(getCurrentSize());
-    return children[getCurrentSize()]->largestTextualKey(size);
+    return ensureChildIsLoaded(getCurrentSize())->largestTextualKey(size);
 }
 
 void IntermediateNode::cacheChild(Node *child) {
@@ -162,8 +164,7 @@ bool IntermediateNode::get(tTerm *key, const int sizeKey, nTerm *value) {
     if (p < 0) {
         p = -p - 1;
     }
-    ensureChildIsLoaded(p);
-    return children[p]->get(key, sizeKey, value);
+    return ensureChildIsLoaded(p)->get(key, sizeKey, value);
 }
 
 //bool IntermediateNode::get(nTerm key, tTerm *container) {
@@ -179,8 +180,7 @@ bool IntermediateNode::get(nTerm key, int64_t &coordinates) {
     if (p < 0) {
         p = -p - 1;
     }
-    ensureChildIsLoaded(p);
-    return children[p]->get(key, coordinates);
+    return ensureChildIsLoaded(p)->get(key, coordinates);
 }
 
 bool IntermediateNode::get(nTerm key, TermCoordinates *value) {
@@ -188,8 +188,7 @@ bool IntermediateNode::get(nTerm key, TermCoordinates *value) {
     if (p < 0) {
         p = -p - 1;
     }
-    ensureChildIsLoaded(p);
-    return children[p]->get(key, value);
+    return ensureChildIsLoaded(p)->get(key, value);
 }
 
 void numAvg(Node *parent, int p, Node *child1, Node *child2) {
@@ -213,7 +212,7 @@ Node *IntermediateNode::updateChildren(Node *split, int p,
         n1->setState(STATE_MODIFIED);
 
         if (n1->children == NULL) {
-            n1->children = new Node*[getContext()->getMaxElementsPerNode() + 1];
+            n1->children = new std::atomic<Node*>[getContext()->getMaxElementsPerNode() + 1];
             n1->idChildren =
                 new int64_t[getContext()->getMaxElementsPerNode() + 1];
         }
@@ -221,9 +220,9 @@ Node *IntermediateNode::updateChildren(Node *split, int p,
         int minSize = getContext()->getMinElementsPerNode();
         if (p < minSize) {
             for (int i = 0; i < minSize + 1; ++i) {
-                n1->children[i] = children[minSize + i];
+                n1->children[i] = children[minSize + i].load();
                 if (n1->children[i] != NULL) {
-                    n1->children[i]->setParent(n1);
+                    n1->children[i].load()->setParent(n1);
                 } else {
                     n1->idChildren[i] = idChildren[minSize + i];
                 }
@@ -233,8 +232,8 @@ Node *IntermediateNode::updateChildren(Node *split, int p,
             removeLastKey();
             insertAverage(this, p, children[p], split);
 
-            memmove(children + p + 2, children + p + 1,
-                    (getCurrentSize() - p - 1) * sizeof(Node *));
+            moveChildren(children + p + 2, children + p + 1,
+                    getCurrentSize() - p - 1);
             memmove(idChildren + p + 2, idChildren + p + 1,
                     (getCurrentSize() - p - 1) * sizeof(int64_t));
             children[p + 1] = split;
@@ -242,9 +241,9 @@ Node *IntermediateNode::updateChildren(Node *split, int p,
 
         } else {
             for (int i = 0; i < minSize; ++i) {
-                n1->children[i] = children[minSize + 1 + i];
+                n1->children[i] = children[minSize + 1 + i].load();
                 if (n1->children[i] != NULL) {
-                    n1->children[i]->setParent(n1);
+                    n1->children[i].load()->setParent(n1);
                 } else {
                     n1->idChildren[i] = idChildren[minSize + 1 + i];
                 }
@@ -255,16 +254,15 @@ Node *IntermediateNode::updateChildren(Node *split, int p,
             if (p > minSize) {
                 n1->removeFirstKey();
                 p -= minSize + 1;
-                memmove(n1->children + p + 2, n1->children + p + 1,
-                        sizeof(Node *) * (minSize - p - 1));
+                moveChildren(n1->children + p + 2, n1->children + p + 1,
+                        minSize - p - 1);
                 memmove(n1->idChildren + p + 2, n1->idChildren + p + 1,
                         sizeof(int64_t) * (minSize - p - 1));
 
                 insertAverage(n1, p, n1->children[p], split);
                 n1->children[p + 1] = split;
             } else { // CASE: pos == getMinSize()
-                memmove(n1->children + 1, n1->children,
-                        minSize * sizeof(Node*));
+                moveChildren(n1->children + 1, n1->children, minSize);
                 memmove(n1->idChildren + 1, n1->idChildren,
                         minSize * sizeof(int64_t));
                 n1->children[0] = split;
@@ -276,8 +274,8 @@ Node *IntermediateNode::updateChildren(Node *split, int p,
         return n1;
     } else {
         insertAverage(this, p, children[p], split);
-        memmove(children + p + 2, children + p + 1,
-                (getCurrentSize() - p - 1) * sizeof(Node*));
+        moveChildren(children + p + 2, children + p + 1,
+                getCurrentSize() - p - 1);
         memmove(idChildren + p + 2, idChildren + p + 1,
                 (getCurrentSize() - p - 1) * sizeof(int64_t));
         children[p + 1] = split;
@@ -294,8 +292,7 @@ Node *IntermediateNode::put(nTerm key, int64_t coordinatesTTerm) {
         p = -p - 1;
     }
 
-    ensureChildIsLoaded(p);
-    Node *split = children[p]->put(key, coordinatesTTerm);
+    Node *split = ensureChildIsLoaded(p)->put(key, coordinatesTTerm);
     if (split != NULL) {
         return updateChildren(split, p, &numAvg);
     } else {
@@ -310,9 +307,7 @@ Node *IntermediateNode::put(nTerm key, TermCoordinates *value) {
         p = -p - 1;
     }
 
-    ensureChildIsLoaded(p);
-
-    Node *split = children[p]->put(key, value);
+    Node *split = ensureChildIsLoaded(p)->put(key, value);
     if (split != NULL) {
         return updateChildren(split, p, &numAvg);
     } else {
@@ -327,9 +322,7 @@ Node *IntermediateNode::put(tTerm *key, int sizeKey, nTerm value) {
         p = -p - 1;
     }
 
-    ensureChildIsLoaded(p);
-
-    Node *split = children[p]->put(key, sizeKey, value);
+    Node *split = ensureChildIsLoaded(p)->put(key, sizeKey, value);
     if (split != NULL) {
         return updateChildren(split, p, &textAvg);
     } else {
@@ -339,9 +332,7 @@ Node *IntermediateNode::put(tTerm *key, int sizeKey, nTerm value) {
 
 Node *IntermediateNode::append(tTerm *key, int sizeKey, nTerm value) {
     int p = getCurrentSize();
-    ensureChildIsLoaded(p);
-
-    Node *split = children[p]->append(key, sizeKey, value);
+    Node *split = ensureChildIsLoaded(p)->append(key, sizeKey, value);
     if (split != NULL) {
         return updateChildren(split, p, &textAvg);
     } else {
@@ -351,9 +342,7 @@ Node *IntermediateNode::append(tTerm *key, int sizeKey, nTerm value) {
 
 Node *IntermediateNode::append(nTerm key, TermCoordinates *value) {
     int p = getCurrentSize();
-    ensureChildIsLoaded(p);
-
-    Node *split = children[p]->append(key, value);
+    Node *split = ensureChildIsLoaded(p)->append(key, value);
     if (split != NULL) {
         return updateChildren(split, p, &numAvg);
     } else {
@@ -363,9 +352,7 @@ Node *IntermediateNode::append(nTerm key, TermCoordinates *value) {
 
 Node *IntermediateNode::append(nTerm key, int64_t coordinatesTerm) {
     int p = getCurrentSize();
-    ensureChildIsLoaded(p);
-
-    Node *split = children[p]->append(key, coordinatesTerm);
+    Node *split = ensureChildIsLoaded(p)->append(key, coordinatesTerm);
     if (split != NULL) {
         return updateChildren(split, p, &numAvg);
     } else {
@@ -381,9 +368,7 @@ Node *IntermediateNode::putOrGet(tTerm *key, int sizeKey, nTerm &value,
         p = -p - 1;
     }
 
-    ensureChildIsLoaded(p);
-
-    Node *split = children[p]->putOrGet(key, sizeKey, value, insertResult);
+    Node *split = ensureChildIsLoaded(p)->putOrGet(key, sizeKey, value, insertResult);
     if (insertResult && split != NULL) {
         return updateChildren(split, p, &textAvg);
     } else {
@@ -391,21 +376,28 @@ Node *IntermediateNode::putOrGet(tTerm *key, int sizeKey, nTerm &value,
     }
 }
 
-void IntermediateNode::ensureChildIsLoaded(int p) {
-    if (children[p] == NULL) {
+Node *IntermediateNode::ensureChildIsLoaded(int p) {
+    //The child is returned rather than read again from the array because in
+    //read-only mode it can be evicted by another thread in the meantime
+    Node *child = children[p];
+    if (child == NULL) {
 #ifdef MT
         std::recursive_mutex &mutex = getContext()->getMutex();
         std::unique_lock<std::recursive_mutex> lock(mutex);
-        if (children[p] == NULL) {
+        child = children[p];
+        if (child == NULL) {
 #endif
-            children[p] = getContext()->getCache()->getNodeFromCache(idChildren[p]);
-            children[p]->setParent(this);
-            getContext()->getCache()->registerNode(children[p]);
+            child = getContext()->getCache()->getNodeFromCache(idChildren[p]);
+            child->setParent(this);
+            //Publish the node only after it is completely unserialized
+            children[p] = child;
+            getContext()->getCache()->registerNode(child);
 #ifdef MT
         }
         lock.unlock();
 #endif
     }
+    return child;
 }
 
 Node *IntermediateNode::getChild(const int p) {
@@ -417,8 +409,7 @@ Node *IntermediateNode::getChildForKey(tTerm *key, const int sizeKey) {
     if (p < 0) {
         p = -p - 1;
     }
-    ensureChildIsLoaded(p);
-    return children[p];
+    return ensureChildIsLoaded(p);
 }
 
 IntermediateNode::~IntermediateNode() {
@@ -428,8 +419,8 @@ IntermediateNode::~IntermediateNode() {
     if (children != NULL) {
         if (getContext()->isReadOnly()) {
             for (int i = 0; i < getCurrentSize() + 1; ++i) {
-                if (children[i] != NULL && children[i]->canHaveChildren()) {
-                    delete children[i];
+                if (children[i] != NULL && children[i].load()->canHaveChildren()) {
+                    delete children[i].load();
                 }
             }
         }
@@ -151,17 +151,19 @@ int Leaf::unserialize_numberlist(char *bytes, int pos) {
 }
 
 int Leaf::unserialize_values(char *bytes, int pos, int previousSize) {
-    if (detailPermutations1 == NULL) {
-        detailPermutations1 = getContext()->getIlBufferFactory()->get();
-    }
-
-    if (getCurrentSize()
-            > getContext()->getMinElementsPerNode() && detailPermutations2 == NULL) {
-        detailPermutations2 = getContext()->getIlBufferFactory()->get();
-    }
     rawNode = bytes + pos;
 
+    //In read-only mode the values are decoded from rawNode when requested
     if (!getContext()->isReadOnly()) {
+        if (detailPermutations1 == NULL) {
+            detailPermutations1 = getContext()->getIlBufferFactory()->get();
+        }
+
+        if (getCurrentSize() > getContext()->getMinElementsPerNode() &&
+                detailPermutations2 == NULL) {
+            detailPermutations2 = getContext()->getIlBufferFactory()->get();
+        }
+
         //Unpack completely the node
         for (int i = 0; i < getCurrentSize(); ++i) {
             if (i < getContext()->getMinElementsPerNode()) {
@@ -647,6 +649,29 @@ const char NCOMBS[64] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2
 //const char ICOMBS[64] = {0, 0, 1, 0, 2, 3, 1, 0, 0, 5, 0, 0, 0, 0, 0, 0, 0, 0, 7, 0, 0, 0, 0, 0, 0, 0, 0, 11, 0, 0, 0, 0, 0, 0, 0, 0, 9, 0, 0, 0, 0, 0, 0, 0, 0, 19, 0, 0, 0, 0, 0, 0, 0, 0, 15, 0, 0, 0, 0, 0, 0, 0, 0, 23};
 //const uint8_t COMBS[29] = {0, 1, 2, 0, 2, 0, 3, 1, 4, 2, 5, 0, 1, 3, 4, 1, 2, 4, 5, 0, 2, 3, 5, 0, 1, 2, 3, 4, 5};
 
+void Leaf::parseInternalLine(const int pos, TermCoordinates *value) {
+    unsigned char permutations = rawNode[pos];
+    int startPos = (unsigned short) Utils::decode_short((const char*)rawNode,
+                   getCurrentSize() + pos * 2);
+    startPos += getCurrentSize() * 3;
+
+    value->clear();
+    int idx = 0;
+    for (int i = 0; i < NCOMBS[(int)rawNode[pos]]; ++i) {
+        const int64_t nElements = Utils::decode_vlong2(rawNode, &startPos);
+        const short file = (uint16_t) Utils::decode_vint2(rawNode, &startPos);
+        const int64_t posInFile = Utils::decode_vlong2(rawNode, &startPos);
+        const char strategy = rawNode[startPos++];
+        while (!(permutations & 1)) {
+            permutations >>= 1;
+            idx++;
+        }
+        value->set(idx, file, posInFile, nElements, strategy);
+        permutations >>= 1;
+        idx++;
+    }
+}
+
 Coordinates *Leaf::parseInternalLine(const int pos) {
 #ifdef MT
         std::recursive_mutex &mutex = getContext()->getMutex();
@@ -725,6 +750,13 @@ tTerm *Leaf::largestTextualKey(int *size) {
 }
 
 void Leaf::getValueAtPos(int pos, TermCoordinates * value) {
+    if (getContext()->isReadOnly()) {
+        //Decode directly from the serialized node, so that the leaf is not
+        //modified and can be read by many threads without locks
+        parseInternalLine(pos, value);
+        return;
+    }
+
     Coordinates *el = NULL;
 
     if (pos >= getContext()->getMinElementsPerNode()) {
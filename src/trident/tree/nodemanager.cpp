@@ -30,7 +30,8 @@ char one[1] = { 1 };
 char zero[1] = { 0 };
 
 NodeManager::NodeManager(TreeContext *context, int nodeMinBytes,
-        int fileMaxSize, int maxNFiles, int64_t cacheMaxSize, std::string path) :
+        int fileMaxSize, int maxNFiles, int64_t cacheMaxSize,
+        MemoryPolicy cachePolicy, std::string path) :
     readOnly(context->isReadOnly()), path(path), nodeMinSize(nodeMinBytes) {
         lastNodeInserted = NULL;
 
@@ -47,10 +48,14 @@ NodeManager::NodeManager(TreeContext *context, int nodeMinBytes,
                 }
             }
         }
-        bytesTracker = new MemoryManager<FileDescriptor>(cacheMaxSize);
+        bytesTracker = new MemoryManager<FileDescriptor>(cacheMaxSize,
+                cachePolicy);
+        //The leaves of read-only trees are parsed without locks straight
+        //from the mapped files. Without a tracker the files are pinned once
+        //opened, so they are never unmapped under a reader
         this->manager = new FileManager<FileDescriptor, FileDescriptor>(path,
                 context->isReadOnly(), fileMaxSize, maxNFiles, lastCreatedFile,
-                bytesTracker, NULL);
+                readOnly ? NULL : bytesTracker, NULL);
 
         //Init storedNodes and firstElementPerFile
         string file = path + DIR_SEP + string("idx");
@@ -26,8 +26,10 @@
 #include <trident/tree/cache.h>
 #include <trident/tree/treecontext.h>
 #include <trident/tree/stringbuffer.h>
+#include <trident/tree/coordtable.h>
 #include <trident/tree/leaf.h>
 #include <trident/utils/propertymap.h>
+#include <trident/utils/epochs.h>
 
 #include <kognac/utils.h>
 
@@ -39,6 +41,7 @@ using namespace std;
 
 Root::Root(string path, StringBuffer *buffer, bool readOnly, PropertyMap &conf) :
     readOnly(readOnly), path(path) {
+        coordTable = NULL;
         cache = new Cache(conf.getInt(MAX_NODES_IN_CACHE, 4),
                 conf.getBool(COMPRESSED_NODES, false));
 
@@ -71,6 +74,7 @@ Root::Root(string path, StringBuffer *buffer, bool readOnly, PropertyMap &conf)
                 textKeys, textValues, ilFactory, ilBufferFactory, nodesKeysFactory);
         cache->init(context, path, conf.getInt(FILE_MAX_SIZE, 64 * 1024 * 1024),
                 conf.getInt(MAX_N_OPENED_FILES, 2), conf.getLong(CACHE_MAX_SIZE, 32 * 1024 * 1024),
+                (MemoryPolicy) conf.getInt(CACHE_POLICY, MEMPOLICY_2Q),
                 conf.getInt(LEAF_SIZE_FACTORY, 1),
                 conf.getInt(LEAF_SIZE_PREALL_FACTORY, 10), conf.getInt(NODE_MIN_BYTES, 0));
 
@@ -103,7 +107,21 @@ Root::Root(string path, StringBuffer *buffer, bool readOnly, PropertyMap &conf)
         }
     }
 
+void Root::setCoordinatesTable(CoordinatesTable *table) {
+    if (coordTable != NULL) {
+        delete coordTable;
+    }
+    coordTable = table;
+}
+
 bool Root::get(nTerm key, TermCoordinates *value) {
+    if (coordTable != NULL) {
+        return coordTable->get(key, value);
+    }
+#ifdef MT
+    //The leaves evicted by other threads are not released while we read
+    EpochGuard guard;
+#endif
     Node *node = rootNode;
     while (node->canHaveChildren()) {
         node = node->getChildForKey(key);
@@ -112,7 +130,38 @@ bool Root::get(nTerm key, TermCoordinates *value) {
     return resp;
 }
 
+void Root::getMany(const nTerm *keys, const size_t n,
+        TermCoordinates *values, bool *found) {
+    if (coordTable != NULL || rootNode == NULL) {
+        //E.g. FlatRoot
+        for (size_t i = 0; i < n; ++i) {
+            found[i] = get(keys[i], values + i);
+        }
+        return;
+    }
+#ifdef MT
+    //The leaf is kept across the keys, so it must not be released
+    EpochGuard guard;
+#endif
+    Node *leaf = NULL;
+    for (size_t i = 0; i < n; ++i) {
+        const nTerm key = keys[i];
+        if (leaf == NULL || leaf->getCurrentSize() == 0 ||
+                key < leaf->smallestNumericKey() ||
+                key > leaf->largestNumericKey()) {
+            leaf = rootNode;
+            while (leaf->canHaveChildren()) {
+                leaf = leaf->getChildForKey(key);
+            }
+        }
+        found[i] = leaf->get(key, values + i);
+    }
+}
+
 bool Root::get(nTerm key, int64_t &coordinates) {
+#ifdef MT
+    EpochGuard guard;
+#endif
     Node *node = rootNode;
     while (node->canHaveChildren()) {
         node = node->getChildForKey(key);
@@ -120,7 +169,18 @@ bool Root::get(nTerm key, int64_t &coordinates) {
     return node->get(key, coordinates);
 }
 
+MemoryManagerStats Root::getCacheStats() {
+    if (cache == NULL) {
+        //E.g. FlatRoot
+        return MemoryManagerStats();
+    }
+    return cache->getStats();
+}
+
 bool Root::get(tTerm *key, const int sizeKey, nTerm *value) {
+#ifdef MT
+    EpochGuard guard;
+#endif
     Node *node = rootNode;
     while (node->canHaveChildren()) {
         node = node->getChildForKey(key, sizeKey);
@@ -318,4 +378,6 @@ Root::~Root() {
         delete nodesKeysFactory;
     if (context)
         delete context;
+    if (coordTable)
+        delete coordTable;
 }
@@ -30,6 +30,7 @@
 #include <string>
 #include <cstring>
 #include <algorithm>
+#include <chrono>
 
 using namespace std;
 
@@ -57,14 +58,14 @@ StringBuffer::StringBuffer(string dir, bool readOnly, int factorySize,
     entriesSinceBaseEntry = 0;
     nMatchedChars = 0;
 
-    ios_base::openmode mode =
-        readOnly ?
-        std::fstream::in | std::fstream::binary :
-        std::fstream::in | std::fstream::out | std::fstream::app | std::fstream::binary;
+    compressedData = NULL;
     if (!Utils::exists(dir)) {
         Utils::create_directories(dir);
     }
-    sb.open((dir + string("/sb")).c_str(), mode);
+    if (!readOnly) {
+        sb.open((dir + string("/sb")).c_str(), std::fstream::in |
+                std::fstream::out | std::fstream::app | std::fstream::binary);
+    }
 
     if (readOnly) {
         //Load the size of the compressed blocks and initialize the other vector
@@ -76,9 +77,23 @@ StringBuffer::StringBuffer(string dir, bool readOnly, int factorySize,
                 sizeCompressedBlocks.push_back(pos);
             }
         }
-        blocks.resize(sizeCompressedBlocks.size());
-        cacheVector.resize(sizeCompressedBlocks.size());
         file.close();
+
+        if (!sizeCompressedBlocks.empty()) {
+            compressedFile = std::unique_ptr<MemoryMappedFile>(
+                    new MemoryMappedFile(dir + string("/sb"), true));
+            compressedData = compressedFile->getData();
+            if (compressedFile->getLength() < sizeCompressedBlocks.back()) {
+                LOG(ERRORL) << "The file " << dir << "/sb is truncated";
+                throw 10;
+            }
+        }
+        const uint64_t bytesPerShard = std::max((int64_t) SB_BLOCK_SIZE,
+                (int64_t) maxElementsInCache * SB_BLOCK_SIZE / SB_CACHE_SHARDS);
+        for (int i = 0; i < SB_CACHE_SHARDS; ++i) {
+            cacheShards.push_back(std::unique_ptr<BlockCache>(
+                        new BlockCache(bytesPerShard)));
+        }
     } else {
         currentBuffer = factory.get();
         blocks.push_back(currentBuffer);
@@ -350,33 +365,20 @@ void StringBuffer::uncompressBlock(int b) {
     int64_t start = 0;
     int length = 0;
 
-    if (!readOnly) {
-        sizeLock.lock();
-        if (b > 0) {
-            start = sizeCompressedBlocks[b - 1];
-        }
-        length = sizeCompressedBlocks[b] - start;
-        sizeLock.unlock();
-
-        fileLock.lock();
-        sb.seekg(start);
-        sb.read(uncompressSupportBuffer, length);
-        if (!sb) {
-            LOG(ERRORL) << "error: only " << sb.gcount() << " could be read";
-        }
-        fileLock.unlock();
-    } else {
-        if (b > 0) {
-            start = sizeCompressedBlocks[b - 1];
-        }
-        length = sizeCompressedBlocks[b] - start;
-
-        sb.seekg(start);
-        sb.read(uncompressSupportBuffer, length);
-        if (!sb) {
-            LOG(ERRORL) << "error: only " << sb.gcount() << " could be read";
-        }
+    sizeLock.lock();
+    if (b > 0) {
+        start = sizeCompressedBlocks[b - 1];
+    }
+    length = sizeCompressedBlocks[b] - start;
+    sizeLock.unlock();
+
+    fileLock.lock();
+    sb.seekg(start);
+    sb.read(uncompressSupportBuffer, length);
+    if (!sb) {
+        LOG(ERRORL) << "error: only " << sb.gcount() << " could be read";
     }
+    fileLock.unlock();
 
     char *uncompressedBuffer = factory.get();
     int sizeUncompressed = SB_BLOCK_SIZE;
@@ -400,23 +402,64 @@ void StringBuffer::uncompressBlock(int b) {
     blocks[b] = uncompressedBuffer;
 }
 
-int StringBuffer::getVInt(int &blockId, char *&block, int &offset) {
+BlockCache::Block StringBuffer::getCachedBlock(int idxBlock) {
+    BlockCache *cache = cacheShards[idxBlock % SB_CACHE_SHARDS].get();
+    BlockCache::Block block = cache->get(0, 0, idxBlock);
+    if (block) {
+        return block;
+    }
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    const int64_t startCompressed = idxBlock > 0 ?
+        sizeCompressedBlocks[idxBlock - 1] : 0;
+    const int length = sizeCompressedBlocks[idxBlock] - startCompressed;
+    int sizeUncompressed = SB_BLOCK_SIZE;
+    if (idxBlock == sizeCompressedBlocks.size() - 1 &&
+            uncompressedSize % SB_BLOCK_SIZE != 0) {
+        sizeUncompressed = uncompressedSize % SB_BLOCK_SIZE;
+    }
+    block = BlockCache::Block(new std::vector<char>(SB_BLOCK_SIZE));
+    const int bytesUncompressed = LZ4_decompress_safe(
+            compressedData + startCompressed, block->data(), length,
+            sizeUncompressed);
+    if (bytesUncompressed < 0) {
+        LOG(ERRORL) << "Decompression of block "
+                                 << idxBlock
+                                 << " has failed. Read at pos "
+                                 << startCompressed
+                                 << " with length "
+                                 << length;
+        throw 10;
+    }
+    const uint64_t usec = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    statsLock.lock();
+    stats->incrNReadIndexBlocks();
+    stats->addNReadIndexBytes(length);
+    statsLock.unlock();
+    return cache->put(0, 0, idxBlock, block, usec);
+}
+
+int StringBuffer::getVInt(Cursor &c) {
     //Retrieve the size of the string.
     //I use five instead of 4 because there is also a flag after it.
-    if (SB_BLOCK_SIZE - offset < 4) {
+    if (SB_BLOCK_SIZE - c.offset < 4) {
         char supportBuffer[4];
         int offsetSupportBuffer = 0;
-        for (int i = offset; i < SB_BLOCK_SIZE; ++i) {
-            supportBuffer[offsetSupportBuffer++] = block[i];
+        for (int i = c.offset; i < SB_BLOCK_SIZE; ++i) {
+            supportBuffer[offsetSupportBuffer++] = c.block[i];
         }
 
-        char *nextBlock = NULL;
-        if (blockId < blocks.size() - 1) {
-            nextBlock = getBlock(blockId + 1);
+        Cursor next;
+        next.block = NULL;
+        if (c.blockId < getNBlocks() - 1) {
+            moveToBlock(next, c.blockId + 1);
             int startNextBlock = 0;
             while (offsetSupportBuffer < 4) {
                 supportBuffer[offsetSupportBuffer++] =
-                    nextBlock[startNextBlock++];
+                    next.block[startNextBlock++];
             }
         }
 
@@ -424,65 +467,67 @@ int StringBuffer::getVInt(int &blockId, char *&block, int &offset) {
         int size = Utils::decode_vint2(supportBuffer, &supportOffset);
 
         //Update current position
-        offset += supportOffset;
-        if (offset >= SB_BLOCK_SIZE) {
-            offset -= SB_BLOCK_SIZE;
-            blockId++;
-            block = nextBlock;
+        c.offset += supportOffset;
+        if (c.offset >= SB_BLOCK_SIZE) {
+            c.offset -= SB_BLOCK_SIZE;
+            c.blockId++;
+            c.block = next.block;
+            c.pin = next.pin;
         }
         return size;
     } else {
-        return Utils::decode_vint2(block, &offset);
+        return Utils::decode_vint2((char*) c.block, &c.offset);
     }
 }
 
 void StringBuffer::get(int64_t pos, char* outputBuffer, int &size) {
-    int idxBlock = pos / SB_BLOCK_SIZE;
-    int initialIdx = idxBlock;
-
-    char *block = getBlock(idxBlock);
-    int start = pos - idxBlock * SB_BLOCK_SIZE;
+    Cursor c;
+    moveToBlock(c, pos / SB_BLOCK_SIZE);
+    const int initialIdx = c.blockId;
+    c.offset = pos - initialIdx * SB_BLOCK_SIZE;
 
     //Get the size
-    size = getVInt(idxBlock, block, start);
+    size = getVInt(c);
     int sizeToCopy = size;
     //Ignore the flag
-    int flag = getFlag(idxBlock, block, start);
+    int flag = getFlag(c);
     if (flag == 1) {
-        int posPrefix = getVInt(idxBlock, block, start);
-        int sizePrefix = getVInt(idxBlock, block, start);
-
-        if (initialIdx != idxBlock) {
-            char *baseTermBlock = getBlock(initialIdx);
-            memcpy(outputBuffer, baseTermBlock + posPrefix, sizePrefix);
-            block = getBlock(idxBlock); // It could be that the block got offloaded
+        int posPrefix = getVInt(c);
+        int sizePrefix = getVInt(c);
+
+        if (initialIdx != c.blockId) {
+            Cursor base;
+            moveToBlock(base, initialIdx);
+            memcpy(outputBuffer, base.block + posPrefix, sizePrefix);
+            if (!readOnly) {
+                moveToBlock(c, c.blockId); // It could be that the block got offloaded
+            }
         } else {
-            memcpy(outputBuffer, block + posPrefix, sizePrefix);
+            memcpy(outputBuffer, c.block + posPrefix, sizePrefix);
         }
         //Copy the remaining size - sizePrefix bytes
         sizeToCopy -= sizePrefix;
         outputBuffer += sizePrefix;
     }
 
-    if (start == SB_BLOCK_SIZE) {
-        start = 0;
-        idxBlock++;
-        block = getBlock(idxBlock);
+    if (c.offset == SB_BLOCK_SIZE) {
+        c.offset = 0;
+        moveToBlock(c, c.blockId + 1);
     }
 
     //Check whether the string is inside the block or not
-    if (start + sizeToCopy > SB_BLOCK_SIZE) {
-        int remSize = SB_BLOCK_SIZE - start;
-        memcpy(outputBuffer, block + start, remSize);
-        idxBlock++;
-        block = getBlock(idxBlock);
-        memcpy(outputBuffer + remSize, block, sizeToCopy - remSize);
+    if (c.offset + sizeToCopy > SB_BLOCK_SIZE) {
+        int remSize = SB_BLOCK_SIZE - c.offset;
+        memcpy(outputBuffer, c.block + c.offset, remSize);
+        moveToBlock(c, c.blockId + 1);
+        memcpy(outputBuffer + remSize, c.block, sizeToCopy - remSize);
     } else {
-        memcpy(outputBuffer, block + start, sizeToCopy);
+        memcpy(outputBuffer, c.block + c.offset, sizeToCopy);
     }
 }
 
 char* StringBuffer::get(int64_t pos, int &size) {
+    static thread_local char termSupportBuffer[MAX_TERM_SIZE];
     get(pos, termSupportBuffer, size);
     termSupportBuffer[size] = '\0';
     return termSupportBuffer;
@@ -521,29 +566,33 @@ char *StringBuffer::getBlock(int idxBlock) {
 }
 
 int StringBuffer::cmp(int64_t pos, char *string, int sizeString) {
-    int startBlock = pos / SB_BLOCK_SIZE;
-    const int initialBlock = startBlock;
-    char *block = getBlock(startBlock);
-
-    int blockStartPos = pos % SB_BLOCK_SIZE;
+    Cursor c;
+    moveToBlock(c, pos / SB_BLOCK_SIZE);
+    const int initialBlock = c.blockId;
+    c.offset = pos % SB_BLOCK_SIZE;
     int stringStart = 0;
 
     //Get the size of the term
-    int size = getVInt(startBlock, block, blockStartPos);
-    int flag = getFlag(startBlock, block, blockStartPos);
+    int size = getVInt(c);
+    int flag = getFlag(c);
     if (flag == 1) {
-        int posBaseTerm = getVInt(startBlock, block, blockStartPos);
-        int sizeBaseTerm = getVInt(startBlock, block, blockStartPos);
-        if (initialBlock != startBlock) {
-            int result = Utils::prefixEquals(blocks[initialBlock] + posBaseTerm,
+        int posBaseTerm = getVInt(c);
+        int sizeBaseTerm = getVInt(c);
+        if (initialBlock != c.blockId) {
+            Cursor base;
+            moveToBlock(base, initialBlock);
+            int result = Utils::prefixEquals((char*) base.block + posBaseTerm,
                                              sizeBaseTerm, string, sizeString);
             if (result != 0) {
                 return result;
             }
+            if (!readOnly) {
+                moveToBlock(c, c.blockId);
+            }
         } else {
             //Do the comparison
-            int result = Utils::prefixEquals(block + posBaseTerm, sizeBaseTerm,
-                                             string, sizeString);
+            int result = Utils::prefixEquals((char*) c.block + posBaseTerm,
+                                             sizeBaseTerm, string, sizeString);
             if (result != 0) {
                 return result;
             }
@@ -553,6 +602,8 @@ int StringBuffer::cmp(int64_t pos, char *string, int sizeString) {
         size -= sizeBaseTerm;
     }
 
+    const char *block = c.block;
+    const int blockStartPos = c.offset;
     int stringBeginningCmp = stringStart;
     if (blockStartPos + size <= SB_BLOCK_SIZE) {
         for (int i = 0; i < size && stringStart < sizeString; ++i) {
@@ -567,8 +618,8 @@ int StringBuffer::cmp(int64_t pos, char *string, int sizeString) {
                 return ((int) block[blockStartPos + i] & 0xff) - ((int) string[stringStart - 1] & 0xff);
             }
         }
-        startBlock++;
-        block = getBlock(startBlock);
+        moveToBlock(c, c.blockId + 1);
+        block = c.block;
         size -= remSize;
         stringBeginningCmp = stringStart;
         for (int i = 0; i < size && stringStart < sizeString; ++i) {
@@ -0,0 +1,331 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/tree/treebuilder.h>
+
+#include <kognac/utils.h>
+#include <kognac/logs.h>
+
+#include <algorithm>
+#include <climits>
+
+//Max size of the values of a single entry in a leaf
+#define MAX_SIZE_ENTRY (N_PARTITIONS * 32)
+
+TreeBuilder::TreeBuilder(std::string path, int maxElementsPerNode,
+        int fileMaxSize, int nodeMinBytes, int nPartitions) :
+    path(path), maxElementsPerNode(maxElementsPerNode),
+    fileMaxSize(fileMaxSize), nodeMinBytes(nodeMinBytes),
+    sizeBuffer(13 + 10 * maxElementsPerNode + 8 * (maxElementsPerNode + 1)
+            + 3 * maxElementsPerNode + 4 + USHRT_MAX + 1 + MAX_SIZE_ENTRY) {
+        finished = false;
+        if (!Utils::exists(path)) {
+            Utils::create_directories(path);
+        }
+        for (int i = 0; i < nPartitions + 1; ++i) {
+            Partition *p = new Partition();
+            p->nFiles = 0;
+            p->sizeFile = 0;
+            p->buffer.resize(sizeBuffer);
+            partitions.push_back(std::unique_ptr<Partition>(p));
+        }
+    }
+
+std::string TreeBuilder::getPartitionFile(int partition, int idx) const {
+    return path + DIR_SEP + std::to_string(partition) + "_" +
+        std::to_string(idx) + ".bulk";
+}
+
+int TreeBuilder::serializeKeys(const std::vector<nTerm> &keys,
+        char *buffer) const {
+    //Same format of Node::serialize
+    const int size = keys.size();
+    Utils::encode_int(buffer, 0, size);
+    int pos = 4;
+    if (size > 0) {
+        Utils::encode_long(buffer, pos, keys[0]);
+        pos += 8;
+        if (size > 1) {
+            //The step is read back as a signed char
+            int64_t step = keys[1] - keys[0];
+            if (step > 127) {
+                step = 0;
+            }
+            for (int i = 2; i < size && step != 0; ++i) {
+                if (keys[i] - keys[i - 1] != step) {
+                    step = 0;
+                }
+            }
+            buffer[pos++] = (char) step;
+            if (step == 0) {
+                for (int i = 1; i < size; ++i) {
+                    pos = Utils::encode_vlong(buffer, pos, keys[i] - keys[0]);
+                }
+            }
+        }
+    }
+    return pos;
+}
+
+void TreeBuilder::writeNode(int partition, const char *buffer, int size,
+        BuiltNode *node) {
+    static const char zeros[4096] = { 0 };
+    Partition *p = partitions[partition].get();
+    //Same policy of NodeManager::put
+    if (!p->out.is_open() || p->sizeFile >= fileMaxSize) {
+        if (p->out.is_open()) {
+            p->out.close();
+        }
+        p->out.open(getPartitionFile(partition, p->nFiles), std::ios_base::binary);
+        if (!p->out.good()) {
+            LOG(ERRORL) << "Cannot create the file " <<
+                getPartitionFile(partition, p->nFiles);
+            throw 10;
+        }
+        p->nFiles++;
+        p->sizeFile = 0;
+    }
+
+    node->fileIndex = p->nFiles - 1;
+    node->posIndex = p->sizeFile;
+    node->nodeSize = size;
+    node->availableSize = std::max(nodeMinBytes, size);
+    p->out.write(buffer, size);
+    int padding = node->availableSize - size;
+    while (padding > 0) {
+        const int n = std::min(padding, (int) sizeof(zeros));
+        p->out.write(zeros, n);
+        padding -= n;
+    }
+    p->sizeFile += node->availableSize;
+}
+
+void TreeBuilder::flushLeaf(int partition) {
+    Partition *p = partitions[partition].get();
+    char *buffer = p->buffer.data();
+    const int size = p->keys.size();
+
+    //Same format of Leaf::serialize
+    int pos = serializeKeys(p->keys, buffer);
+    memcpy(buffer + pos, p->combinations.data(), size);
+    pos += size;
+    for (int i = 0; i < size; ++i) {
+        Utils::encode_short(buffer, pos, p->offsets[i]);
+        pos += 2;
+    }
+    Utils::encode_int(buffer, pos, 4 + p->values.size());
+    pos += 4;
+    if (!p->values.empty()) {
+        memcpy(buffer + pos, p->values.data(), p->values.size());
+        pos += p->values.size();
+    }
+
+    BuiltNode node;
+    node.smallestKey = size > 0 ? p->keys.front() : 0;
+    node.largestKey = size > 0 ? p->keys.back() : 0;
+    node.children = false;
+    writeNode(partition, buffer, pos, &node);
+    p->nodes.push_back(node);
+
+    p->keys.clear();
+    p->combinations.clear();
+    p->offsets.clear();
+    p->values.clear();
+}
+
+void TreeBuilder::append(int partition, nTerm key, TermCoordinates *value) {
+    Partition *p = partitions[partition].get();
+    if (!p->keys.empty() && key <= p->keys.back()) {
+        LOG(ERRORL) << "The keys must be appended in ascending order (" <<
+            key << " after " << p->keys.back() << ")";
+        throw 10;
+    }
+
+    char entry[MAX_SIZE_ENTRY];
+    int sizeEntry = 0;
+    int combinations = 0;
+    for (int perm = 0; perm < N_PARTITIONS; ++perm) {
+        if (value->exists(perm)) {
+            sizeEntry = Utils::encode_vlong2(entry, sizeEntry,
+                    value->getNElements(perm));
+            sizeEntry = Utils::encode_vint2(entry, sizeEntry,
+                    (uint16_t) value->getFileIdx(perm));
+            sizeEntry = Utils::encode_vlong2(entry, sizeEntry,
+                    value->getMark(perm));
+            entry[sizeEntry++] = value->getStrategy(perm);
+            combinations |= 1 << perm;
+        }
+    }
+
+    //The offsets of the entries in the leaves are stored with two bytes
+    if (p->keys.size() == maxElementsPerNode ||
+            4 + p->values.size() > USHRT_MAX) {
+        flushLeaf(partition);
+    }
+    p->keys.push_back(key);
+    p->combinations.push_back((char) combinations);
+    p->offsets.push_back(4 + p->values.size());
+    p->values.insert(p->values.end(), entry, entry + sizeEntry);
+}
+
+void TreeBuilder::finish() {
+    const int nPartitions = getNPartitions();
+    Partition *upper = partitions[nPartitions].get();
+
+    //Flush the last leaves and assign the IDs in the order of the keys
+    int64_t nodeCounter = 0;
+    std::vector<BuiltNode> level;
+    for (int i = 0; i < nPartitions; ++i) {
+        Partition *p = partitions[i].get();
+        if (!p->keys.empty()) {
+            flushLeaf(i);
+        }
+        if (p->out.is_open()) {
+            p->out.close();
+        }
+        for (auto &node : p->nodes) {
+            if (!level.empty() && node.smallestKey <= level.back().largestKey) {
+                LOG(ERRORL) << "The ranges of keys of the partitions overlap";
+                throw 10;
+            }
+            node.id = nodeCounter++;
+            level.push_back(node);
+        }
+    }
+
+    if (level.empty()) {
+        //Empty tree. The root is an empty leaf
+        flushLeaf(nPartitions);
+        upper->nodes.back().id = nodeCounter++;
+        level.push_back(upper->nodes.back());
+    }
+
+    //Build the intermediate nodes bottom-up
+    char *buffer = upper->buffer.data();
+    std::vector<nTerm> keys;
+    while (level.size() > 1) {
+        std::vector<BuiltNode> nextLevel;
+        const size_t nNodes = (level.size() + maxElementsPerNode) /
+            (maxElementsPerNode + 1);
+        for (size_t j = 0; j < nNodes; ++j) {
+            const size_t begin = level.size() * j / nNodes;
+            const size_t end = level.size() * (j + 1) / nNodes;
+            //Same separators of the splits in IntermediateNode
+            keys.clear();
+            for (size_t c = begin; c < end - 1; ++c) {
+                keys.push_back((level[c].largestKey +
+                            level[c + 1].smallestKey) / 2);
+            }
+            int pos = serializeKeys(keys, buffer);
+            for (size_t c = begin; c < end; ++c) {
+                Utils::encode_long(buffer, pos, level[c].id);
+                pos += 8;
+            }
+
+            BuiltNode node;
+            node.smallestKey = level[begin].smallestKey;
+            node.largestKey = level[end - 1].largestKey;
+            node.children = true;
+            node.id = nodeCounter++;
+            writeNode(nPartitions, buffer, pos, &node);
+            upper->nodes.push_back(node);
+            nextLevel.push_back(node);
+        }
+        level.swap(nextLevel);
+    }
+    if (upper->out.is_open()) {
+        upper->out.close();
+    }
+    const int64_t rootId = level[0].id;
+
+    //Rename the files of the partitions to the files of the tree
+    int nFiles = 0;
+    for (int i = 0; i <= nPartitions; ++i) {
+        Partition *p = partitions[i].get();
+        if (nFiles + p->nFiles > SHRT_MAX) {
+            LOG(ERRORL) << "The tree requires too many files. Increase the max size of the files";
+            throw 10;
+        }
+        for (int j = 0; j < p->nFiles; ++j) {
+            Utils::rename(getPartitionFile(i, j),
+                    path + DIR_SEP + std::to_string(nFiles + j));
+        }
+        for (auto &node : p->nodes) {
+            node.fileIndex += nFiles;
+        }
+        nFiles += p->nFiles;
+    }
+
+    //Write the index of the nodes (same format of NodeManager)
+    std::ofstream out(path + DIR_SEP + "idx", std::ios_base::binary);
+    char supportBuffer[32];
+    Utils::encode_int(supportBuffer, 0, nodeCounter);
+    out.write(supportBuffer, 4);
+    const int64_t sizeCoordinates = 4 * nodeCounter;
+    std::unique_ptr<char[]> coordinatesSpace(new char[sizeCoordinates]);
+    out.seekp(4 + sizeCoordinates);
+    int lastFile = -1;
+    for (int i = 0; i <= nPartitions; ++i) {
+        for (const auto &node : partitions[i]->nodes) {
+            supportBuffer[0] = node.fileIndex != lastFile ? 1 : 0;
+            out.write(supportBuffer, 1);
+            lastFile = node.fileIndex;
+            Utils::encode_int(coordinatesSpace.get(), node.id * 4, out.tellp());
+            Utils::encode_long(supportBuffer, 0, node.id);
+            supportBuffer[8] = node.children ? 1 : 0;
+            Utils::encode_int(supportBuffer, 9, node.fileIndex);
+            Utils::encode_int(supportBuffer, 13, node.posIndex);
+            Utils::encode_int(supportBuffer, 17, node.nodeSize);
+            Utils::encode_int(supportBuffer, 21, node.availableSize);
+            out.write(supportBuffer, 25);
+        }
+    }
+    out.seekp(4);
+    out.write(coordinatesSpace.get(), sizeCoordinates);
+    out.close();
+
+    //Write the metadata of the tree (same format of Root)
+    std::ofstream meta(path + DIR_SEP + "tree", std::ios_base::binary);
+    Utils::encode_long(supportBuffer, 0, rootId);
+    Utils::encode_long(supportBuffer, 8, nodeCounter);
+    meta.write(supportBuffer, 16);
+    meta.close();
+
+    LOG(DEBUGL) << "Bulk-loaded tree: " << nodeCounter << " nodes in " <<
+        nFiles << " files";
+    finished = true;
+}
+
+TreeBuilder::~TreeBuilder() {
+    if (!finished) {
+        //Remove the files of the partitions
+        for (int i = 0; i < partitions.size(); ++i) {
+            Partition *p = partitions[i].get();
+            if (p->out.is_open()) {
+                p->out.close();
+            }
+            for (int j = 0; j < p->nFiles; ++j) {
+                Utils::remove(getPartitionFile(i, j));
+            }
+        }
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/utils/epochs.h>
+
+#include <kognac/logs.h>
+
+std::atomic<uint64_t> Epochs::globalEpoch(1);
+std::atomic<int> Epochs::nSlots(0);
+Epochs::Slot Epochs::slots[EPOCHS_MAX_THREADS];
+
+//The slot is returned when the thread terminates
+struct ThreadEpoch {
+    int slot;
+    int depth;
+
+    ThreadEpoch() : slot(-1), depth(0) {
+    }
+
+    ~ThreadEpoch() {
+        if (slot != -1) {
+            Epochs::releaseSlot(slot);
+        }
+    }
+};
+
+static thread_local ThreadEpoch threadEpoch;
+
+int Epochs::acquireSlot() {
+    for (int i = 0; i < EPOCHS_MAX_THREADS; ++i) {
+        bool expected = false;
+        if (!slots[i].used.load(std::memory_order_relaxed) &&
+                slots[i].used.compare_exchange_strong(expected, true)) {
+            int n = nSlots.load();
+            while (n < i + 1 && !nSlots.compare_exchange_weak(n, i + 1)) {
+            }
+            return i;
+        }
+    }
+    LOG(ERRORL) << "Too many threads are reading the tree (max " <<
+        EPOCHS_MAX_THREADS << ")";
+    throw 10;
+}
+
+void Epochs::releaseSlot(int slot) {
+    slots[slot].epoch.store(0);
+    slots[slot].used.store(false);
+}
+
+void Epochs::enter() {
+    ThreadEpoch &t = threadEpoch;
+    if (t.depth++ > 0) {
+        return;
+    }
+    if (t.slot == -1) {
+        t.slot = acquireSlot();
+    }
+    //Sequentially consistent, so that the loads of the reader cannot be
+    //executed before the epoch is published
+    slots[t.slot].epoch.store(globalEpoch.load());
+}
+
+void Epochs::exit() {
+    ThreadEpoch &t = threadEpoch;
+    if (--t.depth == 0) {
+        slots[t.slot].epoch.store(0, std::memory_order_release);
+    }
+}
+
+uint64_t Epochs::retire() {
+    return globalEpoch.fetch_add(1);
+}
+
+uint64_t Epochs::getOldestActive() {
+    uint64_t oldest = UINT64_MAX;
+    const int n = nSlots.load();
+    for (int i = 0; i < n; ++i) {
+        const uint64_t e = slots[i].epoch.load();
+        if (e != 0 && e < oldest) {
+            oldest = e;
+        }
+    }
+    return oldest;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2017 Jacopo Urbani
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+**/
+
+
+#include <trident/utils/memorybudget.h>
+
+#include <kognac/logs.h>
+
+#include <algorithm>
+
+MemoryBudget::MemoryBudget() : limit(0), used(0), peak(0) {
+}
+
+void MemoryBudget::setLimit(uint64_t limit) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->limit = limit;
+}
+
+uint64_t MemoryBudget::reserve(std::string stage, uint64_t wanted,
+        uint64_t minimum) {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t size = wanted;
+    if (limit > 0) {
+        const uint64_t available = used < limit ? limit - used : 0;
+        size = std::max(std::min(minimum, wanted), std::min(wanted, available));
+        if (size > available) {
+            LOG(WARNL) << "The stage " << stage << " needs at least " <<
+                size << " bytes, but only " << available <<
+                " bytes are left in the memory budget";
+        } else if (size < wanted) {
+            LOG(DEBUGL) << "The stage " << stage << " gets " << size <<
+                " bytes instead of " << wanted;
+        }
+    }
+    used += size;
+    peak = std::max(peak, used);
+    uint64_t &s = usedByStage[stage];
+    s += size;
+    uint64_t &p = peakByStage[stage];
+    p = std::max(p, s);
+    return size;
+}
+
+void MemoryBudget::release(std::string stage, uint64_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    used -= size;
+    usedByStage[stage] -= size;
+}
+
+void MemoryBudget::report() {
+    std::lock_guard<std::mutex> lock(mutex);
+    LOG(INFOL) << "Memory budget: limit " << (limit / 1024 / 1024) <<
+        "MB, peak " << (peak / 1024 / 1024) << "MB";
+    for (auto &p : peakByStage) {
+        LOG(INFOL) << "Memory budget: peak of " << p.first << " " <<
+            (p.second / 1024 / 1024) << "MB";
+    }
+}
+
+MemoryBudget &MemoryBudget::getInstance() {
+    static MemoryBudget budget;
+    return budget;
+}
@@ -0,0 +1,105 @@
+#include <trident/loader.h>
+#include <trident/kb/kb.h>
+#include <trident/kb/kbconfig.h>
+#include <trident/kb/querier.h>
+#include <trident/iterators/pairitr.h>
+#include <trident/binarytables/tableshandler.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+static bool expect(string label, AccessPattern value, AccessPattern expected) {
+    if (value != expected) {
+        cerr << label << ": " << value << " instead of " << expected << endl;
+        return false;
+    }
+    return true;
+}
+
+static PairItr *startScan(Querier *q) {
+    PairItr *itr = q->get(IDX_SPO, -1, -1, -1);
+    //The file is switched when it is read
+    if (itr->hasNext()) {
+        itr->next();
+    }
+    return itr;
+}
+
+int main(int argc, const char** argv) {
+    const string dir = "accesshints";
+    if (Utils::exists(dir)) {
+        Utils::remove_all(dir);
+    }
+    Utils::create_directories(dir + "/input");
+    {
+        ofstream out(dir + "/input/triples.nt");
+        for (int i = 0; i < 10000; ++i) {
+            out << "<http://s" << (i / 10) << "> <http://p" << (i % 7) <<
+                "> <http://o" << i << "> ." << endl;
+        }
+    }
+    ParamsLoad p;
+    p.triplesInputDir = dir + "/input";
+    p.kbDir = dir + "/kb";
+    p.tmpDir = p.kbDir;
+    p.parallelThreads = 2;
+    p.maxReadingThreads = 1;
+    p.sample = false;
+    Loader loader;
+    loader.load(p);
+
+    bool ok = true;
+    {
+        KBConfig config;
+        config.setParamBool(STORAGE_ACCESS_HINTS, true);
+        KB kb(p.kbDir.c_str(), true, false, true, config);
+        Querier *q = kb.query();
+        TableStorage *storage = q->getTableStorage(IDX_SPO);
+        ok &= expect("no scan", storage->getAccessPattern(0), ACCESS_RANDOM);
+
+        PairItr *scan1 = startScan(q);
+        PairItr *scan2 = startScan(q);
+        ok &= expect("two scans", storage->getAccessPattern(0),
+                ACCESS_SEQUENTIAL);
+        q->releaseItr(scan1);
+        ok &= expect("one scan released", storage->getAccessPattern(0),
+                ACCESS_SEQUENTIAL);
+        //A lookup does not change the hint of the running scan
+        PairItr *lookup = q->get(IDX_SPO, scan2->getKey(), -1, -1);
+        q->releaseItr(lookup);
+        ok &= expect("after a lookup", storage->getAccessPattern(0),
+                ACCESS_SEQUENTIAL);
+        q->releaseItr(scan2);
+        ok &= expect("all scans released", storage->getAccessPattern(0),
+                ACCESS_RANDOM);
+
+        //Only the scanned file is switched
+        storage->startScan(0);
+        ok &= expect("scanned file", storage->getAccessPattern(0),
+                ACCESS_SEQUENTIAL);
+        ok &= expect("other file", storage->getAccessPattern(1),
+                ACCESS_RANDOM);
+        storage->stopScan(0);
+        ok &= expect("stopped", storage->getAccessPattern(0), ACCESS_RANDOM);
+        delete q;
+    }
+    {
+        KBConfig config;
+        KB kb(p.kbDir.c_str(), true, false, true, config);
+        Querier *q = kb.query();
+        PairItr *scan = startScan(q);
+        ok &= expect("no hints", q->getTableStorage(IDX_SPO)->getAccessPattern(0),
+                ACCESS_NORMAL);
+        q->releaseItr(scan);
+        delete q;
+    }
+
+    Utils::remove_all(dir);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include <trident/binarytables/batchreaders.h>
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+static void encode(char *buffer, const uint8_t nbytes, const uint64_t v) {
+    for (int i = 0; i < nbytes; ++i) {
+        buffer[i] = (v >> ((nbytes - 1 - i) * 8)) & 0xFF;
+    }
+}
+
+static uint64_t maxValue(const uint8_t nbytes) {
+    return nbytes == 8 ? ~UINT64_C(0) : (UINT64_C(1) << (nbytes * 8)) - 1;
+}
+
+static bool testColumn(const uint8_t nbytes, const size_t n, std::mt19937_64 &gen) {
+    std::vector<char> buffer(n * nbytes);
+    std::vector<uint64_t> values(n);
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = gen() & maxValue(nbytes);
+        encode(buffer.data() + i * nbytes, nbytes, values[i]);
+    }
+    std::vector<uint64_t> out(n);
+    BatchReader::readColumn(buffer.data(), nbytes, n,
+            buffer.data() + buffer.size(), out.data());
+    return out == values;
+}
+
+static bool testRows(const uint8_t nbytes1, const uint8_t nbytes2,
+        const size_t n, std::mt19937_64 &gen) {
+    const size_t rowsize = nbytes1 + nbytes2;
+    std::vector<char> buffer(n * rowsize);
+    std::vector<uint64_t> values1(n), values2(n);
+    for (size_t i = 0; i < n; ++i) {
+        values1[i] = gen() & maxValue(nbytes1);
+        values2[i] = gen() & maxValue(nbytes2);
+        encode(buffer.data() + i * rowsize, nbytes1, values1[i]);
+        encode(buffer.data() + i * rowsize + nbytes1, nbytes2, values2[i]);
+    }
+    std::vector<uint64_t> out1(n), out2(n);
+    BatchReader::readRows(buffer.data(), nbytes1, nbytes2, n,
+            buffer.data() + buffer.size(), out1.data(), out2.data());
+    return out1 == values1 && out2 == values2;
+}
+
+int main(int argc, const char** argv) {
+    std::mt19937_64 gen(42);
+    const int bestMode = BatchReader::getMode();
+    bool ok = true;
+    for (int mode = BATCH_SCALAR; mode <= bestMode; ++mode) {
+        BatchReader::setMode(mode);
+        for (uint8_t nbytes = 1; nbytes <= 8; ++nbytes) {
+            for (size_t n : {0, 1, 2, 3, 5, 17, 1000}) {
+                if (!testColumn(nbytes, n, gen)) {
+                    cerr << "Column mode=" << mode << " nbytes=" << (int) nbytes
+                        << " n=" << n << " FAILED" << endl;
+                    ok = false;
+                }
+                for (uint8_t nbytes2 = 1; nbytes2 <= 8; ++nbytes2) {
+                    if (!testRows(nbytes, nbytes2, n, gen)) {
+                        cerr << "Rows mode=" << mode << " nbytes=" << (int) nbytes
+                            << "," << (int) nbytes2 << " n=" << n << " FAILED" << endl;
+                        ok = false;
+                    }
+                }
+            }
+        }
+    }
+
+    //Throughput on a large column of 5-byte values
+    const size_t n = 50000000;
+    std::vector<char> buffer(n * 5);
+    for (size_t i = 0; i < n; ++i) {
+        encode(buffer.data() + i * 5, 5, i);
+    }
+    std::vector<uint64_t> out(4096);
+    for (int mode = BATCH_SCALAR; mode <= bestMode; ++mode) {
+        BatchReader::setMode(mode);
+        std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i += out.size()) {
+            const size_t m = std::min(out.size(), n - i);
+            BatchReader::readColumn(buffer.data() + i * 5, 5, m,
+                    buffer.data() + buffer.size(), out.data());
+            sum += out[m - 1];
+        }
+        std::chrono::duration<double> sec = std::chrono::system_clock::now() - start;
+        cout << "Mode " << mode << ": " << sec.count() * 1000 << "ms (" << sum << ")" << endl;
+    }
+
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
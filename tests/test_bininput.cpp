@@ -0,0 +1,209 @@
+#include <trident/loader.h>
+#include <trident/kb/kb.h>
+#include <trident/kb/kbconfig.h>
+#include <trident/kb/querier.h>
+#include <trident/kb/dictmgmt.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <tuple>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+typedef std::tuple<int64_t, int64_t, int64_t> BinTriple;
+
+static const int NTERMS = 3000;
+
+static string getTerm(int64_t id) {
+    return "<http://t" + to_string(id) + ">";
+}
+
+//The IDs are written little-endian, whatever the byte order of the machine
+static void writeID(ofstream &out, uint64_t id, int idSize) {
+    for (int i = 0; i < idSize; ++i) {
+        out.put((char) ((id >> (8 * i)) & 0xFF));
+    }
+}
+
+static void writeBin(string file, const vector<BinTriple> &triples,
+        int idSize) {
+    ofstream out(file, ios_base::binary);
+    for (auto &t : triples) {
+        writeID(out, get<0>(t), idSize);
+        writeID(out, get<1>(t), idSize);
+        writeID(out, get<2>(t), idSize);
+    }
+}
+
+//The input of --comprinput and --comprdict
+static void writeText(string triplesFile, string dictFile,
+        const vector<BinTriple> &triples) {
+    ofstream out(triplesFile);
+    for (auto &t : triples) {
+        out << get<0>(t) << " " << get<1>(t) << " " << get<2>(t) << endl;
+    }
+    ofstream dict(dictFile);
+    for (int i = 0; i < NTERMS; ++i) {
+        const string term = getTerm(i);
+        dict << i << " " << term.size() << " " << term << endl;
+    }
+}
+
+//The triples of the KB, with the IDs and, if there is a dictionary, with
+//the texts
+static vector<string> getTriples(string kbDir, bool texts) {
+    vector<string> triples;
+    KBConfig config;
+    KB kb(kbDir.c_str(), true, false, true, config);
+    DictMgmt *dict = kb.getDictMgmt();
+    Querier *q = kb.query();
+    PairItr *itr = q->get(IDX_SPO, -1, -1, -1);
+    char text[MAX_TERM_SIZE];
+    while (itr->hasNext()) {
+        itr->next();
+        const int64_t terms[3] = { itr->getKey(), itr->getValue1(),
+            itr->getValue2() };
+        string triple;
+        for (int i = 0; i < 3; ++i) {
+            triple += to_string(terms[i]);
+            int size;
+            if (texts && dict->getText(terms[i], text, size)) {
+                triple += "=" + string(text, size);
+            }
+            triple += i < 2 ? " " : "";
+        }
+        triples.push_back(triple);
+    }
+    q->releaseItr(itr);
+    delete q;
+    sort(triples.begin(), triples.end());
+    return triples;
+}
+
+static ParamsLoad getParams(string input, string dict, string kbDir) {
+    ParamsLoad p;
+    p.triplesInputDir = input;
+    p.dictDir = dict;
+    p.kbDir = kbDir;
+    p.tmpDir = kbDir;
+    p.parallelThreads = 2;
+    p.maxReadingThreads = 1;
+    p.sample = false;
+    return p;
+}
+
+static ParamsLoad getBinParams(string input, string dict, string kbDir,
+        int idSize) {
+    ParamsLoad p = getParams(input, dict, kbDir);
+    p.inputformat = "bin";
+    p.binIDSize = idSize;
+    return p;
+}
+
+static bool checkLoad(string name, ParamsLoad p, const vector<string> &expected,
+        bool texts) {
+    Loader loader;
+    loader.load(p);
+    if (getTriples(p.kbDir, texts) != expected) {
+        cerr << "The KB loaded from " << name << " differs from the one " <<
+            "loaded with comprinput" << endl;
+        return false;
+    }
+    cout << "Loaded " << name << endl;
+    return true;
+}
+
+static bool checkError(string name, ParamsLoad p) {
+    try {
+        Loader loader;
+        loader.load(p);
+    } catch (int) {
+        cout << "Rejected " << name << endl;
+        return true;
+    }
+    cerr << "The load of " << name << " did not fail" << endl;
+    return false;
+}
+
+int main(int argc, const char** argv) {
+    const string dir = "bininput";
+    if (Utils::exists(dir)) {
+        Utils::remove_all(dir);
+    }
+    Utils::create_directories(dir);
+
+    //Subjects with many triples, a few predicates and IDs that need more
+    //than one byte
+    vector<BinTriple> triples;
+    for (int i = 0; i < 20000; ++i) {
+        triples.push_back(BinTriple((i * 7) % NTERMS, NTERMS - 1 - i % 5,
+                    (i * 13 + i / NTERMS) % NTERMS));
+    }
+    sort(triples.begin(), triples.end());
+    triples.erase(unique(triples.begin(), triples.end()), triples.end());
+    //The order of the input must not matter
+    std::reverse(triples.begin(), triples.begin() + triples.size() / 2);
+
+    writeText(dir + "/triples.txt", dir + "/dict.txt", triples);
+    {
+        Loader loader;
+        ParamsLoad p = getParams(dir + "/triples.txt", dir + "/dict.txt",
+                dir + "/compr");
+        p.inputCompressed = true;
+        loader.load(p);
+    }
+    const vector<string> expected = getTriples(dir + "/compr", true);
+    const vector<string> expectedIDs = getTriples(dir + "/compr", false);
+
+    bool ok = true;
+    for (int idSize = 4; idSize <= 8; idSize += 4) {
+        const string bin = dir + "/triples" + to_string(idSize) + ".bin";
+        writeBin(bin, triples, idSize);
+        const string name = to_string(idSize) + "-byte IDs";
+        ok &= checkLoad(name + " with comprdict", getBinParams(bin,
+                    dir + "/dict.txt", dir + "/kb" + to_string(idSize), idSize),
+                expected, true);
+        ok &= checkLoad(name + " without dictionary", getBinParams(bin, "",
+                    dir + "/kbnodict" + to_string(idSize), idSize),
+                expectedIDs, false);
+    }
+
+    //A directory of files, read in the order of their names
+    Utils::create_directories(dir + "/parts");
+    const size_t half = triples.size() / 2;
+    writeBin(dir + "/parts/a", vector<BinTriple>(triples.begin(),
+                triples.begin() + half), 8);
+    writeBin(dir + "/parts/b", vector<BinTriple>(triples.begin() + half,
+                triples.end()), 8);
+    ok &= checkLoad("a directory", getBinParams(dir + "/parts",
+                dir + "/dict.txt", dir + "/kbparts", 8), expected, true);
+
+    //The size is not a multiple of the triples
+    {
+        ofstream out(dir + "/truncated.bin", ios_base::binary);
+        for (int i = 0; i < 3 * 8 + 5; ++i) {
+            out.put(0);
+        }
+    }
+    ok &= checkError("a truncated file", getBinParams(dir + "/truncated.bin",
+                "", dir + "/kbtruncated", 8));
+    //The sort has five bytes per term
+    {
+        vector<BinTriple> large = triples;
+        get<2>(large[large.size() / 2]) = (int64_t) 1 << 40;
+        writeBin(dir + "/large.bin", large, 8);
+    }
+    ok &= checkError("an ID of 2^40", getBinParams(dir + "/large.bin", "",
+                dir + "/kblarge", 8));
+    ok &= checkError("IDs of 3 bytes", getBinParams(dir + "/triples4.bin", "",
+                dir + "/kbidsize", 3));
+
+    Utils::remove_all(dir);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
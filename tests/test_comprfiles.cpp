@@ -0,0 +1,74 @@
+#include <trident/files/comprfiledescriptor.h>
+#include <trident/files/blockcache.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <random>
+#include <cstring>
+
+using namespace std;
+
+int main(int argc, const char** argv) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <tmp dir>" << endl;
+        return 1;
+    }
+    const string raw = string(argv[1]) + "/0";
+    std::mt19937 gen(42);
+
+    //Tables of different size, some of them larger than a block
+    std::vector<uint64_t> starts;
+    std::vector<char> data;
+    for (int t = 0; t < 3000; ++t) {
+        starts.push_back(data.size());
+        size_t len = gen() % 5 == 0 ? gen() % 200000 : gen() % 300;
+        for (size_t i = 0; i < len; ++i) {
+            data.push_back((char) (t % 7 == 0 ? gen() : i % 13));
+        }
+    }
+    {
+        ofstream out(raw, ios_base::binary);
+        out.write(data.data(), data.size());
+    }
+    ComprFileDescriptor::compress(raw, starts, raw + ".cmp");
+    cout << "Raw " << data.size() << " bytes, compressed " <<
+        Utils::fileSize(raw + ".cmp") << " bytes" << endl;
+
+    BlockCache cache(1024 * 1024);
+    ComprFileDescriptor file(raw + ".cmp", 0, 0, &cache);
+    bool ok = file.getFileLength() == data.size();
+    std::vector<BlockCache::Block> pinned;
+    for (int i = 0; i < 20000; ++i) {
+        const size_t t = i < 10000 ? gen() % starts.size() : gen() % 20;
+        const uint64_t start = starts[t];
+        const uint64_t end = t + 1 < starts.size() ? starts[t + 1] : data.size();
+        BlockCache::Block pin;
+        const char *table = file.getBuffer(start, end - start, pin);
+        if (memcmp(table, data.data() + start, end - start) != 0) {
+            cerr << "Table " << t << " FAILED" << endl;
+            ok = false;
+        }
+        //The pinned blocks must survive the evictions
+        if (i % 100 == 0) {
+            pinned.push_back(pin);
+        }
+    }
+    for (auto &pin : pinned) {
+        if (pin && pin->empty()) {
+            ok = false;
+        }
+    }
+
+    BlockCacheStats stats = cache.getStats();
+    cout << "Hits " << stats.hits << " misses " << stats.misses << " hit rate "
+        << stats.getHitRate() << " evictions " << stats.evictions
+        << " decompression time " << stats.decompressionTime << "us" << endl;
+    Utils::remove(raw);
+    Utils::remove(raw + ".cmp");
+
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+#include <trident/tree/stringbuffer.h>
+#include <trident/kb/statistics.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+//Sorted strings with long common prefixes, like the terms of a dictionary
+static std::vector<string> generateStrings(int64_t n) {
+    const char *prefixes[] = { "<http://very_long_domain1.com/",
+        "<http://long_domain2.com/", "<http://short_domain1.com/", "\"" };
+    std::mt19937_64 gen(0);
+    std::vector<string> strings;
+    for (int64_t i = 0; i < n; ++i) {
+        string s = prefixes[gen() % 4];
+        const int len = 1 + gen() % 40;
+        for (int j = 0; j < len; ++j) {
+            s += (char) ('A' + gen() % 25);
+        }
+        strings.push_back(s);
+    }
+    std::sort(strings.begin(), strings.end());
+    return strings;
+}
+
+int main(int argc, const char** argv) {
+    const string path = "concurrentsb";
+    const int64_t n = argc > 1 ? atol(argv[1]) : 2000000;
+    const int64_t lookupsPerThread = argc > 2 ? atol(argv[2]) : 200000;
+    //Small cache, so that the threads decompress and evict blocks often
+    const int64_t cacheSize = argc > 3 ? atol(argv[3]) : 256 * SB_BLOCK_SIZE;
+
+    if (Utils::exists(path)) {
+        Utils::remove_all(path);
+    }
+    std::vector<string> strings = generateStrings(n);
+    std::vector<int64_t> positions;
+    Stats stats;
+    {
+        StringBuffer sb(path, false, 10, cacheSize, &stats);
+        for (auto &s : strings) {
+            positions.push_back(sb.getSize());
+            sb.append((char*) s.c_str(), s.size());
+        }
+    }
+
+    StringBuffer sb(path, true, 10, cacheSize, &stats);
+    bool ok = true;
+    double baseline = 0;
+    for (int nthreads = 1; nthreads <= 32; nthreads *= 2) {
+        std::atomic<int64_t> errors(0);
+        std::vector<std::thread> threads;
+        std::chrono::system_clock::time_point start =
+            std::chrono::system_clock::now();
+        for (int t = 0; t < nthreads; ++t) {
+            threads.push_back(std::thread([&sb, &strings, &positions, &errors,
+                            t, n, lookupsPerThread]() {
+                        std::mt19937_64 gen(t);
+                        char buffer[MAX_TERM_SIZE];
+                        for (int64_t i = 0; i < lookupsPerThread; ++i) {
+                            const int64_t idx = gen() % n;
+                            const string &expected = strings[idx];
+                            int size = 0;
+                            if (i % 2 == 0) {
+                                sb.get(positions[idx], buffer, size);
+                            } else {
+                                char *text = sb.get(positions[idx], size);
+                                memcpy(buffer, text, size);
+                            }
+                            if (string(buffer, size) != expected ||
+                                    sb.cmp(positions[idx],
+                                        (char*) expected.c_str(),
+                                        expected.size()) != 0) {
+                                errors++;
+                            }
+                        }
+                        }));
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        std::chrono::duration<double> sec = std::chrono::system_clock::now()
+            - start;
+        const double throughput = nthreads * lookupsPerThread / sec.count();
+        if (nthreads == 1) {
+            baseline = throughput;
+        }
+        cout << nthreads << " threads: " << (int64_t) throughput <<
+            " lookups/s speedup " << throughput / baseline << " errors " <<
+            errors << endl;
+        if (errors > 0) {
+            ok = false;
+        }
+    }
+    Utils::remove_all(path);
+
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+#include <trident/tree/root.h>
+#include <trident/tree/coordinates.h>
+#include <trident/utils/propertymap.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <chrono>
+
+using namespace std;
+
+//Same configuration used by the KB, with few leaves in cache so that the
+//threads load and evict them all the time. Small files and caches make the
+//tree open, close and unmap its files during the lookups
+static PropertyMap getConfig(int nodesInCache, int fileMaxSize, int maxFiles,
+        int64_t cacheMaxSize) {
+    PropertyMap config;
+    config.setBool(TEXT_KEYS, false);
+    config.setBool(TEXT_VALUES, false);
+    config.setBool(COMPRESSED_NODES, false);
+    config.setInt(MAX_EL_PER_NODE, 2048);
+    config.setInt(FILE_MAX_SIZE, fileMaxSize);
+    config.setLong(CACHE_MAX_SIZE, cacheMaxSize);
+    config.setInt(NODE_MIN_BYTES, 0);
+    config.setInt(MAX_NODES_IN_CACHE, nodesInCache);
+    config.setInt(LEAF_SIZE_FACTORY, 10);
+    config.setInt(LEAF_SIZE_PREALL_FACTORY, 10);
+    config.setInt(LEAF_ARRAYS_FACTORY_SIZE, 10);
+    config.setInt(LEAF_ARRAYS_PREALL_FACTORY_SIZE, 10);
+    config.setInt(LEAF_MAX_INTERNAL_LINES, 2048);
+    config.setInt(LEAF_MAX_PREALL_INTERNAL_LINES, 2048);
+    config.setInt(NODE_KEYS_FACTORY_SIZE, 10);
+    config.setInt(NODE_KEYS_PREALL_FACTORY_SIZE, 10);
+    config.setInt(MAX_N_OPENED_FILES, maxFiles);
+    return config;
+}
+
+static void getCoordinates(int64_t key, TermCoordinates *value) {
+    value->clear();
+    value->set(0, key % 100, key * 3, key + 1, (char) (key % 64));
+    if (key % 2 == 0) {
+        value->set(3, key % 7, key * 5, 2 * key + 1, (char) (key % 32));
+    }
+}
+
+static bool check(int64_t key, TermCoordinates &value) {
+    TermCoordinates expected;
+    getCoordinates(key, &expected);
+    for (int perm = 0; perm < N_PARTITIONS; ++perm) {
+        if (value.exists(perm) != expected.exists(perm)) {
+            return false;
+        }
+        if (value.exists(perm) && (value.getFileIdx(perm) !=
+                    expected.getFileIdx(perm) ||
+                    value.getMark(perm) != expected.getMark(perm) ||
+                    value.getNElements(perm) != expected.getNElements(perm) ||
+                    value.getStrategy(perm) != expected.getStrategy(perm))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool run(const string path, const int64_t n,
+        const int64_t lookupsPerThread, const int nodesInCache,
+        const int fileMaxSize, const int maxFiles, const int64_t cacheMaxSize,
+        const int maxThreads) {
+    if (Utils::exists(path)) {
+        Utils::remove_all(path);
+    }
+    {
+        PropertyMap config = getConfig(nodesInCache, fileMaxSize, maxFiles,
+                cacheMaxSize);
+        Root root(path, NULL, false, config);
+        TermCoordinates value;
+        for (int64_t key = 0; key < n; ++key) {
+            getCoordinates(key, &value);
+            root.append(key, &value);
+        }
+    }
+
+    PropertyMap config = getConfig(nodesInCache, fileMaxSize, maxFiles,
+            cacheMaxSize);
+    Root root(path, NULL, true, config);
+    bool ok = true;
+    double baseline = 0;
+    for (int nthreads = 1; nthreads <= maxThreads; nthreads *= 2) {
+        std::atomic<int64_t> errors(0);
+        std::vector<std::thread> threads;
+        std::chrono::system_clock::time_point start =
+            std::chrono::system_clock::now();
+        for (int t = 0; t < nthreads; ++t) {
+            threads.push_back(std::thread([&root, &errors, t, n,
+                            lookupsPerThread]() {
+                        std::mt19937_64 gen(t);
+                        TermCoordinates value;
+                        for (int64_t i = 0; i < lookupsPerThread; ++i) {
+                            const int64_t key = gen() % n;
+                            if (!root.get(key, &value) || !check(key, value)) {
+                                errors++;
+                            }
+                        }
+                        }));
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        std::chrono::duration<double> sec = std::chrono::system_clock::now()
+            - start;
+        const double throughput = nthreads * lookupsPerThread / sec.count();
+        if (nthreads == 1) {
+            baseline = throughput;
+        }
+        cout << nthreads << " threads: " << (int64_t) throughput <<
+            " lookups/s speedup " << throughput / baseline << " errors " <<
+            errors << endl;
+        if (errors > 0) {
+            ok = false;
+        }
+    }
+    Utils::remove_all(path);
+    return ok;
+}
+
+int main(int argc, const char** argv) {
+    const string path = "concurrenttree";
+    const int64_t n = argc > 1 ? atol(argv[1]) : 10000000;
+    const int64_t lookupsPerThread = argc > 2 ? atol(argv[2]) : 2000000;
+    const int nodesInCache = argc > 3 ? atoi(argv[3]) : 64;
+
+    bool ok = run(path, n, lookupsPerThread, nodesInCache, 64 * 1024 * 1024,
+            1024, 1024 * 1024 * 1024, 32);
+    //Files of 1MB, at most 2 opened and 2MB of cache. The read-only tree
+    //must not unmap a file while the other threads parse its leaves
+    cout << "Small files and cache" << endl;
+    ok &= run(path, n / 10, lookupsPerThread / 10, nodesInCache, 1024 * 1024,
+            2, 2 * 1024 * 1024, 8);
+
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include <trident/tree/coordtable.h>
+#include <trident/tree/root.h>
+#include <trident/tree/treeitr.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+
+using namespace std;
+
+struct Entry {
+    int64_t key;
+    TermCoordinates coord;
+};
+
+//Iterates over a vector instead of the leaves
+class VectorItr : public TreeItr {
+    private:
+        const std::vector<Entry> &entries;
+        size_t pos;
+
+    public:
+        VectorItr(const std::vector<Entry> &entries) : entries(entries), pos(0) {
+        }
+
+        bool hasNext() {
+            return pos < entries.size();
+        }
+
+        int64_t next(TermCoordinates *value) {
+            value->copyFrom((TermCoordinates*) &entries[pos].coord);
+            return entries[pos++].key;
+        }
+};
+
+class VectorRoot : public Root {
+    private:
+        const std::vector<Entry> &entries;
+
+    public:
+        VectorRoot(const std::vector<Entry> &entries) : entries(entries) {
+        }
+
+        TreeItr *itr() {
+            return new VectorItr(entries);
+        }
+};
+
+static std::vector<Entry> generateEntries(int64_t n, int step, std::mt19937_64 &gen) {
+    std::vector<Entry> entries;
+    for (int64_t key = 0; key < n; key += 1 + gen() % step) {
+        Entry e;
+        e.key = key;
+        e.coord.clear();
+        for (int perm = 0; perm < N_PARTITIONS; ++perm) {
+            //Every key appears in at least one permutation
+            if (perm == 0 || gen() % 3 != 0) {
+                e.coord.set(perm, gen() % 100, gen() % (INT64_C(1) << 34),
+                        1 + gen() % 1000000, (char) (gen() % 256));
+            }
+        }
+        entries.push_back(e);
+    }
+    return entries;
+}
+
+static bool equals(TermCoordinates &c1, TermCoordinates &c2) {
+    for (int perm = 0; perm < N_PARTITIONS; ++perm) {
+        if (c1.exists(perm) != c2.exists(perm)) {
+            return false;
+        }
+        if (c1.exists(perm) && (c1.getFileIdx(perm) != c2.getFileIdx(perm) ||
+                    c1.getMark(perm) != c2.getMark(perm) ||
+                    c1.getNElements(perm) != c2.getNElements(perm) ||
+                    c1.getStrategy(perm) != c2.getStrategy(perm))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, const char** argv) {
+    const string file = "coords";
+    std::mt19937_64 gen(42);
+    bool ok = true;
+
+    //Almost dense keys
+    std::vector<Entry> entries = generateEntries(1000000, 2, gen);
+    {
+        VectorRoot root(entries);
+        if (!CoordinatesTable::create(&root, file)) {
+            cerr << "The table was not created" << endl;
+            return 1;
+        }
+    }
+    CoordinatesTable table(file);
+    TermCoordinates value;
+    int64_t expectedKey = 0;
+    for (auto &e : entries) {
+        for (; expectedKey < e.key; ++expectedKey) {
+            if (table.get(expectedKey, &value)) {
+                cerr << "Key " << expectedKey << " should not exist" << endl;
+                ok = false;
+            }
+        }
+        if (!table.get(e.key, &value) || !equals(value, e.coord)) {
+            cerr << "Wrong coordinates for key " << e.key << endl;
+            ok = false;
+        }
+        expectedKey = e.key + 1;
+    }
+    if (table.get(entries.back().key + 1, &value)) {
+        cerr << "Key after the last should not exist" << endl;
+        ok = false;
+    }
+
+    //Random lookups
+    std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
+    int64_t found = 0;
+    for (int i = 0; i < 10000000; ++i) {
+        found += table.get(gen() % expectedKey, &value);
+    }
+    std::chrono::duration<double> sec = std::chrono::system_clock::now() - start;
+    cout << "10M lookups: " << sec.count() * 1000 << "ms (" << found << " found)" << endl;
+
+    //Sparse keys
+    std::vector<Entry> sparse = generateEntries(1000000, 100, gen);
+    {
+        VectorRoot root(sparse);
+        if (CoordinatesTable::create(&root, file + "2")) {
+            cerr << "The table should not be created with sparse keys" << endl;
+            ok = false;
+        }
+    }
+    Utils::remove(file);
+
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
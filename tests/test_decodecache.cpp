@@ -0,0 +1,107 @@
+#include <trident/kb/decodecache.h>
+
+#include <iostream>
+#include <string>
+#include <random>
+#include <thread>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+
+#define N_TERMS 1000000
+
+static string getText(uint64_t id) {
+    return "<http://example.org/resource/" + to_string(id) + ">";
+}
+
+//Zipf-distributed IDs, as the popular terms in the results of the queries
+static vector<uint64_t> zipf(int n, double s, int seed) {
+    vector<double> cdf(N_TERMS);
+    double sum = 0;
+    for (int i = 0; i < N_TERMS; ++i) {
+        sum += 1.0 / pow(i + 1, s);
+        cdf[i] = sum;
+    }
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(0, sum);
+    vector<uint64_t> out;
+    for (int i = 0; i < n; ++i) {
+        out.push_back(lower_bound(cdf.begin(), cdf.end(), dist(gen)) -
+                cdf.begin());
+    }
+    return out;
+}
+
+static bool access(DecodeCache &cache, uint64_t id) {
+    char text[1024];
+    int size;
+    if (cache.get(id, text, size)) {
+        if (string(text, size) != getText(id)) {
+            cerr << "Wrong text for " << id << endl;
+            exit(1);
+        }
+        return true;
+    }
+    const string t = getText(id);
+    cache.put(id, t.c_str(), t.size());
+    return false;
+}
+
+int main(int argc, const char **argv) {
+    DecodeCache cache(4 * 1024 * 1024);
+    const vector<uint64_t> ids = zipf(2000000, 0.9, 42);
+
+    //Warmup
+    for (int i = 0; i < 1000000; ++i) {
+        access(cache, ids[i]);
+    }
+    //Requests of the popular terms, mixed with scans of many distinct IDs
+    uint64_t hits = 0, requests = 0, scanned = 500000;
+    for (int i = 1000000; i < ids.size(); ++i) {
+        hits += access(cache, ids[i]);
+        requests++;
+        if (i % 1000 == 0) {
+            for (int j = 0; j < 100; ++j) {
+                access(cache, scanned++);
+            }
+        }
+    }
+    const double hitRate = (double) hits / requests;
+    DecodeCacheStats stats = cache.getStats();
+    cout << "Hit rate popular terms " << hitRate << " (overall " <<
+        stats.getHitRate() << ") admissions " << stats.admissions <<
+        " rejections " << stats.rejections << " evictions " <<
+        stats.evictions << " entries " << stats.entries << " bytes " <<
+        stats.bytes << "/" << stats.maxBytes << endl;
+    if (stats.bytes > stats.maxBytes || hitRate < 0.4) {
+        cerr << "FAILED" << endl;
+        return 1;
+    }
+
+    //Concurrent readers
+    vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.push_back(std::thread([&cache, t]() {
+            const vector<uint64_t> ids = zipf(200000, 0.9, t);
+            for (auto id : ids) {
+                access(cache, id);
+                std::string text;
+                if (cache.get(id, text) && text != getText(id)) {
+                    cerr << "Wrong text for " << id << endl;
+                    exit(1);
+                }
+            }
+        }));
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    stats = cache.getStats();
+    if (stats.bytes > stats.maxBytes) {
+        cerr << "FAILED" << endl;
+        return 1;
+    }
+    cout << "OK" << endl;
+    return 0;
+}
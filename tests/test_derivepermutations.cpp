@@ -0,0 +1,145 @@
+#include <trident/kb/permsorter.h>
+#include <trident/kb/consts.h>
+#include <trident/utils/radixsort.h>
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <array>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+typedef std::array<unsigned char, 15> PackedTriple;
+
+struct Triple3 {
+    int64_t s, p, o;
+};
+
+//Fields (0 for s, 1 for p, 2 for o) in the order of every permutation
+static const int orders[][3] = {
+    { 0, 1, 2 }, //IDX_SPO
+    { 2, 1, 0 }, //IDX_OPS
+    { 1, 2, 0 }, //IDX_POS
+    { 0, 2, 1 }, //IDX_SOP
+    { 2, 0, 1 }, //IDX_OSP
+    { 1, 0, 2 }, //IDX_PSO
+};
+
+static void writeTerm(unsigned char *buffer, const int64_t n) {
+    buffer[0] = (n >> 32) & 0xFF;
+    buffer[1] = (n >> 24) & 0xFF;
+    buffer[2] = (n >> 16) & 0xFF;
+    buffer[3] = (n >> 8) & 0xFF;
+    buffer[4] = n & 0xFF;
+}
+
+//The unsorted buffer of a permutation, padded with 0xFF like in the loader
+static vector<PackedTriple> pack(const vector<Triple3> &triples, int perm,
+        int64_t size) {
+    vector<PackedTriple> packed(size);
+    for (size_t i = 0; i < triples.size(); ++i) {
+        const int64_t fields[3] = { triples[i].s, triples[i].p, triples[i].o };
+        for (int j = 0; j < 3; ++j) {
+            writeTerm(packed[i].data() + j * 5, fields[orders[perm][j]]);
+        }
+    }
+    for (size_t i = triples.size(); i < packed.size(); ++i) {
+        packed[i].fill(0xFF);
+    }
+    return packed;
+}
+
+//Skewed triples with duplicates. maxBits sets the size of the IDs
+static vector<Triple3> generate(int64_t n, int maxBits, std::mt19937_64 &gen) {
+    vector<Triple3> triples;
+    const int64_t range = (INT64_C(1) << maxBits) - 1;
+    std::geometric_distribution<int64_t> pred(0.05);
+    for (int64_t i = 0; i < n; ++i) {
+        Triple3 t;
+        t.s = gen() % (i % 5 ? range : 1000);
+        t.p = range - pred(gen);
+        t.o = i % 3 ? gen() % range : gen() % 100;
+        triples.push_back(t);
+        if (i % 11 == 0 && ++i < n) {
+            triples.push_back(t);
+        }
+    }
+    std::shuffle(triples.begin(), triples.end(), gen);
+    return triples;
+}
+
+//Every derived permutation must be the same as a full sort of its buffer
+static bool check(const vector<Triple3> &triples, const vector<int> &perms,
+        int nthreads) {
+    const int64_t n = triples.size();
+    const int64_t size = n + n / 10 + 1;
+    vector<PackedTriple> spo = pack(triples, IDX_SPO, size);
+    vector<vector<PackedTriple>> outputs(perms.size(),
+            vector<PackedTriple>(size));
+    std::vector<std::pair<char*, char>> others;
+    for (size_t i = 0; i < perms.size(); ++i) {
+        others.push_back(make_pair((char*) outputs[i].data(), (char) perms[i]));
+    }
+    vector<bool> derived(perms.size() + 1, false);
+    bool ok = true;
+    PermSorter::derivePermutations((char*) spo.data(), n, size, others,
+            nthreads, [&](int target, int source) {
+            //The source must be ready before the target
+            if (derived[target] || (source >= 0 && !derived[source])) {
+                ok = false;
+            }
+            derived[target] = true;
+            });
+    if (std::find(derived.begin(), derived.end(), false) != derived.end()) {
+        cerr << "Not all permutations were derived" << endl;
+        ok = false;
+    }
+
+    vector<PackedTriple> expected = pack(triples, IDX_SPO, size);
+    RadixSort<PackedTriple, PackedTripleKey<0, 5, 10>>::sort(&expected[0],
+            &expected[0] + size, 1);
+    if (spo != expected) {
+        cerr << "SPO is not sorted" << endl;
+        ok = false;
+    }
+    for (size_t i = 0; i < perms.size(); ++i) {
+        expected = pack(triples, perms[i], size);
+        RadixSort<PackedTriple, PackedTripleKey<0, 5, 10>>::sort(&expected[0],
+                &expected[0] + size, 1);
+        if (outputs[i] != expected) {
+            cerr << "Permutation " << perms[i] << " differs from a full sort" << endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int main(int argc, const char **argv) {
+    const int64_t n = argc > 1 ? atol(argv[1]) : 1000000;
+    std::mt19937_64 gen(42);
+    //The permutations of the loader, with and without aggregated indices
+    const vector<vector<int>> permSets = {
+        { IDX_SOP, IDX_OPS, IDX_OSP, IDX_POS, IDX_PSO },
+        { IDX_SOP, IDX_OPS, IDX_OSP },
+        { IDX_PSO, IDX_POS },
+    };
+    bool ok = true;
+    for (int64_t size : { (int64_t) 0, (int64_t) 1, (int64_t) 37, n }) {
+        for (int maxBits : { 20, 36, 40 }) {
+            const vector<Triple3> triples = generate(size, maxBits, gen);
+            for (auto &perms : permSets) {
+                for (int nthreads : { 1, 3, 8 }) {
+                    if (!check(triples, perms, nthreads)) {
+                        cerr << size << " triples, IDs of " << maxBits <<
+                            " bits, " << nthreads << " threads FAILED" << endl;
+                        ok = false;
+                    }
+                }
+            }
+        }
+    }
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include <trident/kb/dicthashindex.h>
+#include <trident/kb/statistics.h>
+#include <trident/tree/root.h>
+#include <trident/tree/stringbuffer.h>
+#include <trident/utils/propertymap.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+//Same configuration of the trees of the dictionary of the KB
+static PropertyMap getConfig() {
+    PropertyMap config;
+    config.setBool(TEXT_KEYS, true);
+    config.setBool(TEXT_VALUES, false);
+    config.setBool(COMPRESSED_NODES, false);
+    config.setInt(MAX_EL_PER_NODE, 2048);
+    config.setInt(FILE_MAX_SIZE, 64 * 1024 * 1024);
+    config.setLong(CACHE_MAX_SIZE, 1024 * 1024 * 1024);
+    config.setInt(NODE_MIN_BYTES, 0);
+    config.setInt(MAX_NODES_IN_CACHE, 100000);
+    config.setInt(LEAF_SIZE_FACTORY, 10);
+    config.setInt(LEAF_SIZE_PREALL_FACTORY, 10);
+    config.setInt(LEAF_ARRAYS_FACTORY_SIZE, 10);
+    config.setInt(LEAF_ARRAYS_PREALL_FACTORY_SIZE, 10);
+    config.setInt(LEAF_MAX_INTERNAL_LINES, 2048);
+    config.setInt(LEAF_MAX_PREALL_INTERNAL_LINES, 2048);
+    config.setInt(NODE_KEYS_FACTORY_SIZE, 10);
+    config.setInt(NODE_KEYS_PREALL_FACTORY_SIZE, 10);
+    config.setInt(MAX_N_OPENED_FILES, 1024);
+    return config;
+}
+
+int main(int argc, const char** argv) {
+    const string dir = "dicthash";
+    const string index = dir + "/index";
+    const int64_t n = argc > 1 ? atol(argv[1]) : 500000;
+    std::mt19937_64 gen(42);
+    bool ok = true;
+
+    std::vector<string> terms;
+    for (int64_t i = 0; i < n; ++i) {
+        terms.push_back("<http://example.org/resource/" + to_string(gen()) + ">");
+    }
+    sort(terms.begin(), terms.end());
+    terms.erase(unique(terms.begin(), terms.end()), terms.end());
+
+    Utils::create_directories(dir + "/dict");
+    PropertyMap config = getConfig();
+    {
+        Stats stats;
+        StringBuffer sb(dir, false, 10, 4096 * SB_BLOCK_SIZE, &stats);
+        Root dict(dir + "/dict", &sb, false, config);
+        for (int64_t id = 0; id < terms.size(); ++id) {
+            nTerm value = id;
+            dict.append((tTerm*) terms[id].c_str(), terms[id].size(), value);
+        }
+        DictHashIndex::create(&dict, &sb, index);
+    }
+
+    Stats stats;
+    StringBuffer sb(dir, true, 10, 4096 * SB_BLOCK_SIZE, &stats);
+    Root dict(dir + "/dict", &sb, true, config);
+    DictHashIndex hashidx(index, &sb);
+    for (int64_t id = 0; id < terms.size(); ++id) {
+        nTerm value;
+        if (!hashidx.get(terms[id].c_str(), terms[id].size(), &value) ||
+                value != id) {
+            cerr << "Wrong ID for " << terms[id] << endl;
+            ok = false;
+        }
+        string missing = terms[id] + "~";
+        if (hashidx.get(missing.c_str(), missing.size(), &value)) {
+            cerr << "The term " << missing << " should not exist" << endl;
+            ok = false;
+        }
+    }
+
+    //Random lookups with the tree and the hash index
+    std::vector<int64_t> queries;
+    for (int i = 0; i < 1000000; ++i) {
+        queries.push_back(gen() % terms.size());
+    }
+    std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
+    int64_t found = 0;
+    for (auto q : queries) {
+        nTerm value;
+        found += dict.get((tTerm*) terms[q].c_str(), terms[q].size(), &value);
+    }
+    std::chrono::duration<double> sec = std::chrono::system_clock::now() - start;
+    cout << "1M lookups tree: " << sec.count() * 1000 << "ms (" << found << " found)" << endl;
+    start = std::chrono::system_clock::now();
+    found = 0;
+    for (auto q : queries) {
+        nTerm value;
+        found += hashidx.get(terms[q].c_str(), terms[q].size(), &value);
+    }
+    sec = std::chrono::system_clock::now() - start;
+    cout << "1M lookups hash index: " << sec.count() * 1000 << "ms (" << found << " found)" << endl;
+
+    Utils::remove_all(dir);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+#include <trident/kb/fcdict.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+//Terms with long common prefixes, like the IRIs of a KB
+static string generateTerm(std::mt19937_64 &gen) {
+    static const char *prefixes[] = { "<http://dbpedia.org/resource/",
+        "<http://www.wikidata.org/entity/Q", "\"", "_:b" };
+    string term = prefixes[gen() % 4];
+    const int len = 1 + gen() % 30;
+    for (int i = 0; i < len; ++i) {
+        term += (char) ('a' + gen() % 26);
+    }
+    return term;
+}
+
+int main(int argc, const char** argv) {
+    const string dir = "fcdict";
+    const int64_t n = argc > 1 ? atol(argv[1]) : 1000000;
+    std::mt19937_64 gen(42);
+    bool ok = true;
+
+    //Unique terms with shuffled IDs. Some IDs are left unused
+    std::vector<string> terms;
+    {
+        std::vector<string> all;
+        for (int64_t i = 0; i < n; ++i) {
+            all.push_back(generateTerm(gen));
+        }
+        sort(all.begin(), all.end());
+        all.erase(unique(all.begin(), all.end()), all.end());
+        terms.resize(all.size() + all.size() / 10);
+        std::vector<int64_t> ids(terms.size());
+        for (int64_t i = 0; i < ids.size(); ++i) {
+            ids[i] = i;
+        }
+        shuffle(ids.begin(), ids.end(), gen);
+        for (int64_t i = 0; i < all.size(); ++i) {
+            terms[ids[i]] = all[i];
+        }
+    }
+
+    //The small buffer creates several runs
+    std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
+    {
+        FCDictBuilder builder(dir, 4 * 1024 * 1024);
+        for (int64_t id = 0; id < terms.size(); ++id) {
+            if (!terms[id].empty()) {
+                builder.add(terms[id].c_str(), terms[id].size(), id);
+            }
+        }
+        //Duplicates with a larger ID must be discarded
+        for (int64_t id = 0; id < 1000; ++id) {
+            if (!terms[id].empty()) {
+                builder.add(terms[id].c_str(), terms[id].size(),
+                        terms.size() + id);
+            }
+        }
+        builder.finish();
+    }
+    std::chrono::duration<double> sec = std::chrono::system_clock::now() - start;
+    uint64_t size = 0;
+    for (auto f : Utils::getFiles(dir)) {
+        size += Utils::fileSize(f);
+    }
+    cout << "Built: " << sec.count() * 1000 << "ms, " << size << " bytes" << endl;
+
+    FCDict dict(dir);
+    char buffer[MAX_TERM_SIZE];
+    int64_t nTerms = 0;
+    for (int64_t id = 0; id < terms.size(); ++id) {
+        int s;
+        const bool found = dict.getText(id, buffer, s);
+        if (terms[id].empty()) {
+            if (found) {
+                cerr << "ID " << id << " should not exist" << endl;
+                ok = false;
+            }
+            continue;
+        }
+        nTerms++;
+        if (!found || string(buffer, s) != terms[id]) {
+            cerr << "Wrong text for ID " << id << endl;
+            ok = false;
+        }
+        nTerm value;
+        if (!dict.getNumber(terms[id].c_str(), terms[id].size(), &value) ||
+                value != id) {
+            cerr << "Wrong ID for " << terms[id] << endl;
+            ok = false;
+        }
+        //Terms that are not in the dictionary
+        string missing = terms[id] + "~";
+        if (dict.getNumber(missing.c_str(), missing.size(), &value)) {
+            cerr << "The term " << missing << " should not exist" << endl;
+            ok = false;
+        }
+    }
+    if (dict.getNTerms() != nTerms) {
+        cerr << "Wrong number of terms " << dict.getNTerms() << endl;
+        ok = false;
+    }
+    nTerm value;
+    if (dict.getNumber("", 0, &value) || dict.getNumber("~", 1, &value)) {
+        cerr << "The terms before the first and after the last should not exist" << endl;
+        ok = false;
+    }
+
+    //Random lookups
+    start = std::chrono::system_clock::now();
+    int64_t bytes = 0;
+    for (int i = 0; i < 10000000; ++i) {
+        int s = 0;
+        if (dict.getText(gen() % terms.size(), buffer, s)) {
+            bytes += s;
+        }
+    }
+    sec = std::chrono::system_clock::now() - start;
+    cout << "10M getText: " << sec.count() * 1000 << "ms (" << bytes << " bytes)" << endl;
+    start = std::chrono::system_clock::now();
+    int64_t found = 0;
+    for (int i = 0; i < 1000000; ++i) {
+        const string &t = terms[gen() % terms.size()];
+        found += dict.getNumber(t.c_str(), t.size(), &value);
+    }
+    sec = std::chrono::system_clock::now() - start;
+    cout << "1M getNumber: " << sec.count() * 1000 << "ms (" << found << " found)" << endl;
+
+    Utils::remove_all(dir);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
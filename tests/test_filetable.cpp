@@ -0,0 +1,137 @@
+#include <trident/files/filetable.h>
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+using namespace std;
+
+struct DummyFile {
+    const int id;
+    DummyFile(int id) : id(id) {
+    }
+    bool isUsed() {
+        return false;
+    }
+};
+
+//The table used before by FileManager: one mutex and a list of the opened
+//files that is walked to find the file to close. It has no reference
+//counts, so the closed files are kept aside instead of being deleted.
+class LegacyTable {
+    private:
+        const int maxFiles;
+        DummyFile *openedFiles[MAX_N_FILES];
+        list<int> trackerOpenedFiles;
+        int nOpenedFiles;
+        std::vector<DummyFile*> closed;
+        std::mutex mutex;
+
+    public:
+        LegacyTable(int maxFiles) : maxFiles(maxFiles), nOpenedFiles(0) {
+            for (int i = 0; i < MAX_N_FILES; ++i) {
+                openedFiles[i] = NULL;
+            }
+        }
+
+        DummyFile *get(const int id) {
+            DummyFile *f = openedFiles[id];
+            if (f == NULL) {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (openedFiles[id] == NULL) {
+                    if (nOpenedFiles >= maxFiles) {
+                        int idxFileToRemove = trackerOpenedFiles.front();
+                        trackerOpenedFiles.pop_front();
+                        while (openedFiles[idxFileToRemove] == NULL ||
+                                openedFiles[idxFileToRemove]->isUsed()) {
+                            if (openedFiles[idxFileToRemove] == NULL) {
+                                nOpenedFiles--;
+                            }
+                            idxFileToRemove = trackerOpenedFiles.front();
+                            trackerOpenedFiles.pop_front();
+                        }
+                        closed.push_back(openedFiles[idxFileToRemove]);
+                        openedFiles[idxFileToRemove] = NULL;
+                        nOpenedFiles--;
+                    }
+                    openedFiles[id] = new DummyFile(id);
+                    trackerOpenedFiles.push_back(id);
+                    nOpenedFiles++;
+                }
+                f = openedFiles[id];
+            }
+            return f;
+        }
+
+        ~LegacyTable() {
+            for (int i = 0; i < MAX_N_FILES; ++i) {
+                delete openedFiles[i];
+            }
+            for (auto f : closed) {
+                delete f;
+            }
+        }
+};
+
+template<typename F>
+static double run(const int nthreads, const int nfiles, const int niters, F fn) {
+    std::vector<std::thread> threads;
+    std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
+    for (int t = 0; t < nthreads; ++t) {
+        threads.push_back(std::thread([t, nfiles, niters, &fn]() {
+                    std::mt19937 gen(t);
+                    for (int i = 0; i < niters; ++i) {
+                        fn(gen() % nfiles);
+                    }
+                    }));
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> sec = std::chrono::system_clock::now() - start;
+    return sec.count() * 1000;
+}
+
+int main(int argc, const char** argv) {
+    const int nfiles = 4000;
+    const int niters = 1000000;
+    std::atomic<bool> ok(true);
+    for (const int maxFiles : {nfiles, nfiles / 4}) {
+        cout << "Max opened files " << maxFiles << " of " << nfiles << endl;
+        for (int nthreads = 1; nthreads <= 64; nthreads *= 2) {
+            LegacyTable legacy(maxFiles);
+            const double t1 = run(nthreads, nfiles, niters, [&](const int id) {
+                    DummyFile *f = legacy.get(id);
+                    if (f->id != id) {
+                        ok = false;
+                    }
+                    });
+
+            FileTable<DummyFile> table(maxFiles);
+            auto create = [](const int id) {
+                return new DummyFile(id);
+            };
+            const double t2 = run(nthreads, nfiles, niters, [&](const int id) {
+                    DummyFile *f = table.acquire(id, create);
+                    if (f->id != id) {
+                        ok = false;
+                    }
+                    table.release(id);
+                    });
+            if (table.getNOpenedFiles() > maxFiles) {
+                cerr << "Too many opened files: " << table.getNOpenedFiles() << endl;
+                ok = false;
+            }
+            cout << "  threads " << nthreads << ": legacy " << t1 <<
+                "ms, sharded " << t2 << "ms (" << table.getNEvictions() <<
+                " evictions)" << endl;
+        }
+    }
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+#include <trident/tree/root.h>
+#include <trident/tree/coordinates.h>
+#include <trident/utils/propertymap.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <memory>
+
+using namespace std;
+
+//Small leaves and few of them in cache, so that the batches cross many
+//leaves and the leaves are evicted during the lookups
+static PropertyMap getConfig() {
+    PropertyMap config;
+    config.setBool(TEXT_KEYS, false);
+    config.setBool(TEXT_VALUES, false);
+    config.setBool(COMPRESSED_NODES, false);
+    config.setInt(MAX_EL_PER_NODE, 64);
+    config.setInt(FILE_MAX_SIZE, 64 * 1024 * 1024);
+    config.setLong(CACHE_MAX_SIZE, 1024 * 1024 * 1024);
+    config.setInt(NODE_MIN_BYTES, 0);
+    config.setInt(MAX_NODES_IN_CACHE, 8);
+    config.setInt(LEAF_SIZE_FACTORY, 10);
+    config.setInt(LEAF_SIZE_PREALL_FACTORY, 10);
+    config.setInt(LEAF_ARRAYS_FACTORY_SIZE, 10);
+    config.setInt(LEAF_ARRAYS_PREALL_FACTORY_SIZE, 10);
+    config.setInt(LEAF_MAX_INTERNAL_LINES, 64);
+    config.setInt(LEAF_MAX_PREALL_INTERNAL_LINES, 64);
+    config.setInt(NODE_KEYS_FACTORY_SIZE, 10);
+    config.setInt(NODE_KEYS_PREALL_FACTORY_SIZE, 10);
+    config.setInt(MAX_N_OPENED_FILES, 1024);
+    return config;
+}
+
+//Only the multiples of 3 are in the tree
+static void getCoordinates(int64_t key, TermCoordinates *value) {
+    value->clear();
+    value->set(0, key % 100, key * 3, key + 1, (char) (key % 64));
+    if (key % 2 == 0) {
+        value->set(4, key % 7, key * 5, 2 * key + 1, (char) (key % 32));
+    }
+}
+
+static bool equals(TermCoordinates &c1, TermCoordinates &c2) {
+    for (int perm = 0; perm < N_PARTITIONS; ++perm) {
+        if (c1.exists(perm) != c2.exists(perm)) {
+            return false;
+        }
+        if (c1.exists(perm) && (c1.getFileIdx(perm) != c2.getFileIdx(perm) ||
+                    c1.getMark(perm) != c2.getMark(perm) ||
+                    c1.getNElements(perm) != c2.getNElements(perm) ||
+                    c1.getStrategy(perm) != c2.getStrategy(perm))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//getMany must return the same as a get on every key
+static bool check(Root &root, const std::vector<nTerm> &keys, string label) {
+    std::vector<TermCoordinates> values(keys.size());
+    std::unique_ptr<bool[]> found(new bool[keys.size() + 1]);
+    root.getMany(keys.data(), keys.size(), values.data(), found.get());
+    int64_t nfound = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        TermCoordinates expected;
+        const bool exists = root.get(keys[i], &expected);
+        if (exists != found[i] || (exists && !equals(expected, values[i]))) {
+            cerr << label << ": wrong result for key " << keys[i] << endl;
+            return false;
+        }
+        nfound += exists;
+    }
+    cout << label << ": " << keys.size() << " keys, " << nfound << " found" << endl;
+    return true;
+}
+
+static bool checkAll(Root &root, const int64_t n, std::mt19937_64 &gen) {
+    bool ok = true;
+    ok &= check(root, std::vector<nTerm>(), "empty");
+
+    //Sorted, with the missing keys in between and around the tree
+    std::vector<nTerm> sorted;
+    for (int64_t key = -5; key < 3 * n + 10; ++key) {
+        sorted.push_back(key);
+    }
+    ok &= check(root, sorted, "sorted");
+
+    //Every key repeated a few times
+    std::vector<nTerm> duplicates;
+    for (int64_t key = 0; key < 3 * n; key += 1 + gen() % 50) {
+        for (int j = 0; j < 1 + (int) (gen() % 3); ++j) {
+            duplicates.push_back(key);
+        }
+    }
+    ok &= check(root, duplicates, "duplicates");
+
+    //The leaf must be searched again when a key goes back
+    std::vector<nTerm> unsorted = sorted;
+    shuffle(unsorted.begin(), unsorted.end(), gen);
+    ok &= check(root, unsorted, "unsorted");
+    std::vector<nTerm> descending(sorted.rbegin(), sorted.rend());
+    ok &= check(root, descending, "descending");
+
+    //Random keys, also repeated
+    std::vector<nTerm> random;
+    for (int i = 0; i < 100000; ++i) {
+        random.push_back(gen() % (3 * n + 3));
+    }
+    ok &= check(root, random, "random");
+    return ok;
+}
+
+int main(int argc, const char** argv) {
+    const string path = "getmany";
+    const int64_t n = 200000;
+    std::mt19937_64 gen(42);
+
+    if (Utils::exists(path)) {
+        Utils::remove_all(path);
+    }
+    bool ok = true;
+    {
+        PropertyMap config = getConfig();
+        Root root(path, NULL, false, config);
+        TermCoordinates value;
+        for (int64_t key = 0; key < n; ++key) {
+            getCoordinates(3 * key, &value);
+            root.append(3 * key, &value);
+        }
+        //Also on the tree that is being written
+        ok &= checkAll(root, n, gen);
+    }
+
+    PropertyMap config = getConfig();
+    Root root(path, NULL, true, config);
+    ok &= checkAll(root, n, gen);
+    Utils::remove_all(path);
+
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
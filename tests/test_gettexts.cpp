@@ -0,0 +1,127 @@
+#include <trident/kb/dictmgmt.h>
+#include <trident/kb/statistics.h>
+#include <trident/tree/root.h>
+#include <trident/tree/stringbuffer.h>
+#include <trident/utils/propertymap.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+//Same configuration of the trees of the dictionary of the KB
+static PropertyMap getConfig(bool textKeys) {
+    PropertyMap config;
+    config.setBool(TEXT_KEYS, textKeys);
+    config.setBool(TEXT_VALUES, !textKeys);
+    config.setBool(COMPRESSED_NODES, false);
+    config.setInt(MAX_EL_PER_NODE, 2048);
+    config.setInt(FILE_MAX_SIZE, 64 * 1024 * 1024);
+    config.setLong(CACHE_MAX_SIZE, 1024 * 1024 * 1024);
+    config.setInt(NODE_MIN_BYTES, 0);
+    config.setInt(MAX_NODES_IN_CACHE, 100000);
+    config.setInt(LEAF_SIZE_FACTORY, 10);
+    config.setInt(LEAF_SIZE_PREALL_FACTORY, 10);
+    config.setInt(LEAF_ARRAYS_FACTORY_SIZE, 10);
+    config.setInt(LEAF_ARRAYS_PREALL_FACTORY_SIZE, 10);
+    config.setInt(LEAF_MAX_INTERNAL_LINES, 2048);
+    config.setInt(LEAF_MAX_PREALL_INTERNAL_LINES, 2048);
+    config.setInt(NODE_KEYS_FACTORY_SIZE, 10);
+    config.setInt(NODE_KEYS_PREALL_FACTORY_SIZE, 10);
+    config.setInt(MAX_N_OPENED_FILES, 1024);
+    return config;
+}
+
+int main(int argc, const char** argv) {
+    const string dir = "gettexts";
+    const int64_t n = argc > 1 ? atol(argv[1]) : 1000000;
+    const int64_t nqueries = argc > 2 ? atol(argv[2]) : 2000000;
+    std::mt19937_64 gen(42);
+    bool ok = true;
+
+    //The texts are stored sorted, but the IDs are shuffled
+    std::vector<string> terms;
+    for (int64_t i = 0; i < n; ++i) {
+        terms.push_back("<http://example.org/resource/" + to_string(gen()) + ">");
+    }
+    sort(terms.begin(), terms.end());
+    terms.erase(unique(terms.begin(), terms.end()), terms.end());
+    std::vector<int64_t> ids(terms.size());
+    for (int64_t i = 0; i < ids.size(); ++i) {
+        ids[i] = i;
+    }
+    shuffle(ids.begin(), ids.end(), gen);
+    std::vector<string> textOf(terms.size());
+
+    Utils::create_directories(dir + "/dict");
+    Utils::create_directories(dir + "/invdict");
+    PropertyMap dictConfig = getConfig(true);
+    PropertyMap invdictConfig = getConfig(false);
+    {
+        Stats stats;
+        StringBuffer sb(dir, false, 10, 4096 * SB_BLOCK_SIZE, &stats);
+        Root dict(dir + "/dict", &sb, false, dictConfig);
+        Root invdict(dir + "/invdict", NULL, false, invdictConfig);
+        for (int64_t i = 0; i < terms.size(); ++i) {
+            nTerm id = ids[i];
+            const int64_t coordinates = sb.getSize();
+            dict.append((tTerm*) terms[i].c_str(), terms[i].size(), id);
+            invdict.put(id, coordinates);
+            textOf[id] = terms[i];
+        }
+    }
+
+    //A small cache, so that the order of the decoding matters
+    DictMgmt::Dict d;
+    d.sb = std::shared_ptr<StringBuffer>(new StringBuffer(dir, true, 10,
+                64 * SB_BLOCK_SIZE, d.stats.get()));
+    d.dict = std::shared_ptr<Root>(new Root(dir + "/dict", d.sb.get(), true,
+                dictConfig));
+    d.invdict = std::shared_ptr<Root>(new Root(dir + "/invdict", NULL, true,
+                invdictConfig));
+    DictMgmt mgmt(d, dir, false, "", "");
+
+    //Random IDs with duplicates and some unknown IDs
+    std::vector<uint64_t> queries(nqueries);
+    for (auto &q : queries) {
+        q = gen() % (terms.size() + terms.size() / 100);
+    }
+    std::unique_ptr<std::string[]> texts(new std::string[nqueries]);
+    std::unique_ptr<bool[]> found(new bool[nqueries]);
+
+    std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
+    std::string text;
+    for (auto q : queries) {
+        mgmt.getText(q, text);
+    }
+    std::chrono::duration<double> sec = std::chrono::system_clock::now() - start;
+    cout << "getText: " << sec.count() * 1000 << "ms" << endl;
+
+    for (int nthreads = 1; nthreads <= 8; nthreads *= 2) {
+        start = std::chrono::system_clock::now();
+        mgmt.getTexts(queries.data(), nqueries, texts.get(), found.get(),
+                nthreads);
+        sec = std::chrono::system_clock::now() - start;
+        cout << "getTexts " << nthreads << " threads: " << sec.count() * 1000
+            << "ms" << endl;
+        for (int64_t i = 0; i < nqueries; ++i) {
+            const bool exists = queries[i] < terms.size();
+            if (found[i] != exists || (exists && texts[i] != textOf[queries[i]])) {
+                cerr << "Wrong text for ID " << queries[i] << endl;
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    mgmt.clean();
+    Utils::remove_all(dir);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+#include <trident/kb/inlineliterals.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+using namespace std;
+
+static const string xsd = "\"^^<http://www.w3.org/2001/XMLSchema#";
+
+static bool inRanges(const vector<InlineLiterals::Range> &ranges, uint64_t id) {
+    for (const auto &r : ranges) {
+        if (id >= r.begin && id < r.end && (id < r.lo || id > r.hi))
+            return false;
+    }
+    return true;
+}
+
+//The permutations are sorted with five bytes per term
+static bool fitsInSort(uint64_t id) {
+    return id < (UINT64_C(1) << 40) && InlineLiterals::isInlined(id);
+}
+
+static bool satisfies(double v, double c, InlineLiterals::Cmp cmp) {
+    switch (cmp) {
+        case InlineLiterals::LESS: return v < c;
+        case InlineLiterals::LESSOREQUAL: return v <= c;
+        case InlineLiterals::GREATER: return v > c;
+        default: return v >= c;
+    }
+}
+
+int main(int argc, const char** argv) {
+    const int n = argc > 1 ? atoi(argv[1]) : 100000;
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<double> mantissa(-1, 1);
+    bool ok = true;
+    char text[256];
+
+    //Numbers: the texts printed with %.<p>g are inlined only if canonical
+    vector<pair<double, uint64_t>> numbers;
+    for (int i = 0; i < n; ++i) {
+        double v = ldexp(mantissa(gen), (int) (gen() % 60) - 29);
+        if (i % 4 == 0)
+            v = (double) ((int64_t) (gen() % 2000000) - 1000000);
+        snprintf(text, sizeof(text), "%.*g", (int) (gen() % 17) + 1, v);
+        const string lex(text);
+        const double value = atof(text);
+        const string t = "\"" + lex + xsd + (i % 2 ? "double>" : "decimal>");
+        uint64_t id;
+        if (!InlineLiterals::encode(t.c_str(), t.size(), id)) {
+            if (lex.find('e') == string::npos && lex.find('.') == string::npos) {
+                cerr << "The integer " << t << " should be inlined" << endl;
+                ok = false;
+            }
+            continue;
+        }
+        if (!fitsInSort(id)) {
+            cerr << "The ID of " << t << " is too large" << endl;
+            ok = false;
+        }
+        const int size = InlineLiterals::decode(id, text);
+        if (string(text, size) != t || InlineLiterals::getDouble(id) != value) {
+            cerr << "Wrong decoding of " << t << ": " << text << endl;
+            ok = false;
+        }
+        numbers.push_back(make_pair(value, id));
+    }
+    const char *rejected[] = { "\"1.50\"", "\"1e3\"", "\"-0\"", "\"+1\"",
+        "\"1.0\"", "\"abc\"", "\"1e300\"", "\"0.1\"", "\"3.14\"" };
+    for (auto r : rejected) {
+        const string t = r + xsd + "double>";
+        uint64_t id;
+        if (InlineLiterals::encode(t.c_str(), t.size(), id)) {
+            cerr << t << " should not be inlined" << endl;
+            ok = false;
+        }
+    }
+
+    //The order of the payloads is the order of the values
+    sort(numbers.begin(), numbers.end());
+    for (size_t i = 1; i < numbers.size(); ++i) {
+        int res;
+        InlineLiterals::compare(numbers[i - 1].second, numbers[i].second, res);
+        const int expected = numbers[i - 1].first < numbers[i].first ? -1 : 0;
+        if (res != expected) {
+            cerr << "Wrong order " << numbers[i - 1].first << " " <<
+                numbers[i].first << endl;
+            ok = false;
+        }
+    }
+
+    //The ranges keep exactly the values that satisfy the comparison. Also
+    //with constants that are not inlined
+    for (int i = 0; i < 200; ++i) {
+        double c = numbers[gen() % numbers.size()].first;
+        if (i % 2)
+            c = ldexp(mantissa(gen), (int) (gen() % 60) - 29);
+        snprintf(text, sizeof(text), "%.17g", c);
+        const string t = "\"" + string(text) + xsd + "double>";
+        const InlineLiterals::Cmp cmp = (InlineLiterals::Cmp) (gen() % 4);
+        vector<InlineLiterals::Range> ranges;
+        if (!InlineLiterals::getRanges(t.c_str(), t.size(), cmp, ranges)) {
+            cerr << "No ranges for " << t << endl;
+            ok = false;
+            continue;
+        }
+        for (const auto &v : numbers) {
+            if (inRanges(ranges, v.second) != satisfies(v.first, c, cmp)) {
+                cerr << "Wrong range " << t << " " << cmp << " " << v.first << endl;
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    //DateTimes
+    vector<pair<int64_t, uint64_t>> dates;
+    for (int i = 0; i < n; ++i) {
+        const int year = 1900 + gen() % 2100;
+        const int month = 1 + gen() % 12;
+        const int day = 1 + gen() % 28;
+        snprintf(text, sizeof(text), "%04d-%02d-%02dT%02d:%02d:%02d", year,
+                month, day, (int) (gen() % 24), (int) (gen() % 60),
+                (int) (gen() % 60));
+        string lex(text);
+        if (gen() % 2)
+            lex += "Z";
+        const string t = "\"" + lex + xsd + "dateTime>";
+        uint64_t id;
+        if (!InlineLiterals::encode(t.c_str(), t.size(), id)) {
+            cerr << t << " should be inlined" << endl;
+            ok = false;
+            continue;
+        }
+        if (!fitsInSort(id)) {
+            cerr << "The ID of " << t << " is too large" << endl;
+            ok = false;
+        }
+        const int size = InlineLiterals::decode(id, text);
+        if (string(text, size) != t) {
+            cerr << "Wrong decoding of " << t << ": " << text << endl;
+            ok = false;
+        }
+        dates.push_back(make_pair(InlineLiterals::getSeconds(id), id));
+    }
+    sort(dates.begin(), dates.end());
+    for (size_t i = 1; i < dates.size(); ++i) {
+        if (dates[i - 1].second > dates[i].second &&
+                dates[i - 1].first < dates[i].first) {
+            cerr << "Wrong order of the dateTimes" << endl;
+            ok = false;
+        }
+    }
+    //The constants can have fractions or be out of the inlined years
+    for (int i = 0; i < 200; ++i) {
+        const uint64_t cid = dates[gen() % dates.size()].second;
+        const int size = InlineLiterals::decode(cid, text);
+        string constant(text, size);
+        int64_t c = InlineLiterals::getSeconds(cid);
+        if (i % 4 == 1) {
+            constant.insert(20, ".5");
+        } else if (i % 4 == 2) {
+            constant.replace(1, 4, gen() % 2 ? "1850" : "4500");
+            c = constant[1] == '1' ? INT64_MIN : INT64_MAX;
+        }
+        const InlineLiterals::Cmp cmp = (InlineLiterals::Cmp) (gen() % 4);
+        vector<InlineLiterals::Range> ranges;
+        if (!InlineLiterals::getRanges(constant.c_str(), constant.size(), cmp,
+                    ranges)) {
+            cerr << "No ranges for " << constant << endl;
+            ok = false;
+            continue;
+        }
+        for (const auto &v : dates) {
+            //The fraction is ignored, like in Selection
+            const bool expected = satisfies(v.first, c, cmp);
+            if (inRanges(ranges, v.second) != expected) {
+                cerr << "Wrong range " << constant << " " << cmp << endl;
+                ok = false;
+                break;
+            }
+        }
+    }
+    const char *rejectedDates[] = { "2001-02-29T00:00:00", "1899-12-31T23:59:59",
+        "4000-01-01T00:00:00", "2001-01-01T00:00:00.5", "2001-01-01T00:00:00+01:00" };
+    for (auto r : rejectedDates) {
+        const string t = "\"" + string(r) + xsd + "dateTime>";
+        uint64_t id;
+        if (InlineLiterals::encode(t.c_str(), t.size(), id)) {
+            cerr << t << " should not be inlined" << endl;
+            ok = false;
+        }
+    }
+
+    cout << numbers.size() << " numbers and " << dates.size() <<
+        " dateTimes inlined" << endl;
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+#include <trident/loader.h>
+#include <trident/kb/kb.h>
+#include <trident/kb/kbconfig.h>
+#include <trident/kb/querier.h>
+#include <trident/kb/dictmgmt.h>
+#include <trident/kb/inlineliterals.h>
+#include <trident/server/server.h>
+#include <trident/utils/json.h>
+#include <layers/TridentLayer.hpp>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+static const string xsd = "\"^^<http://www.w3.org/2001/XMLSchema#";
+
+struct Literal {
+    string text;
+    double number;
+    string lex; //The dateTimes without fractions and timezones
+    bool inlined;
+};
+
+//Numbers and dateTimes that are inlined and others that stay in the
+//dictionary
+static void generate(vector<Literal> &numbers, vector<Literal> &dates) {
+    for (int i = 0; i < 200; ++i) {
+        Literal l;
+        switch (i % 3) {
+            case 0:
+                l.text = "\"" + to_string(i) + xsd + "double>";
+                l.number = i;
+                l.inlined = true;
+                break;
+            case 1:
+                l.text = "\"" + to_string(i) + ".5" + xsd + "decimal>";
+                l.number = i + 0.5;
+                l.inlined = true;
+                break;
+            default:
+                //The mantissa does not fit
+                l.text = "\"" + to_string(i) + ".1" + xsd + "double>";
+                l.number = i + 0.1;
+                l.inlined = false;
+        }
+        numbers.push_back(l);
+
+        const int year = 1980 + i % 40;
+        char text[64];
+        snprintf(text, sizeof(text), "%04d-%02d-%02dT10:20:30", year,
+                1 + i % 12, 1 + i % 28);
+        l.text = "\"" + string(text) + (i % 10 == 0 ? ".5Z" : "Z") + xsd +
+            "dateTime>";
+        l.lex = text;
+        l.inlined = i % 10 != 0;
+        dates.push_back(l);
+    }
+}
+
+//The decoded object of every triple must be the text that was loaded
+static bool checkTexts(KB &kb, const vector<Literal> &numbers,
+        const vector<Literal> &dates) {
+    vector<string> expected;
+    size_t expectedInlined = 0;
+    for (auto &l : numbers) {
+        expected.push_back(l.text);
+        expectedInlined += l.inlined;
+    }
+    for (auto &l : dates) {
+        expected.push_back(l.text);
+        expectedInlined += l.inlined;
+    }
+    sort(expected.begin(), expected.end());
+
+    bool ok = true;
+    DictMgmt *dict = kb.getDictMgmt();
+    Querier *q = kb.query();
+    PairItr *itr = q->get(IDX_SPO, -1, -1, -1);
+    vector<string> texts;
+    size_t inlined = 0;
+    char text[MAX_TERM_SIZE];
+    while (itr->hasNext()) {
+        itr->next();
+        const uint64_t id = itr->getValue2();
+        if (InlineLiterals::isInlined(id)) {
+            inlined++;
+            if (id >= (UINT64_C(1) << 40)) {
+                cerr << "The inlined ID " << id << " is too large" << endl;
+                ok = false;
+            }
+        }
+        int size;
+        if (!dict->getText(id, text, size)) {
+            cerr << "The ID " << id << " is not decoded" << endl;
+            ok = false;
+            continue;
+        }
+        const string t(text, size);
+        texts.push_back(t);
+        nTerm back;
+        if (!dict->getNumber(t.c_str(), t.size(), &back) || back != (nTerm) id) {
+            cerr << t << " is not encoded as " << id << endl;
+            ok = false;
+        }
+    }
+    q->releaseItr(itr);
+    delete q;
+    sort(texts.begin(), texts.end());
+    if (texts != expected) {
+        cerr << "The decoded literals differ from the loaded ones" << endl;
+        ok = false;
+    }
+    if (inlined != expectedInlined) {
+        cerr << inlined << " inlined literals instead of " << expectedInlined << endl;
+        ok = false;
+    }
+    return ok;
+}
+
+static int64_t countResults(TridentLayer &db, int64_t nterms, string query) {
+    JSON vars, bindings, stats;
+    TridentServer::execSPARQLQuery(query, false, nterms, db, false, true,
+            &vars, &bindings, &stats);
+    ostringstream out;
+    JSON::write(out, stats);
+    const string s = out.str();
+    const size_t pos = s.find("nresults");
+    if (pos == string::npos) {
+        return -1;
+    }
+    const size_t start = s.find_first_of("0123456789", pos);
+    return start == string::npos ? -1 : atol(s.c_str() + start);
+}
+
+//The range filters are pushed into the scans. The results must be the
+//same of a comparison on every value
+static bool checkFilters(KB &kb, const vector<Literal> &numbers,
+        const vector<Literal> &dates) {
+    bool ok = true;
+    TridentLayer db(kb);
+    const int64_t nterms = kb.getNTerms();
+    const string prefix = "PREFIX xsd: <http://www.w3.org/2001/XMLSchema#> ";
+    for (double c : { 0.0, 50.3, 66.5, 100.0, 133.1, 1000.0 }) {
+        ostringstream os;
+        os << c;
+        const string constant = os.str().find('.') == string::npos ?
+            os.str() + ".0" : os.str();
+        const char *ops[] = { "<", "<=", ">", ">=" };
+        for (int op = 0; op < 4; ++op) {
+            int64_t expected = 0;
+            for (auto &l : numbers) {
+                const double v = l.number;
+                expected += op == 0 ? v < c : (op == 1 ? v <= c :
+                        (op == 2 ? v > c : v >= c));
+            }
+            const string query = prefix + "SELECT ?s WHERE { ?s <http://p/value> ?v . FILTER (?v " +
+                ops[op] + " " + constant + ") }";
+            const int64_t n = countResults(db, nterms, query);
+            if (n != expected) {
+                cerr << query << ": " << n << " results instead of " <<
+                    expected << endl;
+                ok = false;
+            }
+        }
+    }
+
+    //The constants with a fraction are compared without it, also when the
+    //filter is not pushed. Some of them are on the second of a literal
+    vector<string> constants = { "1970-01-01T00:00:00", "1990-01-01T00:00:00",
+        "2000-01-01T00:00:00", "2019-01-01T00:00:00", "2030-01-01T00:00:00",
+        dates[7].lex + ".5", dates[23].lex + ".25", dates[10].lex + ".5" };
+    for (auto &constant : constants) {
+        const char *ops[] = { "<", "<=", ">", ">=" };
+        const string c = constant.substr(0, 19);
+        for (int op = 0; op < 4; ++op) {
+            int64_t expected = 0;
+            for (auto &l : dates) {
+                expected += op == 0 ? l.lex < c : (op == 1 ? l.lex <= c :
+                        (op == 2 ? l.lex > c : l.lex >= c));
+            }
+            const string query = prefix + "SELECT ?s WHERE { ?s <http://p/date> ?d . FILTER (?d " +
+                ops[op] + " \"" + constant + "Z\"^^xsd:dateTime) }";
+            const int64_t n = countResults(db, nterms, query);
+            if (n != expected) {
+                cerr << query << ": " << n << " results instead of " <<
+                    expected << endl;
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+int main(int argc, const char** argv) {
+    const string dir = "inlineliteralskb";
+    if (Utils::exists(dir)) {
+        Utils::remove_all(dir);
+    }
+    Utils::create_directories(dir + "/input");
+    vector<Literal> numbers, dates;
+    generate(numbers, dates);
+    {
+        ofstream out(dir + "/input/triples.nt");
+        for (size_t i = 0; i < numbers.size(); ++i) {
+            out << "<http://s" << i << "> <http://p/value> " <<
+                numbers[i].text << " ." << endl;
+            out << "<http://s" << i << "> <http://p/date> " <<
+                dates[i].text << " ." << endl;
+        }
+    }
+
+    ParamsLoad p;
+    p.triplesInputDir = dir + "/input";
+    p.kbDir = dir + "/kb";
+    p.tmpDir = p.kbDir;
+    p.parallelThreads = 2;
+    p.maxReadingThreads = 1;
+    p.sample = false;
+    p.inlineLiterals = true;
+    Loader loader;
+    loader.load(p);
+
+    bool ok = true;
+    {
+        KBConfig config;
+        KB kb(p.kbDir.c_str(), true, false, true, config);
+        ok &= checkTexts(kb, numbers, dates);
+        ok &= checkFilters(kb, numbers, dates);
+    }
+
+    Utils::remove_all(dir);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#include <trident/utils/memorybudget.h>
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static bool expect(string label, uint64_t value, uint64_t expected) {
+    if (value != expected) {
+        cerr << label << ": " << value << " instead of " << expected << endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, const char** argv) {
+    bool ok = true;
+
+    //Without a limit every stage gets what it asks for
+    {
+        MemoryBudget budget;
+        ok &= expect("no limit", budget.reserve("a", 1000, 10), 1000);
+        ok &= expect("no limit again", budget.reserve("b", 1000, 10), 1000);
+    }
+
+    {
+        MemoryBudget budget;
+        budget.setLimit(100);
+        ok &= expect("first", budget.reserve("a", 60, 10), 60);
+        //The stages split what is left
+        ok &= expect("split", budget.reserve("b", 60, 10), 40);
+        //Nothing is left, the minimum is reserved anyway
+        ok &= expect("minimum", budget.reserve("c", 50, 20), 20);
+        //A minimum larger than the request is not applied
+        ok &= expect("small request", budget.reserve("d", 5, 10), 5);
+
+        //Released memory can be reserved again
+        budget.release("a", 60);
+        budget.release("c", 20);
+        budget.release("d", 5);
+        ok &= expect("after release", budget.reserve("e", 100, 10), 60);
+        budget.release("e", 60);
+        budget.release("b", 40);
+        ok &= expect("all released", budget.reserve("f", 100, 10), 100);
+        budget.release("f", 100);
+
+        //The reservations are released at the end of the scope, also with
+        //exceptions
+        {
+            MemoryReservation r1(budget, "g", 70, 10);
+            ok &= expect("reservation", r1.getSize(), 70);
+            MemoryReservation r2(budget, "h", 70, 10);
+            ok &= expect("reservation split", r2.getSize(), 30);
+        }
+        try {
+            MemoryReservation r(budget, "i", 80, 10);
+            throw 10;
+        } catch (int) {
+        }
+        MemoryReservation r(budget, "j", 100, 10);
+        ok &= expect("reservations released", r.getSize(), 100);
+    }
+
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
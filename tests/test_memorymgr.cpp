@@ -0,0 +1,86 @@
+#include <trident/utils/memorymgr.h>
+
+#include <iostream>
+#include <atomic>
+
+using namespace std;
+
+#define N_SLOTS 10000
+#define BLOCK_SIZE 10
+
+//Behaves like the files tracked by the MemoryManager
+struct Element {
+    MemoryManager<Element> *tracker;
+    std::atomic<Element*> *slots;
+    int id;
+    int trackerId;
+
+    Element(MemoryManager<Element> *tracker, std::atomic<Element*> *slots,
+            int id) : tracker(tracker), slots(slots), id(id) {
+        slots[id] = this;
+        trackerId = tracker->add(BLOCK_SIZE, this, id, slots);
+    }
+
+    ~Element() {
+        tracker->removeBlockWithoutDeallocation(trackerId);
+    }
+};
+
+static std::atomic<Element*> slots[N_SLOTS];
+
+static void access(MemoryManager<Element> &mgr, int id) {
+    Element *e = slots[id];
+    if (e == NULL) {
+        e = new Element(&mgr, slots, id);
+    }
+    mgr.access(e->trackerId);
+}
+
+//Returns how many of the hot elements survive a scan
+static int run(MemoryPolicy policy) {
+    for (int i = 0; i < N_SLOTS; ++i) {
+        slots[i] = NULL;
+    }
+    const int nHot = 20;
+    const int hotElements = 0;
+    MemoryManager<Element> mgr(100 * BLOCK_SIZE, policy);
+
+    //The hot elements are used by many queries
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < nHot; ++i) {
+            access(mgr, hotElements + i);
+        }
+        for (int i = 0; i < 200; ++i) {
+            access(mgr, 1000 + round * 200 + i);
+        }
+    }
+    //Large scan
+    for (int i = 5000; i < N_SLOTS; ++i) {
+        access(mgr, i);
+    }
+
+    int survived = 0;
+    for (int i = 0; i < nHot; ++i) {
+        if (slots[hotElements + i] != NULL) {
+            survived++;
+        }
+    }
+    MemoryManagerStats stats = mgr.getStats();
+    cout << (policy == MEMPOLICY_2Q ? "2Q" : "FIFO") << ": hot elements "
+        << survived << "/" << nHot << " hits " << stats.hits << " misses "
+        << stats.misses << " evictions " << stats.evictions << " bytes "
+        << stats.bytes << "/" << stats.maxBytes << endl;
+    if (stats.bytes > stats.maxBytes) {
+        cerr << "The cache is too large" << endl;
+        return -1;
+    }
+    return survived;
+}
+
+int main(int argc, const char** argv) {
+    const int fifo = run(MEMPOLICY_FIFO);
+    const int twoq = run(MEMPOLICY_2Q);
+    const bool ok = fifo == 0 && twoq == 20;
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,242 @@
+#include <trident/binarytables/storagestrat.h>
+#include <trident/binarytables/factorytables.h>
+#include <trident/binarytables/newtable.h>
+#include <trident/binarytables/tableshandler.h>
+#include <trident/kb/statistics.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+typedef std::vector<std::pair<uint64_t, uint64_t>> Pairs;
+
+//Sorted pairs without duplicates. The values fit in the five bytes of the
+//row and cluster layouts
+static Pairs generate(size_t n, int nfirst, uint64_t range, std::mt19937_64 &gen) {
+    Pairs pairs;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t v1 = gen() % nfirst;
+        uint64_t v2 = gen() % range;
+        if (i % 97 == 0) {
+            v2 = ((uint64_t) 1 << 38) + (gen() % ((uint64_t) 1 << 38));
+        }
+        pairs.push_back(make_pair(v1 * 1000, v2));
+    }
+    sort(pairs.begin(), pairs.end());
+    pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+    return pairs;
+}
+
+static bool same(PairItr *t, const Pairs &pairs, size_t i) {
+    return i < pairs.size() && (uint64_t) t->getValue1() == pairs[i].first &&
+        (uint64_t) t->getValue2() == pairs[i].second;
+}
+
+//The reference is a linear scan of the table with next()
+static bool scan(PairItr *t, const Pairs &pairs, Pairs &scanned) {
+    while (t->hasNext()) {
+        t->next();
+        scanned.push_back(make_pair(t->getValue1(), t->getValue2()));
+    }
+    return scanned == pairs;
+}
+
+//The first pair >= target from the position current, read linearly
+static size_t linearSearch(const Pairs &scanned, size_t current,
+        const std::pair<uint64_t, uint64_t> &target) {
+    while (current < scanned.size() && scanned[current] < target) {
+        current++;
+    }
+    return current;
+}
+
+//After the moveto, the next pair must be the one of the linear scan
+static bool checkTarget(PairItr *t, const Pairs &scanned, size_t &current,
+        const std::pair<uint64_t, uint64_t> &target) {
+    t->moveto(target.first, target.second);
+    const size_t expected = linearSearch(scanned, current, target);
+    if (expected >= scanned.size()) {
+        current = scanned.size();
+        return !t->hasNext();
+    }
+    if (!t->hasNext()) {
+        return false;
+    }
+    t->next();
+    current = expected;
+    return same(t, scanned, expected);
+}
+
+//Increasing targets with short and long jumps, some of them not in the
+//table
+static bool checkJumps(PairItr *t, const Pairs &scanned, size_t maxJump,
+        std::mt19937_64 &gen) {
+    if (!t->hasNext()) {
+        return scanned.empty();
+    }
+    t->next();
+    size_t current = 0;
+    while (current < scanned.size()) {
+        const size_t jump = gen() % maxJump;
+        if (current + jump >= scanned.size()) {
+            break;
+        }
+        std::pair<uint64_t, uint64_t> target = scanned[current + jump];
+        const int r = gen() % 4;
+        if (r == 1) {
+            target.second++; //Maybe missing
+        } else if (r == 2) {
+            target = make_pair(target.first + 1, 0); //Missing first term
+        }
+        if (!checkTarget(t, scanned, current, target)) {
+            cerr << "moveto(" << target.first << "," << target.second <<
+                ") after a jump of " << jump << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+//The first and the last pairs, and the pairs after the last one
+static bool checkBorders(AbsNewTable *t, const char *s, const char *e,
+        const Pairs &scanned) {
+    const std::pair<uint64_t, uint64_t> first = scanned.front();
+    const std::pair<uint64_t, uint64_t> last = scanned.back();
+    const std::pair<uint64_t, uint64_t> targets[] = { first, last,
+        make_pair(last.first, last.second + 1),
+        make_pair(last.first + 1, 0),
+        make_pair(first.first, 0) };
+    for (auto &target : targets) {
+        t->setup(s, e);
+        if (!t->hasNext()) {
+            return false;
+        }
+        t->next();
+        size_t current = 0;
+        if (!checkTarget(t, scanned, current, target)) {
+            cerr << "moveto(" << target.first << "," << target.second <<
+                ") from the first pair" << endl;
+            return false;
+        }
+        //The rest of the table is read after the moveto
+        while (current + 1 < scanned.size()) {
+            if (!t->hasNext()) {
+                return false;
+            }
+            t->next();
+            if (!same(t, scanned, ++current)) {
+                return false;
+            }
+        }
+        if (t->hasNext()) {
+            return false;
+        }
+    }
+    //From the last pair, backwards targets do not move
+    t->setup(s, e);
+    size_t current = 0;
+    while (t->hasNext()) {
+        t->next();
+        current++;
+    }
+    current--;
+    return checkTarget(t, scanned, current, first) &&
+        !t->hasNext();
+}
+
+int main(int argc, const char** argv) {
+    const string dir = "moveto";
+    if (Utils::exists(dir)) {
+        Utils::remove_all(dir);
+    }
+    std::mt19937_64 gen(42);
+
+    //Tables of one pair, with many first terms, with a single first term
+    //and a long list of second terms, and mixed
+    std::vector<Pairs> tables;
+    for (size_t n : { 1, 2, 129, 5000, 100000 }) {
+        tables.push_back(generate(n, 1 + n / 50, 1000, gen));
+        tables.push_back(generate(n, n, 3, gen));
+        tables.push_back(generate(n, 1, (uint64_t) 1 << 34, gen));
+    }
+
+    const std::pair<string, char> layouts[] = {
+        make_pair("column", (char) FIXEDSTRAT5),
+        make_pair("row", (char) FIXEDSTRAT6),
+        make_pair("cluster", (char) FIXEDSTRAT7),
+        make_pair("packed", (char) StorageStrat::setStorageType(0,
+                    PACKED_STORAGE)) };
+
+    Factory<NewColumnTable> ncFactory;
+    FactoryNewRowTable nrFactory;
+    FactoryNewClusterTable ncluFactory;
+    Factory<PackedTable> packedFactory;
+    Factory<NewColumnTableInserter> ncFactory_i;
+    Factory<NewRowTableInserter> nrFactory_i;
+    Factory<NewClusterTableInserter> ncluFactory_i;
+    Factory<PackedTableInserter> packedFactory_i;
+    StorageStrat strat;
+    strat.init(&ncFactory, &nrFactory, &ncluFactory, &packedFactory, NULL,
+            NULL, NULL, &ncFactory_i, &nrFactory_i, &ncluFactory_i,
+            &packedFactory_i);
+
+    bool ok = true;
+    for (auto &layout : layouts) {
+        const string tableDir = dir + "/" + layout.first;
+        //TableStorage creates the directory
+        Stats stats;
+        std::vector<int64_t> marks;
+        {
+            TableStorage storage(false, tableDir, 64 * 1024 * 1024, 10, NULL,
+                    stats, 0);
+            for (size_t i = 0; i < tables.size(); ++i) {
+                BinaryTableInserter *inserter = strat.getBinaryTableInserter(
+                        layout.second);
+                marks.push_back(storage.startAppend(i, layout.second,
+                            inserter));
+                for (auto &p : tables[i]) {
+                    storage.append(p.first, p.second);
+                }
+                storage.stopAppend();
+                if (storage.getLastCreatedFile() != 0) {
+                    cerr << "The tables should be in one file" << endl;
+                    return 1;
+                }
+            }
+        }
+
+        TableStorage storage(true, tableDir, 64 * 1024 * 1024, 10, NULL,
+                stats, 0);
+        for (size_t i = 0; i < tables.size(); ++i) {
+            const Pairs &pairs = tables[i];
+            std::pair<const char*, const char*> table = storage.getTable(0,
+                    marks[i]);
+            AbsNewTable *t = (AbsNewTable*) strat.getBinaryTable(layout.second);
+            Pairs scanned;
+            t->setup(table.first, table.second);
+            bool tableOk = scan(t, pairs, scanned);
+            for (size_t maxJump : { (size_t) 4, (size_t) 64,
+                    pairs.size() / 4 + 1 }) {
+                t->setup(table.first, table.second);
+                tableOk &= tableOk && checkJumps(t, scanned, maxJump, gen);
+            }
+            tableOk &= tableOk && checkBorders(t, table.first, table.second,
+                    scanned);
+            if (!tableOk) {
+                cerr << "Table " << i << " (" << pairs.size() << " rows, " <<
+                    layout.first << ") FAILED" << endl;
+                ok = false;
+            }
+        }
+    }
+
+    Utils::remove_all(dir);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
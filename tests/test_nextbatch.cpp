@@ -0,0 +1,131 @@
+#include <trident/loader.h>
+#include <trident/kb/kb.h>
+#include <trident/kb/kbconfig.h>
+#include <trident/kb/querier.h>
+#include <trident/kb/updater.h>
+#include <trident/iterators/pairitr.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <tuple>
+#include <string>
+
+using namespace std;
+
+typedef std::tuple<int64_t, int64_t, int64_t> ScanRow;
+
+//Few subjects with many objects each, so that the scans cross many keys
+static void writeTriples(string file, int nsubjects, int nobjects) {
+    ofstream out(file);
+    for (int s = 0; s < nsubjects; ++s) {
+        for (int o = 0; o < nobjects; ++o) {
+            out << "<http://s" << s << "> <http://p" << (o % 3) <<
+                "> <http://o" << o << "> ." << endl;
+        }
+    }
+}
+
+static vector<ScanRow> scanOneByOne(Querier *q, int perm) {
+    vector<ScanRow> out;
+    PairItr *itr = q->get(perm, -1, -1, -1);
+    while (itr->hasNext()) {
+        itr->next();
+        out.push_back(ScanRow(itr->getKey(), itr->getValue1(),
+                    itr->getValue2()));
+    }
+    q->releaseItr(itr);
+    return out;
+}
+
+//Label every batch with the key read after it, like TridentLayer::query
+static vector<ScanRow> scanBatches(Querier *q, int perm, size_t batchSize) {
+    vector<ScanRow> out;
+    vector<uint64_t> v1(batchSize), v2(batchSize);
+    PairItr *itr = q->get(perm, -1, -1, -1);
+    size_t n;
+    while ((n = itr->nextBatch(v1.data(), v2.data(), batchSize)) > 0) {
+        const int64_t key = itr->getKey();
+        for (size_t i = 0; i < n; ++i) {
+            out.push_back(ScanRow(key, v1[i], v2[i]));
+        }
+    }
+    q->releaseItr(itr);
+    return out;
+}
+
+static bool checkScans(string kbDir, string label, size_t ntriples) {
+    bool ok = true;
+    KBConfig config;
+    KB kb(kbDir.c_str(), true, false, true, config);
+    Querier *q = kb.query();
+    for (int perm = 0; perm < 6; ++perm) {
+        vector<ScanRow> expected = scanOneByOne(q, perm);
+        if (expected.size() != ntriples) {
+            cout << label << ": perm " << perm << " has " << expected.size() <<
+                " triples instead of " << ntriples << endl;
+            ok = false;
+        }
+        for (size_t batchSize : { (size_t) 1, (size_t) 7, (size_t) 4096 }) {
+            if (scanBatches(q, perm, batchSize) != expected) {
+                cout << label << ": perm " << perm << " batch " <<
+                    batchSize << " differs from next()" << endl;
+                ok = false;
+            }
+        }
+    }
+    delete q;
+    return ok;
+}
+
+int main(int argc, const char **argv) {
+    const string dir = "nextbatch";
+    if (Utils::exists(dir)) {
+        Utils::remove_all(dir);
+    }
+    Utils::create_directories(dir + "/input");
+    Utils::create_directories(dir + "/rm");
+    Utils::create_directories(dir + "/add");
+    writeTriples(dir + "/input/triples.nt", 20, 50);
+
+    ParamsLoad p;
+    p.triplesInputDir = dir + "/input";
+    p.kbDir = dir + "/kb";
+    p.tmpDir = p.kbDir;
+    p.parallelThreads = 2;
+    p.maxReadingThreads = 1;
+    p.sample = false;
+    Loader loader;
+    loader.load(p);
+    bool ok = checkScans(p.kbDir, "loaded", 1000);
+
+    //Remove the last triple of a subject and the first of the following
+    //one: the RmItr of the scan crosses the key between them
+    {
+        ofstream out(dir + "/rm/rm.nt");
+        out << "<http://s3> <http://p1> <http://o49> ." << endl;
+        out << "<http://s4> <http://p0> <http://o0> ." << endl;
+        out << "<http://s4> <http://p1> <http://o1> ." << endl;
+    }
+    Updater rm;
+    rm.creatediffupdate(DiffIndex::TypeUpdate::DELETE_df, p.kbDir, dir + "/rm");
+    ok &= checkScans(p.kbDir, "removed", 997);
+
+    //New subjects and new pairs of existing subjects
+    {
+        ofstream out(dir + "/add/add.nt");
+        out << "<http://s3> <http://p2> <http://new0> ." << endl;
+        out << "<http://new1> <http://p0> <http://o0> ." << endl;
+        out << "<http://new1> <http://p0> <http://o1> ." << endl;
+        out << "<http://s5> <http://p0> <http://new2> ." << endl;
+    }
+    Updater add;
+    add.creatediffupdate(DiffIndex::TypeUpdate::ADDITION_df, p.kbDir, dir + "/add");
+    ok &= checkScans(p.kbDir, "added", 1001);
+
+    Utils::remove_all(dir);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
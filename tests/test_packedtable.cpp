@@ -0,0 +1,226 @@
+#include <trident/binarytables/packedtable.h>
+#include <trident/binarytables/packedtableinserter.h>
+#include <trident/binarytables/tableshandler.h>
+#include <trident/kb/statistics.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+typedef std::vector<std::pair<uint64_t, uint64_t>> Pairs;
+
+//Sorted pairs without duplicates. Large values produce exceptions in the
+//bit-packed columns
+static Pairs generate(size_t n, int nfirst, uint64_t range, std::mt19937_64 &gen) {
+    Pairs pairs;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t v1 = gen() % nfirst;
+        uint64_t v2 = gen() % range;
+        if (i % 97 == 0) {
+            v2 = ((uint64_t) 1 << 38) + (gen() % ((uint64_t) 1 << 38));
+        }
+        pairs.push_back(make_pair(v1 * 1000, v2));
+    }
+    sort(pairs.begin(), pairs.end());
+    pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+    return pairs;
+}
+
+static bool same(PackedTable &t, const Pairs &pairs, size_t i) {
+    return i < pairs.size() && (uint64_t) t.getValue1() == pairs[i].first &&
+        (uint64_t) t.getValue2() == pairs[i].second;
+}
+
+static bool checkNext(PackedTable &t, const Pairs &pairs) {
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (!t.hasNext()) {
+            return false;
+        }
+        t.next();
+        if (!same(t, pairs, i)) {
+            return false;
+        }
+    }
+    return !t.hasNext();
+}
+
+static bool checkBatches(PackedTable &t, const Pairs &pairs, size_t batchSize) {
+    std::vector<uint64_t> v1(batchSize), v2(batchSize);
+    size_t i = 0;
+    size_t n;
+    while ((n = t.nextBatch(v1.data(), v2.data(), batchSize)) > 0) {
+        for (size_t j = 0; j < n; ++j, ++i) {
+            if (i >= pairs.size() || v1[j] != pairs[i].first ||
+                    v2[j] != pairs[i].second) {
+                return false;
+            }
+        }
+        //Positioned on the last pair of the batch
+        if (!same(t, pairs, i - 1)) {
+            return false;
+        }
+    }
+    return i == pairs.size();
+}
+
+//Increasing targets, some of them not in the table. After every moveto the
+//next pair is read one by one or with a batch
+static bool checkMoveto(PackedTable &t, const Pairs &pairs, std::mt19937_64 &gen) {
+    t.next();
+    size_t current = 0;
+    std::vector<uint64_t> v1(300), v2(300);
+    while (true) {
+        const size_t jump = gen() % 400;
+        if (current + jump >= pairs.size()) {
+            break;
+        }
+        std::pair<uint64_t, uint64_t> target = pairs[current + jump];
+        if (gen() % 2) {
+            target.second++;
+        }
+        t.moveto(target.first, target.second);
+        size_t expected = max(current, (size_t) (lower_bound(pairs.begin(),
+                        pairs.end(), target) - pairs.begin()));
+        if (expected >= pairs.size()) {
+            return !t.hasNext();
+        }
+        if (!t.hasNext()) {
+            return false;
+        }
+        if (gen() % 2) {
+            t.next();
+            if (!same(t, pairs, expected)) {
+                return false;
+            }
+            current = expected;
+        } else {
+            const size_t n = t.nextBatch(v1.data(), v2.data(), v1.size());
+            for (size_t j = 0; j < n; ++j) {
+                if (v1[j] != pairs[expected + j].first ||
+                        v2[j] != pairs[expected + j].second) {
+                    return false;
+                }
+            }
+            current = expected + n - 1;
+        }
+    }
+    return true;
+}
+
+static bool checkFirstColumn(PackedTable &t, const Pairs &pairs) {
+    t.ignoreSecondColumn();
+    size_t i = 0;
+    while (i < pairs.size()) {
+        size_t j = i;
+        while (j < pairs.size() && pairs[j].first == pairs[i].first) {
+            j++;
+        }
+        if (!t.hasNext()) {
+            return false;
+        }
+        t.next();
+        if ((uint64_t) t.getValue1() != pairs[i].first ||
+                t.getCount() != (int64_t) (j - i)) {
+            return false;
+        }
+        i = j;
+    }
+    return !t.hasNext();
+}
+
+static bool checkConstraints(PackedTable &t, const char *s, const char *e,
+        const Pairs &pairs, std::mt19937_64 &gen) {
+    if (pairs.empty()) {
+        return true;
+    }
+    const std::pair<uint64_t, uint64_t> p = pairs[gen() % pairs.size()];
+    Pairs withFirst;
+    for (auto &pair : pairs) {
+        if (pair.first == p.first) {
+            withFirst.push_back(pair);
+        }
+    }
+    t.setup(p.first, s, e);
+    if (!checkNext(t, withFirst)) {
+        return false;
+    }
+    t.setup(p.first + 1, s, e);
+    if (t.hasNext()) {
+        return false;
+    }
+    t.setup(p.first, p.second, s, e);
+    if (!checkNext(t, Pairs(1, p))) {
+        return false;
+    }
+    t.setup(p.first, p.second + 1, s, e);
+    return t.hasNext() == binary_search(pairs.begin(), pairs.end(),
+            make_pair(p.first, p.second + 1));
+}
+
+int main(int argc, const char** argv) {
+    const string dir = "packedtable";
+    if (Utils::exists(dir)) {
+        Utils::remove_all(dir);
+    }
+    std::mt19937_64 gen(42);
+
+    //Tables of one block, of partial blocks and of many blocks
+    std::vector<Pairs> tables;
+    for (size_t n : { 1, 2, 127, 128, 129, 300, 5000, 100000 }) {
+        tables.push_back(generate(n, 1 + n / 50, 1000, gen));
+        tables.push_back(generate(n, 1, (uint64_t) 1 << 34, gen));
+    }
+
+    //TableStorage creates the directory
+    Stats stats;
+    std::vector<int64_t> marks;
+    {
+        TableStorage storage(false, dir, 64 * 1024 * 1024, 10, NULL, stats, 0);
+        PackedTableInserter inserter;
+        for (size_t i = 0; i < tables.size(); ++i) {
+            marks.push_back(storage.startAppend(i, 0, &inserter));
+            for (auto &p : tables[i]) {
+                storage.append(p.first, p.second);
+            }
+            storage.stopAppend();
+            if (storage.getLastCreatedFile() != 0) {
+                cerr << "The tables should be in one file" << endl;
+                return 1;
+            }
+        }
+    }
+
+    bool ok = true;
+    TableStorage storage(true, dir, 64 * 1024 * 1024, 10, NULL, stats, 0);
+    for (size_t i = 0; i < tables.size(); ++i) {
+        const Pairs &pairs = tables[i];
+        std::pair<const char*, const char*> table = storage.getTable(0, marks[i]);
+        PackedTable t;
+        bool tableOk = true;
+        t.setup(table.first, table.second);
+        tableOk &= checkNext(t, pairs);
+        for (size_t batchSize : { 1, 5, 128, 1000 }) {
+            t.setup(table.first, table.second);
+            tableOk &= checkBatches(t, pairs, batchSize);
+        }
+        t.setup(table.first, table.second);
+        tableOk &= checkMoveto(t, pairs, gen);
+        t.setup(table.first, table.second);
+        tableOk &= checkFirstColumn(t, pairs);
+        tableOk &= checkConstraints(t, table.first, table.second, pairs, gen);
+        if (!tableOk) {
+            cerr << "Table " << i << " (" << pairs.size() << " rows) FAILED" << endl;
+            ok = false;
+        }
+    }
+
+    Utils::remove_all(dir);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include <trident/files/prefetcher.h>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <atomic>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+//Usage: testPrefetcher <tmp dir>. To measure the effect on a cold page
+//cache, drop the caches before running it.
+int main(int argc, const char** argv) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <tmp dir>" << endl;
+        return 1;
+    }
+    const string file = string(argv[1]) + "/prefetch";
+    const uint64_t size = 256 * 1024 * 1024;
+    {
+        std::vector<char> data(1024 * 1024, 'a');
+        ofstream out(file, ios_base::binary);
+        for (uint64_t i = 0; i < size; i += data.size()) {
+            out.write(data.data(), data.size());
+        }
+    }
+    const int fd = open(file.c_str(), O_RDONLY);
+
+    //Random "tables" of up to 1MB
+    std::mt19937_64 gen(42);
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    uint64_t expected = 0;
+    for (int i = 0; i < 1000; ++i) {
+        const uint64_t len = gen() % (1024 * 1024);
+        const uint64_t start = gen() % (size - len);
+        ranges.push_back(make_pair(start, len));
+        expected += len;
+    }
+
+    bool ok = true;
+    for (const bool iouring : {false, true}) {
+        Prefetcher p(4, iouring);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (const auto &r : ranges) {
+            p.read(fd, r.first, r.second);
+        }
+        std::atomic<int> ntasks(0);
+        for (int i = 0; i < 100; ++i) {
+            p.run([&ntasks]() { ntasks++; });
+        }
+        p.wait();
+        std::chrono::duration<double> sec = std::chrono::steady_clock::now() - start;
+        PrefetchStats stats = p.getStats();
+        cout << (p.usesIOUring() ? "io_uring" : "threads") << ": " <<
+            stats.bytes << " bytes in " << sec.count() * 1000 << "ms" << endl;
+        if (stats.bytes != expected || ntasks != 100 || stats.tasks != 100 ||
+                stats.dropped != 0) {
+            cerr << "FAILED (expected " << expected << " bytes)" << endl;
+            ok = false;
+        }
+    }
+    close(fd);
+    unlink(file.c_str());
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+#include <trident/loader.h>
+#include <trident/kb/kb.h>
+#include <trident/kb/kbconfig.h>
+#include <trident/kb/querier.h>
+#include <trident/iterators/pairitr.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <tuple>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <memory>
+
+using namespace std;
+
+typedef std::tuple<int64_t, int64_t, int64_t> ScanRow;
+
+//Subjects with many objects, subjects with a single triple and predicates
+//of very different sizes, so that the tables have different layouts
+static void writeTriples(string file) {
+    ofstream out(file);
+    for (int s = 0; s < 30; ++s) {
+        for (int o = 0; o < 200; ++o) {
+            if (o % (s + 1) == 0) {
+                out << "<http://s" << s << "> <http://p" << (o % 4) <<
+                    "> <http://o" << o << "> ." << endl;
+            }
+        }
+    }
+    for (int s = 0; s < 100; ++s) {
+        out << "<http://single" << s << "> <http://rare> <http://o" << s <<
+            "> ." << endl;
+    }
+}
+
+static vector<ScanRow> read(Querier *q, PairItr *itr) {
+    vector<ScanRow> out;
+    if (itr->getTypeItr() != EMPTY_ITR) {
+        while (itr->hasNext()) {
+            itr->next();
+            out.push_back(ScanRow(itr->getKey(), itr->getValue1(),
+                        itr->getValue2()));
+        }
+        q->releaseItr(itr);
+    }
+    return out;
+}
+
+//Patterns built from the triples of the KB, with some terms replaced by
+//variables and some by terms that make the pattern empty. The patterns are
+//shuffled, so the input is not sorted
+static void getPatterns(const vector<ScanRow> &triples, const int64_t nterms,
+        const bool allowVars, std::mt19937_64 &gen, vector<int64_t> &s,
+        vector<int64_t> &p, vector<int64_t> &o) {
+    for (int i = 0; i < 3000; ++i) {
+        const ScanRow &t = triples[gen() % triples.size()];
+        int64_t terms[3] = { get<0>(t), get<1>(t), get<2>(t) };
+        for (int j = 0; j < 3; ++j) {
+            const int r = gen() % 10;
+            if (r == 0) {
+                terms[j] = nterms + gen() % 100; //Not in the KB
+            } else if (r == 1) {
+                terms[j] = gen() % nterms; //Maybe not in this position
+            } else if (r < 4 && allowVars) {
+                terms[j] = -1;
+            }
+        }
+        s.push_back(terms[0]);
+        p.push_back(terms[1]);
+        o.push_back(terms[2]);
+    }
+    //The same patterns again, and keys that repeat in the input
+    const size_t n = s.size();
+    for (size_t i = 0; i < n; i += 7) {
+        s.push_back(s[i]);
+        p.push_back(p[i]);
+        o.push_back(o[i]);
+    }
+    if (allowVars) {
+        s.push_back(-1);
+        p.push_back(-1);
+        o.push_back(-1);
+    }
+    vector<size_t> order(s.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), gen);
+    vector<int64_t> s2, p2, o2;
+    for (auto i : order) {
+        s2.push_back(s[i]);
+        p2.push_back(p[i]);
+        o2.push_back(o[i]);
+    }
+    s.swap(s2);
+    p.swap(p2);
+    o.swap(o2);
+}
+
+static bool checkExists(Querier *q, const vector<ScanRow> &triples,
+        const int64_t nterms, std::mt19937_64 &gen) {
+    vector<int64_t> s, p, o;
+    getPatterns(triples, nterms, false, gen, s, p, o);
+    std::unique_ptr<bool[]> out(new bool[s.size()]);
+    q->existsMany(s.data(), p.data(), o.data(), s.size(), out.get());
+    size_t nexist = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        const bool expected = q->exists(s[i], p[i], o[i]);
+        if (out[i] != expected) {
+            cerr << "existsMany(" << s[i] << "," << p[i] << "," << o[i] <<
+                ") is " << out[i] << endl;
+            return false;
+        }
+        nexist += expected;
+    }
+    cout << "existsMany: " << s.size() << " triples, " << nexist <<
+        " exist" << endl;
+    return true;
+}
+
+static bool checkCard(Querier *q, const vector<ScanRow> &triples,
+        const int64_t nterms, std::mt19937_64 &gen) {
+    vector<int64_t> s, p, o;
+    getPatterns(triples, nterms, true, gen, s, p, o);
+    std::unique_ptr<int64_t[]> out(new int64_t[s.size()]);
+    q->getCardMany(s.data(), p.data(), o.data(), s.size(), out.get());
+    for (size_t i = 0; i < s.size(); ++i) {
+        const int64_t expected = q->getCard(s[i], p[i], o[i]);
+        if (out[i] != expected) {
+            cerr << "getCardMany(" << s[i] << "," << p[i] << "," << o[i] <<
+                ") is " << out[i] << " instead of " << expected << endl;
+            return false;
+        }
+    }
+    cout << "getCardMany: " << s.size() << " patterns" << endl;
+    return true;
+}
+
+static bool checkGet(Querier *q, const int idx, const vector<ScanRow> &triples,
+        const int64_t nterms, std::mt19937_64 &gen) {
+    vector<int64_t> s, p, o;
+    getPatterns(triples, nterms, true, gen, s, p, o);
+    //Every iterator is kept open until the end
+    s.resize(500);
+    p.resize(500);
+    o.resize(500);
+    vector<PairItr*> out(s.size());
+    q->getMany(idx, s.data(), p.data(), o.data(), s.size(), out.data());
+    vector<vector<ScanRow>> results;
+    for (size_t i = 0; i < s.size(); ++i) {
+        results.push_back(read(q, out[i]));
+    }
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (results[i] != read(q, q->get(idx, s[i], p[i], o[i]))) {
+            cerr << "getMany(" << idx << "," << s[i] << "," << p[i] << "," <<
+                o[i] << ") differs from get" << endl;
+            return false;
+        }
+    }
+    cout << "getMany on " << idx << ": " << s.size() << " patterns" << endl;
+    return true;
+}
+
+int main(int argc, const char** argv) {
+    const string dir = "querymany";
+    if (Utils::exists(dir)) {
+        Utils::remove_all(dir);
+    }
+    Utils::create_directories(dir + "/input");
+    writeTriples(dir + "/input/triples.nt");
+
+    ParamsLoad p;
+    p.triplesInputDir = dir + "/input";
+    p.kbDir = dir + "/kb";
+    p.tmpDir = p.kbDir;
+    p.parallelThreads = 2;
+    p.maxReadingThreads = 1;
+    p.sample = false;
+    Loader loader;
+    loader.load(p);
+
+    bool ok = true;
+    {
+        KBConfig config;
+        KB kb(p.kbDir.c_str(), true, false, true, config);
+        Querier *q = kb.query();
+        const vector<ScanRow> triples = read(q, q->get(IDX_SPO, -1, -1, -1));
+        const int64_t nterms = kb.getNTerms();
+        std::mt19937_64 gen(42);
+        ok &= checkExists(q, triples, nterms, gen);
+        ok &= checkCard(q, triples, nterms, gen);
+        for (int idx = 0; idx < 6; ++idx) {
+            ok &= checkGet(q, idx, triples, nterms, gen);
+        }
+        delete q;
+    }
+
+    Utils::remove_all(dir);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+#include <trident/utils/radixsort.h>
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <array>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+typedef std::array<unsigned char, 15> PackedTriple;
+
+struct Triple3 {
+    uint64_t first, second, third;
+};
+
+static void writeTerm(unsigned char *buffer, const int64_t n) {
+    buffer[0] = (n >> 32) & 0xFF;
+    buffer[1] = (n >> 24) & 0xFF;
+    buffer[2] = (n >> 16) & 0xFF;
+    buffer[3] = (n >> 8) & 0xFF;
+    buffer[4] = n & 0xFF;
+}
+
+static double since(std::chrono::system_clock::time_point start) {
+    std::chrono::duration<double> d = std::chrono::system_clock::now() - start;
+    return d.count();
+}
+
+//Skewed triples: few predicates, popular subjects and objects
+static void generate(vector<Triple3> &triples, int64_t n, int seed) {
+    std::mt19937_64 gen(seed);
+    std::geometric_distribution<int64_t> pred(0.05);
+    std::uniform_int_distribution<int64_t> ent(0, n / 2);
+    for (int64_t i = 0; i < n; ++i) {
+        Triple3 t;
+        t.first = ent(gen);
+        t.second = 1000000 + pred(gen);
+        t.third = i % 3 ? ent(gen) : ent(gen) % 1000;
+        triples.push_back(t);
+    }
+}
+
+static bool checkPacked(int64_t n, int nthreads) {
+    vector<Triple3> triples;
+    generate(triples, n, 42);
+    vector<PackedTriple> packed(n + n / 10);
+    for (int64_t i = 0; i < n; ++i) {
+        //In the POS order
+        writeTerm(packed[i].data(), triples[i].second);
+        writeTerm(packed[i].data() + 5, triples[i].third);
+        writeTerm(packed[i].data() + 10, triples[i].first);
+    }
+    //Padding of the loader
+    for (size_t i = n; i < packed.size(); ++i) {
+        packed[i].fill(0xFF);
+    }
+    std::shuffle(packed.begin(), packed.end(), std::mt19937(1));
+    vector<PackedTriple> copy = packed;
+
+    auto start = std::chrono::system_clock::now();
+    std::sort(copy.begin(), copy.end());
+    const double tcmp = since(start);
+    start = std::chrono::system_clock::now();
+    RadixSort<PackedTriple, PackedTripleKey<0, 5, 10>>::sort(&packed[0],
+            &packed[0] + packed.size(), nthreads);
+    const double tradix = since(start);
+    cout << "Packed " << packed.size() << " threads " << nthreads <<
+        ": std::sort " << tcmp << "s radix " << tradix << "s" << endl;
+    return packed == copy;
+}
+
+static bool checkFields(int64_t n, int nthreads) {
+    vector<Triple3> triples;
+    generate(triples, n, 7);
+    vector<Triple3> copy = triples;
+    //OSP
+    auto cmp = [](const Triple3 &a, const Triple3 &b) {
+        if (a.third != b.third)
+            return a.third < b.third;
+        if (a.first != b.first)
+            return a.first < b.first;
+        return a.second < b.second;
+    };
+    auto start = std::chrono::system_clock::now();
+    std::sort(copy.begin(), copy.end(), cmp);
+    const double tcmp = since(start);
+    start = std::chrono::system_clock::now();
+    RadixSort<Triple3, FieldsTripleKey<2, 0, 1>>::sort(&triples[0],
+            &triples[0] + triples.size(), nthreads);
+    const double tradix = since(start);
+    cout << "Fields " << n << " threads " << nthreads << ": std::sort " <<
+        tcmp << "s radix " << tradix << "s" << endl;
+    for (int64_t i = 0; i < n; ++i) {
+        if (memcmp(&triples[i], &copy[i], sizeof(Triple3))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, const char **argv) {
+    const int64_t n = argc > 1 ? atol(argv[1]) : 5000000;
+    bool ok = true;
+    for (int64_t size : { (int64_t) 1, (int64_t) 20, (int64_t) 3000, n }) {
+        for (int nthreads : { 1, 4 }) {
+            ok &= checkPacked(size, nthreads);
+            ok &= checkFields(size, nthreads);
+        }
+    }
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
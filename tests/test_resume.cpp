@@ -0,0 +1,184 @@
+#include <trident/loader.h>
+#include <trident/kb/kb.h>
+#include <trident/kb/kbconfig.h>
+#include <trident/kb/querier.h>
+#include <trident/kb/dictmgmt.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+static void writeTriples(string file, int n, int first) {
+    ofstream out(file, first == 0 ? ios_base::out : ios_base::app);
+    for (int i = first; i < first + n; ++i) {
+        out << "<http://s" << (i / 10) << "> <http://p" << (i % 7) <<
+            "> <http://o" << (i % 1000) << "> ." << endl;
+    }
+}
+
+//The triples of the KB as text, sorted
+static vector<string> getTriples(string kbDir) {
+    vector<string> triples;
+    KBConfig config;
+    KB kb(kbDir.c_str(), true, false, true, config);
+    DictMgmt *dict = kb.getDictMgmt();
+    Querier *q = kb.query();
+    PairItr *itr = q->get(IDX_SPO, -1, -1, -1);
+    char text[MAX_TERM_SIZE];
+    while (itr->hasNext()) {
+        itr->next();
+        const int64_t terms[3] = { itr->getKey(), itr->getValue1(),
+            itr->getValue2() };
+        string triple;
+        for (int i = 0; i < 3; ++i) {
+            int size;
+            if (!dict->getText(terms[i], text, size)) {
+                triple += "ID:" + to_string(terms[i]);
+            } else {
+                triple += string(text, size);
+            }
+            triple += i < 2 ? " " : "";
+        }
+        triples.push_back(triple);
+    }
+    q->releaseItr(itr);
+    delete q;
+    sort(triples.begin(), triples.end());
+    return triples;
+}
+
+static ParamsLoad getParams(string input, string kbDir, bool resume) {
+    ParamsLoad p;
+    p.triplesInputDir = input;
+    p.kbDir = kbDir;
+    p.tmpDir = kbDir;
+    p.parallelThreads = 2;
+    p.maxReadingThreads = 1;
+    p.sample = false;
+    p.resume = resume;
+    return p;
+}
+
+static bool hasStage(string manifest, string stage) {
+    ifstream in(manifest);
+    string line;
+    while (getline(in, line)) {
+        if (line == stage || line.compare(0, stage.size() + 1, stage + " ") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//Loads in another process, which is killed as soon as the stage is in the
+//manifest. Returns false if the load finished before
+static bool loadAndKill(ParamsLoad p, string stage) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        Loader loader;
+        loader.load(p);
+        _exit(0);
+    }
+    const string manifest = p.tmpDir + "/load-manifest";
+    while (true) {
+        int status;
+        if (waitpid(pid, &status, WNOHANG) == pid) {
+            return false;
+        }
+        if (hasStage(manifest, stage)) {
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            return true;
+        }
+        usleep(100);
+    }
+}
+
+static bool hasDictFiles(string dir) {
+    for (auto &f : Utils::getFiles(dir)) {
+        if (Utils::starts_with(Utils::filename(f), "dict-")) {
+            return true;
+        }
+    }
+    for (auto &d : Utils::getSubdirs(dir)) {
+        if (Utils::starts_with(Utils::filename(d), "dict-")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//Interrupts the load at the stage, resumes it and compares the KB with the
+//expected triples
+static bool checkResume(string input, string kbDir, string stage,
+        const vector<string> &expected, bool changeInput) {
+    if (Utils::exists(kbDir)) {
+        Utils::remove_all(kbDir);
+    }
+    if (!loadAndKill(getParams(input, kbDir, true), stage)) {
+        cerr << "The load finished before the stage " << stage << endl;
+        return false;
+    }
+    if (!hasDictFiles(kbDir)) {
+        cerr << "The dictionary was not kept after the stage " << stage << endl;
+        return false;
+    }
+    if (changeInput) {
+        //Same path, but the input is different
+        writeTriples(input + "/triples.nt", 10, 1000000);
+    }
+    Loader loader;
+    loader.load(getParams(input, kbDir, true));
+    if (getTriples(kbDir) != expected) {
+        cerr << "The load resumed after the stage " << stage <<
+            (changeInput ? " with a new input" : "") <<
+            " differs from a fresh load" << endl;
+        return false;
+    }
+    cout << "Resumed after " << stage << (changeInput ? " with a new input" :
+            "") << endl;
+    return true;
+}
+
+int main(int argc, const char** argv) {
+    const string dir = "resume";
+    const int n = argc > 1 ? atoi(argv[1]) : 500000;
+    if (Utils::exists(dir)) {
+        Utils::remove_all(dir);
+    }
+    const string input = dir + "/input";
+    Utils::create_directories(input);
+    writeTriples(input + "/triples.nt", n, 0);
+
+    Loader loader;
+    loader.load(getParams(input, dir + "/fresh", false));
+    const vector<string> expected = getTriples(dir + "/fresh");
+
+    bool ok = true;
+    //Killed during the sort, or after it
+    ok &= checkResume(input, dir + "/kb", "encoded", expected, false);
+    ok &= checkResume(input, dir + "/kb", "sorted", expected, false);
+
+    //The input changes at the same path: the new triples must be loaded
+    const string changed = dir + "/changed";
+    Utils::create_directories(changed);
+    writeTriples(changed + "/triples.nt", n, 0);
+    writeTriples(changed + "/triples.nt", 10, 1000000);
+    loader.load(getParams(changed, dir + "/freshchanged", false));
+    const vector<string> expectedChanged = getTriples(dir + "/freshchanged");
+    ok &= checkResume(input, dir + "/kb", "sorted", expectedChanged, true);
+
+    Utils::remove_all(dir);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+#include <trident/kb/textindex.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+static const char *words[] = { "amsterdam", "berlin", "paris", "rome",
+    "london", "madrid", "vienna", "prague", "lisbon", "dublin", "oslo",
+    "athens", "warsaw", "budapest", "helsinki", "stockholm" };
+
+int main(int argc, const char** argv) {
+    const string dir = "textidx";
+    const int64_t n = argc > 1 ? atol(argv[1]) : 1000000;
+    std::mt19937_64 gen(42);
+    bool ok = true;
+
+    std::vector<string> terms;
+    for (int64_t i = 0; i < n; ++i) {
+        string t = "\"";
+        for (int j = gen() % 4; j >= 0; --j) {
+            t += words[gen() % 16];
+            t += " " + to_string(gen() % 100000) + " ";
+        }
+        terms.push_back(t + "\"@en");
+    }
+
+    //Small runs, so that they must be merged
+    {
+        TextIndexBuilder builder(dir, 16 * 1024 * 1024);
+        for (int64_t id = 0; id < terms.size(); ++id) {
+            builder.add(terms[id].c_str(), terms[id].size(), id);
+        }
+        //A duplicated term must not duplicate the IDs
+        builder.add(terms[0].c_str(), terms[0].size(), 0);
+        builder.finish();
+    }
+
+    TextIndex idx(dir);
+    std::vector<string> patterns = { "paris 12", "stockholm", "n 9999",
+        "rome 1 ", "zzz", "\"oslo", "ab", "dublin 4242" };
+    for (const auto &p : patterns) {
+        std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
+        std::vector<uint64_t> candidates;
+        const bool answered = idx.getCandidates(p.c_str(), p.size(),
+                UINT64_MAX, candidates);
+        std::vector<uint64_t> matches;
+        for (auto id : candidates) {
+            if (terms[id].find(p) != string::npos) {
+                matches.push_back(id);
+            }
+        }
+        std::chrono::duration<double> sec = std::chrono::system_clock::now() - start;
+        double secIndex = sec.count();
+
+        start = std::chrono::system_clock::now();
+        std::vector<uint64_t> expected;
+        for (int64_t id = 0; id < terms.size(); ++id) {
+            if (terms[id].find(p) != string::npos) {
+                expected.push_back(id);
+            }
+        }
+        sec = std::chrono::system_clock::now() - start;
+        if (p.size() < 3) {
+            if (answered) {
+                cerr << "The pattern " << p << " is too short" << endl;
+                ok = false;
+            }
+            continue;
+        }
+        if (!answered || matches != expected) {
+            cerr << "Wrong matches for " << p << endl;
+            ok = false;
+        }
+        cout << "'" << p << "': " << expected.size() << " matches, " <<
+            candidates.size() << " candidates, index " << secIndex * 1000 <<
+            "ms scan " << sec.count() * 1000 << "ms" << endl;
+    }
+
+    //The index is not used if the candidates are too many
+    std::vector<uint64_t> candidates;
+    if (idx.getCandidates("\"@en", 4, 1000, candidates)) {
+        cerr << "The candidates should be more than 1000" << endl;
+        ok = false;
+    }
+
+    Utils::remove_all(dir);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
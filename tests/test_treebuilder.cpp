@@ -0,0 +1,221 @@
+#include <trident/tree/treebuilder.h>
+#include <trident/tree/root.h>
+#include <trident/tree/treeitr.h>
+#include <trident/tree/coordinates.h>
+#include <trident/utils/propertymap.h>
+
+#include <kognac/utils.h>
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <random>
+#include <chrono>
+
+using namespace std;
+
+static PropertyMap getConfig(int maxElementsPerNode, int fileMaxSize,
+        int nodeMinBytes) {
+    PropertyMap config;
+    config.setBool(TEXT_KEYS, false);
+    config.setBool(TEXT_VALUES, false);
+    config.setBool(COMPRESSED_NODES, false);
+    config.setInt(MAX_EL_PER_NODE, maxElementsPerNode);
+    config.setInt(FILE_MAX_SIZE, fileMaxSize);
+    config.setLong(CACHE_MAX_SIZE, 1024 * 1024 * 1024);
+    config.setInt(NODE_MIN_BYTES, nodeMinBytes);
+    config.setInt(MAX_NODES_IN_CACHE, 64);
+    config.setInt(LEAF_SIZE_FACTORY, 10);
+    config.setInt(LEAF_SIZE_PREALL_FACTORY, 10);
+    config.setInt(LEAF_ARRAYS_FACTORY_SIZE, 10);
+    config.setInt(LEAF_ARRAYS_PREALL_FACTORY_SIZE, 10);
+    config.setInt(LEAF_MAX_INTERNAL_LINES, 2048);
+    config.setInt(LEAF_MAX_PREALL_INTERNAL_LINES, 2048);
+    config.setInt(NODE_KEYS_FACTORY_SIZE, 10);
+    config.setInt(NODE_KEYS_PREALL_FACTORY_SIZE, 10);
+    config.setInt(MAX_N_OPENED_FILES, 1024);
+    return config;
+}
+
+struct Entry {
+    int64_t key;
+    TermCoordinates coord;
+};
+
+//Large coordinates fill the values of the leaves before the max number
+//of elements is reached
+static std::vector<Entry> generateEntries(int64_t n, int step, bool large,
+        std::mt19937_64 &gen) {
+    std::vector<Entry> entries;
+    int64_t key = step > 1 ? 3 : 0;
+    for (int64_t i = 0; i < n; ++i) {
+        Entry e;
+        e.key = key;
+        e.coord.clear();
+        for (int perm = 0; perm < N_PARTITIONS; ++perm) {
+            if (perm == 0 || large || gen() % 3 != 0) {
+                const int64_t max = large ? INT64_C(1) << 50 : 1000;
+                e.coord.set(perm, gen() % 1000, gen() % max, 1 + gen() % max,
+                        (char) (gen() % 256));
+            }
+        }
+        entries.push_back(e);
+        key += step > 0 ? step : 1 + gen() % 1000;
+    }
+    return entries;
+}
+
+static bool equals(TermCoordinates &c1, TermCoordinates &c2) {
+    for (int perm = 0; perm < N_PARTITIONS; ++perm) {
+        if (c1.exists(perm) != c2.exists(perm)) {
+            return false;
+        }
+        if (c1.exists(perm) && (c1.getFileIdx(perm) != c2.getFileIdx(perm) ||
+                    c1.getMark(perm) != c2.getMark(perm) ||
+                    c1.getNElements(perm) != c2.getNElements(perm) ||
+                    c1.getStrategy(perm) != c2.getStrategy(perm))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool test(int64_t n, int step, bool large, int maxElementsPerNode,
+        int fileMaxSize, int nodeMinBytes, int nPartitions) {
+    const string path = "treebuilder";
+    std::mt19937_64 gen(n + step);
+    std::vector<Entry> entries = generateEntries(n, step, large, gen);
+    if (Utils::exists(path)) {
+        Utils::remove_all(path);
+    }
+
+    std::chrono::system_clock::time_point start =
+        std::chrono::system_clock::now();
+    {
+        TreeBuilder builder(path, maxElementsPerNode, fileMaxSize,
+                nodeMinBytes, nPartitions);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nPartitions; ++t) {
+            threads.push_back(std::thread([&builder, &entries, t, nPartitions]() {
+                        const size_t begin = entries.size() * t / nPartitions;
+                        const size_t end = entries.size() * (t + 1) / nPartitions;
+                        for (size_t i = begin; i < end; ++i) {
+                            builder.append(t, entries[i].key, &entries[i].coord);
+                        }
+                        }));
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        builder.finish();
+    }
+    std::chrono::duration<double> sec = std::chrono::system_clock::now()
+        - start;
+
+    PropertyMap config = getConfig(maxElementsPerNode, fileMaxSize,
+            nodeMinBytes);
+    Root root(path, NULL, true, config);
+    int64_t errors = 0;
+    TermCoordinates value;
+    for (auto &e : entries) {
+        if (!root.get(e.key, &value) || !equals(value, e.coord)) {
+            errors++;
+        }
+        //The keys in the gaps must not be found
+        if (step > 1 && root.get(e.key + 1, &value)) {
+            errors++;
+        }
+    }
+    if (!entries.empty() && root.get(entries.back().key + 1000000, &value)) {
+        errors++;
+    }
+
+    TreeItr *itr = root.itr();
+    size_t i = 0;
+    while (itr->hasNext()) {
+        const int64_t key = itr->next(&value);
+        if (i >= entries.size() || key != entries[i].key ||
+                !equals(value, entries[i].coord)) {
+            errors++;
+        }
+        i++;
+    }
+    delete itr;
+    if (i != entries.size()) {
+        errors++;
+    }
+
+    cout << "n=" << n << " step=" << step << " large=" << large <<
+        " maxEl=" << maxElementsPerNode << " partitions=" << nPartitions <<
+        ": built in " << sec.count() * 1000 << " ms errors " << errors << endl;
+    return errors == 0;
+}
+
+//Compares the bulk load with the insertions one by one
+static void benchmark(int64_t n, int nPartitions) {
+    const string path = "treebuilder";
+    std::mt19937_64 gen(0);
+    std::vector<Entry> entries = generateEntries(n, 1, false, gen);
+    if (Utils::exists(path)) {
+        Utils::remove_all(path);
+    }
+
+    std::chrono::system_clock::time_point start =
+        std::chrono::system_clock::now();
+    {
+        PropertyMap config = getConfig(2048, 64 * 1024 * 1024, 0);
+        Root root(path, NULL, false, config);
+        for (auto &e : entries) {
+            root.append(e.key, &e.coord);
+        }
+    }
+    std::chrono::duration<double> secAppend = std::chrono::system_clock::now()
+        - start;
+    Utils::remove_all(path);
+
+    start = std::chrono::system_clock::now();
+    {
+        TreeBuilder builder(path, 2048, 64 * 1024 * 1024, 0, nPartitions);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nPartitions; ++t) {
+            threads.push_back(std::thread([&builder, &entries, t, nPartitions]() {
+                        const size_t begin = entries.size() * t / nPartitions;
+                        const size_t end = entries.size() * (t + 1) / nPartitions;
+                        for (size_t i = begin; i < end; ++i) {
+                            builder.append(t, entries[i].key, &entries[i].coord);
+                        }
+                        }));
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        builder.finish();
+    }
+    std::chrono::duration<double> secBulk = std::chrono::system_clock::now()
+        - start;
+    Utils::remove_all(path);
+
+    cout << "n=" << n << ": append " << secAppend.count() * 1000 <<
+        " ms, bulk load (" << nPartitions << " partitions) " <<
+        secBulk.count() * 1000 << " ms" << endl;
+}
+
+int main(int argc, const char** argv) {
+    bool ok = true;
+    ok &= test(0, 1, false, 2048, 64 * 1024 * 1024, 0, 1);
+    ok &= test(1, 1, false, 2048, 64 * 1024 * 1024, 0, 4);
+    ok &= test(100000, 1, false, 2048, 64 * 1024 * 1024, 0, 4);
+    ok &= test(100000, 2, false, 2048, 64 * 1024 * 1024, 12000, 3);
+    ok &= test(100000, 200, false, 2048, 64 * 1024 * 1024, 0, 4);
+    ok &= test(100000, 0, false, 16, 256 * 1024, 0, 8);
+    ok &= test(100000, 0, true, 2048, 1024 * 1024, 0, 2);
+    ok &= test(1000000, 0, false, 2048, 64 * 1024 * 1024, 12000, 8);
+    Utils::remove_all("treebuilder");
+
+    const int64_t n = argc > 1 ? atol(argv[1]) : 10000000;
+    const int nPartitions = argc > 2 ? atoi(argv[2]) : 8;
+    benchmark(n, nPartitions);
+
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}